@@ -47,6 +47,7 @@ bool EmuSystem::hasPALVideoSystem = true;
 bool EmuSystem::hasResetModes = true;
 IG::Audio::SampleFormat EmuSystem::audioSampleFormat = IG::Audio::SampleFormats::f32;
 bool EmuSystem::hasRectangularPixels = true;
+bool EmuSystem::hasRunAhead = true;
 bool EmuApp::needsGlobalInstance = true;
 
 EmuSystem::NameFilterFunc EmuSystem::defaultFsFilter =
@@ -73,6 +74,7 @@ FS::FileString A2600System::stateFilename(int slot, std::string_view name) const
 void A2600System::closeSystem()
 {
 	osystem.deleteConsole();
+	stateSize_ = 0;
 }
 
 void A2600System::updateSwitchValues()
@@ -219,25 +221,41 @@ void A2600System::reset(EmuApp &, ResetMode mode)
 	}
 }
 
-void A2600System::saveState(IG::CStringView path)
+size_t A2600System::stateSize()
 {
-	Serializer state{path.data()};
-	if(!osystem.state().saveState(state))
+	// the state size only depends on the loaded cartridge, so measure it once
+	if(!stateSize_)
 	{
-		throwFileWriteError();
+		Serializer state;
+		if(!osystem.state().saveState(state))
+			return 0;
+		stateSize_ = state.size();
 	}
+	return stateSize_;
 }
 
-void A2600System::loadState(EmuApp &, IG::CStringView path)
+void A2600System::readState(EmuApp &, std::span<const uint8_t> buff)
 {
-	Serializer state{path.data(), Serializer::Mode::ReadOnly};
+	Serializer state{{const_cast<uint8_t*>(buff.data()), buff.size()}, Serializer::Mode::ReadOnly};
 	if(!osystem.state().loadState(state))
 	{
-		throwFileReadError();
+		throw std::runtime_error("Invalid state data");
 	}
 	updateSwitchValues();
 }
 
+size_t A2600System::writeState(std::span<uint8_t> buff, SaveStateFlags)
+{
+	Serializer state{buff, Serializer::Mode::ReadWrite};
+	if(!osystem.state().saveState(state))
+	{
+		// the data may have outgrown the buffer, measure it again on the next stateSize() call
+		stateSize_ = 0;
+		throw std::runtime_error("Error serializing state");
+	}
+	return state.tellp();
+}
+
 void EmuApp::onCustomizeNavView(EmuApp::NavView &view)
 {
 	const Gfx::LGradientStopDesc navViewGrad[] =
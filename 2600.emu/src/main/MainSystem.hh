@@ -101,8 +101,9 @@ public:
 	[[gnu::hot]] void runFrame(EmuSystemTaskContext task, EmuVideo *video, EmuAudio *audio);
 	FS::FileString stateFilename(int slot, std::string_view name) const;
 	std::string_view stateFilenameExt() const { return ".sta"; }
-	void loadState(EmuApp &, CStringView uri);
-	void saveState(CStringView path);
+	size_t stateSize();
+	void readState(EmuApp &, std::span<const uint8_t> buff);
+	size_t writeState(std::span<uint8_t> buff, SaveStateFlags = {});
 	bool readConfig(ConfigType, MapIO &io, unsigned key, size_t readSize);
 	void writeConfig(ConfigType, FileIO &);
 	void reset(EmuApp &, ResetMode mode);
@@ -124,6 +125,8 @@ public:
 	bool resetSessionOptions(EmuApp &);
 
 private:
+	size_t stateSize_{};
+
 	bool updatePaddle(Input::DragTrackerState dragState);
 	void updateSwitchValues();
 	void updateJoytickMapping(EmuApp &app, Controller::Type type);
@@ -19,6 +19,7 @@
 #define SERIALIZER_HXX
 
 #include "bspf.hxx"
+#include <span>
 
 /**
   This class implements a Serializer device, whereby data is serialized and
@@ -52,6 +53,12 @@ class Serializer
     explicit Serializer(const string& filename, Mode m = Mode::ReadWrite);
     Serializer();
 
+    /**
+      Creates a Serializer device streaming directly to/from the given buffer,
+      writing past its end fails like a full file.
+    */
+    Serializer(std::span<uInt8> buff, Mode m);
+
   public:
     /**
       Answers whether the serializer is currently initialized for reading
@@ -74,6 +81,11 @@ class Serializer
     */
     size_t size();
 
+    /**
+      Returns the current write location in the stream.
+    */
+    size_t tellp();
+
     /**
       Reads a byte value (unsigned 8-bit) from the current input stream.
 
@@ -596,6 +596,7 @@ render1x1.c \
 render1x2.c \
 render1x1pal.c \
 render1x1ntsc.c \
+render-simd.c \
 render1x1rgbi.c \
 render1x2rgbi.c \
 video-canvas.c \
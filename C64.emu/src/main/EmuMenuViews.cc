@@ -161,6 +161,38 @@ class CustomVideoOptionView : public VideoOptionView, public MainAppHelper<Custo
 		borderModeItem
 	};
 
+	BoolMenuItem crtEmulation
+	{
+		"CRT Emulation", &defaultFace(),
+		(bool)system().optionCrtEmulation,
+		[this](BoolMenuItem &item)
+		{
+			system().optionCrtEmulation = item.flipBoolValue(*this);
+			system().setCrtEmulation(system().optionCrtEmulation);
+		}
+	};
+
+	BoolMenuItem threadedRender
+	{
+		"Render On Worker Thread", &defaultFace(),
+		(bool)system().optionThreadedRender,
+		[this](BoolMenuItem &item)
+		{
+			system().setThreadedRender(item.flipBoolValue(*this));
+		}
+	};
+
+	DualTextMenuItem renderTime
+	{
+		"Render Time", system().renderStats.summary(), &defaultFace(),
+		[this](DualTextMenuItem &item)
+		{
+			item.set2ndName(system().renderStats.summary());
+			item.compile2nd(renderer());
+			postDraw();
+		}
+	};
+
 	std::vector<std::string> paletteName{};
 	std::vector<TextMenuItem> paletteItem{};
 
@@ -186,6 +218,9 @@ public:
 		item.emplace_back(&systemSpecificHeading);
 		item.emplace_back(&cropNormalBorders);
 		item.emplace_back(&borderMode);
+		item.emplace_back(&crtEmulation);
+		item.emplace_back(&threadedRender);
+		item.emplace_back(&renderTime);
 		paletteItem.emplace_back("Internal", &defaultFace(),
 			[this](Input::Event)
 			{
@@ -179,6 +179,7 @@ void C64System::applyInitialOptionResources()
 	setBorderMode(optionBorderMode);
 	setSidEngine(optionSidEngine);
 	setReSidSampling(optionReSidSampling);
+	setCrtEmulation(optionCrtEmulation);
 }
 
 int systemCartType(ViceSystem system)
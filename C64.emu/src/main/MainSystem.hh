@@ -19,9 +19,12 @@
 #include <imagine/thread/Semaphore.hh>
 #include <imagine/pixmap/Pixmap.hh>
 #include <imagine/thread/Thread.hh>
+#include <imagine/time/Time.hh>
 #include <imagine/fs/FS.hh>
 #include <emuframework/Option.hh>
 #include <emuframework/EmuSystem.hh>
+#include <atomic>
+#include <memory>
 #include <vector>
 #include <string>
 #include <string_view>
@@ -56,6 +59,7 @@ enum
 	CFGKEY_DEFAULT_MODEL = 282, CFGKEY_DEFAULT_PALETTE_NAME = 283,
 	CFGKEY_DRIVE8_TYPE = 284, CFGKEY_DRIVE9_TYPE = 285,
 	CFGKEY_DRIVE10_TYPE = 286, CFGKEY_DRIVE11_TYPE = 287,
+	CFGKEY_CRT_EMULATION = 288, CFGKEY_THREADED_RENDER = 289,
 };
 
 enum Vic20Ram : uint8_t
@@ -81,11 +85,32 @@ bool hasC64TapeExtension(std::string_view name);
 bool hasC64CartExtension(std::string_view name);
 int systemCartType(ViceSystem system);
 
+// Canvas render cost per emulated frame, averaged over one second of frames
+class CanvasRenderStats
+{
+public:
+	void addTime(SteadyClockTime t) { frameTime += t; }
+	void endFrame();
+	std::string summary() const;
+
+private:
+	SteadyClockTime frameTime{}, sumTime{}, maxTime{};
+	int frames{};
+	std::atomic<uint32_t> avgUSecs{}, maxUSecs{};
+};
+
 class C64System final: public EmuSystem
 {
 public:
 	double systemFrameRate{60.};
 	std::binary_semaphore execSem{0}, execDoneSem{0};
+	// threaded rendering: the canvas of frame N renders on renderThread while frame N+1 emulates
+	std::binary_semaphore renderSem{0}, renderDoneSem{0};
+	std::vector<uint8_t> renderSrcBuff;
+	std::unique_ptr<uint8_t[]> renderPixmapData;
+	struct video_canvas_s *renderCanvas{};
+	struct CanvasRect { int xs, ys, xt, yt, w, h; } renderRect{};
+	CanvasRenderStats renderStats;
 	EmuAudio *audioPtr{};
 	struct video_canvas_s *activeCanvas{};
 	const char *sysFileDir{};
@@ -98,9 +123,11 @@ public:
 	std::atomic_bool runningFrame{};
 	bool ctrlLock{};
 	bool c64IsInit{}, c64FailedInit{};
+	bool renderPending{}, renderPrevQueued{};
 	std::array <FS::PathString, Config::envIsLinux ? 3 : 1> sysFilePath{};
 	std::array<char, 21> externalPaletteResStr{};
 	std::array<char, 17> paletteFileResStr{};
+	std::array<char, 12> filterResStr{};
 	Byte1Option optionDriveTrueEmulation{CFGKEY_DRIVE_TRUE_EMULATION, 0};
 	Byte1Option optionCropNormalBorders{CFGKEY_CROP_NORMAL_BORDERS, 1};
 	Byte1Option optionAutostartWarp{CFGKEY_AUTOSTART_WARP, 1};
@@ -118,6 +145,8 @@ public:
 	Byte1Option optionSwapJoystickPorts{CFGKEY_SWAP_JOYSTICK_PORTS, JoystickMode::NORMAL, false,
 		optionIsValidWithMax<JoystickMode::KEYBOARD>};
 	Byte1Option optionAutostartOnLaunch{CFGKEY_AUTOSTART_ON_LOAD, 1};
+	Byte1Option optionCrtEmulation{CFGKEY_CRT_EMULATION, 0};
+	Byte1Option optionThreadedRender{CFGKEY_THREADED_RENDER, 0};
 	// VIC-20 specific
 	Byte1Option optionVic20RamExpansions{CFGKEY_VIC20_RAM_EXPANSIONS, 0};
 	// C64 specific
@@ -133,6 +162,16 @@ public:
 				logMsg("starting maincpu_mainloop()");
 				plugin.maincpu_mainloop();
 			});
+		makeDetachedThread(
+			[this]()
+			{
+				while(true)
+				{
+					renderSem.acquire();
+					renderCanvasJob();
+					renderDoneSem.release();
+				}
+			});
 
 		if(sysFilePath.size() == 3)
 		{
@@ -181,6 +220,11 @@ public:
 	bool currSystemIsC64Or128() const;
 	void setRuntimeReuSize(int size);
 	void resetCanvasSourcePixmap(struct video_canvas_s *c);
+	void setCrtEmulation(bool on);
+	bool crtEmulation() const;
+	void setThreadedRender(bool on);
+	void waitCanvasRender();
+	void endCanvasFrame(struct video_canvas_s *);
 
 	// required API functions
 	void loadContent(IO &, EmuSystemCreateParams, OnLoadProgressDelegate);
@@ -228,6 +272,9 @@ protected:
 	void execC64Frame();
 	void startCanvasRunningFrame();
 	void setCanvasSkipFrame(bool on);
+	void queueCanvasRender(struct video_canvas_s *);
+	void finishCanvasRender(struct video_canvas_s *);
+	void renderCanvasJob();
 	bool updateCanvasPixelFormat(struct video_canvas_s *, PixelFormat);
 };
 
@@ -454,6 +454,26 @@ void VicePlugin::video_canvas_render(struct video_canvas_s *canvas, uint8_t *trg
 	}
 }
 
+void VicePlugin::video_canvas_render_prepare(struct video_canvas_s *canvas,
+	int width, int height, int xs, int ys)
+{
+	if(video_canvas_render_prepare_)
+	{
+		video_canvas_render_prepare_(canvas, width, height, xs, ys);
+	}
+}
+
+void VicePlugin::video_canvas_render_source(struct video_canvas_s *canvas, uint8_t *src,
+	int pitchs, uint8_t *trg, int width, int height,
+	int xs, int ys, int xt, int yt, int pitcht)
+{
+	if(video_canvas_render_source_)
+	{
+		video_canvas_render_source_(canvas, src, pitchs, trg, width, height,
+			xs, ys, xt, yt, pitcht);
+	}
+}
+
 void VicePlugin::video_render_setphysicalcolor(video_render_config_t *config,
 	int index, uint32_t color, int depth)
 {
@@ -585,6 +605,8 @@ VicePlugin commonVicePlugin(void *lib, ViceSystem system)
 	loadSymbolCheck(plugin.drive_check_type_, lib, "drive_check_type");
 	loadSymbolCheck(plugin.sound_register_device_, lib, "sound_register_device");
 	loadSymbolCheck(plugin.video_canvas_render_, lib, "video_canvas_render");
+	loadSymbolCheck(plugin.video_canvas_render_prepare_, lib, "video_canvas_render_prepare");
+	loadSymbolCheck(plugin.video_canvas_render_source_, lib, "video_canvas_render_source");
 	loadSymbolCheck(plugin.video_render_setphysicalcolor_, lib, "video_render_setphysicalcolor");
 	loadSymbolCheck(plugin.video_render_setrawrgb_, lib, "video_render_setrawrgb");
 	loadSymbolCheck(plugin.video_render_initraw_, lib, "video_render_initraw");
@@ -86,6 +86,11 @@ struct VicePlugin
 	void (*video_canvas_render_)(struct video_canvas_s *canvas, uint8_t *trg,
 		int width, int height, int xs, int ys,
 		int xt, int yt, int pitcht){};
+	void (*video_canvas_render_prepare_)(struct video_canvas_s *canvas,
+		int width, int height, int xs, int ys){};
+	void (*video_canvas_render_source_)(struct video_canvas_s *canvas, uint8_t *src,
+		int pitchs, uint8_t *trg, int width, int height,
+		int xs, int ys, int xt, int yt, int pitcht){};
 	void (*video_render_setphysicalcolor_)(video_render_config_t *config,
 		int index, uint32_t color, int depth){};
 	void (*video_render_setrawrgb_)(video_render_color_tables_t *color_tab, unsigned int index,
@@ -137,6 +142,11 @@ struct VicePlugin
 	void video_canvas_render(struct video_canvas_s *canvas, uint8_t *trg,
     int width, int height, int xs, int ys,
     int xt, int yt, int pitcht);
+	void video_canvas_render_prepare(struct video_canvas_s *canvas,
+		int width, int height, int xs, int ys);
+	void video_canvas_render_source(struct video_canvas_s *canvas, uint8_t *src,
+		int pitchs, uint8_t *trg, int width, int height,
+		int xs, int ys, int xt, int yt, int pitcht);
 	void video_render_setphysicalcolor(video_render_config_t *config,
 		int index, uint32_t color, int depth);
 	void video_render_setrawrgb(video_render_color_tables_t *color_tab, unsigned int index,
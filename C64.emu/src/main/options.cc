@@ -100,6 +100,7 @@ void C64System::onOptionsLoaded()
 	}
 	IG::formatTo(externalPaletteResStr, "{}ExternalPalette", videoChipStr());
 	IG::formatTo(paletteFileResStr, "{}PaletteFile", videoChipStr());
+	IG::formatTo(filterResStr, "{}Filter", videoChipStr());
 	optionDefaultModel = SByte1Option{CFGKEY_DEFAULT_MODEL, plugin.defaultModelId, false, modelIdIsValid};
 	optionModel = SByte1Option{CFGKEY_MODEL, -1, false, modelIdIsValid};
 }
@@ -182,6 +183,8 @@ bool C64System::readConfig(ConfigType type, MapIO &io, unsigned key, size_t read
 			case CFGKEY_SYSTEM_FILE_PATH:
 				return readStringOptionValue<FS::PathString>(io, readSize, [&](auto &&path){sysFilePath[0] = IG_forward(path);});
 			case CFGKEY_RESID_SAMPLING: return optionReSidSampling.readFromIO(io, readSize);
+			case CFGKEY_CRT_EMULATION: return optionCrtEmulation.readFromIO(io, readSize);
+			case CFGKEY_THREADED_RENDER: return optionThreadedRender.readFromIO(io, readSize);
 		}
 	}
 	else if(type == ConfigType::CORE)
@@ -236,6 +239,8 @@ void C64System::writeConfig(ConfigType type, FileIO &io)
 		optionCropNormalBorders.writeWithKeyIfNotDefault(io);
 		optionSidEngine.writeWithKeyIfNotDefault(io);
 		optionReSidSampling.writeWithKeyIfNotDefault(io);
+		optionCrtEmulation.writeWithKeyIfNotDefault(io);
+		optionThreadedRender.writeWithKeyIfNotDefault(io);
 		writeStringOptionValue(io, CFGKEY_SYSTEM_FILE_PATH, sysFilePath[0]);
 	}
 	else if(type == ConfigType::CORE)
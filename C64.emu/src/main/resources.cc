@@ -19,6 +19,7 @@
 extern "C"
 {
 	#include "resources.h"
+	#include "video.h"
 }
 
 namespace EmuEx
@@ -143,6 +144,17 @@ int C64System::reSidSampling() const
 	return intResource("SidResidSampling");
 }
 
+void C64System::setCrtEmulation(bool on)
+{
+	logMsg("set CRT emulation %d", on);
+	setIntResource(filterResStr.data(), on ? VIDEO_FILTER_CRT : VIDEO_FILTER_NONE);
+}
+
+bool C64System::crtEmulation() const
+{
+	return intResource(filterResStr.data()) == VIDEO_FILTER_CRT;
+}
+
 void C64System::setVirtualDeviceTraps(bool on)
 {
 	setIntResource("VirtualDevice8", on);
@@ -17,6 +17,8 @@
 #include <emuframework/EmuSystem.hh>
 #include <emuframework/EmuApp.hh>
 #include "MainSystem.hh"
+#include <imagine/util/format.hh>
+#include <cstring>
 
 extern "C"
 {
@@ -37,6 +39,31 @@ static EmuEx::C64System &c64Sys(struct video_canvas_s *c)
 	return *(EmuEx::C64System*)c->systemPtr;
 }
 
+static uint32_t toUSecs(SteadyClockTime t)
+{
+	return std::chrono::duration_cast<Microseconds>(t).count();
+}
+
+void CanvasRenderStats::endFrame()
+{
+	sumTime += frameTime;
+	maxTime = std::max(maxTime, frameTime);
+	frameTime = {};
+	if(++frames < 60)
+		return;
+	avgUSecs.store(toUSecs(sumTime / frames), std::memory_order_relaxed);
+	maxUSecs.store(toUSecs(maxTime), std::memory_order_relaxed);
+	logMsg("canvas render avg:%uus max:%uus", (unsigned)toUSecs(sumTime / frames), (unsigned)toUSecs(maxTime));
+	sumTime = maxTime = {};
+	frames = 0;
+}
+
+std::string CanvasRenderStats::summary() const
+{
+	return fmt::format("{:.2f}ms avg / {:.2f}ms max",
+		avgUSecs.load(std::memory_order_relaxed) / 1000., maxUSecs.load(std::memory_order_relaxed) / 1000.);
+}
+
 void C64System::setCanvasSkipFrame(bool on)
 {
 	if(activeCanvas)
@@ -55,6 +82,8 @@ void vsync_do_vsync2(struct video_canvas_s *c)
 	if(sys.runningFrame) [[likely]]
 	{
 		//logMsg("vsync_do_vsync signaling main thread");
+		if(sys.activeCanvas)
+			sys.endCanvasFrame(sys.activeCanvas);
 		sys.runningFrame = false;
 		sys.execDoneSem.release();
 		sys.execSem.acquire();
@@ -107,6 +136,7 @@ void video_arch_canvas_init(struct video_canvas_s *c)
 
 int video_canvas_set_palette(video_canvas_t *c, struct palette_s *palette)
 {
+	c64Sys(c).waitCanvasRender();
 	IG::PixelFormat fmt{(IG::PixelFormatID)c->pixelFormat};
 	const auto pDesc = pixelDesc(fmt);
 	auto colorTables = &c->videoconfig->color_tables;
@@ -131,20 +161,134 @@ int video_canvas_set_palette(video_canvas_t *c, struct palette_s *palette)
 	return 0;
 }
 
-void video_canvas_refresh(struct video_canvas_s *c, unsigned int xs, unsigned int ys, unsigned int xi, unsigned int yi, unsigned int w, unsigned int h)
+static C64System::CanvasRect canvasRenderRect(struct video_canvas_s *c, unsigned int xs, unsigned int ys,
+	unsigned int xi, unsigned int yi, unsigned int w, unsigned int h)
 {
-	if(!c->created) [[unlikely]]
-		return;
 	xi *= c->videoconfig->scalex;
 	w *= c->videoconfig->scalex;
 	yi *= c->videoconfig->scaley;
 	h *= c->videoconfig->scaley;
+	return {(int)xs, (int)ys, (int)xi, (int)yi, std::min((int)w, c->w), std::min((int)h, c->h)};
+}
+
+static C64System::CanvasRect fullCanvasRenderRect(video_canvas_t *canvas)
+{
+	auto viewport = canvas->viewport;
+	auto geometry = canvas->geometry;
+	return canvasRenderRect(canvas,
+		viewport->first_x + geometry->extra_offscreen_border_left,
+		viewport->first_line,
+		viewport->x_offset,
+		viewport->y_offset,
+		std::min(canvas->draw_buffer->canvas_width, geometry->screen_size.width - viewport->first_x),
+		std::min(canvas->draw_buffer->canvas_height, viewport->last_line - viewport->first_line + 1));
+}
+
+void video_canvas_refresh(struct video_canvas_s *c, unsigned int xs, unsigned int ys, unsigned int xi, unsigned int yi, unsigned int w, unsigned int h)
+{
+	if(!c->created) [[unlikely]]
+		return;
+	auto &sys = c64Sys(c);
+	bool threaded = sys.optionThreadedRender && c == sys.activeCanvas;
+	if(threaded)
+	{
+		if(sys.runningFrame)
+			return; // full canvas is queued at vsync in endCanvasFrame()
+		sys.waitCanvasRender();
+	}
+	auto r = canvasRenderRect(c, xs, ys, xi, yi, w, h);
 	auto pixView = pixmapView(c);
+	auto time = timeFunc([&]()
+	{
+		sys.plugin.video_canvas_render(c, (uint8_t*)pixView.data(), r.w, r.h, r.xs, r.ys, r.xt, r.yt, pixView.pitchBytes());
+	});
+	if(!threaded)
+		sys.renderStats.addTime(time);
+}
+
+void C64System::endCanvasFrame(struct video_canvas_s *c)
+{
+	if(!optionThreadedRender)
+	{
+		waitCanvasRender();
+		if(!c->skipFrame)
+			renderStats.endFrame();
+		return;
+	}
+	if(c->skipFrame || !c->created || !c->pixmapData)
+	{
+		renderPrevQueued = false;
+		return;
+	}
+	// Present the previous frame's render and queue this one. After a skipped frame
+	// there's nothing to present yet, so wait for this frame's render instead.
+	bool catchUp = !renderPrevQueued;
+	finishCanvasRender(c);
+	queueCanvasRender(c);
+	if(catchUp)
+		finishCanvasRender(c);
+	renderPrevQueued = true;
+}
 
-	w = std::min((int)w, pixView.w());
-	h = std::min((int)h, pixView.h());
+void C64System::queueCanvasRender(struct video_canvas_s *c)
+{
+	auto r = fullCanvasRenderRect(c);
+	plugin.video_canvas_render_prepare(c, r.w, r.h, r.xs, r.ys);
+	// snapshot the draw buffer including the 2 lines of padding on each side read by the CRT filters
+	auto drawBuff = c->draw_buffer;
+	size_t padBytes = drawBuff->draw_buffer_width * 2;
+	size_t buffBytes = drawBuff->draw_buffer_width * (drawBuff->draw_buffer_height + 4);
+	renderSrcBuff.resize(buffBytes);
+	std::memcpy(renderSrcBuff.data(), drawBuff->draw_buffer - padBytes, buffBytes);
+	if(!renderPixmapData)
+		renderPixmapData = std::make_unique<uint8_t[]>(pixmapView(c).bytes());
+	renderCanvas = c;
+	renderRect = r;
+	renderPending = true;
+	renderSem.release();
+}
 
-	c64Sys(c).plugin.video_canvas_render(c, (uint8_t*)pixView.data(), w, h, xs, ys, xi, yi, pixView.pitchBytes());
+void C64System::finishCanvasRender(struct video_canvas_s *c)
+{
+	if(!renderPending)
+		return;
+	renderDoneSem.acquire();
+	renderPending = false;
+	auto renderedData = renderPixmapData.release();
+	renderPixmapData.reset(c->pixmapData);
+	c->pixmapData = renderedData;
+	resetCanvasSourcePixmap(c);
+}
+
+void C64System::waitCanvasRender()
+{
+	if(renderPending)
+	{
+		renderDoneSem.acquire();
+		renderPending = false;
+	}
+	renderPrevQueued = false;
+}
+
+void C64System::renderCanvasJob()
+{
+	auto c = renderCanvas;
+	auto &r = renderRect;
+	auto pitchs = c->draw_buffer->draw_buffer_width;
+	auto time = timeFunc([&]()
+	{
+		plugin.video_canvas_render_source(c, renderSrcBuff.data() + pitchs * 2, pitchs,
+			renderPixmapData.get(), r.w, r.h, r.xs, r.ys, r.xt, r.yt, pixmapView(c).pitchBytes());
+	});
+	renderStats.addTime(time);
+	renderStats.endFrame();
+}
+
+void C64System::setThreadedRender(bool on)
+{
+	if(!on)
+		waitCanvasRender();
+	optionThreadedRender = on;
 }
 
 void C64System::resetCanvasSourcePixmap(struct video_canvas_s *c)
@@ -182,6 +326,9 @@ static void updateCanvasMemPixmap(struct video_canvas_s *c, int x, int y)
 	IG::PixelFormat fmt{(IG::PixelFormatID)c->pixelFormat};
 	assumeExpr(isValidPixelFormat(fmt));
 	IG::PixmapDesc desc{{x, y}, fmt};
+	auto &sys = c64Sys(c);
+	sys.waitCanvasRender();
+	sys.renderPixmapData.reset();
 	c->w = x;
 	c->h = y;
 	delete[] c->pixmapData;
@@ -240,8 +387,12 @@ void video_canvas_destroy(struct video_canvas_s *c)
 {
 	logMsg("canvas destroy:0x%p", c);
 	c->created = false;
+	c64Sys(c).waitCanvasRender();
 	delete[] c->pixmapData;
 	c->pixmapData = {};
 	if(c == c64Sys(c).activeCanvas)
+	{
 		c64Sys(c).activeCanvas = {};
+		c64Sys(c).renderPixmapData.reset();
+	}
 }
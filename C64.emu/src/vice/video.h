@@ -267,6 +267,11 @@ extern void video_canvas_resize(struct video_canvas_s *canvas, char resize_canva
 extern void video_canvas_render(struct video_canvas_s *canvas, uint8_t *trg,
                                 int width, int height, int xs, int ys,
                                 int xt, int yt, int pitcht);
+extern void video_canvas_render_prepare(struct video_canvas_s *canvas,
+                                        int width, int height, int xs, int ys);
+extern void video_canvas_render_source(struct video_canvas_s *canvas, uint8_t *src,
+                                       int pitchs, uint8_t *trg, int width, int height,
+                                       int xs, int ys, int xt, int yt, int pitcht);
 extern void video_canvas_refresh_all(struct video_canvas_s *canvas);
 extern char video_canvas_can_resize(struct video_canvas_s *canvas);
 extern void video_viewport_get(struct video_canvas_s *canvas,
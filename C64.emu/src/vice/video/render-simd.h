@@ -0,0 +1,50 @@
+/*
+ * render-simd.h - Vectorized line kernels for the 1x1 renderers.
+ *
+ * This file is part of VICE, the Versatile Commodore Emulator.
+ * See README for copyright notice.
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA
+ *  02111-1307  USA.
+ *
+ */
+
+#ifndef VICE_RENDER_SIMD_H
+#define VICE_RENDER_SIMD_H
+
+#include "types.h"
+
+#include "video.h"
+
+/* 256 color palette lookup of one line */
+extern void render_simd_palette_line(uint32_t *trg, const uint8_t *src,
+                                     const uint32_t *colortab, unsigned int width);
+
+/* Fill the PAL delay line for the source line before the first rendered one.
+   U values are stored at line[0..width) and V at line[VIDEO_MAX_OUTPUT_WIDTH..]. */
+extern void render_simd_pal_delay_line(int32_t *line, const uint8_t *src, unsigned int width,
+                                       const int32_t *cbtable, const int32_t *crtable);
+
+/* Render one PAL/NTSC line of width pixels, src points 2 pixels left of the
+   first pixel since every output pixel filters a 4 pixel window. */
+extern void render_simd_pal_line(const video_render_color_tables_t *color_tab,
+                                 uint32_t *trg, const uint8_t *src, unsigned int width,
+                                 const int32_t *cbtable, const int32_t *crtable,
+                                 int32_t *line, int off_flip);
+extern void render_simd_ntsc_line(const video_render_color_tables_t *color_tab,
+                                  uint32_t *trg, const uint8_t *src, unsigned int width,
+                                  const int32_t *cbtable, const int32_t *crtable);
+
+#endif
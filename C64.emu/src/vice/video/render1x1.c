@@ -27,6 +27,7 @@
 #include "vice.h"
 
 #include "render1x1.h"
+#include "render-simd.h"
 #include "types.h"
 
 
@@ -39,43 +40,12 @@ void render_32_1x1_04(const video_render_color_tables_t *color_tab, const uint8_
                       const unsigned int pitchs, const unsigned int pitcht)
 {
     const uint32_t *colortab = color_tab->physical_colors;
-    const uint8_t *tmpsrc;
-    uint32_t *tmptrg;
-    unsigned int x, y, wstart, wfast, wend;
+    unsigned int y;
 
     src = src + pitchs * ys + xs;
     trg = trg + pitcht * yt + (xt << 2);
-    if (width < 8) {
-        wstart = width;
-        wfast = 0;
-        wend = 0;
-    } else {
-        /* alignment: 8 pixels*/
-        wstart = (unsigned int)(8 - (vice_ptr_to_uint(trg) & 7));
-        wfast = (width - wstart) >> 3; /* fast loop for 8 pixel segments*/
-        wend = (width - wstart) & 0x07; /* do not forget the rest*/
-    }
     for (y = 0; y < height; y++) {
-        tmpsrc = src;
-        tmptrg = (uint32_t *)trg;
-        for (x = 0; x < wstart; x++) {
-            *tmptrg++ = colortab[*tmpsrc++];
-        }
-        for (x = 0; x < wfast; x++) {
-            tmptrg[0] = colortab[tmpsrc[0]];
-            tmptrg[1] = colortab[tmpsrc[1]];
-            tmptrg[2] = colortab[tmpsrc[2]];
-            tmptrg[3] = colortab[tmpsrc[3]];
-            tmptrg[4] = colortab[tmpsrc[4]];
-            tmptrg[5] = colortab[tmpsrc[5]];
-            tmptrg[6] = colortab[tmpsrc[6]];
-            tmptrg[7] = colortab[tmpsrc[7]];
-            tmpsrc += 8;
-            tmptrg += 8;
-        }
-        for (x = 0; x < wend; x++) {
-            *tmptrg++ = colortab[*tmpsrc++];
-        }
+        render_simd_palette_line((uint32_t *)trg, src, colortab, width);
         src += pitchs;
         trg += pitcht;
     }
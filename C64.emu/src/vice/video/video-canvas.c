@@ -46,6 +46,7 @@
 #include "video-canvas.h"
 #include "video-color.h"
 #include "video-render.h"
+#include "video-sound.h"
 #include "video.h"
 #include "viewport.h"
 
@@ -114,6 +115,17 @@ void video_canvas_shutdown(video_canvas_t *canvas)
 void video_canvas_render(video_canvas_t *canvas, uint8_t *trg, int width,
                          int height, int xs, int ys, int xt, int yt,
                          int pitcht)
+{
+    video_canvas_render_prepare(canvas, width, height, xs, ys);
+    video_canvas_render_source(canvas, canvas->draw_buffer->draw_buffer,
+                               canvas->draw_buffer->draw_buffer_width,
+                               trg, width, height, xs, ys, xt, yt, pitcht);
+}
+
+/* First half of video_canvas_render(), updates the palette and video sound
+   from the draw buffer and must run on the emulation thread */
+void video_canvas_render_prepare(video_canvas_t *canvas, int width, int height,
+                                 int xs, int ys)
 {
     viewport_t *viewport = canvas->viewport;
 #ifdef VIDEO_SCALE_SOURCE
@@ -130,10 +142,27 @@ void video_canvas_render(video_canvas_t *canvas, uint8_t *trg, int width,
     if (!canvas->videoconfig->color_tables.updated) { /* update colors as necessary */
         video_color_update_palette(canvas);
     }
-    video_render_main(canvas->videoconfig, canvas->draw_buffer->draw_buffer,
-                      trg, width, height, xs, ys, xt, yt,
-                      canvas->draw_buffer->draw_buffer_width, pitcht,
-                      viewport);
+    if (width > 0) {
+        video_sound_update(canvas->videoconfig, canvas->draw_buffer->draw_buffer,
+                           width, height, xs, ys,
+                           canvas->draw_buffer->draw_buffer_width, viewport);
+    }
+}
+
+/* Second half of video_canvas_render(), renders from src which may be a copy
+   of the draw buffer. Only reads the canvas render state so it can run on
+   another thread while emulation continues, as long as the palette isn't
+   changed at the same time. */
+void video_canvas_render_source(video_canvas_t *canvas, uint8_t *src, int pitchs,
+                                uint8_t *trg, int width, int height,
+                                int xs, int ys, int xt, int yt, int pitcht)
+{
+#ifdef VIDEO_SCALE_SOURCE
+    xs /= canvas->videoconfig->scalex;
+    ys /= canvas->videoconfig->scaley;
+#endif
+    video_render_frame(canvas->videoconfig, src, trg, width, height,
+                       xs, ys, xt, yt, pitchs, pitcht, canvas->viewport);
 }
 
 /** \brief Force refresh all tracked canvases.
@@ -75,8 +75,6 @@ void video_render_main(video_render_config_t *config, uint8_t *src, uint8_t *trg
                        int width, int height, int xs, int ys, int xt, int yt,
                        int pitchs, int pitcht, viewport_t *viewport)
 {
-    int rendermode;
-
 #if 0
     log_debug("w:%i h:%i xs:%i ys:%i xt:%i yt:%i ps:%i pt:%i d%i",
               width, height, xs, ys, xt, yt, pitchs, pitcht, depth);
@@ -87,6 +85,21 @@ void video_render_main(video_render_config_t *config, uint8_t *src, uint8_t *trg
     }
 
     video_sound_update(config, src, width, height, xs, ys, pitchs, viewport);
+    video_render_frame(config, src, trg, width, height, xs, ys, xt, yt,
+                       pitchs, pitcht, viewport);
+}
+
+/* Same as video_render_main() without the video sound update, so it only
+   reads the source buffer and color tables and can run on another thread. */
+void video_render_frame(video_render_config_t *config, uint8_t *src, uint8_t *trg,
+                        int width, int height, int xs, int ys, int xt, int yt,
+                        int pitchs, int pitcht, viewport_t *viewport)
+{
+    int rendermode;
+
+    if (width <= 0) {
+        return;
+    }
 
     rendermode = config->rendermode;
 
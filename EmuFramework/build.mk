@@ -1,8 +1,12 @@
 include $(IMAGINE_PATH)/make/imagineStaticLibBase.mk
 
 SRC += \
+ArchiveContentCache.cc \
+AudioResampler.cc \
+AudioStats.cc \
 AutosaveManager.cc \
 ConfigFile.cc \
+ContentDigest.cc \
 EmuApp.cc \
 EmuAudio.cc \
 EmuInput.cc \
@@ -12,10 +16,16 @@ EmuSystemTask.cc \
 EmuTiming.cc \
 EmuVideo.cc \
 EmuVideoLayer.cc \
+FrameTimingStats.cc \
+LocalLink.cc \
 OutputTimingManager.cc \
 pathUtils.cc \
+RewindManager.cc \
+RunAheadManager.cc \
+StateWriteTask.cc \
 VideoImageEffect.cc \
 VideoImageOverlay.cc \
+VideoPostProcessor.cc \
 gui/AudioOptionView.cc \
 gui/AutosaveSlotView.cc \
 gui/BundledGamesView.cc \
@@ -66,8 +76,15 @@ LDLIBS := -l$(libName) $(LDLIBS)
 
 CFLAGS_WARN += -Werror=implicit-fallthrough
 
+# count C++ heap allocations for the command line benchmark's allocsPerFrame,
+# only set by linux-x86_64-benchmark.mk since it replaces the global operator new/delete
+ifdef emuframeworkAllocStats
+ CPPFLAGS += -DCONFIG_EMUFRAMEWORK_ALLOC_STATS
+endif
+
 include $(IMAGINE_PATH)/make/package/imagine.mk
 include $(IMAGINE_PATH)/make/package/stdc++.mk
+include $(IMAGINE_PATH)/make/package/zlib.mk
 
 include $(IMAGINE_PATH)/make/imagineStaticLibTarget.mk
 
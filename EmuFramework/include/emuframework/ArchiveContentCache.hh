@@ -0,0 +1,109 @@
+#pragma once
+
+/*  This file is part of EmuFramework.
+
+	Imagine is free software: you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation, either version 3 of the License, or
+	(at your option) any later version.
+
+	Imagine is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License
+	along with EmuFramework.  If not, see <http://www.gnu.org/licenses/> */
+
+#include <imagine/base/ApplicationContext.hh>
+#include <imagine/io/IO.hh>
+#include <imagine/fs/FSDefs.hh>
+#include <imagine/util/string/CStringView.hh>
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <vector>
+
+namespace IG
+{
+class MapIO;
+class FileIO;
+}
+
+namespace EmuEx
+{
+
+using namespace IG;
+
+// Persistent index of solid archives that content was loaded from, keyed by the archive's
+// path, size, & modification time. Each record holds the entry that was loaded along
+// with its size & CRC32, and a copy of its decompressed data in the cache directory
+// so re-opening the archive skips scanning & decompression entirely. Data files are
+// checked against their CRC32 when used and evicted in least recently used order once
+// their total size exceeds the budget.
+
+class ArchiveContentCache
+{
+public:
+	static constexpr uint16_t defaultMaxMiB = 256;
+	static constexpr uint16_t maxMiBLimit = 4096;
+
+	struct Key
+	{
+		std::string_view path;
+		size_t size;
+		FS::file_time_type lastWriteTime;
+	};
+
+	struct Content
+	{
+		FS::FileString name;
+		IO io;
+	};
+
+	ArchiveContentCache(ApplicationContext ctx): ctx{ctx} {}
+	// Returns the previously cached entry of the archive if it's still valid
+	std::optional<Content> find(Key);
+	// Stores the entry's data & returns it as a memory-backed IO, returns the original
+	// IO if caching is off or it's too large to cache
+	IO insert(Key, std::string_view entryName, uint32_t entryCrc32, IO entryIO);
+	// Deletes all cached data
+	void clear();
+	// 0 turns off caching & deletes the cached data, a smaller budget evicts entries to fit
+	bool setMaxMiB(uint16_t mib);
+	uint16_t maxMiB() const { return maxMiB_; }
+	bool isEnabled() const { return maxMiB_; }
+	bool readConfig(MapIO &, unsigned key, size_t size);
+	void writeConfig(FileIO &) const;
+
+private:
+	struct Record
+	{
+		uint64_t id;
+		std::string archivePath;
+		size_t archiveSize;
+		int64_t lastWriteTime;
+		std::string entryName;
+		size_t entrySize;
+		uint32_t entryCrc32;
+		uint64_t lastUse;
+	};
+
+	ApplicationContext ctx;
+	std::vector<Record> records;
+	uint16_t maxMiB_{defaultMaxMiB};
+	uint64_t useCounter{};
+	bool indexLoaded{};
+
+	size_t maxBytes() const { return size_t(maxMiB_) * 1024 * 1024; }
+	FS::PathString cacheDir() const;
+	FS::PathString dataPath(uint64_t id) const;
+	void loadIndex();
+	void saveIndex() const;
+	void removeRecord(std::vector<Record>::iterator);
+	void evict(size_t neededBytes);
+	static bool isCacheable(Key);
+	static uint64_t makeId(Key);
+};
+
+}
@@ -43,13 +43,18 @@ protected:
 	TextMenuItem soundBuffersItem[7];
 	MultiChoiceMenuItem soundBuffers;
 	BoolMenuItem addSoundBuffersOnUnderrun;
+	BoolMenuItem dynamicRateControl;
+	TextMenuItem resamplerQualityItem[3];
+	MultiChoiceMenuItem resamplerQuality;
 	StaticArrayList<TextMenuItem, 5> audioRateItem;
 	MultiChoiceMenuItem audioRate;
 	IG_UseMemberIf(IG::Audio::Manager::HAS_SOLO_MIX, BoolMenuItem, audioSoloMix);
+	BoolMenuItem showStats;
+	TextMenuItem dumpStats;
 	using ApiItemContainer = StaticArrayList<TextMenuItem, MAX_APIS + 1>;
 	IG_UseMemberIf(IG::Audio::Config::MULTIPLE_SYSTEM_APIS, ApiItemContainer, apiItem);
 	IG_UseMemberIf(IG::Audio::Config::MULTIPLE_SYSTEM_APIS, MultiChoiceMenuItem, api);
-	StaticArrayList<MenuItem*, 22> item;
+	StaticArrayList<MenuItem*, 26> item;
 };
 
 }
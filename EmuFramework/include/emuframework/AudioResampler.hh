@@ -0,0 +1,73 @@
+#pragma once
+
+/*  This file is part of EmuFramework.
+
+	Imagine is free software: you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation, either version 3 of the License, or
+	(at your option) any later version.
+
+	Imagine is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License
+	along with EmuFramework.  If not, see <http://www.gnu.org/licenses/> */
+
+#include <imagine/audio/Format.hh>
+#include <imagine/util/enum.hh>
+#include <cstdint>
+#include <cstddef>
+#include <string>
+#include <vector>
+
+namespace EmuEx
+{
+
+// Low: 4-tap cubic interpolation, Medium: 16-tap windowed sinc, High: 32-tap windowed sinc
+WISE_ENUM_CLASS((AudioResamplerQuality, uint8_t),
+	Low,
+	Medium,
+	High);
+
+// Streaming polyphase resampler for interleaved int16 or float frames with 1 or 2 channels.
+// Input is converted into per-channel float history buffers so one SIMD dot product kernel
+// handles all formats, and the fractional position & history carry over between calls so
+// consecutive blocks join without clicks. The ratio is in input frames per output frame and
+// may change per call, the filter table is only rebuilt when it changes the low-pass cutoff.
+
+class AudioResampler
+{
+public:
+	AudioResampler() = default;
+	void setFormat(IG::Audio::Format);
+	void setQuality(AudioResamplerQuality);
+	AudioResamplerQuality quality() const { return quality_; }
+	void reset();
+	// resamples srcFrames of input into dest, returning the number of frames written,
+	// any output past destFrames is dropped
+	size_t resample(void *dest, size_t destFrames, const void *src, size_t srcFrames, double ratio);
+	// upper bound of frames returned by resample() with the given input size and ratio
+	size_t maxOutputFrames(size_t srcFrames, double ratio) const;
+	int taps() const { return taps_; }
+
+private:
+	IG::Audio::Format format{};
+	std::vector<float> history[2];
+	std::vector<float> filterTable;
+	size_t historyFrames{};
+	double pos{};
+	float cutoff{};
+	int taps_{};
+	AudioResamplerQuality quality_{AudioResamplerQuality::Medium};
+
+	void updateFilter(double ratio);
+	void appendInput(const void *src, size_t srcFrames);
+};
+
+// runs each quality preset over a few seconds of generated audio and returns
+// the results in samples per second as JSON
+std::string benchmarkAudioResampler();
+
+}
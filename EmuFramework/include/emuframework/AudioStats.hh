@@ -0,0 +1,131 @@
+#pragma once
+
+/*  This file is part of EmuFramework.
+
+	Imagine is free software: you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation, either version 3 of the License, or
+	(at your option) any later version.
+
+	Imagine is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License
+	along with EmuFramework.  If not, see <http://www.gnu.org/licenses/> */
+
+#include <imagine/util/string/CStringView.hh>
+#include <array>
+#include <atomic>
+#include <bit>
+#include <cstdint>
+#include <string>
+
+namespace IG
+{
+class ApplicationContext;
+}
+
+namespace EmuEx
+{
+
+using namespace IG;
+
+// Histogram with 4 linear sub-buckets per power of 2, written by a single thread and
+// readable from any other thread without locking. Values are never reset, readers
+// compare snapshots to get the distribution over an interval.
+
+class AudioStatsHistogram
+{
+public:
+	static constexpr int subBuckets = 4;
+	static constexpr int buckets = subBuckets + (32 - 2) * subBuckets;
+
+	struct Snapshot
+	{
+		std::array<uint32_t, buckets> counts{};
+		uint32_t samples{};
+
+		Snapshot operator-(const Snapshot &) const;
+		// returns the lower bound of the bucket containing the given percentile (0 - 1)
+		uint32_t percentile(double p) const;
+		uint32_t max() const { return percentile(1.); }
+	};
+
+	// only call from the producer thread
+	void record(uint32_t val)
+	{
+		auto &bucket = counts[bucketIndex(val)];
+		bucket.store(bucket.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+		samples.store(samples.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+	}
+
+	Snapshot snapshot() const;
+	static constexpr int bucketIndex(uint32_t val)
+	{
+		if(val < subBuckets)
+			return val;
+		int exp = 31 - std::countl_zero(val);
+		int sub = (val >> (exp - 2)) & (subBuckets - 1);
+		return subBuckets + (exp - 2) * subBuckets + sub;
+	}
+	static constexpr uint32_t bucketLowerBound(int idx)
+	{
+		if(idx < subBuckets)
+			return idx;
+		int exp = (idx - subBuckets) / subBuckets + 2;
+		int sub = (idx - subBuckets) % subBuckets;
+		return (uint32_t(subBuckets + sub)) << (exp - 2);
+	}
+
+private:
+	std::array<std::atomic_uint32_t, buckets> counts{};
+	std::atomic_uint32_t samples{};
+};
+
+// Audio output instrumentation that's always compiled in. Counters may be incremented from any
+// thread, each histogram has a single producer: the audio callback thread records everything
+// except rateAdjustPpm, which the emulation thread records from EmuAudio::writeFrames().
+
+class AudioStats
+{
+public:
+	std::atomic_uint32_t underruns{};
+	std::atomic_uint32_t overruns{};
+	std::atomic_uint32_t callbacks{};
+	std::atomic_uint32_t rateAdjusts{};
+	std::atomic_uint64_t callbackFrames{};
+	AudioStatsHistogram callbackIntervalUSecs;
+	AudioStatsHistogram framesPerCallback;
+	AudioStatsHistogram bufferFillFrames;
+	// frames queued in the ring buffer plus the callback's request, as time until a
+	// newly written frame reaches the output device
+	AudioStatsHistogram latencyUSecs;
+	AudioStatsHistogram rateAdjustPpm; // absolute deviation from the nominal rate
+
+	struct Snapshot
+	{
+		uint32_t underruns{};
+		uint32_t overruns{};
+		uint32_t callbacks{};
+		uint32_t rateAdjusts{};
+		uint64_t callbackFrames{};
+		AudioStatsHistogram::Snapshot callbackIntervalUSecs;
+		AudioStatsHistogram::Snapshot framesPerCallback;
+		AudioStatsHistogram::Snapshot bufferFillFrames;
+		AudioStatsHistogram::Snapshot latencyUSecs;
+		AudioStatsHistogram::Snapshot rateAdjustPpm;
+
+		Snapshot operator-(const Snapshot &) const;
+		// short multi-line summary for the stats overlay
+		std::string summary() const;
+		// full bucket counts of every histogram
+		std::string report() const;
+	};
+
+	Snapshot snapshot() const;
+	bool dumpToFile(ApplicationContext, CStringView path) const;
+};
+
+}
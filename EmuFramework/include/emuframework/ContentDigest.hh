@@ -0,0 +1,90 @@
+#pragma once
+
+/*  This file is part of EmuFramework.
+
+	Imagine is free software: you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation, either version 3 of the License, or
+	(at your option) any later version.
+
+	Imagine is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License
+	along with EmuFramework.  If not, see <http://www.gnu.org/licenses/> */
+
+#include <imagine/base/ApplicationContext.hh>
+#include <imagine/io/IO.hh>
+#include <imagine/fs/FSDefs.hh>
+#include <imagine/util/string/CStringView.hh>
+#include <imagine/util/bitset.hh>
+#include <imagine/util/enum.hh>
+#include <array>
+#include <cstdint>
+#include <span>
+#include <string>
+#include <vector>
+
+namespace EmuEx
+{
+
+using namespace IG;
+
+enum class ContentDigestMask : uint8_t
+{
+	CRC32 = bit(0),
+	MD5 = bit(1),
+	SHA1 = bit(2),
+};
+
+IG_DEFINE_ENUM_BIT_FLAG_FUNCTIONS(ContentDigestMask);
+
+struct ContentDigest
+{
+	ContentDigestMask types{}; // which of the digests below are valid
+	uint32_t crc32{};
+	std::array<uint8_t, 16> md5{};
+	std::array<uint8_t, 20> sha1{};
+
+	// Computes the requested digests in one pass over the data, using multiple threads for large inputs
+	static ContentDigest compute(std::span<const uint8_t>, ContentDigestMask);
+	constexpr bool has(ContentDigestMask t) const { return (types & t) == t; }
+	constexpr bool operator==(const ContentDigest &) const = default;
+};
+
+// Identifies content files by their digests, keeping a persistent cache keyed by the
+// file's path, size, & modification time so unchanged files aren't hashed again
+
+class ContentIdentifier
+{
+public:
+	static constexpr size_t maxRecords = 512;
+
+	ContentIdentifier(ApplicationContext);
+	// Returns the requested digests of io's data starting at offset, io being the content loaded
+	// from path. If io isn't memory mapped, it's replaced with a buffered copy so its data only
+	// needs to be read once
+	ContentDigest identify(CStringView path, IO &io, ContentDigestMask, size_t offset = 0);
+
+private:
+	struct Record
+	{
+		std::string path;
+		size_t size;
+		int64_t lastWriteTime;
+		size_t offset;
+		ContentDigest digest;
+	};
+
+	ApplicationContext ctx;
+	std::vector<Record> records;
+	bool indexLoaded{};
+
+	FS::PathString indexPath() const;
+	void loadIndex();
+	void saveIndex() const;
+};
+
+}
@@ -18,6 +18,7 @@
 #include <emuframework/config.hh>
 #include <emuframework/EmuSystem.hh>
 #include <emuframework/EmuSystemTask.hh>
+#include <emuframework/StateWriteTask.hh>
 #include <emuframework/EmuAudio.hh>
 #include <emuframework/EmuVideo.hh>
 #include <emuframework/EmuVideoLayer.hh>
@@ -27,7 +28,12 @@
 #include <emuframework/TurboInput.hh>
 #include <emuframework/Option.hh>
 #include <emuframework/AutosaveManager.hh>
+#include <emuframework/ArchiveContentCache.hh>
+#include <emuframework/ContentDigest.hh>
+#include <emuframework/RewindManager.hh>
+#include <emuframework/RunAheadManager.hh>
 #include <emuframework/OutputTimingManager.hh>
+#include <emuframework/FrameTimingStats.hh>
 #include <imagine/input/Input.hh>
 #include <imagine/input/android/MogaManager.hh>
 #include <imagine/gui/ViewManager.hh>
@@ -205,6 +211,13 @@ public:
 	bool saveStateWithSlot(int slot);
 	bool loadState(IG::CStringView path);
 	bool loadStateWithSlot(int slot);
+	void waitForStateWrites() { stateWriteTask.wait(); }
+	// copies backup memory (SRAM, EEPROM, etc.) and writes it to path on the state write thread
+	void saveBackupMemory(IG::CStringView path, std::span<const uint8_t> data) { stateWriteTask.saveBackupMemory(path, data); }
+	void removeBackupMemory(IG::CStringView path) { stateWriteTask.removeBackupMemory(path); }
+	// called on the main thread each time a state file is written
+	void setOnStateWritten(DelegateFunc<void ()>);
+	void dispatchStateWritten() { onStateWritten_.callCopySafe(); }
 	bool shouldOverwriteExistingState() const;
 	const auto &contentSearchPath() const { return contentSearchPath_; }
 	FS::PathString contentSearchPath(std::string_view name) const;
@@ -237,6 +250,14 @@ public:
 	const Screen &emuScreen() const;
 	Window &emuWindow();
 	AutosaveManager &autosaveManager() { return autosaveManager_; }
+	ArchiveContentCache &archiveContentCache() { return archiveContentCache_; }
+	ContentIdentifier &contentIdentifier() { return contentIdentifier_; }
+	RewindManager &rewindManager() { return rewindManager_; }
+	RunAheadManager &runAheadManager() { return runAheadManager_; }
+	FrameTimingStats &frameTimingStats() { return frameTimingStats_; }
+	void setShowFrameTimingGraph(bool on);
+	bool showFrameTimingGraph() const;
+	bool dumpFrameTimingStats();
 	FrameTimeConfig configFrameTime();
 	void setDisabledInputKeys(std::span<const unsigned> keys);
 	void unsetDisabledInputKeys();
@@ -284,6 +305,8 @@ public:
 	void setIntendedFrameRate(Window &, FrameTimeConfig);
 	static std::u16string_view mainViewName();
 	void runBenchmarkOneShot(EmuVideo &);
+	void runBenchmarkFromCommandLine(IG::CStringView path, int frames);
+	std::string runBenchmarkSuite(int frames);
 	void onSelectFileFromPicker(IG::IO, IG::CStringView path, std::string_view displayName,
 		const Input::Event &, EmuSystemCreateParams, ViewAttachParams);
 	void handleOpenFileCommand(IG::CStringView path);
@@ -309,6 +332,13 @@ public:
 	bool soundIsEnabled() const;
 	void setAddSoundBuffersOnUnderrun(bool on);
 	bool addSoundBuffersOnUnderrun() const { return optionAddSoundBuffersOnUnderrun; }
+	void setAudioResamplerQuality(AudioResamplerQuality);
+	AudioResamplerQuality audioResamplerQuality() const { return AudioResamplerQuality(optionAudioResamplerQuality.val); }
+	void setAudioDynamicRateControl(bool on);
+	bool audioDynamicRateControl() const { return optionAudioDynamicRateControl; }
+	void setShowAudioStats(bool on);
+	bool showAudioStats() { return audioStatsTimer.isArmed(); }
+	bool dumpAudioStats();
 	void setSoundDuringFastSlowModeEnabled(bool on);
 	bool soundDuringFastSlowModeIsEnabled() const;
 
@@ -339,6 +369,10 @@ public:
 	auto &showOnSecondScreenOption() { return optionShowOnSecondScreen; }
 	auto &textureBufferModeOption() { return optionTextureBufferMode; }
 	auto &videoImageBuffersOption() { return optionVideoImageBuffers; }
+	void setVideoPostFilter(VideoPostFilter);
+	VideoPostFilter videoPostFilter() const { return VideoPostFilter(optionVideoPostFilter.val); }
+	void setUseGpuPalette(bool on);
+	bool useGpuPalette() const { return optionGpuPalette; }
 	void setUsePresentationTime(bool on) { usePresentationTime_ = on; }
 	bool usePresentationTime() const { return usePresentationTime_; }
 	void setContentRotation(IG::Rotation);
@@ -516,13 +550,22 @@ protected:
 	EmuVideo emuVideo;
 	EmuVideoLayer emuVideoLayer;
 	EmuSystemTask emuSystemTask;
+	StateWriteTask stateWriteTask;
 	mutable Gfx::Texture assetBuffImg[wise_enum::size<AssetFileID>];
 	VController vController;
 	AutosaveManager autosaveManager_;
+	ArchiveContentCache archiveContentCache_;
+	ContentIdentifier contentIdentifier_;
+	RewindManager rewindManager_;
+	RunAheadManager runAheadManager_;
+	IG::Timer audioStatsTimer{"EmuApp::audioStatsTimer"};
+	AudioStats::Snapshot lastAudioStats;
+	FrameTimingStats frameTimingStats_;
 public:
 	OutputTimingManager outputTimingManager;
 protected:
 	DelegateFunc<void ()> onUpdateInputDevices_;
+	DelegateFunc<void ()> onStateWritten_;
 	KeyConfigContainer customKeyConfigs;
 	InputDeviceSavedConfigContainer savedInputDevs;
 	TurboInput turboActions;
@@ -547,6 +590,8 @@ protected:
 	Byte1Option optionSoundVolume;
 	Byte1Option optionSoundBuffers;
 	Byte1Option optionAddSoundBuffersOnUnderrun;
+	Byte1Option optionAudioResamplerQuality;
+	Byte1Option optionAudioDynamicRateControl;
 	IG_UseMemberIf(IG::Audio::Config::MULTIPLE_SYSTEM_APIS, Byte1Option, optionAudioAPI);
 	Byte1Option optionNotificationIcon;
 	Byte1Option optionTitleBar;
@@ -574,6 +619,8 @@ protected:
 	Byte1Option optionShowOnSecondScreen;
 	Byte1Option optionTextureBufferMode;
 	Byte1Option optionVideoImageBuffers;
+	Byte1Option optionVideoPostFilter;
+	Byte1Option optionGpuPalette;
 	bool turboModifierActive{};
 	Gfx::DrawableConfig windowDrawableConf;
 	IG::PixelFormat renderPixelFmt;
@@ -597,6 +644,7 @@ protected:
 	void saveConfigFile(FileIO &);
 	void initOptions(IG::ApplicationContext);
 	std::optional<IG::PixelFormat> renderPixelFormatOption() const;
+	IG::PixelFormat videoRenderPixelFormat() const;
 	void applyRenderPixelFormat();
 	std::optional<IG::PixelFormat> windowDrawablePixelFormatOption() const;
 	std::optional<Gfx::ColorSpace> windowDrawableColorSpaceOption() const;
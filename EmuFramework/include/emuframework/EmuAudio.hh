@@ -15,6 +15,8 @@
 	You should have received a copy of the GNU General Public License
 	along with EmuFramework.  If not, see <http://www.gnu.org/licenses/> */
 
+#include <emuframework/AudioResampler.hh>
+#include <emuframework/AudioStats.hh>
 #include <imagine/audio/OutputStream.hh>
 #include <imagine/time/Time.hh>
 #include <imagine/vmem/RingBuffer.hh>
@@ -42,20 +44,28 @@ public:
 	void stop();
 	void close();
 	void flush();
+	void startWithoutOutput(IG::Microseconds bufferUSecs);
+	void clearBuffer() { rBuff.clear(); }
 	void writeFrames(const void *samples, size_t framesToWrite);
 	void setRate(int rate);
 	void setStereo(bool on);
 	void setSpeedMultiplier(double speed);
 	void setAddSoundBuffersOnUnderrun(bool on);
+	void setResamplerQuality(AudioResamplerQuality);
+	void setDynamicRateControl(bool on);
 	void setVolume(int8_t vol);
 	IG::Audio::Format format() const;
+	const AudioStats &stats() const { return stats_; }
 	explicit operator bool() const;
 
 protected:
 	IG::Audio::OutputStream audioStream;
 	const IG::Audio::Manager *audioManagerPtr{};
 	IG::RingBuffer rBuff;
+	AudioResampler resampler;
+	AudioStats stats_;
 	IG::Time lastUnderrunTime{};
+	IG::Time lastCallbackTime{}; // only accessed from the audio callback
 	double speedMultiplier = 1.;
 	size_t targetBufferFillBytes{};
 	size_t bufferIncrementBytes{};
@@ -64,11 +74,13 @@ protected:
 	float requestedVolume = 1.0;
 	std::atomic<AudioWriteState> audioWriteState = AudioWriteState::BUFFER;
 	bool addSoundBuffersOnUnderrun = false;
+	bool dynamicRateControl = false;
 	int8_t channels = 2;
 
 	size_t framesFree() const;
 	size_t framesWritten() const;
 	size_t framesCapacity() const;
+	double dynamicRateAdjustment(size_t framesToWrite) const;
 	bool shouldStartAudioWrites(size_t bytesToWrite = 0) const;
 	void resizeAudioBuffer(size_t targetBufferFillBytes);
 	const IG::Audio::Manager &audioManager() const;
@@ -25,6 +25,7 @@
 #include <imagine/util/bitset.hh>
 #include <emuframework/EmuTiming.hh>
 #include <emuframework/VController.hh>
+#include <emuframework/ContentDigest.hh>
 #include <optional>
 #include <string>
 #include <string_view>
@@ -79,6 +80,20 @@ struct EmuSystemCreateParams
 	uint8_t systemFlags;
 };
 
+struct BenchmarkStats
+{
+	IG::Time total{};
+	IG::Time min{};
+	IG::Time avg{};
+	IG::Time p99{};
+	IG::Time max{};
+	int frames{};
+	int64_t allocations{-1}; // C++ heap allocations, only counted with CONFIG_EMUFRAMEWORK_ALLOC_STATS
+
+	double framesPerSecond() const { return frames / IG::FloatSeconds(total).count(); }
+	double allocationsPerFrame() const { return allocations < 0 ? -1. : double(allocations) / frames; }
+};
+
 enum class ConfigType : uint8_t
 {
 	MAIN, SESSION, CORE
@@ -144,6 +159,14 @@ enum class VideoSystem: uint8_t
 	NATIVE_NTSC, PAL
 };
 
+enum class SaveStateFlags: uint8_t
+{
+	// skip any compression of the state data, used for frequent in-memory snapshots like rewind
+	uncompressed = bit(0),
+};
+
+IG_DEFINE_ENUM_BIT_FLAG_FUNCTIONS(SaveStateFlags);
+
 constexpr const char *optionUserPathContentToken = ":CONTENT:";
 
 class EmuSystem
@@ -190,6 +213,8 @@ public:
 	static bool hasBundledGames;
 	static bool hasPALVideoSystem;
 	static bool canRenderRGBA8888;
+	// renders PIXEL_I8 frames when EmuVideo::usePaletteFormat() is set
+	static bool canRenderPaletteIndexed;
 	static bool hasResetModes;
 	static bool handlesArchiveFiles;
 	static bool handlesGenericIO;
@@ -201,6 +226,9 @@ public:
 	static const char *creditsViewStr;
 	static FP validFrameRateRange;
 	static bool hasRectangularPixels;
+	// in-memory states capture all emulation state including audio, so states can be
+	// restored every frame without audible glitches
+	static bool hasRunAhead;
 
 	EmuSystem(IG::ApplicationContext ctx): appCtx{ctx} {}
 
@@ -209,8 +237,6 @@ public:
 	[[gnu::hot]] void runFrame(EmuSystemTaskContext task, EmuVideo *video, EmuAudio *audio);
 	FS::FileString stateFilename(int slot, std::string_view name) const;
 	std::string_view stateFilenameExt() const;
-	void loadState(EmuApp &, CStringView uri);
-	void saveState(CStringView path);
 	bool readConfig(ConfigType, MapIO &io, unsigned key, size_t readSize);
 	void writeConfig(ConfigType, FileIO &);
 	void reset(EmuApp &, ResetMode mode);
@@ -247,6 +273,30 @@ public:
 	bool shouldFastForward() const;
 	FS::FileString contentDisplayNameForPath(CStringView path) const;
 	IG::Rotation contentRotation() const;
+	// In-memory state functions, writeState() returns the same data saveState() stores in a file
+	// unless passed SaveStateFlags::uncompressed and stateSize() returns an upper bound of its size.
+	// Errors are reported by throwing an exception.
+	size_t stateSize();
+	void readState(EmuApp &, std::span<const uint8_t> buff);
+	size_t writeState(std::span<uint8_t> buff, SaveStateFlags = {});
+	// Converts uncompressed writeState() data to the regular format, implemented by systems whose
+	// compression doesn't depend on emulation state so it can run on a separate thread.
+	// dest is at least stateSize() bytes, returns the compressed size or 0 on error.
+	size_t compressState(std::span<const uint8_t> src, std::span<uint8_t> dest) const;
+	// Runs core-specific micro-benchmarks that don't need loaded content, args are the
+	// command line arguments following --benchmark-core like paths to test data.
+	// Returns the results as JSON or an empty string if unsupported
+	std::string benchmarkCore(std::span<const char * const> args);
+	// Connects the link cable port to another instance on the same machine opening
+	// the same name, see LocalLink. Errors are reported by throwing an exception.
+	// Link state isn't part of save states & frames can't be run twice without sending
+	// transfers twice, so run-ahead & rewind are disabled while a link is open.
+	void openLocalLink(CStringView name);
+	bool hasLocalLink() const { return hasLocalLink_; }
+	// File state functions, defaults to writing/reading the in-memory state data,
+	// only needed for systems that can't implement the above
+	void loadState(EmuApp &, CStringView uri);
+	void saveState(CStringView path);
 
 	ApplicationContext appContext() const { return appCtx; }
 	bool isActive() const { return state == State::ACTIVE; }
@@ -270,8 +320,12 @@ public:
 	const auto &contentName() const { return contentName_; }
 	FS::FileString contentFileName() const;
 	std::string contentDisplayName() const;
+	// For use in loadContent(), returns the requested digests of io's data from offset, cached across runs
+	ContentDigest identifyContent(IO &io, ContentDigestMask, size_t offset = 0);
 	void setContentDisplayName(std::string_view name);
 	FS::FileString contentDisplayNameForPathDefaultImpl(IG::CStringView path) const;
+	void loadStateDefaultImpl(EmuApp &, CStringView uri);
+	void saveStateDefaultImpl(CStringView path);
 	void setInitialLoadPath(IG::CStringView path);
 	FS::PathString fallbackSaveDirectory(bool create = false);
 	const auto &contentSaveDirectory() const { return contentSaveDirectory_; }
@@ -327,6 +381,8 @@ public:
 	void onBackupMemoryWritten(BackupMemoryDirtyFlags flags = 0xFF);
 	bool updateBackupMemoryCounter();
 	bool usesBackupMemory() const;
+	bool hasMemoryStates() const;
+	bool hasStateCompression() const;
 	FileIO staticBackupMemoryFile(CStringView uri, size_t staticSize, uint8_t initValue = 0) const;
 	void sessionOptionSet();
 	void resetSessionOptionsSet() { sessionOptionsSet = false; }
@@ -347,7 +403,7 @@ public:
 	void setStartFrameTime(IG::FrameTime time);
 	EmuFrameTimeInfo advanceFramesWithTime(IG::FrameTime time);
 	void setSpeedMultiplier(EmuAudio &, double speed);
-	IG::Time benchmark(EmuVideo &video);
+	BenchmarkStats benchmark(EmuVideo *, EmuAudio *, int frames);
 	bool hasContent() const;
 	void resetFrameTime();
 	void pause(EmuApp &);
@@ -367,6 +423,7 @@ protected:
 	int saveStateSlot{};
 	State state{};
 	bool sessionOptionsSet{};
+	bool hasLocalLink_{};
 	BackupMemoryDirtyFlags backupMemoryDirtyFlags{};
 	int8_t backupMemoryCounter{};
 	FS::PathString contentDirectory_; // full directory path of content on disk, if any
@@ -19,6 +19,7 @@
 #include <emuframework/EmuVideo.hh>
 #include <main/MainSystem.hh>
 #include <imagine/io/IO.hh>
+#include <stdexcept>
 
 namespace EmuEx
 {
@@ -199,16 +200,6 @@ void EmuSystem::runFrame(EmuSystemTaskContext task, EmuVideo *video, EmuAudio *a
 	static_cast<MainSystem*>(this)->runFrame(task, video, audio);
 }
 
-void EmuSystem::loadState(EmuApp &app, IG::CStringView uri)
-{
-	static_cast<MainSystem*>(this)->loadState(app, uri);
-}
-
-void EmuSystem::saveState(IG::CStringView uri)
-{
-	static_cast<MainSystem*>(this)->saveState(uri);
-}
-
 void EmuSystem::clearInputBuffers(EmuInputView &view)
 {
 	static_cast<MainSystem*>(this)->clearInputBuffers(view);
@@ -258,6 +249,75 @@ IG::Rotation EmuSystem::contentRotation() const
 	return {};
 }
 
+size_t EmuSystem::stateSize()
+{
+	if(&MainSystem::stateSize != &EmuSystem::stateSize)
+		return static_cast<MainSystem*>(this)->stateSize();
+	return 0;
+}
+
+void EmuSystem::readState(EmuApp &app, std::span<const uint8_t> buff)
+{
+	if(&MainSystem::readState != &EmuSystem::readState)
+		static_cast<MainSystem*>(this)->readState(app, buff);
+}
+
+size_t EmuSystem::writeState(std::span<uint8_t> buff, SaveStateFlags flags)
+{
+	if(&MainSystem::writeState != &EmuSystem::writeState)
+		return static_cast<MainSystem*>(this)->writeState(buff, flags);
+	return 0;
+}
+
+bool EmuSystem::hasMemoryStates() const
+{
+	return &MainSystem::writeState != &EmuSystem::writeState;
+}
+
+size_t EmuSystem::compressState(std::span<const uint8_t> src, std::span<uint8_t> dest) const
+{
+	if(&MainSystem::compressState != &EmuSystem::compressState)
+		return static_cast<const MainSystem*>(this)->compressState(src, dest);
+	return 0;
+}
+
+bool EmuSystem::hasStateCompression() const
+{
+	return &MainSystem::compressState != &EmuSystem::compressState;
+}
+
+std::string EmuSystem::benchmarkCore(std::span<const char * const> args)
+{
+	if(&MainSystem::benchmarkCore != &EmuSystem::benchmarkCore)
+		return static_cast<MainSystem*>(this)->benchmarkCore(args);
+	return {};
+}
+
+void EmuSystem::openLocalLink(CStringView name)
+{
+	if(&MainSystem::openLocalLink != &EmuSystem::openLocalLink)
+	{
+		static_cast<MainSystem*>(this)->openLocalLink(name);
+		hasLocalLink_ = true;
+		return;
+	}
+	throw std::runtime_error{"Link cable isn't supported by this system"};
+}
+
+void EmuSystem::loadState(EmuApp &app, IG::CStringView uri)
+{
+	if(&MainSystem::loadState != &EmuSystem::loadState)
+		return static_cast<MainSystem*>(this)->loadState(app, uri);
+	loadStateDefaultImpl(app, uri);
+}
+
+void EmuSystem::saveState(IG::CStringView uri)
+{
+	if(&MainSystem::saveState != &EmuSystem::saveState)
+		return static_cast<MainSystem*>(this)->saveState(uri);
+	saveStateDefaultImpl(uri);
+}
+
 void EmuSystem::onStart()
 {
 	if(&MainSystem::onStart != &EmuSystem::onStart)
@@ -18,9 +18,14 @@
 #include <emuframework/EmuAppHelper.hh>
 #include <emuframework/EmuSystemTask.hh>
 #include <emuframework/EmuSystemTaskContext.hh>
+#include <emuframework/VideoPostProcessor.hh>
 #include <imagine/gfx/PixmapBufferTexture.hh>
 #include <imagine/gfx/SyncFence.hh>
+#include <imagine/pixmap/MemPixmap.hh>
+#include <array>
+#include <memory>
 #include <optional>
+#include <span>
 
 namespace EmuEx
 {
@@ -85,12 +90,25 @@ public:
 	bool setRenderPixelFormat(EmuSystem &, IG::PixelFormat, Gfx::ColorSpace);
 	IG::PixelFormat renderPixelFormat() const;
 	IG::PixelFormat internalRenderPixelFormat() const;
+	void setPostFilter(VideoPostFilter);
+	VideoPostFilter postFilter() const;
+	// When enabled, systems that set EmuSystem::canRenderPaletteIndexed submit PIXEL_I8 frames
+	// and pass their palette (in renderPixelFormat()) to setPalette(), colors are resolved on the GPU
+	void setUsePaletteFormat(EmuSystem &, bool on);
+	bool usePaletteFormat() const { return usePaletteFmt; }
+	bool hasPaletteFormat() const;
+	void setPalette(std::span<const uint16_t, 256>);
+	void setPalette(std::span<const uint32_t, 256>);
+	Gfx::Texture &paletteImage() { return paletteImg; }
 	static Gfx::TextureSamplerConfig samplerConfigForLinearFilter(bool useLinearFilter);
 
 protected:
 	Gfx::RendererTask *rTask{};
 	Gfx::SyncFence fence;
 	Gfx::PixmapBufferTexture vidImg;
+	IG::MemPixmap headlessImg; // frames are rendered here instead of vidImg without a renderer task
+	Gfx::Texture paletteImg;
+	std::unique_ptr<VideoPostProcessor> postProcessor;
 	FrameFinishedDelegate onFrameFinished;
 	FormatChangedDelegate onFormatChanged;
 	IG::PixelFormat renderFmt;
@@ -98,13 +116,20 @@ protected:
 	bool screenshotNextFrame{};
 	bool singleBuffer{};
 	bool needsFence{};
+	bool usePaletteFmt{};
 	Gfx::ColorSpace colSpace{Gfx::ColorSpace::LINEAR};
 	bool useLinearFilter{true};
+	alignas(uint32_t) std::array<uint8_t, 256 * 4> paletteData{};
 
 	void doScreenshot(EmuSystemTaskContext, IG::PixmapView pix);
+	void finishPostProcessedFrame(EmuSystemTaskContext, IG::PixmapView pix);
+	bool usesPostProcessor() const { return postProcessor && postProcessor->isEnabled() && !usePaletteFmt; }
+	IG::PixmapDesc sourceDesc() const;
 	void postFrameFinished(EmuSystemTaskContext);
 	void syncImageAccess();
 	void updateNeedsFence();
+	void writePalette(std::span<const std::byte> data);
+	IG::PixmapView paletteView() const { return {{{256, 1}, renderFmt}, paletteData.data()}; }
 	Gfx::TextureSamplerConfig samplerConfig() const { return samplerConfigForLinearFilter(useLinearFilter); }
 };
 
@@ -59,8 +59,9 @@ public:
 
 private:
 	VideoImageOverlay vidImgOverlay;
-	IG::StaticArrayList<VideoImageEffect*, 1> effects;
+	IG::StaticArrayList<VideoImageEffect*, 2> effects;
 	EmuVideo &video;
+	VideoImageEffect paletteEffect;
 	VideoImageEffect userEffect;
 	Gfx::Sprite disp;
 	IG::WindowRect contentRect_;
@@ -83,6 +84,7 @@ private:
 	void updateEffectImageSize();
 	void buildEffectChain();
 	bool updateConvertColorSpaceEffect();
+	bool updatePaletteEffect();
 	void updateSprite();
 	void logOutputFormat();
 	Gfx::Renderer &renderer();
@@ -16,9 +16,8 @@
 	along with EmuFramework.  If not, see <http://www.gnu.org/licenses/> */
 
 #include <imagine/gui/View.hh>
-#ifdef CONFIG_EMUFRAMEWORK_AUDIO_STATS
 #include <imagine/gfx/GfxText.hh>
-#endif
+#include <string_view>
 
 namespace EmuEx
 {
@@ -27,6 +26,7 @@ using namespace IG;
 class EmuInputView;
 class EmuVideoLayer;
 class EmuSystem;
+class FrameTimingStats;
 
 class EmuView : public View
 {
@@ -39,8 +39,10 @@ public:
 	bool inputEvent(const Input::Event &) final;
 	bool hasLayer() const { return layer; }
 	void setLayoutInputView(EmuInputView *view);
-	void updateAudioStats(int underruns, int overruns, int callbacks, double avgCallbackFrames, int frames);
+	void updateAudioStats(std::string_view stats);
 	void clearAudioStats();
+	void setFrameTimingGraph(const FrameTimingStats *stats) { frameTimingGraph = stats; }
+	bool showsFrameTimingGraph() const { return frameTimingGraph; }
 	EmuVideoLayer *videoLayer() const { return layer; }
 	EmuSystem &system() { return *sysPtr; }
 
@@ -48,10 +50,11 @@ private:
 	EmuVideoLayer *layer{};
 	EmuInputView *inputView{};
 	EmuSystem *sysPtr{};
-	#ifdef CONFIG_EMUFRAMEWORK_AUDIO_STATS
 	Gfx::Text audioStatsText{};
 	WRect audioStatsRect{};
-	#endif
+	const FrameTimingStats *frameTimingGraph{};
+
+	void drawFrameTimingGraph(Gfx::RendererCommands &__restrict__) const;
 };
 
 }
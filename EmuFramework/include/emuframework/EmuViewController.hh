@@ -81,8 +81,10 @@ public:
 	void updateExtraWindowViewport(IG::Window &, IG::Viewport, Gfx::RendererTask &);
 	bool drawMainWindow(IG::Window &win, IG::WindowDrawParams, Gfx::RendererTask &);
 	bool drawExtraWindow(IG::Window &win, IG::WindowDrawParams, Gfx::RendererTask &);
-	void updateEmuAudioStats(int underruns, int overruns, int callbacks, double avgCallbackFrames, int frames);
+	void updateEmuAudioStats(std::string_view stats);
 	void clearEmuAudioStats();
+	void setShowFrameTimingGraph(const FrameTimingStats *stats) { emuView.setFrameTimingGraph(stats); }
+	bool showsFrameTimingGraph() const { return emuView.showsFrameTimingGraph(); }
 	void popToSystemActionsMenu();
 	void postDrawToEmuWindows();
 	IG::Screen *emuWindowScreen() const;
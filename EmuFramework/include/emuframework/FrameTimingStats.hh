@@ -0,0 +1,76 @@
+#pragma once
+
+/*  This file is part of EmuFramework.
+
+	Imagine is free software: you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation, either version 3 of the License, or
+	(at your option) any later version.
+
+	Imagine is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License
+	along with EmuFramework.  If not, see <http://www.gnu.org/licenses/> */
+
+#include <imagine/time/Time.hh>
+#include <imagine/util/string/CStringView.hh>
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <string>
+
+namespace IG
+{
+class ApplicationContext;
+}
+
+namespace EmuEx
+{
+
+using namespace IG;
+
+// Ring of per-frame pacing samples covering the last few seconds of emulation. The main thread
+// adds a sample each time a screen frame advances emulation, then the emulation and renderer
+// threads fill in their timings for the newest sample. Every field is atomic so the stats
+// graph and CSV dump can read the ring from any thread without locking.
+
+class FrameTimingStats
+{
+public:
+	static constexpr size_t capacity = 600;
+
+	struct Sample
+	{
+		std::atomic_int64_t timestampNSecs{}; // screen frame time passed to onFrameUpdate
+		std::atomic_int64_t presentTimeNSecs{}; // target present time of the emulated frame
+		std::atomic_uint32_t emulateUSecs{}; // time spent in EmuApp::runFrames()
+		std::atomic_uint32_t submitUSecs{}; // time spent building & presenting the window's draw commands
+		std::atomic_int16_t elapsedFrames{}; // frames advanced by EmuTiming, != 1 means a skipped or repeated frame
+		std::atomic_int16_t emulatedFrames{}; // frames actually run after frame skip limits
+	};
+
+	// main thread only
+	void addFrame(FrameTime timestamp, FrameTime presentTime, int elapsedFrames, int emulatedFrames);
+	void reset();
+	void setTargetFrameTime(FloatSeconds time) { targetFrameTimeNSecs = std::chrono::duration_cast<Nanoseconds>(time).count(); }
+	// returns the index to pass to addEmulateTime()
+	size_t newestIndex() const { return (writeCount.load(std::memory_order_acquire) - 1) % capacity; }
+	void addEmulateTime(size_t idx, SteadyClockTime);
+	void setSubmitTime(SteadyClockTime);
+	size_t size() const { return std::min(writeCount.load(std::memory_order_acquire), capacity); }
+	// 0 is the oldest sample
+	const Sample &operator[](size_t idx) const;
+	FloatSeconds targetFrameTime() const { return Nanoseconds{targetFrameTimeNSecs.load(std::memory_order_relaxed)}; }
+	std::string csv() const;
+	bool dumpToFile(ApplicationContext, CStringView path) const;
+
+private:
+	std::array<Sample, capacity> samples;
+	std::atomic_size_t writeCount{};
+	std::atomic_int64_t targetFrameTimeNSecs{};
+};
+
+}
@@ -49,6 +49,9 @@ protected:
 	BoolMenuItem showBundledGames;
 	BoolMenuItem showBluetoothScan;
 	BoolMenuItem showHiddenFiles;
+	TextMenuItem archiveContentCacheItem[5];
+	MultiChoiceMenuItem archiveContentCache;
+	TextMenuItem clearArchiveContentCache;
 	TextHeadingMenuItem orientationHeading;
 	TextMenuItem menuOrientationItem[5];
 	MultiChoiceMenuItem menuOrientation;
@@ -0,0 +1,83 @@
+#pragma once
+
+/*  This file is part of EmuFramework.
+
+	Imagine is free software: you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation, either version 3 of the License, or
+	(at your option) any later version.
+
+	Imagine is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License
+	along with EmuFramework.  If not, see <http://www.gnu.org/licenses/> */
+
+#include <imagine/util/DelegateFunc.hh>
+#include <imagine/util/string/CStringView.hh>
+#include <cstdint>
+#include <optional>
+#include <string>
+
+namespace EmuEx
+{
+
+using namespace IG;
+
+// Link cable between two emulator instances on the same machine. Both open the same
+// name, the first one becomes player 0 and creates a shared memory block holding a
+// message ring & clock for each side, waiting is done with futexes on that memory.
+//
+// Each side advances its link clock by the emulated cycles it runs and blocks once it's
+// more than syncCycles ahead of the other, keeping the two cores in lockstep. Link
+// transfers are request/reply messages handled on the receiving side by the
+// RequestDelegate the next time it calls advance(), poll(), or transfer().
+// Waits never block for more than about a frame. When the other side doesn't respond in
+// that time (paused, in its menu, or in the background), this side runs on its own and
+// transfers fail until the other side's clock moves again. A player that closes the link
+// can be replaced by another instance opening the same name.
+// The constructor throws std::runtime_error on failure.
+
+class LocalLink
+{
+public:
+	using RequestDelegate = DelegateFunc<uint32_t(uint32_t type, uint32_t data)>;
+
+	LocalLink(CStringView name, uint32_t protocol, uint32_t syncCycles, RequestDelegate);
+	~LocalLink();
+	LocalLink(const LocalLink&) = delete;
+	LocalLink &operator=(const LocalLink&) = delete;
+	int playerId() const { return player; }
+	bool isConnected() const;
+	// Sends a request & waits for the reply, returns nothing if the other side is detached or idle
+	std::optional<uint32_t> transfer(uint32_t type, uint32_t data);
+	void advance(uint32_t cycles);
+	void poll();
+
+	struct SharedBlock;
+
+private:
+	SharedBlock *shared{};
+	RequestDelegate onRequest;
+	std::string shmName;
+	uint64_t clock{};
+	uint64_t nextSyncClock{};
+	uint32_t syncCycles{};
+	uint64_t idlePeerClock{};
+	uint32_t transferSeq{};
+	int player{};
+	bool peerAttached{};
+	bool peerIdle{};
+
+	void pushMessage(uint32_t type, uint32_t data, uint32_t seq, bool isReply);
+	void handleMessages(std::optional<uint32_t> *reply = {});
+	void publishClock();
+	bool updatePeerAttached();
+	void setPeerIdle();
+	bool peerResumed();
+	bool waitUntil(auto &&isDone);
+};
+
+}
@@ -0,0 +1,97 @@
+#pragma once
+
+/*  This file is part of EmuFramework.
+
+	Imagine is free software: you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation, either version 3 of the License, or
+	(at your option) any later version.
+
+	Imagine is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License
+	along with EmuFramework.  If not, see <http://www.gnu.org/licenses/> */
+
+#include <emuframework/config.hh>
+#include <cstdint>
+#include <cstddef>
+#include <atomic>
+#include <deque>
+#include <memory>
+#include <span>
+
+namespace IG
+{
+class MapIO;
+class FileIO;
+}
+
+namespace EmuEx
+{
+
+using namespace IG;
+class EmuApp;
+class EmuSystem;
+
+// Keeps a history of uncompressed in-memory save states for rewinding emulation.
+// Each snapshot is stored as a run-length encoded XOR delta against the next newer one
+// inside a fixed-size ring, so the oldest snapshots are dropped once the memory budget is used.
+
+class RewindManager
+{
+public:
+	static constexpr uint8_t defaultMaxMemoryMiB = 0;
+	static constexpr uint8_t maxMemoryMiBLimit = 64;
+	static constexpr uint8_t defaultFrameInterval = 1;
+	static constexpr uint8_t maxFrameInterval = 8;
+
+	RewindManager() = default;
+	void reset();
+	void saveState(EmuSystem &, int elapsedFrames);
+	bool rewindState(EmuApp &);
+	void setRewinding(bool on) { rewinding = on; }
+	bool isRewinding() const { return rewinding; }
+	bool isEnabled() const { return maxMemoryMiB_; }
+	size_t storedStates() const { return entries.size(); }
+	// buffers are re-allocated on the emulation thread by the next saveState()/rewindState() call
+	bool setMaxMemoryMiB(uint8_t mib);
+	uint8_t maxMemoryMiB() const { return maxMemoryMiB_; }
+	bool setFrameInterval(uint8_t frames);
+	uint8_t frameInterval() const { return frameInterval_; }
+	bool readConfig(MapIO &, unsigned key, size_t size);
+	void writeConfig(FileIO &) const;
+
+private:
+	struct Entry
+	{
+		size_t offset{};
+		uint32_t size{};
+		uint32_t stateSize{}; // size of the state restored by applying this entry
+	};
+
+	std::unique_ptr<uint8_t[]> ringBuff;
+	size_t ringSize{};
+	std::deque<Entry> entries;
+	// newest state in the history, bytes past its size are always zero so deltas of
+	// different sized states can be computed over the larger of the two sizes
+	std::unique_ptr<uint8_t[]> lastState;
+	std::unique_ptr<uint8_t[]> currState;
+	std::unique_ptr<uint8_t[]> deltaBuff;
+	size_t stateBuffSize{};
+	uint32_t lastStateSize{};
+	uint32_t currStateSize{};
+	int framesUntilSave{};
+	std::atomic<uint8_t> maxMemoryMiB_{defaultMaxMemoryMiB};
+	uint8_t frameInterval_{defaultFrameInterval};
+	std::atomic_bool resetPending{};
+	bool rewinding{};
+
+	bool allocBuffers(size_t stateSize);
+	void applyPendingReset();
+	void addEntry(std::span<const uint8_t> delta, uint32_t stateSize);
+};
+
+}
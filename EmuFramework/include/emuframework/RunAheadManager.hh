@@ -0,0 +1,88 @@
+#pragma once
+
+/*  This file is part of EmuFramework.
+
+	Imagine is free software: you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation, either version 3 of the License, or
+	(at your option) any later version.
+
+	Imagine is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License
+	along with EmuFramework.  If not, see <http://www.gnu.org/licenses/> */
+
+#include <emuframework/config.hh>
+#include <emuframework/EmuSystemTaskContext.hh>
+#include <atomic>
+#include <cstdint>
+#include <cstddef>
+#include <memory>
+#include <string>
+
+namespace IG
+{
+class MapIO;
+class FileIO;
+}
+
+namespace EmuEx
+{
+
+using namespace IG;
+class EmuApp;
+class EmuSystem;
+class EmuVideo;
+class EmuAudio;
+
+// Hides input latency by presenting video from frames emulated ahead of the real timeline.
+// Each frame runs once for real with audio, the result is saved to an uncompressed in-memory
+// state, then the hidden frames run with the same input and only the last one renders video
+// before the saved state is restored. Only used by systems that set EmuSystem::hasRunAhead.
+
+class RunAheadManager
+{
+public:
+	static constexpr uint8_t defaultFrames = 0;
+	static constexpr uint8_t maxFrames = 4;
+
+	struct Overhead
+	{
+		uint64_t frames{};
+		uint64_t runAheadUSecs{}; // state save/restore and hidden frames
+		uint64_t totalUSecs{}; // total including the real frame
+	};
+
+	RunAheadManager() = default;
+	void reset();
+	// returns false if run-ahead isn't active and the caller should run the frame normally
+	bool runFrame(EmuApp &, EmuSystemTaskContext, EmuVideo &, EmuAudio *);
+	bool isEnabled() const { return frames_; }
+	// the state buffer is re-allocated on the emulation thread by the next runFrame() call
+	bool setFrames(uint8_t frames);
+	uint8_t frames() const { return frames_; }
+	Overhead overhead() const;
+	std::string overheadSummary() const;
+	void resetOverhead();
+	bool readConfig(MapIO &, unsigned key, size_t size);
+	void writeConfig(FileIO &) const;
+
+private:
+	std::unique_ptr<uint8_t[]> stateBuff;
+	size_t stateBuffSize{};
+	int framesUntilRetry{};
+	std::atomic_bool resetPending{};
+	// written by the emulation thread, read by the UI
+	std::atomic_uint64_t overheadFrames{};
+	std::atomic_uint64_t runAheadUSecs{};
+	std::atomic_uint64_t totalUSecs{};
+	std::atomic<uint8_t> frames_{defaultFrames};
+
+	bool allocStateBuff(EmuSystem &);
+	size_t writeState(EmuSystem &);
+};
+
+}
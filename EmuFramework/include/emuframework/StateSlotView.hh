@@ -28,6 +28,7 @@ class StateSlotView : public TableView, public EmuAppHelper<StateSlotView>
 {
 public:
 	StateSlotView(ViewAttachParams attach);
+	~StateSlotView();
 	void onShow() final;
 
 private:
@@ -0,0 +1,88 @@
+#pragma once
+
+/*  This file is part of EmuFramework.
+
+	Imagine is free software: you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation, either version 3 of the License, or
+	(at your option) any later version.
+
+	Imagine is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License
+	along with EmuFramework.  If not, see <http://www.gnu.org/licenses/> */
+
+#include <imagine/base/MessagePort.hh>
+#include <imagine/fs/FSDefs.hh>
+#include <imagine/util/string/CStringView.hh>
+#include <memory>
+#include <span>
+#include <thread>
+
+namespace EmuEx
+{
+
+using namespace IG;
+class EmuApp;
+class EmuSystem;
+
+// Writes save state & backup memory snapshots to storage on a separate thread so emulation
+// only pauses while the data is captured. States are compressed (if the system supports
+// doing it outside of writeState()) and every file is written to a temporary file that's
+// renamed over the destination when complete. Jobs run in the order they're queued, errors
+// are posted & EmuApp::setOnStateWritten() is notified from the main thread.
+
+class StateWriteTask
+{
+public:
+	StateWriteTask(EmuApp &);
+	~StateWriteTask();
+	// captures the system's current state and queues writing it to path
+	void saveState(EmuSystem &, CStringView path);
+	// copies the backup memory data and queues writing it to path
+	void saveBackupMemory(CStringView path, std::span<const uint8_t> data);
+	// queues removing the backup memory file at path
+	void removeBackupMemory(CStringView path);
+	// blocks until all queued writes finish
+	void wait();
+	EmuApp &app() const;
+
+private:
+	enum class JobType : uint8_t
+	{
+		state, backupMemory, removeBackupMemory
+	};
+
+	struct WriteJob
+	{
+		FS::PathString path;
+		std::unique_ptr<uint8_t[]> data;
+		size_t size{};
+		size_t compressedSize{}; // non-zero if data still needs compressing
+		EmuSystem *systemPtr{};
+		JobType type{};
+	};
+
+	struct CommandMessage
+	{
+		std::binary_semaphore *semPtr{};
+		WriteJob *job{}; // null for flush and exit commands
+		bool exit{};
+
+		void setReplySemaphore(std::binary_semaphore *semPtr_) { assert(!semPtr); semPtr = semPtr_; };
+	};
+
+	EmuApp *appPtr{};
+	IG::MessagePort<CommandMessage> commandPort{"StateWriteTask Command"};
+	std::thread taskThread;
+
+	void start();
+	void stop();
+	void queue(std::unique_ptr<WriteJob>);
+	void write(WriteJob &);
+};
+
+}
@@ -42,6 +42,13 @@ protected:
 	MultiChoiceMenuItem fastModeSpeed;
 	TextMenuItem slowModeSpeedItem[3];
 	MultiChoiceMenuItem slowModeSpeed;
+	TextMenuItem rewindMemoryItem[6];
+	MultiChoiceMenuItem rewindMemory;
+	TextMenuItem rewindIntervalItem[3];
+	MultiChoiceMenuItem rewindInterval;
+	TextMenuItem runAheadItem[5];
+	MultiChoiceMenuItem runAhead;
+	TextMenuItem runAheadOverhead;
 	IG_UseMemberIf(Config::envIsAndroid, BoolMenuItem, performanceMode);
 	StaticArrayList<MenuItem*, 26> item;
 };
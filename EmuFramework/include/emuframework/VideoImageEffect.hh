@@ -47,6 +47,9 @@ public:
 
 	constexpr	VideoImageEffect() = default;
 	VideoImageEffect(Gfx::Renderer &r, Id effect, IG::PixelFormat, Gfx::ColorSpace, Gfx::TextureSamplerConfig, IG::WP size);
+	// resolves PIXEL_I8 images through a palette texture bound to paletteTextureUnit
+	static VideoImageEffect makePaletteLookup(Gfx::Renderer &r, IG::PixelFormat, Gfx::ColorSpace, Gfx::TextureSamplerConfig, IG::WP size);
+	static constexpr int paletteTextureUnit = 1;
 	void setImageSize(Gfx::Renderer &r, IG::WP size, Gfx::TextureSamplerConfig);
 	void setFormat(Gfx::Renderer &r, IG::PixelFormat, Gfx::ColorSpace, Gfx::TextureSamplerConfig);
 	void setSampler(Gfx::TextureSamplerConfig);
@@ -54,6 +57,7 @@ public:
 	Gfx::Texture &renderTarget();
 	void drawRenderTarget(Gfx::RendererCommands &, const Gfx::TextureSpan);
 	constexpr IG::PixelFormat imageFormat() const { return format; }
+	constexpr Gfx::ColorSpace imageColorSpace() const { return colorSpace; }
 	operator bool() const { return (bool)prog; }
 
 private:
@@ -62,12 +66,14 @@ private:
 	int srcTexelDeltaU{};
 	int srcTexelHalfDeltaU{};
 	int srcPixelsU{};
+	int paletteU{};
 	IG::WP renderTargetScale;
 	IG::WP renderTargetImgSize;
 	IG::WP inputImgSize{1, 1};
 	IG::PixelFormat format;
 	Gfx::ColorSpace colorSpace{Gfx::ColorSpace::LINEAR};
 
+	VideoImageEffect(Gfx::Renderer &r, EffectDesc, IG::PixelFormat, Gfx::ColorSpace, Gfx::TextureSamplerConfig, IG::WP size);
 	void initRenderTargetTexture(Gfx::Renderer &r, Gfx::TextureSamplerConfig);
 	void updateProgramUniforms(Gfx::Renderer &r);
 	void compile(Gfx::Renderer &r, EffectDesc desc, Gfx::TextureSamplerConfig);
@@ -69,6 +69,9 @@ protected:
 	MultiChoiceMenuItem overlayEffectLevel;
 	TextMenuItem imgEffectPixelFormatItem[3];
 	MultiChoiceMenuItem imgEffectPixelFormat;
+	TextMenuItem postFilterItem[4];
+	MultiChoiceMenuItem postFilter;
+	BoolMenuItem gpuPalette;
 	StaticArrayList<TextMenuItem, 4> windowPixelFormatItem;
 	MultiChoiceMenuItem windowPixelFormat;
 	IG_UseMemberIf(Config::envIsLinux && Config::BASE_MULTI_WINDOW, BoolMenuItem, secondDisplay);
@@ -79,6 +82,8 @@ protected:
 	MultiChoiceMenuItem renderPixelFormat;
 	IG_UseMemberIf(Config::envIsAndroid, BoolMenuItem, presentationTime);
 	IG_UseMemberIf(Config::envIsAndroid, BoolMenuItem, forceMaxScreenFrameRate);
+	BoolMenuItem showFrameTimingGraph;
+	TextMenuItem dumpFrameTimingStats;
 	TextMenuItem brightnessItem[2];
 	TextMenuItem redItem[2];
 	TextMenuItem greenItem[2];
@@ -92,7 +97,7 @@ protected:
 	TextHeadingMenuItem colorLevelsHeading;
 	TextHeadingMenuItem advancedHeading;
 	TextHeadingMenuItem systemSpecificHeading;
-	StaticArrayList<MenuItem*, 34> item;
+	StaticArrayList<MenuItem*, 38> item;
 
 	bool onFrameTimeChange(VideoSystem vidSys, FloatSeconds time);
 	TextMenuItem::SelectDelegate setVideoBrightnessCustomDel(ImageChannel);
@@ -0,0 +1,89 @@
+#pragma once
+
+/*  This file is part of EmuFramework.
+
+	Imagine is free software: you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation, either version 3 of the License, or
+	(at your option) any later version.
+
+	Imagine is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License
+	along with EmuFramework.  If not, see <http://www.gnu.org/licenses/> */
+
+#include <imagine/pixmap/Pixmap.hh>
+#include <imagine/util/enum.hh>
+#include <array>
+#include <memory>
+#include <semaphore>
+#include <thread>
+
+namespace EmuEx
+{
+
+using namespace IG;
+
+WISE_ENUM_CLASS((VideoPostFilter, uint8_t),
+	Off,
+	Scale2x,
+	Scanlines,
+	Scale2xScanlines);
+
+// Runs CPU image filters on emulated frames before they're uploaded to the video texture,
+// for devices where the GPU effects are too slow or unavailable. Frames are filtered on a
+// worker thread so emulating a frame overlaps with filtering the previous one, which adds
+// one frame of latency. Input and output buffers are double-buffered: while the worker
+// filters frame N, the emulation thread renders frame N + 1 and the renderer may still be
+// uploading frame N - 1.
+
+class VideoPostProcessor
+{
+public:
+	static constexpr int scale = 2;
+
+	VideoPostProcessor() = default;
+	~VideoPostProcessor();
+	// call with the emulation thread paused, waits for any frame in progress
+	void setFilter(VideoPostFilter);
+	VideoPostFilter filter() const { return filter_; }
+	bool isEnabled() const { return filter_ != VideoPostFilter::Off; }
+	void setFormat(PixmapDesc);
+	PixmapDesc format() const { return srcDesc; }
+	PixmapDesc outputFormat() const { return {srcDesc.size * scale, srcDesc.format}; }
+	// buffer the next frame can be rendered into directly to skip a copy in submitFrame()
+	MutablePixmapView inputPixmap() const;
+	// waits for the worker and returns its last filtered frame, if any, which
+	// stays valid until the next submitFrame() after this one
+	PixmapView finishedFrame();
+	// queues pix for filtering after finishedFrame() was called
+	void submitFrame(PixmapView pix);
+	// filters pix on the calling thread, dropping any frame in progress
+	PixmapView filterFrame(PixmapView pix);
+	void stop();
+
+private:
+	std::array<std::unique_ptr<char[]>, 2> inBuff;
+	std::array<std::unique_ptr<char[]>, 2> outBuff;
+	std::thread thread;
+	std::binary_semaphore workSem{0};
+	std::binary_semaphore doneSem{0};
+	PixmapDesc srcDesc;
+	int frameIdx{}; // buffer pair for the next submitted frame
+	int jobIdx{}; // buffer pair the worker is filtering
+	bool busy{};
+	bool hasOutput{};
+	bool exiting{};
+	VideoPostFilter filter_{};
+
+	void start();
+	void wait();
+	void run(int idx);
+	MutablePixmapView inPixmap(int idx) const { return {srcDesc, inBuff[idx].get()}; }
+	MutablePixmapView outPixmap(int idx) const { return {outputFormat(), outBuff[idx].get()}; }
+};
+
+}
@@ -0,0 +1,86 @@
+#pragma once
+
+/*  This file is part of EmuFramework.
+
+	Imagine is free software: you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation, either version 3 of the License, or
+	(at your option) any later version.
+
+	Imagine is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License
+	along with EmuFramework.  If not, see <http://www.gnu.org/licenses/> */
+
+// Helpers for systems that store save states as gzip data, only include from
+// system code that links against zlib
+
+#include <zlib.h>
+#include <cstdint>
+#include <cstddef>
+#include <span>
+
+namespace EmuEx
+{
+
+constexpr size_t gzipHeaderSize = 10;
+constexpr size_t gzipTrailerSize = 8;
+
+inline bool hasGzipHeader(std::span<const uint8_t> buff)
+{
+	return buff.size() >= gzipHeaderSize + gzipTrailerSize && buff[0] == 0x1F && buff[1] == 0x8B;
+}
+
+// upper bound of the gzip stream size for uncompressed data of the given size
+constexpr size_t gzipCompressBound(size_t size)
+{
+	return size + (size >> 12) + (size >> 14) + (size >> 25) + 13 + gzipHeaderSize + gzipTrailerSize;
+}
+
+// size of the uncompressed data as stored in the gzip trailer (modulo 2^32),
+// returns 0 if it's larger than maxSize since the trailer comes from untrusted data
+inline size_t gzipUncompressedSize(std::span<const uint8_t> buff, size_t maxSize)
+{
+	if(!hasGzipHeader(buff))
+		return 0;
+	auto sizePtr = &buff[buff.size() - 4];
+	size_t size = sizePtr[0] | (sizePtr[1] << 8) | (sizePtr[2] << 16) | (size_t(sizePtr[3]) << 24);
+	return size <= maxSize ? size : 0;
+}
+
+// returns the size of the compressed data or 0 if dest is too small
+inline size_t gzipCompress(std::span<const uint8_t> src, std::span<uint8_t> dest, int level = Z_DEFAULT_COMPRESSION)
+{
+	z_stream s{};
+	if(deflateInit2(&s, level, Z_DEFLATED, MAX_WBITS + 16, 8, Z_DEFAULT_STRATEGY) != Z_OK)
+		return 0;
+	s.next_in = const_cast<Bytef*>(src.data());
+	s.avail_in = src.size();
+	s.next_out = dest.data();
+	s.avail_out = dest.size();
+	auto result = deflate(&s, Z_FINISH);
+	size_t size = s.total_out;
+	deflateEnd(&s);
+	return result == Z_STREAM_END ? size : 0;
+}
+
+// returns the size of the uncompressed data or 0 on error
+inline size_t gzipDecompress(std::span<const uint8_t> src, std::span<uint8_t> dest)
+{
+	z_stream s{};
+	if(inflateInit2(&s, MAX_WBITS + 16) != Z_OK)
+		return 0;
+	s.next_in = const_cast<Bytef*>(src.data());
+	s.avail_in = src.size();
+	s.next_out = dest.data();
+	s.avail_out = dest.size();
+	auto result = inflate(&s, Z_FINISH);
+	size_t size = s.total_out;
+	inflateEnd(&s);
+	return result == Z_STREAM_END ? size : 0;
+}
+
+}
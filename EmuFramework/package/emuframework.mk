@@ -7,6 +7,11 @@ ifndef RELEASE
  endif
 endif
 
-pkgConfigDeps += emuframework$(imagineLibExt)
+# set to -benchmark to link the library built by linux-x86_64-benchmark.mk
+ifndef emuframeworkLibExt
+ emuframeworkLibExt := $(imagineLibExt)
+endif
+
+pkgConfigDeps += emuframework$(emuframeworkLibExt)
 
 endif
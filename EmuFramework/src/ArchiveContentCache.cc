@@ -0,0 +1,290 @@
+/*  This file is part of EmuFramework.
+
+	Imagine is free software: you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation, either version 3 of the License, or
+	(at your option) any later version.
+
+	Imagine is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License
+	along with EmuFramework.  If not, see <http://www.gnu.org/licenses/> */
+
+#define LOGTAG "ArchiveCache"
+#include <emuframework/ArchiveContentCache.hh>
+#include <emuframework/ContentDigest.hh>
+#include <emuframework/Option.hh>
+#include "EmuOptions.hh"
+#include <imagine/io/FileIO.hh>
+#include <imagine/io/MapIO.hh>
+#include <imagine/fs/FS.hh>
+#include <imagine/fs/FSUtils.hh>
+#include <imagine/util/format.hh>
+#include <imagine/logger/logger.h>
+#include <algorithm>
+#include <charconv>
+
+namespace EmuEx
+{
+
+// each line: id, archive size, archive write time, entry size, entry CRC32, last use,
+// entry name, archive path, separated by tabs
+constexpr std::string_view indexName = "index";
+constexpr char fieldSeparator = '\t';
+
+FS::PathString ArchiveContentCache::cacheDir() const
+{
+	return FS::pathString(ctx.cachePath(), "archiveContent");
+}
+
+FS::PathString ArchiveContentCache::dataPath(uint64_t id) const
+{
+	return FS::pathString(cacheDir(), IG::format<FS::FileString>("{:016x}", id));
+}
+
+bool ArchiveContentCache::isCacheable(Key key)
+{
+	// without a valid modification time, a changed archive of the same size can't be detected
+	return key.size && key.lastWriteTime.count();
+}
+
+uint64_t ArchiveContentCache::makeId(Key key)
+{
+	// FNV-1a over the path & file metadata
+	uint64_t hash = 0xcbf29ce484222325;
+	auto add = [&](std::span<const char> bytes)
+	{
+		for(auto b : bytes)
+		{
+			hash ^= (uint8_t)b;
+			hash *= 0x100000001b3;
+		}
+	};
+	add(key.path);
+	uint64_t size = key.size;
+	int64_t time = key.lastWriteTime.count();
+	add({reinterpret_cast<const char*>(&size), sizeof(size)});
+	add({reinterpret_cast<const char*>(&time), sizeof(time)});
+	return hash;
+}
+
+void ArchiveContentCache::loadIndex()
+{
+	if(indexLoaded)
+		return;
+	indexLoaded = true;
+	auto buff = FileUtils::bufferFromPath(FS::pathString(cacheDir(), indexName), OpenFlagsMask::Test);
+	if(!buff)
+		return;
+	std::string_view index{reinterpret_cast<const char*>(buff.data()), buff.size()};
+	while(index.size())
+	{
+		auto lineEnd = index.find('\n');
+		auto line = index.substr(0, lineEnd);
+		index.remove_prefix(lineEnd == index.npos ? index.size() : lineEnd + 1);
+		std::string_view fields[8];
+		size_t fieldCount{};
+		while(fieldCount < std::size(fields))
+		{
+			auto sep = fieldCount < std::size(fields) - 1 ? line.find(fieldSeparator) : line.npos;
+			fields[fieldCount++] = line.substr(0, sep);
+			if(sep == line.npos)
+				break;
+			line.remove_prefix(sep + 1);
+		}
+		if(fieldCount != std::size(fields))
+			continue;
+		Record rec{};
+		int64_t lastWriteTime{};
+		auto parse = [](std::string_view s, auto &val, int base = 10)
+		{
+			auto [ptr, ec] = std::from_chars(s.data(), s.data() + s.size(), val, base);
+			return ec == std::errc{} && ptr == s.data() + s.size();
+		};
+		if(!parse(fields[0], rec.id, 16) || !parse(fields[1], rec.archiveSize) || !parse(fields[2], lastWriteTime) ||
+			!parse(fields[3], rec.entrySize) || !parse(fields[4], rec.entryCrc32, 16) || !parse(fields[5], rec.lastUse))
+		{
+			logWarn("skipping malformed index line");
+			continue;
+		}
+		rec.lastWriteTime = lastWriteTime;
+		rec.entryName = fields[6];
+		rec.archivePath = fields[7];
+		useCounter = std::max(useCounter, rec.lastUse);
+		records.emplace_back(std::move(rec));
+	}
+	logMsg("loaded %zu archive cache records", records.size());
+	// the budget may have been lowered since the index was written
+	auto recordCount = records.size();
+	evict(0);
+	if(records.size() != recordCount)
+		saveIndex();
+}
+
+void ArchiveContentCache::saveIndex() const
+{
+	std::string index;
+	for(const auto &rec : records)
+	{
+		index += IG::format<std::string>("{:016x}\t{}\t{}\t{}\t{:08x}\t{}\t{}\t{}\n",
+			rec.id, rec.archiveSize, rec.lastWriteTime, rec.entrySize, rec.entryCrc32, rec.lastUse,
+			rec.entryName, rec.archivePath);
+	}
+	auto path = FS::pathString(cacheDir(), indexName);
+	if(FileUtils::writeToPath(path, {reinterpret_cast<const unsigned char*>(index.data()), index.size()}) == -1)
+		logErr("error writing:%s", path.data());
+}
+
+void ArchiveContentCache::removeRecord(std::vector<Record>::iterator it)
+{
+	FS::remove(dataPath(it->id));
+	records.erase(it);
+}
+
+void ArchiveContentCache::evict(size_t neededBytes)
+{
+	auto totalBytes = [&]
+	{
+		size_t total{};
+		for(const auto &rec : records)
+			total += rec.entrySize;
+		return total;
+	};
+	while(records.size() && totalBytes() + neededBytes > maxBytes())
+	{
+		auto oldest = std::ranges::min_element(records, {}, &Record::lastUse);
+		logMsg("evicting cached entry:%s", oldest->entryName.c_str());
+		removeRecord(oldest);
+	}
+}
+
+static uint32_t crc32(std::span<const uint8_t> data)
+{
+	return ContentDigest::compute(data, ContentDigestMask::CRC32).crc32;
+}
+
+std::optional<ArchiveContentCache::Content> ArchiveContentCache::find(Key key)
+{
+	if(!isEnabled() || !isCacheable(key))
+		return {};
+	loadIndex();
+	auto id = makeId(key);
+	auto it = std::ranges::find_if(records, [&](const Record &rec)
+	{
+		return rec.id == id && rec.archivePath == key.path && rec.archiveSize == key.size &&
+			rec.lastWriteTime == key.lastWriteTime.count();
+	});
+	if(it == records.end())
+		return {};
+	FileIO file{dataPath(id), IOAccessHint::All, OpenFlagsMask::Test};
+	IOBuffer buff;
+	if(file.size() == it->entrySize)
+		buff = file.buffer(IOBufferMode::Release);
+	if(!buff || buff.size() != it->entrySize || crc32(buff.span()) != it->entryCrc32)
+	{
+		logWarn("missing or corrupt data for cached entry:%s", it->entryName.c_str());
+		removeRecord(it);
+		saveIndex();
+		return {};
+	}
+	it->lastUse = ++useCounter;
+	saveIndex();
+	logMsg("using cached entry:%s from archive:%s", it->entryName.c_str(), it->archivePath.c_str());
+	return Content{FS::FileString{it->entryName}, MapIO{std::move(buff)}};
+}
+
+IO ArchiveContentCache::insert(Key key, std::string_view entryName, uint32_t entryCrc32, IO entryIO)
+{
+	if(!isEnabled() || !isCacheable(key) || entryIO.size() > maxBytes())
+		return entryIO;
+	loadIndex();
+	auto buff = entryIO.buffer(IOBufferMode::Release);
+	if(!buff)
+		return IO{};
+	// the archive's CRC32 may be unset depending on its format, so store one of the data actually cached
+	auto dataCrc32 = crc32(buff.span());
+	if(entryCrc32 && entryCrc32 != dataCrc32)
+	{
+		logErr("CRC32 mismatch in entry:%.*s, not caching", int(entryName.size()), entryName.data());
+		return MapIO{std::move(buff)};
+	}
+	auto id = makeId(key);
+	if(auto it = std::ranges::find(records, id, &Record::id);
+		it != records.end())
+	{
+		removeRecord(it);
+	}
+	evict(buff.size());
+	try
+	{
+		FS::create_directory(ctx.cachePath());
+		FS::create_directory(cacheDir());
+	}
+	catch(std::exception &err)
+	{
+		logErr("error creating cache directory:%s", err.what());
+		return MapIO{std::move(buff)};
+	}
+	if(FileUtils::writeToPath(dataPath(id), buff.span()) != ssize_t(buff.size()))
+	{
+		logErr("error writing data for entry:%.*s", int(entryName.size()), entryName.data());
+		FS::remove(dataPath(id));
+	}
+	else
+	{
+		records.emplace_back(id, std::string{key.path}, key.size, key.lastWriteTime.count(),
+			std::string{entryName}, buff.size(), dataCrc32, ++useCounter);
+		saveIndex();
+		logMsg("cached entry:%.*s (%zu bytes)", int(entryName.size()), entryName.data(), buff.size());
+	}
+	return MapIO{std::move(buff)};
+}
+
+void ArchiveContentCache::clear()
+{
+	records.clear();
+	useCounter = 0;
+	indexLoaded = true;
+	FS::forEachInDirectory(cacheDir(), [](const FS::directory_entry &e)
+	{
+		FS::remove(e.path());
+		return true;
+	}, FS::DirOpenFlagsMask::Test);
+	logMsg("cleared archive content cache");
+}
+
+bool ArchiveContentCache::setMaxMiB(uint16_t mib)
+{
+	if(mib > maxMiBLimit)
+		return false;
+	maxMiB_ = mib;
+	if(!mib)
+	{
+		clear();
+	}
+	else if(indexLoaded)
+	{
+		evict(0);
+		saveIndex();
+	}
+	return true;
+}
+
+bool ArchiveContentCache::readConfig(MapIO &io, unsigned key, size_t size)
+{
+	switch(key)
+	{
+		default: return false;
+		case CFGKEY_ARCHIVE_CONTENT_CACHE_SIZE: return readOptionValue<uint16_t>(io, size, [&](auto val){ setMaxMiB(val); });
+	}
+}
+
+void ArchiveContentCache::writeConfig(FileIO &io) const
+{
+	writeOptionValueIfNotDefault(io, CFGKEY_ARCHIVE_CONTENT_CACHE_SIZE, maxMiB_, defaultMaxMiB);
+}
+
+}
@@ -0,0 +1,379 @@
+/*  This file is part of EmuFramework.
+
+	Imagine is free software: you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation, either version 3 of the License, or
+	(at your option) any later version.
+
+	Imagine is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License
+	along with EmuFramework.  If not, see <http://www.gnu.org/licenses/> */
+
+#define LOGTAG "AudioResampler"
+#include <emuframework/AudioResampler.hh>
+#include <imagine/time/Time.hh>
+#include <imagine/util/utility.h>
+#include <imagine/util/ranges.hh>
+#include <imagine/logger/logger.h>
+#include <imagine/util/format.hh>
+#include <algorithm>
+#include <numbers>
+#include <cmath>
+#include <cstring>
+#if defined __SSE__
+#include <xmmintrin.h>
+#elif defined __ARM_NEON
+#include <arm_neon.h>
+#endif
+
+namespace EmuEx
+{
+
+using namespace IG;
+
+struct FilterDesc
+{
+	int taps;
+	int phases;
+	float passband; // fraction of the Nyquist rate kept before the cutoff
+	float beta; // Kaiser window shape
+};
+
+constexpr FilterDesc filterDesc(AudioResamplerQuality q)
+{
+	switch(q)
+	{
+		case AudioResamplerQuality::Low: return {4, 256, 1.f, 0.f};
+		case AudioResamplerQuality::Medium: return {16, 256, .90f, 7.f};
+		case AudioResamplerQuality::High: return {32, 512, .95f, 9.f};
+	}
+	bug_unreachable("invalid AudioResamplerQuality");
+}
+
+// taps are always a multiple of 4 so the kernels need no remainder loop
+
+#if defined __SSE__
+static float horizontalSum(__m128 v)
+{
+	v = _mm_add_ps(v, _mm_movehl_ps(v, v));
+	v = _mm_add_ss(v, _mm_shuffle_ps(v, v, 1));
+	return _mm_cvtss_f32(v);
+}
+
+static float dot(const float *a, const float *coefs, int taps)
+{
+	auto sum = _mm_setzero_ps();
+	for(int i = 0; i < taps; i += 4)
+		sum = _mm_add_ps(sum, _mm_mul_ps(_mm_loadu_ps(a + i), _mm_loadu_ps(coefs + i)));
+	return horizontalSum(sum);
+}
+
+static void dot2(const float *a, const float *b, const float *coefs, int taps, float &outA, float &outB)
+{
+	auto sumA = _mm_setzero_ps();
+	auto sumB = _mm_setzero_ps();
+	for(int i = 0; i < taps; i += 4)
+	{
+		auto c = _mm_loadu_ps(coefs + i);
+		sumA = _mm_add_ps(sumA, _mm_mul_ps(_mm_loadu_ps(a + i), c));
+		sumB = _mm_add_ps(sumB, _mm_mul_ps(_mm_loadu_ps(b + i), c));
+	}
+	outA = horizontalSum(sumA);
+	outB = horizontalSum(sumB);
+}
+#elif defined __ARM_NEON
+static float horizontalSum(float32x4_t v)
+{
+	auto s = vadd_f32(vget_low_f32(v), vget_high_f32(v));
+	return vget_lane_f32(vpadd_f32(s, s), 0);
+}
+
+static float dot(const float *a, const float *coefs, int taps)
+{
+	auto sum = vdupq_n_f32(0);
+	for(int i = 0; i < taps; i += 4)
+		sum = vmlaq_f32(sum, vld1q_f32(a + i), vld1q_f32(coefs + i));
+	return horizontalSum(sum);
+}
+
+static void dot2(const float *a, const float *b, const float *coefs, int taps, float &outA, float &outB)
+{
+	auto sumA = vdupq_n_f32(0);
+	auto sumB = vdupq_n_f32(0);
+	for(int i = 0; i < taps; i += 4)
+	{
+		auto c = vld1q_f32(coefs + i);
+		sumA = vmlaq_f32(sumA, vld1q_f32(a + i), c);
+		sumB = vmlaq_f32(sumB, vld1q_f32(b + i), c);
+	}
+	outA = horizontalSum(sumA);
+	outB = horizontalSum(sumB);
+}
+#else
+static float dot(const float *a, const float *coefs, int taps)
+{
+	float sum[4]{};
+	for(int i = 0; i < taps; i += 4)
+	{
+		for(int j = 0; j < 4; j++)
+			sum[j] += a[i + j] * coefs[i + j];
+	}
+	return (sum[0] + sum[1]) + (sum[2] + sum[3]);
+}
+
+static void dot2(const float *a, const float *b, const float *coefs, int taps, float &outA, float &outB)
+{
+	outA = dot(a, coefs, taps);
+	outB = dot(b, coefs, taps);
+}
+#endif
+
+// zeroth order modified Bessel function of the first kind, for the Kaiser window
+static double besselI0(double x)
+{
+	double sum = 1., term = 1.;
+	for(int k = 1; k < 32; k++)
+	{
+		term *= (x / (2. * k)) * (x / (2. * k));
+		sum += term;
+		if(term < sum * 1e-12)
+			break;
+	}
+	return sum;
+}
+
+static void makeCubicTable(float *table, int phases)
+{
+	for(int p = 0; p <= phases; p++)
+	{
+		float f = float(p) / phases;
+		float f2 = f * f, f3 = f2 * f;
+		auto row = &table[p * 4];
+		// Catmull-Rom spline through the 2 neighboring frames on each side
+		row[0] = (-f3 + 2.f * f2 - f) * .5f;
+		row[1] = (3.f * f3 - 5.f * f2 + 2.f) * .5f;
+		row[2] = (-3.f * f3 + 4.f * f2 + f) * .5f;
+		row[3] = (f3 - f2) * .5f;
+	}
+}
+
+static void makeSincTable(float *table, FilterDesc desc, float cutoff)
+{
+	const double halfWidth = desc.taps / 2;
+	const double i0Beta = besselI0(desc.beta);
+	for(int p = 0; p <= desc.phases; p++)
+	{
+		double f = double(p) / desc.phases;
+		auto row = &table[p * desc.taps];
+		double sum{};
+		for(int t = 0; t < desc.taps; t++)
+		{
+			double x = t - (halfWidth - 1) - f;
+			double r = x / halfWidth;
+			double window = r * r < 1. ? besselI0(desc.beta * std::sqrt(1. - r * r)) / i0Beta : 0.;
+			double sincX = std::numbers::pi * cutoff * x;
+			double sinc = x == 0. ? 1. : std::sin(sincX) / sincX;
+			row[t] = cutoff * sinc * window;
+			sum += row[t];
+		}
+		// normalize each phase to unity gain so DC passes unchanged
+		for(int t = 0; t < desc.taps; t++)
+			row[t] /= sum;
+	}
+}
+
+void AudioResampler::setFormat(IG::Audio::Format format_)
+{
+	assumeExpr(format_.channels == 1 || format_.channels == 2);
+	format = format_;
+	reset();
+}
+
+void AudioResampler::setQuality(AudioResamplerQuality q)
+{
+	if(quality_ == q)
+		return;
+	quality_ = q;
+	reset();
+}
+
+void AudioResampler::reset()
+{
+	taps_ = filterDesc(quality_).taps;
+	cutoff = 0;
+	pos = 0;
+	// prime the history with silence so the first output frame is centered on the first input frame
+	historyFrames = taps_ / 2 - 1;
+	for(auto &h : history)
+	{
+		h.assign(historyFrames, 0.f);
+	}
+}
+
+void AudioResampler::updateFilter(double ratio)
+{
+	auto desc = filterDesc(quality_);
+	// when downsampling move the cutoff below the output Nyquist rate to avoid aliasing
+	float newCutoff = desc.passband * std::min(1., 1. / ratio);
+	if(std::abs(newCutoff - cutoff) <= cutoff * .01f)
+		return;
+	cutoff = newCutoff;
+	filterTable.resize((desc.phases + 1) * desc.taps);
+	if(quality_ == AudioResamplerQuality::Low)
+		makeCubicTable(filterTable.data(), desc.phases);
+	else
+		makeSincTable(filterTable.data(), desc, cutoff);
+}
+
+void AudioResampler::appendInput(const void *src, size_t srcFrames)
+{
+	auto channels = format.channels;
+	auto newSize = historyFrames + srcFrames;
+	for(auto c : iotaCount(channels))
+	{
+		if(history[c].size() < newSize)
+			history[c].resize(newSize);
+	}
+	if(format.sample.isFloat())
+	{
+		auto in = (const float*)src;
+		for(auto c : iotaCount(channels))
+		{
+			auto out = &history[c][historyFrames];
+			for(auto i : iotaCount(srcFrames))
+				out[i] = in[i * channels + c];
+		}
+	}
+	else
+	{
+		auto in = (const int16_t*)src;
+		for(auto c : iotaCount(channels))
+		{
+			auto out = &history[c][historyFrames];
+			for(auto i : iotaCount(srcFrames))
+				out[i] = in[i * channels + c] * (1.f / 32768.f);
+		}
+	}
+	historyFrames = newSize;
+}
+
+static void writeOutput(void *dest, size_t idx, int channel, int channels, bool isFloat, float val)
+{
+	if(isFloat)
+	{
+		((float*)dest)[idx * channels + channel] = val;
+	}
+	else
+	{
+		((int16_t*)dest)[idx * channels + channel] = std::clamp(std::lround(val * 32768.f), -32768l, 32767l);
+	}
+}
+
+size_t AudioResampler::resample(void *dest, size_t destFrames, const void *src, size_t srcFrames, double ratio)
+{
+	assumeExpr(format);
+	assumeExpr(ratio > 0.);
+	updateFilter(ratio);
+	appendInput(src, srcFrames);
+	const int phases = filterDesc(quality_).phases;
+	const int channels = format.channels;
+	const bool isFloat = format.sample.isFloat();
+	size_t written{};
+	for(auto idx = size_t(pos); idx + taps_ <= historyFrames; idx = size_t(pos))
+	{
+		if(written < destFrames) [[likely]]
+		{
+			int phase = (pos - idx) * phases + .5;
+			auto coefs = &filterTable[phase * taps_];
+			if(channels == 1)
+			{
+				writeOutput(dest, written, 0, 1, isFloat, dot(&history[0][idx], coefs, taps_));
+			}
+			else
+			{
+				float l, r;
+				dot2(&history[0][idx], &history[1][idx], coefs, taps_, l, r);
+				writeOutput(dest, written, 0, 2, isFloat, l);
+				writeOutput(dest, written, 1, 2, isFloat, r);
+			}
+			written++;
+		}
+		pos += ratio;
+	}
+	// drop the frames no future output depends on
+	auto consumed = std::min(size_t(pos), historyFrames);
+	if(consumed)
+	{
+		auto remaining = historyFrames - consumed;
+		for(auto c : iotaCount(channels))
+		{
+			std::memmove(history[c].data(), &history[c][consumed], remaining * sizeof(float));
+		}
+		historyFrames = remaining;
+		pos -= consumed;
+	}
+	return written;
+}
+
+size_t AudioResampler::maxOutputFrames(size_t srcFrames, double ratio) const
+{
+	auto framesAvail = double(historyFrames + srcFrames) - pos;
+	return std::max(std::ceil(framesAvail / ratio), 0.);
+}
+
+std::string benchmarkAudioResampler()
+{
+	constexpr int rate = 48000;
+	constexpr size_t blockFrames = 800;
+	constexpr size_t totalFrames = rate * 4;
+	constexpr double ratio = 1.005;
+	std::vector<float> srcF32(totalFrames * 2);
+	std::vector<int16_t> srcI16(totalFrames * 2);
+	for(auto i : iotaCount(totalFrames))
+	{
+		// quiet sweep with some content near Nyquist to exercise the whole filter
+		float t = float(i) / rate;
+		float val = .5f * std::sin(2.f * std::numbers::pi_v<float> * (200.f + 5000.f * t) * t);
+		srcF32[i * 2] = srcF32[i * 2 + 1] = val;
+		srcI16[i * 2] = srcI16[i * 2 + 1] = val * 32767.f;
+	}
+	std::vector<float> dest(blockFrames * 4);
+	std::string resultsJson;
+	for(auto q : wise_enum::range<AudioResamplerQuality>)
+	{
+		for(bool isFloat : {false, true})
+		{
+			for(int channels : {1, 2})
+			{
+				IG::Audio::SampleFormat sampleFormat = isFloat ? IG::Audio::SampleFormats::f32 : IG::Audio::SampleFormats::i16;
+				IG::Audio::Format format{rate, sampleFormat, int8_t(channels)};
+				AudioResampler resampler;
+				resampler.setQuality(q.value);
+				resampler.setFormat(format);
+				const void *src = isFloat ? (const void*)srcF32.data() : (const void*)srcI16.data();
+				auto blockBytes = format.framesToBytes(blockFrames);
+				size_t outFrames{};
+				auto start = IG::steadyClockTimestamp();
+				for(size_t i = 0; i + blockFrames <= totalFrames; i += blockFrames)
+				{
+					outFrames += resampler.resample(dest.data(), blockFrames * 2, (const char*)src + (i / blockFrames) * blockBytes, blockFrames, ratio);
+				}
+				auto secs = IG::FloatSeconds(IG::steadyClockTimestamp() - start).count();
+				auto samplesPerSec = outFrames * channels / secs;
+				logMsg("%s quality %s %d channel(s):%.0f samples/sec", q.name.data(),
+					isFloat ? "f32" : "i16", channels, samplesPerSec);
+				if(resultsJson.size())
+					resultsJson += ",";
+				resultsJson += fmt::format("{{\"quality\":\"{}\",\"format\":\"{}\",\"channels\":{},\"samplesPerSec\":{:.0f}}}",
+					q.name, isFloat ? "f32" : "i16", channels, samplesPerSec);
+			}
+		}
+	}
+	return fmt::format("{{\"resampler\":[{}]}}", resultsJson);
+}
+
+}
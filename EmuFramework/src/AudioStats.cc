@@ -0,0 +1,157 @@
+/*  This file is part of EmuFramework.
+
+	Imagine is free software: you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation, either version 3 of the License, or
+	(at your option) any later version.
+
+	Imagine is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License
+	along with EmuFramework.  If not, see <http://www.gnu.org/licenses/> */
+
+#define LOGTAG "AudioStats"
+#include <emuframework/AudioStats.hh>
+#include <imagine/base/ApplicationContext.hh>
+#include <imagine/io/FileIO.hh>
+#include <imagine/util/format.hh>
+#include <imagine/logger/logger.h>
+#include <cmath>
+
+namespace EmuEx
+{
+
+AudioStatsHistogram::Snapshot AudioStatsHistogram::snapshot() const
+{
+	Snapshot s;
+	// load the sample count first so it never exceeds the sum of the loaded buckets
+	s.samples = samples.load(std::memory_order_acquire);
+	for(int i = 0; i < buckets; i++)
+	{
+		s.counts[i] = counts[i].load(std::memory_order_relaxed);
+	}
+	return s;
+}
+
+AudioStatsHistogram::Snapshot AudioStatsHistogram::Snapshot::operator-(const Snapshot &rhs) const
+{
+	Snapshot s;
+	for(int i = 0; i < buckets; i++)
+	{
+		s.counts[i] = counts[i] - rhs.counts[i];
+	}
+	s.samples = samples - rhs.samples;
+	return s;
+}
+
+uint32_t AudioStatsHistogram::Snapshot::percentile(double p) const
+{
+	if(!samples)
+		return 0;
+	auto target = std::max(uint32_t(std::ceil(samples * p)), 1u);
+	uint32_t seen{};
+	for(int i = 0; i < buckets; i++)
+	{
+		seen += counts[i];
+		if(seen >= target)
+			return bucketLowerBound(i);
+	}
+	// buckets were updated after the sample count was read, return the highest non-empty one
+	for(int i = buckets - 1; i >= 0; i--)
+	{
+		if(counts[i])
+			return bucketLowerBound(i);
+	}
+	return 0;
+}
+
+AudioStats::Snapshot AudioStats::snapshot() const
+{
+	return
+	{
+		.underruns = underruns.load(std::memory_order_relaxed),
+		.overruns = overruns.load(std::memory_order_relaxed),
+		.callbacks = callbacks.load(std::memory_order_relaxed),
+		.rateAdjusts = rateAdjusts.load(std::memory_order_relaxed),
+		.callbackFrames = callbackFrames.load(std::memory_order_relaxed),
+		.callbackIntervalUSecs = callbackIntervalUSecs.snapshot(),
+		.framesPerCallback = framesPerCallback.snapshot(),
+		.bufferFillFrames = bufferFillFrames.snapshot(),
+		.latencyUSecs = latencyUSecs.snapshot(),
+		.rateAdjustPpm = rateAdjustPpm.snapshot(),
+	};
+}
+
+AudioStats::Snapshot AudioStats::Snapshot::operator-(const Snapshot &rhs) const
+{
+	return
+	{
+		.underruns = underruns - rhs.underruns,
+		.overruns = overruns - rhs.overruns,
+		.callbacks = callbacks - rhs.callbacks,
+		.rateAdjusts = rateAdjusts - rhs.rateAdjusts,
+		.callbackFrames = callbackFrames - rhs.callbackFrames,
+		.callbackIntervalUSecs = callbackIntervalUSecs - rhs.callbackIntervalUSecs,
+		.framesPerCallback = framesPerCallback - rhs.framesPerCallback,
+		.bufferFillFrames = bufferFillFrames - rhs.bufferFillFrames,
+		.latencyUSecs = latencyUSecs - rhs.latencyUSecs,
+		.rateAdjustPpm = rateAdjustPpm - rhs.rateAdjustPpm,
+	};
+}
+
+static std::string percentileString(const AudioStatsHistogram::Snapshot &h, double scale = 1.)
+{
+	return fmt::format("{:g}/{:g}/{:g}", h.percentile(.5) * scale, h.percentile(.99) * scale, h.max() * scale);
+}
+
+std::string AudioStats::Snapshot::summary() const
+{
+	return fmt::format("Underruns:{} Overruns:{}\nCallbacks:{} Frames:{}\n"
+		"p50/p99/max\nCallback interval ms:{}\nFrames per callback:{}\nBuffer fill frames:{}\n"
+		"Latency ms:{}\nRate adjustments:{} ppm:{}",
+		underruns, overruns, callbacks, callbackFrames,
+		percentileString(callbackIntervalUSecs, .001), percentileString(framesPerCallback),
+		percentileString(bufferFillFrames), percentileString(latencyUSecs, .001),
+		rateAdjusts, percentileString(rateAdjustPpm));
+}
+
+static void appendHistogram(std::string &str, const char *name, const AudioStatsHistogram::Snapshot &h)
+{
+	str += fmt::format("\n{} ({} samples, p50:{} p90:{} p99:{} max:{})\n", name, h.samples,
+		h.percentile(.5), h.percentile(.9), h.percentile(.99), h.max());
+	for(int i = 0; i < AudioStatsHistogram::buckets; i++)
+	{
+		if(!h.counts[i])
+			continue;
+		str += fmt::format("{:>10}: {}\n", AudioStatsHistogram::bucketLowerBound(i), h.counts[i]);
+	}
+}
+
+std::string AudioStats::Snapshot::report() const
+{
+	std::string str = fmt::format("underruns: {}\noverruns: {}\ncallbacks: {}\ncallback frames: {}\nrate adjustments: {}\n",
+		underruns, overruns, callbacks, callbackFrames, rateAdjusts);
+	appendHistogram(str, "callback interval (usecs)", callbackIntervalUSecs);
+	appendHistogram(str, "frames per callback", framesPerCallback);
+	appendHistogram(str, "buffer fill at callback (frames)", bufferFillFrames);
+	appendHistogram(str, "latency estimate (usecs)", latencyUSecs);
+	appendHistogram(str, "rate adjustment (ppm)", rateAdjustPpm);
+	return str;
+}
+
+bool AudioStats::dumpToFile(ApplicationContext ctx, CStringView path) const
+{
+	auto str = snapshot().report();
+	if(FileUtils::writeToUri(ctx, path, {(const unsigned char*)str.data(), str.size()}) == -1)
+	{
+		logErr("error writing audio stats to:%s", path.data());
+		return false;
+	}
+	logMsg("wrote audio stats to:%s", path.data());
+	return true;
+}
+
+}
@@ -54,6 +54,7 @@ bool AutosaveManager::load(AutosaveActionSource src, LoadAutosaveMode mode)
 {
 	if(autoSaveSlot == noAutosaveName)
 		return true;
+	app.waitForStateWrites();
 	try
 	{
 		system().loadBackupMemory(app);
@@ -104,6 +105,7 @@ bool AutosaveManager::setSlot(std::string_view name)
 
 bool AutosaveManager::renameSlot(std::string_view name, std::string_view newName)
 {
+	app.waitForStateWrites();
 	if(!appContext().renameFileUri(system().contentLocalSaveDirectory(name),
 		system().contentLocalSaveDirectory(newName)))
 	{
@@ -118,6 +120,7 @@ bool AutosaveManager::deleteSlot(std::string_view name)
 {
 	if(name == autoSaveSlot)
 		return false;
+	app.waitForStateWrites();
 	auto ctx = appContext();
 	if(!ctx.forEachInDirectoryUri(system().contentLocalSaveDirectory(name),
 			[this, ctx](const FS::directory_entry &e)
@@ -287,6 +287,8 @@ void EmuApp::saveConfigFile(FileIO &io)
 		optionImgEffect,
 		optionImageEffectPixelFormat,
 		optionVideoImageBuffers,
+		optionVideoPostFilter,
+		optionGpuPalette,
 		optionOverlayEffect,
 		optionOverlayEffectLevel,
 		optionFontSize,
@@ -316,6 +318,8 @@ void EmuApp::saveConfigFile(FileIO &io)
 		#endif
 		optionSoundBuffers,
 		optionAddSoundBuffersOnUnderrun,
+		optionAudioResamplerQuality,
+		optionAudioDynamicRateControl,
 		#ifdef CONFIG_AUDIO_MULTIPLE_SYSTEM_APIS
 		optionAudioAPI,
 		#endif
@@ -351,6 +355,9 @@ void EmuApp::saveConfigFile(FileIO &io)
 	writeOptionValueIfNotDefault(io, CFGKEY_FRAME_RATE_PAL, outputTimingManager.frameTimeOption(VideoSystem::PAL), OutputTimingManager::autoOption);
 	vController.writeConfig(io);
 	autosaveManager_.writeConfig(io);
+	rewindManager_.writeConfig(io);
+	runAheadManager_.writeConfig(io);
+	archiveContentCache_.writeConfig(io);
 	if(IG::used(usePresentationTime_) && !usePresentationTime_)
 		writeOptionValue(io, CFGKEY_RENDERER_PRESENTATION_TIME, false);
 	if(IG::used(forceMaxScreenFrameRate) && forceMaxScreenFrameRate)
@@ -553,6 +560,12 @@ EmuApp::ConfigParams EmuApp::loadConfigFile(IG::ApplicationContext ctx)
 						return true;
 					if(autosaveManager_.readConfig(io, key, size))
 						return true;
+					if(rewindManager_.readConfig(io, key, size))
+						return true;
+					if(runAheadManager_.readConfig(io, key, size))
+						return true;
+					if(archiveContentCache_.readConfig(io, key, size))
+						return true;
 					logMsg("skipping key %u", (unsigned)key);
 					return false;
 				}
@@ -580,6 +593,8 @@ EmuApp::ConfigParams EmuApp::loadConfigFile(IG::ApplicationContext ctx)
 					setRenderPixelFormat(readOptionValue<IG::PixelFormat>(io, size, renderPixelFormatIsValid));
 					return true;
 				case CFGKEY_VIDEO_IMAGE_BUFFERS: return optionVideoImageBuffers.readFromIO(io, size);
+				case CFGKEY_VIDEO_POST_FILTER: return optionVideoPostFilter.readFromIO(io, size);
+				case CFGKEY_VIDEO_GPU_PALETTE: return optionGpuPalette.readFromIO(io, size);
 				case CFGKEY_OVERLAY_EFFECT: return optionOverlayEffect.readFromIO(io, size);
 				case CFGKEY_OVERLAY_EFFECT_LEVEL: return optionOverlayEffectLevel.readFromIO(io, size);
 				case CFGKEY_RECENT_GAMES: return readRecentContent(ctx, io, size);
@@ -620,6 +635,8 @@ EmuApp::ConfigParams EmuApp::loadConfigFile(IG::ApplicationContext ctx)
 				case CFGKEY_SOUND_BUFFERS: return optionSoundBuffers.readFromIO(io, size);
 				case CFGKEY_SOUND_VOLUME: return optionSoundVolume.readFromIO(io, size);
 				case CFGKEY_ADD_SOUND_BUFFERS_ON_UNDERRUN: return optionAddSoundBuffersOnUnderrun.readFromIO(io, size);
+				case CFGKEY_AUDIO_RESAMPLER_QUALITY: return optionAudioResamplerQuality.readFromIO(io, size);
+				case CFGKEY_AUDIO_DYNAMIC_RATE_CONTROL: return optionAudioDynamicRateControl.readFromIO(io, size);
 				case CFGKEY_AUDIO_SOLO_MIX:
 					audioManager().setSoloMix(readOptionValue<bool>(io, size));
 					return true;
@@ -0,0 +1,357 @@
+/*  This file is part of EmuFramework.
+
+	Imagine is free software: you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation, either version 3 of the License, or
+	(at your option) any later version.
+
+	Imagine is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License
+	along with EmuFramework.  If not, see <http://www.gnu.org/licenses/> */
+
+#define LOGTAG "ContentDigest"
+#include <emuframework/ContentDigest.hh>
+#include <imagine/io/FileIO.hh>
+#include <imagine/io/MapIO.hh>
+#include <imagine/fs/FS.hh>
+#include <imagine/time/Time.hh>
+#include <imagine/util/format.hh>
+#include <imagine/logger/logger.h>
+#include <zlib.h>
+#include <algorithm>
+#include <bit>
+#include <charconv>
+#include <cstring>
+#include <thread>
+#include <utility>
+
+namespace EmuEx
+{
+
+// inputs smaller than this are hashed on the calling thread
+constexpr size_t parallelMinSize = 0x100000;
+constexpr size_t crcMinChunkSize = 0x400000;
+
+static uint32_t loadLE32(const uint8_t *p) { return p[0] | (p[1] << 8) | (p[2] << 16) | (uint32_t(p[3]) << 24); }
+static uint32_t loadBE32(const uint8_t *p) { return (uint32_t(p[0]) << 24) | (p[1] << 16) | (p[2] << 8) | p[3]; }
+
+// Runs compress() on each 64 byte block of data followed by the padding & bit length,
+// which MD5 stores little-endian & SHA-1 big-endian
+static void forEachPaddedBlock(std::span<const uint8_t> data, bool bigEndianLength, auto &&compress)
+{
+	size_t fullBlocks = data.size() / 64;
+	for(size_t i = 0; i < fullBlocks; i++)
+		compress(&data[i * 64]);
+	uint8_t tail[128]{};
+	size_t tailSize = data.size() % 64;
+	std::memcpy(tail, data.data() + fullBlocks * 64, tailSize);
+	tail[tailSize] = 0x80;
+	size_t tailBlocks = tailSize < 56 ? 1 : 2;
+	uint64_t bitLength = uint64_t(data.size()) * 8;
+	for(int i = 0; i < 8; i++)
+	{
+		auto shift = bigEndianLength ? (7 - i) * 8 : i * 8;
+		tail[tailBlocks * 64 - 8 + i] = bitLength >> shift;
+	}
+	for(size_t i = 0; i < tailBlocks; i++)
+		compress(&tail[i * 64]);
+}
+
+static std::array<uint8_t, 16> md5(std::span<const uint8_t> data)
+{
+	static constexpr uint32_t k[64]
+	{
+		0xd76aa478, 0xe8c7b756, 0x242070db, 0xc1bdceee, 0xf57c0faf, 0x4787c62a, 0xa8304613, 0xfd469501,
+		0x698098d8, 0x8b44f7af, 0xffff5bb1, 0x895cd7be, 0x6b901122, 0xfd987193, 0xa679438e, 0x49b40821,
+		0xf61e2562, 0xc040b340, 0x265e5a51, 0xe9b6c7aa, 0xd62f105d, 0x02441453, 0xd8a1e681, 0xe7d3fbc8,
+		0x21e1cde6, 0xc33707d6, 0xf4d50d87, 0x455a14ed, 0xa9e3e905, 0xfcefa3f8, 0x676f02d9, 0x8d2a4c8a,
+		0xfffa3942, 0x8771f681, 0x6d9d6122, 0xfde5380c, 0xa4beea44, 0x4bdecfa9, 0xf6bb4b60, 0xbebfbc70,
+		0x289b7ec6, 0xeaa127fa, 0xd4ef3085, 0x04881d05, 0xd9d4d039, 0xe6db99e5, 0x1fa27cf8, 0xc4ac5665,
+		0xf4292244, 0x432aff97, 0xab9423a7, 0xfc93a039, 0x655b59c3, 0x8f0ccc92, 0xffeff47d, 0x85845dd1,
+		0x6fa87e4f, 0xfe2ce6e0, 0xa3014314, 0x4e0811a1, 0xf7537e82, 0xbd3af235, 0x2ad7d2bb, 0xeb86d391,
+	};
+	static constexpr int r[16]{7, 12, 17, 22, 5, 9, 14, 20, 4, 11, 16, 23, 6, 10, 15, 21};
+	uint32_t h[4]{0x67452301, 0xefcdab89, 0x98badcfe, 0x10325476};
+	forEachPaddedBlock(data, false, [&](const uint8_t *block)
+	{
+		uint32_t w[16];
+		for(int i = 0; i < 16; i++)
+			w[i] = loadLE32(&block[i * 4]);
+		uint32_t a = h[0], b = h[1], c = h[2], d = h[3];
+		for(int i = 0; i < 64; i++)
+		{
+			uint32_t f;
+			int g;
+			switch(i / 16)
+			{
+				case 0: f = (b & c) | (~b & d); g = i; break;
+				case 1: f = (d & b) | (~d & c); g = (5 * i + 1) % 16; break;
+				case 2: f = b ^ c ^ d; g = (3 * i + 5) % 16; break;
+				default: f = c ^ (b | ~d); g = (7 * i) % 16; break;
+			}
+			f += a + k[i] + w[g];
+			a = d; d = c; c = b;
+			b += std::rotl(f, r[(i / 16) * 4 + i % 4]);
+		}
+		h[0] += a; h[1] += b; h[2] += c; h[3] += d;
+	});
+	std::array<uint8_t, 16> digest;
+	for(int i = 0; i < 16; i++)
+		digest[i] = h[i / 4] >> ((i % 4) * 8);
+	return digest;
+}
+
+static std::array<uint8_t, 20> sha1(std::span<const uint8_t> data)
+{
+	uint32_t h[5]{0x67452301, 0xefcdab89, 0x98badcfe, 0x10325476, 0xc3d2e1f0};
+	forEachPaddedBlock(data, true, [&](const uint8_t *block)
+	{
+		uint32_t w[80];
+		for(int i = 0; i < 16; i++)
+			w[i] = loadBE32(&block[i * 4]);
+		for(int i = 16; i < 80; i++)
+			w[i] = std::rotl(w[i - 3] ^ w[i - 8] ^ w[i - 14] ^ w[i - 16], 1);
+		uint32_t a = h[0], b = h[1], c = h[2], d = h[3], e = h[4];
+		for(int i = 0; i < 80; i++)
+		{
+			uint32_t f, k;
+			if(i < 20) { f = (b & c) | (~b & d); k = 0x5a827999; }
+			else if(i < 40) { f = b ^ c ^ d; k = 0x6ed9eba1; }
+			else if(i < 60) { f = (b & c) | (b & d) | (c & d); k = 0x8f1bbcdc; }
+			else { f = b ^ c ^ d; k = 0xca62c1d6; }
+			uint32_t temp = std::rotl(a, 5) + f + e + k + w[i];
+			e = d; d = c; c = std::rotl(b, 30); b = a; a = temp;
+		}
+		h[0] += a; h[1] += b; h[2] += c; h[3] += d; h[4] += e;
+	});
+	std::array<uint8_t, 20> digest;
+	for(int i = 0; i < 20; i++)
+		digest[i] = h[i / 4] >> ((3 - i % 4) * 8);
+	return digest;
+}
+
+// zlib's crc32 uses the CPU's CRC or carry-less multiply instructions when built with them,
+// chunks are hashed in parallel & joined with crc32_combine()
+static uint32_t crc32(std::span<const uint8_t> data, size_t threads)
+{
+	auto chunks = std::clamp(data.size() / crcMinChunkSize, size_t(1), threads);
+	if(chunks == 1)
+		return crc32_z(0, data.data(), data.size());
+	auto chunkSize = data.size() / chunks;
+	std::vector<uLong> crcs(chunks);
+	std::vector<std::thread> workers;
+	workers.reserve(chunks - 1);
+	auto chunkData = [&](size_t i)
+	{
+		return data.subspan(i * chunkSize, i == chunks - 1 ? std::dynamic_extent : chunkSize);
+	};
+	for(size_t i = 1; i < chunks; i++)
+	{
+		workers.emplace_back([&, i]{ auto d = chunkData(i); crcs[i] = crc32_z(0, d.data(), d.size()); });
+	}
+	crcs[0] = crc32_z(0, data.data(), chunkSize);
+	for(auto &t : workers)
+		t.join();
+	auto crc = crcs[0];
+	for(size_t i = 1; i < chunks; i++)
+		crc = crc32_combine(crc, crcs[i], chunkData(i).size());
+	return crc;
+}
+
+ContentDigest ContentDigest::compute(std::span<const uint8_t> data, ContentDigestMask types)
+{
+	ContentDigest digest{.types = types};
+	bool doCRC32 = digest.has(ContentDigestMask::CRC32);
+	bool doMD5 = digest.has(ContentDigestMask::MD5);
+	bool doSHA1 = digest.has(ContentDigestMask::SHA1);
+	if(data.size() < parallelMinSize)
+	{
+		if(doCRC32)
+			digest.crc32 = EmuEx::crc32(data, 1);
+		if(doMD5)
+			digest.md5 = EmuEx::md5(data);
+		if(doSHA1)
+			digest.sha1 = EmuEx::sha1(data);
+		return digest;
+	}
+	// MD5 & SHA-1 are sequential so they each get a thread, CRC32 splits across the remaining cores
+	std::thread md5Thread, sha1Thread;
+	if(doMD5)
+		md5Thread = std::thread{[&]{ digest.md5 = EmuEx::md5(data); }};
+	if(doSHA1)
+		sha1Thread = std::thread{[&]{ digest.sha1 = EmuEx::sha1(data); }};
+	if(doCRC32)
+	{
+		auto cores = std::max(std::thread::hardware_concurrency(), 3u);
+		digest.crc32 = EmuEx::crc32(data, cores - doMD5 - doSHA1);
+	}
+	if(md5Thread.joinable())
+		md5Thread.join();
+	if(sha1Thread.joinable())
+		sha1Thread.join();
+	return digest;
+}
+
+ContentIdentifier::ContentIdentifier(ApplicationContext ctx):
+	ctx{ctx} {}
+
+FS::PathString ContentIdentifier::indexPath() const
+{
+	return FS::pathString(ctx.cachePath(), "contentDigests");
+}
+
+template<size_t size>
+static bool parseHex(std::string_view s, std::array<uint8_t, size> &bytes)
+{
+	if(s.size() != size * 2)
+		return false;
+	for(size_t i = 0; i < size; i++)
+	{
+		auto [ptr, ec] = std::from_chars(&s[i * 2], &s[i * 2 + 2], bytes[i], 16);
+		if(ec != std::errc{} || ptr != &s[i * 2 + 2])
+			return false;
+	}
+	return true;
+}
+
+template<size_t size>
+static std::string hexString(const std::array<uint8_t, size> &bytes)
+{
+	std::string str;
+	for(auto b : bytes)
+		str += IG::format<std::string>("{:02x}", b);
+	return str;
+}
+
+// each line: size, write time, data offset, digest types, CRC32, MD5, SHA-1, path, separated by tabs,
+// with zeros for digests that weren't requested
+void ContentIdentifier::loadIndex()
+{
+	if(indexLoaded)
+		return;
+	indexLoaded = true;
+	auto buff = FileUtils::bufferFromPath(indexPath(), OpenFlagsMask::Test);
+	if(!buff)
+		return;
+	std::string_view index{reinterpret_cast<const char*>(buff.data()), buff.size()};
+	while(index.size())
+	{
+		auto lineEnd = index.find('\n');
+		auto line = index.substr(0, lineEnd);
+		index.remove_prefix(lineEnd == index.npos ? index.size() : lineEnd + 1);
+		std::string_view fields[8];
+		size_t fieldCount{};
+		while(fieldCount < std::size(fields))
+		{
+			auto sep = fieldCount < std::size(fields) - 1 ? line.find('\t') : line.npos;
+			fields[fieldCount++] = line.substr(0, sep);
+			if(sep == line.npos)
+				break;
+			line.remove_prefix(sep + 1);
+		}
+		Record rec{};
+		auto parse = [](std::string_view s, auto &val, int base = 10)
+		{
+			auto [ptr, ec] = std::from_chars(s.data(), s.data() + s.size(), val, base);
+			return ec == std::errc{} && ptr == s.data() + s.size();
+		};
+		uint8_t types{};
+		if(fieldCount != std::size(fields) || !parse(fields[0], rec.size) || !parse(fields[1], rec.lastWriteTime) ||
+			!parse(fields[2], rec.offset) || !parse(fields[3], types, 16) ||
+			!parse(fields[4], rec.digest.crc32, 16) || !parseHex(fields[5], rec.digest.md5) ||
+			!parseHex(fields[6], rec.digest.sha1))
+		{
+			logWarn("skipping malformed index line");
+			continue;
+		}
+		rec.digest.types = ContentDigestMask(types);
+		rec.path = fields[7];
+		records.emplace_back(std::move(rec));
+	}
+	logMsg("loaded %zu content digests", records.size());
+}
+
+void ContentIdentifier::saveIndex() const
+{
+	std::string index;
+	for(const auto &rec : records)
+	{
+		index += IG::format<std::string>("{}\t{}\t{}\t{:x}\t{:08x}\t{}\t{}\t{}\n", rec.size, rec.lastWriteTime,
+			rec.offset, std::to_underlying(rec.digest.types), rec.digest.crc32,
+			hexString(rec.digest.md5), hexString(rec.digest.sha1), rec.path);
+	}
+	try
+	{
+		FS::create_directory(ctx.cachePath());
+	}
+	catch(std::exception &err)
+	{
+		logErr("error creating cache directory:%s", err.what());
+		return;
+	}
+	if(FileUtils::writeToPath(indexPath(), {reinterpret_cast<const unsigned char*>(index.data()), index.size()}) == -1)
+		logErr("error writing:%s", indexPath().data());
+}
+
+ContentDigest ContentIdentifier::identify(CStringView path, IO &io, ContentDigestMask types, size_t offset)
+{
+	auto size = io.size();
+	if(offset > size)
+		offset = size;
+	auto lastWriteTime = ctx.fileUriLastWriteTime(path).count();
+	// without a valid modification time, a changed file of the same size can't be detected
+	bool isCacheable = lastWriteTime;
+	Record *rec{};
+	if(isCacheable)
+	{
+		loadIndex();
+		if(auto it = std::ranges::find_if(records, [&](const Record &rec)
+			{
+				return rec.path == path.data() && rec.size == size && rec.lastWriteTime == lastWriteTime &&
+					rec.offset == offset;
+			});
+			it != records.end())
+		{
+			// move to the back so the oldest records are evicted first
+			std::rotate(it, it + 1, records.end());
+			rec = &records.back();
+			if(rec->digest.has(types))
+				return rec->digest;
+		}
+	}
+	// only compute the digests missing from the cached record
+	auto missingTypes = rec ? types & ~rec->digest.types : types;
+	if(!io.map().data())
+		io = MapIO{io.buffer(IOBufferMode::Release)};
+	ContentDigest digest;
+	auto time = timeFunc([&]{ digest = ContentDigest::compute(io.map().subspan(offset), missingTypes); });
+	logMsg("computed digests (types:0x%X) of %zu bytes in %.3fs", std::to_underlying(missingTypes),
+		size - offset, std::chrono::duration_cast<FloatSeconds>(time).count());
+	if(rec)
+	{
+		auto &cached = rec->digest;
+		if(digest.has(ContentDigestMask::CRC32))
+			cached.crc32 = digest.crc32;
+		if(digest.has(ContentDigestMask::MD5))
+			cached.md5 = digest.md5;
+		if(digest.has(ContentDigestMask::SHA1))
+			cached.sha1 = digest.sha1;
+		cached.types |= missingTypes;
+		digest = cached;
+	}
+	else if(isCacheable)
+	{
+		if(records.size() >= maxRecords)
+			records.erase(records.begin());
+		records.emplace_back(std::string{path}, size, lastWriteTime, offset, digest);
+	}
+	if(isCacheable)
+		saveIndex();
+	return digest;
+}
+
+}
@@ -124,8 +124,11 @@ EmuApp::EmuApp(ApplicationInitParams initParams, ApplicationContext &ctx):
 	emuAudio{audioManager_},
 	emuVideoLayer{emuVideo, defaultVideoAspectRatio()},
 	emuSystemTask{*this},
+	stateWriteTask{*this},
 	vController{ctx},
 	autosaveManager_{*this},
+	archiveContentCache_{ctx},
+	contentIdentifier_{ctx},
 	pixmapReader{ctx},
 	pixmapWriter{ctx},
 	vibrationManager_{ctx},
@@ -144,6 +147,9 @@ EmuApp::EmuApp(ApplicationInitParams initParams, ApplicationContext &ctx):
 	optionSoundBuffers{CFGKEY_SOUND_BUFFERS,
 		3, 0, optionIsValidWithMinMax<1, 7, uint8_t>},
 	optionAddSoundBuffersOnUnderrun{CFGKEY_ADD_SOUND_BUFFERS_ON_UNDERRUN, 1, 0},
+	optionAudioResamplerQuality{CFGKEY_AUDIO_RESAMPLER_QUALITY, std::to_underlying(AudioResamplerQuality::Medium),
+		false, optionIsValidWithMax<std::to_underlying(lastEnum<AudioResamplerQuality>)>},
+	optionAudioDynamicRateControl{CFGKEY_AUDIO_DYNAMIC_RATE_CONTROL, 0, 0},
 	optionAudioAPI{CFGKEY_AUDIO_API, 0},
 	optionNotificationIcon{CFGKEY_NOTIFICATION_ICON, 1, !Config::envIsAndroid},
 	optionTitleBar{CFGKEY_TITLE_BAR, 1, !CAN_HIDE_TITLE_BAR},
@@ -171,6 +177,9 @@ EmuApp::EmuApp(ApplicationInitParams initParams, ApplicationContext &ctx):
 	optionShowOnSecondScreen{CFGKEY_SHOW_ON_2ND_SCREEN, 0},
 	optionTextureBufferMode{CFGKEY_TEXTURE_BUFFER_MODE, 0},
 	optionVideoImageBuffers{CFGKEY_VIDEO_IMAGE_BUFFERS, 0, 0, optionIsValidWithMax<2>},
+	optionVideoPostFilter{CFGKEY_VIDEO_POST_FILTER, std::to_underlying(VideoPostFilter::Off),
+		false, optionIsValidWithMax<std::to_underlying(lastEnum<VideoPostFilter>)>},
+	optionGpuPalette{CFGKEY_VIDEO_GPU_PALETTE, 0, !EmuSystem::canRenderPaletteIndexed},
 	layoutBehindSystemUI{ctx.hasTranslucentSysUI()}
 {
 	if(ctx.registerInstance(initParams))
@@ -280,6 +289,7 @@ static void suspendEmulation(EmuApp &app)
 		return;
 	app.autosaveManager().save();
 	app.system().flushBackupMemory(app);
+	app.waitForStateWrites();
 }
 
 void EmuApp::closeSystem()
@@ -287,7 +297,10 @@ void EmuApp::closeSystem()
 	showUI();
 	emuSystemTask.stop();
 	system().closeRuntimeSystem(*this);
+	stateWriteTask.wait();
 	autosaveManager_.resetSlot();
+	rewindManager_.reset();
+	runAheadManager_.reset();
 	viewController().onSystemClosed();
 }
 
@@ -332,15 +345,66 @@ void EmuApp::showExitAlert(ViewAttachParams attach, const Input::Event &e)
 		attach, system().hasContent()), e, false);
 }
 
-static const char *parseCommandArgs(IG::CommandArgs arg)
+struct LaunchArgs
+{
+	const char *path{};
+	int benchmarkFrames{};
+	bool benchmarkResampler{};
+	bool benchmarkPaletteExpand{};
+	bool benchmarkCore{};
+	std::span<const char * const> benchmarkCoreArgs{};
+	const char *linkName{};
+};
+
+constexpr int defaultBenchmarkFrames = 1800;
+
+// accepts either a content path, --benchmark <content path> [--frames N], --benchmark-resampler, --benchmark-palette, or --benchmark-core [args],
+// content can be followed by --link <name> to connect the link cable to another instance
+static LaunchArgs parseContentCommandArgs(IG::CommandArgs arg)
 {
 	if(arg.c < 2)
 	{
-		return nullptr;
+		return {};
+	}
+	if(std::string_view{arg.v[1]} == "--benchmark-resampler")
+	{
+		return {.benchmarkResampler = true};
+	}
+	if(std::string_view{arg.v[1]} == "--benchmark-palette")
+	{
+		return {.benchmarkPaletteExpand = true};
+	}
+	if(std::string_view{arg.v[1]} == "--benchmark-core")
+	{
+		return {.benchmarkCore = true, .benchmarkCoreArgs = {arg.v + 2, size_t(arg.c - 2)}};
+	}
+	if(std::string_view{arg.v[1]} == "--benchmark")
+	{
+		if(arg.c < 3)
+		{
+			logErr("missing content path for --benchmark");
+			return {};
+		}
+		LaunchArgs launch{arg.v[2], defaultBenchmarkFrames};
+		if(arg.c >= 5 && std::string_view{arg.v[3]} == "--frames")
+			launch.benchmarkFrames = std::max(std::atoi(arg.v[4]), 1);
+		logMsg("benchmarking content from command line:%s for %d frames", launch.path, launch.benchmarkFrames);
+		return launch;
 	}
 	auto launchPath = arg.v[1];
 	logMsg("starting content from command line:%s", launchPath);
-	return launchPath;
+	return {launchPath};
+}
+
+static LaunchArgs parseCommandArgs(IG::CommandArgs arg)
+{
+	auto launch = parseContentCommandArgs(arg);
+	for(int i = 2; i < arg.c - 1; i++)
+	{
+		if(std::string_view{arg.v[i]} == "--link")
+			launch.linkName = arg.v[i + 1];
+	}
+	return launch;
 }
 
 bool EmuApp::setWindowDrawableConfig(Gfx::DrawableConfig conf)
@@ -392,10 +456,8 @@ std::optional<IG::PixelFormat> EmuApp::renderPixelFormatOption() const
 	return {};
 }
 
-void EmuApp::applyRenderPixelFormat()
+IG::PixelFormat EmuApp::videoRenderPixelFormat() const
 {
-	if(!emuVideo.hasRendererTask())
-		return;
 	auto fmt = renderPixelFormat();
 	if(!fmt)
 		fmt = windowPixelFormat();
@@ -404,7 +466,14 @@ void EmuApp::applyRenderPixelFormat()
 		logMsg("Using RGB565 render format since emulated system can't render RGBA8888");
 		fmt = IG::PIXEL_RGB565;
 	}
-	emuVideoLayer.setFormat(system(), fmt, videoEffectPixelFormat(), windowDrawableConf.colorSpace);
+	return fmt;
+}
+
+void EmuApp::applyRenderPixelFormat()
+{
+	if(!emuVideo.hasRendererTask())
+		return;
+	emuVideoLayer.setFormat(system(), videoRenderPixelFormat(), videoEffectPixelFormat(), windowDrawableConf.colorSpace);
 }
 
 void EmuApp::renderSystemFramebuffer(EmuVideo &video)
@@ -477,14 +546,61 @@ void EmuApp::mainInitCommon(IG::ApplicationInitParams initParams, IG::Applicatio
 	system().onOptionsLoaded();
 	loadSystemOptions();
 	updateLegacySavePathOnStoragePath(ctx, system());
-	if(auto launchGame = parseCommandArgs(initParams.commandArgs());
-		launchGame)
-		system().setInitialLoadPath(launchGame);
+	auto launch = parseCommandArgs(initParams.commandArgs());
+	if(launch.benchmarkResampler || launch.benchmarkPaletteExpand)
+	{
+		fmt::print("{}\n", launch.benchmarkResampler ? benchmarkAudioResampler() : benchmarkPaletteExpand());
+		std::fflush(stdout);
+		ctx.exit(0);
+		return;
+	}
+	if(launch.benchmarkCore)
+	{
+		try
+		{
+			auto results = system().benchmarkCore(launch.benchmarkCoreArgs);
+			if(results.empty())
+				logErr("no core benchmark available");
+			else
+				fmt::print("{}\n", results);
+		}
+		catch(std::exception &err)
+		{
+			logErr("core benchmark failed:%s", err.what());
+		}
+		std::fflush(stdout);
+		ctx.exit(0);
+		return;
+	}
+	if(launch.linkName)
+	{
+		try
+		{
+			system().openLocalLink(launch.linkName);
+			if(rewindManager_.isEnabled() || runAheadManager_.frames())
+				logMsg("rewind & run-ahead are disabled while the link is open");
+		}
+		catch(std::exception &err)
+		{
+			logErr("error opening link:%s", err.what());
+		}
+	}
+	if(launch.path && !launch.benchmarkFrames)
+	{
+		system().setInitialLoadPath(launch.path);
+	}
 	audioManager().setMusicVolumeControlHint();
 	if(optionSoundRate > optionSoundRate.defaultVal)
 		optionSoundRate.reset();
 	emuAudio.setRate(optionSoundRate);
 	emuAudio.setAddSoundBuffersOnUnderrun(optionAddSoundBuffersOnUnderrun);
+	emuAudio.setResamplerQuality(AudioResamplerQuality(optionAudioResamplerQuality.val));
+	emuAudio.setDynamicRateControl(optionAudioDynamicRateControl);
+	if(launch.benchmarkFrames)
+	{
+		runBenchmarkFromCommandLine(launch.path, launch.benchmarkFrames);
+		return;
+	}
 	if(!renderer.supportsColorSpace())
 		windowDrawableConf.colorSpace = {};
 	applyOSNavStyle(ctx, false);
@@ -583,6 +699,8 @@ void EmuApp::mainInitCommon(IG::ApplicationInitParams initParams, IG::Applicatio
 			emuVideo.setRendererTask(renderer.task());
 			emuVideo.setTextureBufferMode(system(), (Gfx::TextureBufferMode)optionTextureBufferMode.val);
 			emuVideo.setImageBuffers(optionVideoImageBuffers);
+			emuVideo.setPostFilter(VideoPostFilter(optionVideoPostFilter.val));
+			emuVideo.setUsePaletteFormat(system(), optionGpuPalette);
 			emuVideoLayer.setLinearFilter(optionImgFilter); // init the texture sampler before setting format
 			applyRenderPixelFormat();
 			emuVideoLayer.setOverlay((ImageOverlayId)optionOverlayEffect.val);
@@ -610,14 +728,17 @@ void EmuApp::mainInitCommon(IG::ApplicationInitParams initParams, IG::Applicatio
 					auto frameInfo = sys.advanceFramesWithTime(params.timestamp());
 					if(!frameInfo.advanced)
 					{
+						frameTimingStats_.addFrame(params.timestamp(), frameInfo.presentTime, 0, 0);
 						return true;
 					}
+					auto elapsedFrames = frameInfo.advanced;
 					if(!shouldSkipLateFrames() && !altSpeed)
 					{
 						frameInfo.advanced = frameInterval();
 					}
 					constexpr int maxFrameSkip = 8;
 					auto framesToEmulate = std::min(frameInfo.advanced, maxFrameSkip);
+					frameTimingStats_.addFrame(params.timestamp(), frameInfo.presentTime, elapsedFrames, framesToEmulate);
 					EmuAudio *audioPtr = audio ? &audio : nullptr;
 					/*logMsg("frame present time:%.4f next display frame:%.4f",
 						std::chrono::duration_cast<IG::FloatSeconds>(frameInfo.presentTime).count(),
@@ -888,11 +1009,95 @@ void EmuApp::handleOpenFileCommand(IG::CStringView path)
 void EmuApp::runBenchmarkOneShot(EmuVideo &emuVideo)
 {
 	logMsg("starting benchmark");
-	IG::FloatSeconds time = system().benchmark(emuVideo);
+	auto stats = system().benchmark(&emuVideo, nullptr, 180);
 	autosaveManager_.resetSlot(noAutosaveName);
 	closeSystem();
-	logMsg("done in: %f", time.count());
-	postMessage(2, 0, fmt::format("{:.2f} fps", double(180.)/time.count()));
+	logMsg("done in: %f", IG::FloatSeconds(stats.total).count());
+	postMessage(2, 0, fmt::format("{:.2f} fps", stats.framesPerSecond()));
+}
+
+static std::string jsonEscaped(std::string_view str)
+{
+	std::string escaped;
+	escaped.reserve(str.size());
+	for(char c : str)
+	{
+		switch(c)
+		{
+			case '"': escaped += "\\\""; break;
+			case '\\': escaped += "\\\\"; break;
+			default:
+				if((unsigned char)c < 0x20)
+					escaped += fmt::format("\\u{:04x}", int(c));
+				else
+					escaped += c;
+		}
+	}
+	return escaped;
+}
+
+// Runs the loaded content with each combination of video and audio output enabled,
+// restoring the initial state before each run if possible so they emulate the same frames
+std::string EmuApp::runBenchmarkSuite(int frames)
+{
+	auto &sys = system();
+	std::unique_ptr<uint8_t[]> initialState;
+	size_t initialStateSize{};
+	if(sys.hasMemoryStates())
+	{
+		auto buffSize = sys.stateSize();
+		initialState = std::make_unique_for_overwrite<uint8_t[]>(buffSize);
+		initialStateSize = sys.writeState({initialState.get(), buffSize}, SaveStateFlags::uncompressed);
+	}
+	configFrameTime();
+	std::string runsJson;
+	for(auto [useVideo, useAudio] : {std::pair{false, false}, {true, false}, {false, true}, {true, true}})
+	{
+		if(initialStateSize)
+			sys.readState(*this, {initialState.get(), initialStateSize});
+		if(useAudio)
+			emuAudio.startWithoutOutput(IG::Milliseconds{100});
+		auto stats = sys.benchmark(useVideo ? &emuVideo : nullptr, useAudio ? &emuAudio : nullptr, frames);
+		if(useAudio)
+			emuAudio.stop();
+		auto toMs = [](IG::Time t){ return IG::FloatSeconds(t).count() * 1000.; };
+		logMsg("video:%d audio:%d frame times min:%.3fms avg:%.3fms p99:%.3fms max:%.3fms",
+			useVideo, useAudio, toMs(stats.min), toMs(stats.avg), toMs(stats.p99), toMs(stats.max));
+		if(runsJson.size())
+			runsJson += ",";
+		runsJson += fmt::format("{{\"video\":{},\"audio\":{},\"minMs\":{:.4f},\"avgMs\":{:.4f},\"p99Ms\":{:.4f},"
+			"\"maxMs\":{:.4f},\"fps\":{:.2f},\"allocsPerFrame\":{}}}",
+			useVideo, useAudio, toMs(stats.min), toMs(stats.avg), toMs(stats.p99), toMs(stats.max),
+			stats.framesPerSecond(), stats.allocations < 0 ? std::string{"null"} : fmt::format("{:.2f}", stats.allocationsPerFrame()));
+	}
+	return fmt::format("{{\"system\":\"{}\",\"content\":\"{}\",\"frames\":{},\"runs\":[{}]}}",
+		jsonEscaped(sys.shortSystemName()), jsonEscaped(sys.contentDisplayName()), frames, runsJson);
+}
+
+// Runs headless before any window or renderer is created: EmuVideo renders frames to system
+// memory, the content is loaded on the main thread, the results are printed as JSON to stdout,
+// and the app exits
+void EmuApp::runBenchmarkFromCommandLine(IG::CStringView path, int frames)
+{
+	auto ctx = appContext();
+	int exitCode = 0;
+	emuVideo.setRenderPixelFormat(system(), videoRenderPixelFormat(), Gfx::ColorSpace::LINEAR);
+	try
+	{
+		system().createWithMedia({}, path, ctx.fileUriDisplayName(path), {},
+			[](int, int, const char *){ return true; });
+		fmt::print("{}\n", runBenchmarkSuite(frames));
+	}
+	catch(std::exception &err)
+	{
+		logErr("benchmark failed:%s", err.what());
+		fmt::print("{{\"error\":\"{}\"}}\n", jsonEscaped(err.what()));
+		exitCode = 1;
+	}
+	std::fflush(stdout);
+	autosaveManager_.resetSlot(noAutosaveName);
+	system().closeRuntimeSystem(*this);
+	ctx.exit(exitCode);
 }
 
 void EmuApp::showEmulation()
@@ -997,7 +1202,10 @@ void EmuApp::reloadSystem(EmuSystemCreateParams params)
 			[](int pos, int max, const char *label){ return true; });
 		onSystemCreated();
 		if(autosaveManager_.slotName() != noAutosaveName)
+		{
+			stateWriteTask.wait();
 			system().loadBackupMemory(*this);
+		}
 		showEmulation();
 	}
 	catch(...)
@@ -1009,6 +1217,8 @@ void EmuApp::reloadSystem(EmuSystemCreateParams params)
 
 void EmuApp::onSystemCreated()
 {
+	rewindManager_.reset();
+	runAheadManager_.reset();
 	updateContentRotation();
 	viewController().onSystemCreated();
 }
@@ -1116,7 +1326,15 @@ bool EmuApp::saveState(IG::CStringView path)
 	logMsg("saving state %s", path.data());
 	try
 	{
-		system().saveState(path);
+		if(system().hasMemoryStates())
+		{
+			stateWriteTask.saveState(system(), path);
+		}
+		else
+		{
+			system().saveState(path);
+			dispatchStateWritten();
+		}
 		return true;
 	}
 	catch(std::exception &err)
@@ -1131,6 +1349,15 @@ bool EmuApp::saveStateWithSlot(int slot)
 	return saveState(system().statePath(slot));
 }
 
+void EmuApp::setOnStateWritten(DelegateFunc<void ()> del)
+{
+	if(del)
+	{
+		assert(!onStateWritten_);
+	}
+	onStateWritten_ = del;
+}
+
 bool EmuApp::loadState(IG::CStringView path)
 {
 	if(!system().hasContent()) [[unlikely]]
@@ -1140,6 +1367,7 @@ bool EmuApp::loadState(IG::CStringView path)
 	}
 	logMsg("loading state %s", path.data());
 	syncEmulationThread();
+	stateWriteTask.wait();
 	try
 	{
 		system().loadState(*this, path);
@@ -1320,6 +1548,24 @@ bool EmuApp::handleKeyInput(InputAction action, const Input::Event &srcEvent)
 			viewController().inputView().toggleAltSpeedMode(AltSpeedMode::slow);
 			break;
 		}
+		case guiKeyIdxRewind:
+		{
+			if(isPushed)
+			{
+				if(!system().hasMemoryStates())
+				{
+					postMessage("This system doesn't support rewinding");
+					break;
+				}
+				if(!rewindManager_.isEnabled())
+				{
+					postMessage("Set rewind memory in Options➔System");
+					break;
+				}
+			}
+			rewindManager_.setRewinding(isPushed);
+			break;
+		}
 		default:
 		{
 			handleSystemKeyInput(action);
@@ -1366,6 +1612,7 @@ void EmuApp::runTurboInputEvents()
 void EmuApp::resetInput()
 {
 	turboModifierActive = false;
+	rewindManager_.setRewinding(false);
 	removeTurboInputEvents();
 	setRunSpeed(1.);
 }
@@ -1511,13 +1758,28 @@ VController &EmuApp::defaultVController()
 
 FrameTimeConfig EmuApp::configFrameTime()
 {
-	auto frameTimeConfig = outputTimingManager.frameTimeConfig(system(), emuScreen());
+	// without a renderer (headless benchmark) there's no screen, so use the system's own frame rate
+	auto frameTimeConfig = emuVideo.hasRendererTask() ? outputTimingManager.frameTimeConfig(system(), emuScreen()) :
+		FrameTimeConfig{system().frameTime(), FrameRate(system().frameRate()), 1};
 	system().configFrameTime(emuAudio.format().rate, frameTimeConfig.time);
+	frameTimingStats_.setTargetFrameTime(frameTimeConfig.time);
 	return frameTimeConfig;
 }
 
 void EmuApp::runFrames(EmuSystemTaskContext taskCtx, EmuVideo *video, EmuAudio *audio, int frames, bool skipForward)
 {
+	auto statsIdx = frameTimingStats_.newestIndex();
+	auto startTime = IG::steadyClockTimestamp();
+	auto recordTime = IG::scopeGuard([&]{ frameTimingStats_.addEmulateTime(statsIdx, IG::steadyClockTimestamp() - startTime); });
+	if(rewindManager_.isRewinding()) [[unlikely]]
+	{
+		// step back one stored state per update and run a silent frame from it to refresh the video
+		if(rewindManager_.rewindState(*this))
+		{
+			system().runFrame(taskCtx, video, nullptr);
+			return;
+		}
+	}
 	if(skipForward) [[unlikely]]
 	{
 		if(skipForwardFrames(taskCtx, frames - 1))
@@ -1536,8 +1798,10 @@ void EmuApp::runFrames(EmuSystemTaskContext taskCtx, EmuVideo *video, EmuAudio *
 		skipFrames(taskCtx, frames - 1, audio);
 	}
 	runTurboInputEvents();
-	system().runFrame(taskCtx, video, audio);
+	if(!video || !runAheadManager_.runFrame(*this, taskCtx, *video, audio))
+		system().runFrame(taskCtx, video, audio);
 	system().updateBackupMemoryCounter();
+	rewindManager_.saveState(system(), frames);
 }
 
 void EmuApp::skipFrames(EmuSystemTaskContext taskCtx, int frames, EmuAudio *audio)
@@ -1727,6 +1991,89 @@ void EmuApp::setAddSoundBuffersOnUnderrun(bool on)
 	audio().setAddSoundBuffersOnUnderrun(on);
 }
 
+void EmuApp::setAudioResamplerQuality(AudioResamplerQuality q)
+{
+	optionAudioResamplerQuality = std::to_underlying(q);
+	audio().setResamplerQuality(q);
+}
+
+void EmuApp::setAudioDynamicRateControl(bool on)
+{
+	optionAudioDynamicRateControl = on;
+	audio().setDynamicRateControl(on);
+}
+
+// Shows the audio stats from the last second over the emulation view
+void EmuApp::setShowAudioStats(bool on)
+{
+	if(!on)
+	{
+		audioStatsTimer.cancel();
+		viewController().clearEmuAudioStats();
+		return;
+	}
+	lastAudioStats = audio().stats().snapshot();
+	audioStatsTimer.run(IG::Seconds{1}, IG::Seconds{1}, false, {},
+		[this]()
+		{
+			auto stats = audio().stats().snapshot();
+			viewController().updateEmuAudioStats((stats - lastAudioStats).summary());
+			lastAudioStats = stats;
+		});
+}
+
+bool EmuApp::dumpAudioStats()
+{
+	auto path = FS::pathString(appContext().storagePath(), "audioStats.txt");
+	if(!audio().stats().dumpToFile(appContext(), path))
+	{
+		postErrorMessage(fmt::format("Error writing {}", path));
+		return false;
+	}
+	postMessage(fmt::format("Wrote {}", path));
+	return true;
+}
+
+void EmuApp::setVideoPostFilter(VideoPostFilter filter)
+{
+	optionVideoPostFilter = std::to_underlying(filter);
+	syncEmulationThread(); // the post-processor is used by the emulation thread
+	emuVideo.setPostFilter(filter);
+	viewController().postDrawToEmuWindows();
+}
+
+void EmuApp::setUseGpuPalette(bool on)
+{
+	if(optionGpuPalette.isConst)
+		return;
+	optionGpuPalette = on;
+	syncEmulationThread(); // the video image & system palette are used by the emulation thread
+	emuVideo.setUsePaletteFormat(system(), on);
+	viewController().postDrawToEmuWindows();
+}
+
+void EmuApp::setShowFrameTimingGraph(bool on)
+{
+	viewController().setShowFrameTimingGraph(on ? &frameTimingStats_ : nullptr);
+}
+
+bool EmuApp::showFrameTimingGraph() const
+{
+	return viewController().showsFrameTimingGraph();
+}
+
+bool EmuApp::dumpFrameTimingStats()
+{
+	auto path = FS::pathString(appContext().storagePath(), "frameTiming.csv");
+	if(!frameTimingStats_.dumpToFile(appContext(), path))
+	{
+		postErrorMessage(fmt::format("Error writing {}", path));
+		return false;
+	}
+	postMessage(fmt::format("Wrote {}", path));
+	return true;
+}
+
 bool EmuApp::soundDuringFastSlowModeIsEnabled() const
 {
 	return optionSound & OPTION_SOUND_DURING_FAST_SLOW_MODE_ENABLED_FLAG;
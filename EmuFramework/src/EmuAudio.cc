@@ -23,50 +23,8 @@
 namespace EmuEx
 {
 
-struct AudioStats
-{
-	constexpr AudioStats() = default;
-	int underruns{};
-	int overruns{};
-	std::atomic_uint callbacks{};
-	std::atomic_uint callbackBytes{};
-
-	void reset()
-	{
-		underruns = overruns = 0;
-		callbacks = 0;
-		callbackBytes = 0;
-	}
-};
-
-#ifdef CONFIG_EMUFRAMEWORK_AUDIO_STATS
-static AudioStats audioStats{};
-static IG::Timer audioStatsTimer{"audioStatsTimer"};
-#endif
-
-static void startAudioStats(IG::Audio::Format format)
-{
-	#ifdef CONFIG_EMUFRAMEWORK_AUDIO_STATS
-	audioStats.reset();
-	audioStatsTimer.run(IG::Seconds(1), IG::Seconds(1), {},
-		[format]()
-		{
-			auto frames = format.bytesToFrames(audioStats.callbackBytes);
-			emuViewController.updateEmuAudioStats(audioStats.underruns, audioStats.overruns,
-				audioStats.callbacks, frames / (double)audioStats.callbacks, frames);
-			audioStats.callbacks = 0;
-			audioStats.callbackBytes = 0;
-		});
-	#endif
-}
-
-static void stopAudioStats()
-{
-	#ifdef CONFIG_EMUFRAMEWORK_AUDIO_STATS
-	audioStatsTimer.deinit();
-	clearEmuAudioStats();
-	#endif
-}
+// maximum amount dynamic rate control may speed up or slow down playback
+constexpr double maxRateAdjust = .005;
 
 size_t EmuAudio::framesFree() const
 {
@@ -89,44 +47,14 @@ bool EmuAudio::shouldStartAudioWrites(size_t bytesToWrite) const
 	return rBuff.size() + bytesToWrite >= targetBufferFillBytes;
 }
 
-template<typename T>
-static void simpleResample(T * __restrict__ dest, size_t destFrames, const T * __restrict__ src, size_t srcFrames)
+// Returns the factor to scale the output rate by so the buffer fill after writing framesToWrite
+// moves toward the target. This is proportional to the fill error and stays within +/-maxRateAdjust,
+// small enough to be inaudible but able to absorb drift between the emulated and output clocks.
+double EmuAudio::dynamicRateAdjustment(size_t framesToWrite) const
 {
-	if(!destFrames)
-		return;
-	float ratio = (float)srcFrames/(float)destFrames;
-	for(auto i : iotaCount(destFrames))
-	{
-		size_t srcPos = std::floor((float)i * ratio);
-		if(srcPos >= srcFrames) [[unlikely]]
-		{
-			logMsg("resample pos %zu too high", srcPos);
-			srcPos = srcFrames-1;
-		}
-		dest[i] = src[srcPos];
-	}
-}
-
-static void simpleResample(void *dest, size_t destFrames, const void *src, size_t srcFrames, IG::Audio::Format format)
-{
-	if(format.channels == 1)
-	{
-		if(format.sample.isFloat())
-			simpleResample((uint32_t*)dest, destFrames, (uint32_t*)src, srcFrames);
-		else
-			simpleResample((uint16_t*)dest, destFrames, (uint16_t*)src, srcFrames);
-	}
-	else
-	{
-		if(format.channels != 2)
-		{
-			bug_unreachable("channels == %d", format.channels);
-		}
-		if(format.sample.isFloat())
-			simpleResample((uint64_t*)dest, destFrames, (uint64_t*)src, srcFrames);
-		else
-			simpleResample((uint32_t*)dest, destFrames, (uint32_t*)src, srcFrames);
-	}
+	auto expectedFill = rBuff.size() + format().framesToBytes(framesToWrite / speedMultiplier);
+	auto fillError = std::clamp(1. - double(expectedFill) / targetBufferFillBytes, -1., 1.);
+	return 1. + maxRateAdjust * fillError;
 }
 
 void EmuAudio::resizeAudioBuffer(size_t targetBufferFillBytes)
@@ -156,6 +84,7 @@ void EmuAudio::start(IG::Microseconds targetBufferFillUSecs, IG::Microseconds bu
 	}
 	lastUnderrunTime = {};
 	auto inputFormat = format();
+	resampler.setFormat(inputFormat);
 	targetBufferFillBytes = inputFormat.timeToBytes(targetBufferFillUSecs);
 	bufferIncrementBytes = inputFormat.timeToBytes(bufferIncrementUSecs);
 	if(!audioStream.isOpen())
@@ -169,14 +98,19 @@ void EmuAudio::start(IG::Microseconds targetBufferFillUSecs, IG::Microseconds bu
 			[this, outputSampleFormat = outputFormat.sample, inputSampleFormat = inputFormat.sample, channels = outputFormat.channels](void *samples, size_t frames)
 			{
 				IG::Audio::Format outputFormat{{}, outputSampleFormat, channels};
-				#ifdef CONFIG_EMUFRAMEWORK_AUDIO_STATS
-				audioStats.callbacks++;
-				audioStats.callbackBytes += bytes;
-				#endif
+				auto now = IG::steadyClockTimestamp();
+				if(lastCallbackTime.count())
+					stats_.callbackIntervalUSecs.record(std::chrono::duration_cast<IG::Microseconds>(now - lastCallbackTime).count());
+				lastCallbackTime = now;
+				stats_.callbacks.fetch_add(1, std::memory_order_relaxed);
+				stats_.callbackFrames.fetch_add(frames, std::memory_order_relaxed);
+				stats_.framesPerCallback.record(frames);
 				if(audioWriteState == AudioWriteState::ACTIVE)
 				{
 					IG::Audio::Format inputFormat = {{}, inputSampleFormat, channels};
 					auto framesReady = inputFormat.bytesToFrames(rBuff.size());
+					stats_.bufferFillFrames.record(framesReady);
+					stats_.latencyUSecs.record((framesReady + frames) * 1000000 / rate);
 					auto const framesToRead = std::min(frames, framesReady);
 					auto frameEndAddr = (char*)outputFormat.copyFrames(samples, rBuff.readAddr(), framesToRead, inputFormat, volume);
 					rBuff.commitRead(inputFormat.framesToBytes(framesToRead));
@@ -185,7 +119,6 @@ void EmuAudio::start(IG::Microseconds targetBufferFillUSecs, IG::Microseconds bu
 						auto padFrames = frames - framesToRead;
 						std::fill_n(frameEndAddr, outputFormat.framesToBytes(padFrames), 0);
 						//logMsg("underrun, %d bytes ready out of %d", bytesReady, bytes);
-						auto now = IG::steadyClockTimestamp();
 						if(now - lastUnderrunTime < IG::Seconds(1))
 						{
 							//logWarn("multiple underruns within a short time");
@@ -196,9 +129,7 @@ void EmuAudio::start(IG::Microseconds targetBufferFillUSecs, IG::Microseconds bu
 							audioWriteState = AudioWriteState::UNDERRUN;
 						}
 						lastUnderrunTime = now;
-						#ifdef CONFIG_EMUFRAMEWORK_AUDIO_STATS
-						audioStats.underruns++;
-						#endif
+						stats_.underruns.fetch_add(1, std::memory_order_relaxed);
 					}
 					return true;
 				}
@@ -210,12 +141,12 @@ void EmuAudio::start(IG::Microseconds targetBufferFillUSecs, IG::Microseconds bu
 			}
 		};
 		outputConf.wantedLatencyHint = {};
-		startAudioStats(inputFormat);
+		lastCallbackTime = {};
 		audioStream.open(outputConf);
 	}
 	else
 	{
-		startAudioStats(inputFormat);
+		lastCallbackTime = {};
 		if(shouldStartAudioWrites())
 		{
 			if(Config::DEBUG_BUILD)
@@ -230,9 +161,18 @@ void EmuAudio::start(IG::Microseconds targetBufferFillUSecs, IG::Microseconds bu
 	}
 }
 
+// Only allocates the sample buffer so systems can write audio frames that are discarded with
+// clearBuffer(), used when benchmarking without an audio device
+void EmuAudio::startWithoutOutput(IG::Microseconds bufferUSecs)
+{
+	stop();
+	resampler.setFormat(format());
+	targetBufferFillBytes = format().timeToBytes(bufferUSecs);
+	resizeAudioBuffer(targetBufferFillBytes);
+}
+
 void EmuAudio::stop()
 {
-	stopAudioStats();
 	audioWriteState = AudioWriteState::BUFFER;
 	if(audioStream)
 		audioStream.close();
@@ -250,7 +190,6 @@ void EmuAudio::flush()
 {
 	if(!audioStream) [[unlikely]]
 		return;
-	stopAudioStats();
 	audioWriteState = AudioWriteState::BUFFER;
 	if(audioStream)
 		audioStream.flush();
@@ -280,33 +219,42 @@ void EmuAudio::writeFrames(const void *samples, size_t framesToWrite)
 		default:
 		break;
 	}
-	const size_t sampleFrames = framesToWrite;
-	if(speedMultiplier != 1.) [[unlikely]]
+	auto freeBytes = rBuff.freeSpace();
+	size_t bytes;
+	double ratio = speedMultiplier;
+	if(dynamicRateControl && audioWriteState == AudioWriteState::ACTIVE)
 	{
-		framesToWrite = std::ceil((double)framesToWrite / speedMultiplier);
-		framesToWrite = std::max(framesToWrite, 1zu);
+		auto rateAdjust = dynamicRateAdjustment(framesToWrite);
+		ratio /= rateAdjust;
+		if(rateAdjust != 1.)
+		{
+			stats_.rateAdjusts.fetch_add(1, std::memory_order_relaxed);
+			stats_.rateAdjustPpm.record(std::abs(rateAdjust - 1.) * 1e6);
+		}
 	}
-	auto bytes = inputFormat.framesToBytes(framesToWrite);
-	auto freeBytes = rBuff.freeSpace();
-	if(bytes <= freeBytes)
+	if(ratio != 1. || dynamicRateControl)
 	{
-		if(sampleFrames != framesToWrite)
+		auto freeFrames = inputFormat.bytesToFrames(freeBytes);
+		bytes = inputFormat.framesToBytes(resampler.maxOutputFrames(framesToWrite, ratio));
+		if(bytes > freeBytes)
 		{
-			simpleResample(rBuff.writeAddr(), framesToWrite, samples, sampleFrames, inputFormat);
-			rBuff.commitWrite(bytes);
+			logMsg("overrun, only %zu out of %zu bytes free", freeBytes, bytes);
+			stats_.overruns.fetch_add(1, std::memory_order_relaxed);
 		}
-		else
-			rBuff.writeUnchecked(samples, bytes);
+		// output that doesn't fit is dropped by the resampler
+		bytes = inputFormat.framesToBytes(resampler.resample(rBuff.writeAddr(), freeFrames, samples, framesToWrite, ratio));
+		rBuff.commitWrite(bytes);
 	}
 	else
 	{
-		logMsg("overrun, only %zu out of %zu bytes free", freeBytes, bytes);
-		#ifdef CONFIG_EMUFRAMEWORK_AUDIO_STATS
-		audioStats.overruns++;
-		#endif
-		auto freeFrames = inputFormat.bytesToFrames(freeBytes);
-		simpleResample(rBuff.writeAddr(), freeFrames, samples, sampleFrames, inputFormat);
-		rBuff.commitWrite(freeBytes);
+		bytes = inputFormat.framesToBytes(framesToWrite);
+		if(bytes > freeBytes)
+		{
+			logMsg("overrun, only %zu out of %zu bytes free", freeBytes, bytes);
+			stats_.overruns.fetch_add(1, std::memory_order_relaxed);
+			bytes = inputFormat.framesToBytes(inputFormat.bytesToFrames(freeBytes));
+		}
+		rBuff.writeUnchecked(samples, bytes);
 	}
 	if(audioWriteState == AudioWriteState::BUFFER && shouldStartAudioWrites(bytes))
 	{
@@ -345,6 +293,11 @@ void EmuAudio::setStereo(bool on)
 void EmuAudio::setSpeedMultiplier(double speed)
 {
 	assumeExpr(speed > 0.);
+	if(speedMultiplier == 1. && speed != 1. && !dynamicRateControl)
+	{
+		// don't resume with history from the last time the speed changed
+		resampler.reset();
+	}
 	speedMultiplier = speed;
 	if(speedMultiplier > 1.)
 	{
@@ -361,6 +314,19 @@ void EmuAudio::setAddSoundBuffersOnUnderrun(bool on)
 	addSoundBuffersOnUnderrun = on;
 }
 
+void EmuAudio::setResamplerQuality(AudioResamplerQuality q)
+{
+	resampler.setQuality(q);
+}
+
+void EmuAudio::setDynamicRateControl(bool on)
+{
+	if(dynamicRateControl == on)
+		return;
+	dynamicRateControl = on;
+	resampler.reset();
+}
+
 void EmuAudio::setVolume(int8_t vol)
 {
 	if(vol == 100)
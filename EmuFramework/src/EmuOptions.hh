@@ -72,6 +72,10 @@ enum { CFGKEY_SOUND = 0, CFGKEY_TOUCH_CONTROL_DISPLAY = 1,
 	CFGKEY_VIDEO_LANDSCAPE_OFFSET = 102, CFGKEY_VIDEO_PORTRAIT_OFFSET = 103,
 	CFGKEY_AUTOSAVE_CONTENT = 104, CFGKEY_SLOW_MODE_SPEED = 105,
 	CFGKEY_VIDEO_LANDSCAPE_ASPECT_RATIO = 106, CFGKEY_VIDEO_PORTRAIT_ASPECT_RATIO = 107,
+	CFGKEY_REWIND_MAX_MEMORY = 108, CFGKEY_REWIND_FRAME_INTERVAL = 109,
+	CFGKEY_AUDIO_RESAMPLER_QUALITY = 110, CFGKEY_AUDIO_DYNAMIC_RATE_CONTROL = 111,
+	CFGKEY_RUN_AHEAD_FRAMES = 112, CFGKEY_VIDEO_POST_FILTER = 113,
+	CFGKEY_VIDEO_GPU_PALETTE = 114, CFGKEY_ARCHIVE_CONTENT_CACHE_SIZE = 115,
 	// 256+ is reserved
 };
 
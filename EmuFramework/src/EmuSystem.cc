@@ -22,6 +22,7 @@
 #include <imagine/base/ApplicationContext.hh>
 #include <imagine/fs/ArchiveFS.hh>
 #include <imagine/fs/FSUtils.hh>
+#include <imagine/io/FileIO.hh>
 #include <imagine/io/IO.hh>
 #include <imagine/input/DragTracker.hh>
 #include <imagine/util/utility.h>
@@ -29,16 +30,44 @@
 #include <imagine/util/ScopeGuard.hh>
 #include <imagine/util/string.h>
 #include <algorithm>
+#include <numeric>
 #include <cstring>
+#include <cstdlib>
+#include <atomic>
 #include "pathUtils.hh"
 
+#ifdef CONFIG_EMUFRAMEWORK_ALLOC_STATS
+static std::atomic_int64_t allocations;
+
+void *operator new(size_t size)
+{
+	allocations.fetch_add(1, std::memory_order_relaxed);
+	if(auto ptr = std::malloc(size ? size : 1); ptr) [[likely]]
+		return ptr;
+	throw std::bad_alloc{};
+}
+
+void operator delete(void *ptr) noexcept { std::free(ptr); }
+void operator delete(void *ptr, size_t) noexcept { std::free(ptr); }
+#endif
+
 namespace EmuEx
 {
 
+static int64_t allocationCount()
+{
+	#ifdef CONFIG_EMUFRAMEWORK_ALLOC_STATS
+	return allocations.load(std::memory_order_relaxed);
+	#else
+	return -1;
+	#endif
+}
+
 [[gnu::weak]] bool EmuSystem::inputHasKeyboard = false;
 [[gnu::weak]] bool EmuSystem::hasBundledGames = false;
 [[gnu::weak]] bool EmuSystem::hasPALVideoSystem = false;
 [[gnu::weak]] bool EmuSystem::canRenderRGBA8888 = true;
+[[gnu::weak]] bool EmuSystem::canRenderPaletteIndexed = false;
 [[gnu::weak]] bool EmuSystem::hasResetModes = false;
 [[gnu::weak]] bool EmuSystem::handlesArchiveFiles = false;
 [[gnu::weak]] bool EmuSystem::handlesGenericIO = true;
@@ -48,6 +77,7 @@ namespace EmuEx
 [[gnu::weak]] IG::Audio::SampleFormat EmuSystem::audioSampleFormat = IG::Audio::SampleFormats::i16;
 [[gnu::weak]] FP EmuSystem::validFrameRateRange{minFrameRate, 80.};
 [[gnu::weak]] bool EmuSystem::hasRectangularPixels = false;
+[[gnu::weak]] bool EmuSystem::hasRunAhead = false;
 
 bool EmuSystem::stateExists(int slot) const
 {
@@ -281,15 +311,30 @@ void EmuSystem::start(EmuApp &app)
 	app.autosaveManager().startTimer();
 }
 
-IG::Time EmuSystem::benchmark(EmuVideo &video)
+BenchmarkStats EmuSystem::benchmark(EmuVideo *video, EmuAudio *audio, int frames)
 {
-	auto now = IG::steadyClockTimestamp();
-	for(auto i : iotaCount(180))
+	assumeExpr(frames > 0);
+	auto frameTimes = std::make_unique_for_overwrite<IG::Time[]>(frames);
+	auto allocationsAtStart = allocationCount();
+	for(auto i : iotaCount(frames))
 	{
-		runFrame({}, &video, nullptr);
+		auto frameStart = IG::steadyClockTimestamp();
+		runFrame({}, video, audio);
+		frameTimes[i] = IG::steadyClockTimestamp() - frameStart;
+		if(audio)
+			audio->clearBuffer();
 	}
-	auto after = IG::steadyClockTimestamp();
-	return after-now;
+	BenchmarkStats stats{.frames = frames};
+	if(allocationsAtStart != -1)
+		stats.allocations = allocationCount() - allocationsAtStart;
+	std::span<IG::Time> times{frameTimes.get(), size_t(frames)};
+	stats.total = std::accumulate(times.begin(), times.end(), IG::Time{});
+	stats.avg = stats.total / frames;
+	std::ranges::sort(times);
+	stats.min = times.front();
+	stats.max = times.back();
+	stats.p99 = times[std::min(size_t(frames * 0.99), times.size() - 1)];
+	return stats;
 }
 
 void EmuSystem::configFrameTime(int outputRate, FloatSeconds outputFrameTime)
@@ -371,19 +416,34 @@ void EmuSystem::loadContentFromFile(IO file, IG::CStringView path, std::string_v
 	{
 		IO io{};
 		FS::FileString originalName{};
-		for(auto &entry : FS::ArchiveIterator{std::move(file)})
+		auto &contentCache = EmuApp::get(appContext()).archiveContentCache();
+		ArchiveContentCache::Key cacheKey{path, file.size(), appContext().fileUriLastWriteTime(path)};
+		if(auto cached = contentCache.find(cacheKey);
+			cached)
 		{
-			if(entry.type() == FS::file_type::directory)
-			{
-				continue;
-			}
-			auto name = entry.name();
-			logMsg("archive file entry:%s", name.data());
-			if(EmuSystem::defaultFsFilter(name))
+			originalName = cached->name;
+			io = std::move(cached->io);
+		}
+		else
+		{
+			for(auto &entry : FS::ArchiveIterator{std::move(file)})
 			{
-				originalName = name;
-				io = entry.releaseIO();
-				break;
+				if(entry.type() == FS::file_type::directory)
+				{
+					continue;
+				}
+				auto name = entry.name();
+				logMsg("archive file entry:%s", name.data());
+				if(EmuSystem::defaultFsFilter(name))
+				{
+					originalName = name;
+					// entries of non-solid archives like zip are read directly, so caching them gains little
+					if(entry.hasSolidFormat())
+						io = contentCache.insert(cacheKey, name, entry.crc32(), entry.releaseIO());
+					else
+						io = entry.releaseIO();
+					break;
+				}
 			}
 		}
 		if(!io)
@@ -401,6 +461,11 @@ void EmuSystem::loadContentFromFile(IO file, IG::CStringView path, std::string_v
 	}
 }
 
+ContentDigest EmuSystem::identifyContent(IO &io, ContentDigestMask types, size_t offset)
+{
+	return EmuApp::get(appContext()).contentIdentifier().identify(contentLocation(), io, types, offset);
+}
+
 void EmuSystem::throwFileReadError()
 {
 	throw std::runtime_error("Error reading file");
@@ -451,6 +516,23 @@ FS::FileString EmuSystem::contentDisplayNameForPathDefaultImpl(IG::CStringView p
 	return FS::FileString{IG::withoutDotExtension(appContext().fileUriDisplayName(path))};
 }
 
+void EmuSystem::loadStateDefaultImpl(EmuApp &app, CStringView uri)
+{
+	auto buff = FileUtils::bufferFromUri(appContext(), uri);
+	if(!buff)
+		throwFileReadError();
+	readState(app, {buff.data(), buff.size()});
+}
+
+void EmuSystem::saveStateDefaultImpl(CStringView path)
+{
+	auto buffSize = stateSize();
+	auto buff = std::make_unique_for_overwrite<uint8_t[]>(buffSize);
+	auto size = writeState({buff.get(), buffSize});
+	if(FileUtils::writeToUri(appContext(), path, {buff.get(), size}) == -1)
+		throwFileWriteError();
+}
+
 void EmuSystem::setInitialLoadPath(IG::CStringView path)
 {
 	assert(contentName_.empty());
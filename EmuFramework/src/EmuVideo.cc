@@ -20,6 +20,7 @@
 #include <imagine/gfx/RendererTask.hh>
 #include <imagine/gfx/RendererCommands.hh>
 #include <imagine/logger/logger.h>
+#include <cstring>
 
 namespace EmuEx
 {
@@ -38,8 +39,9 @@ void EmuVideo::resetImage(IG::PixelFormat newFmt)
 
 IG::PixmapDesc EmuVideo::deleteImage()
 {
-	auto desc = vidImg.pixmapDesc();
+	auto desc = sourceDesc();
 	vidImg = {};
+	headlessImg = {};
 	return desc;
 }
 
@@ -66,15 +68,35 @@ bool EmuVideo::setFormat(IG::PixmapDesc desc, EmuSystemTaskContext taskCtx)
 	{
 		return false; // no change to size/format
 	}
+	if(!rTask)
+	{
+		// headless, frames are only rendered to system memory
+		headlessImg = {desc};
+		logMsg("resized headless image to:%dx%d", desc.w(), desc.h());
+		return true;
+	}
+	auto texDesc = desc;
+	if(usesPostProcessor())
+	{
+		postProcessor->setFormat(desc);
+		texDesc = postProcessor->outputFormat();
+	}
+	bool isPaletteFmt = texDesc.format == IG::PIXEL_I8;
+	if(vidImg && (vidImg.pixmapDesc().format == IG::PIXEL_I8) != isPaletteFmt)
+	{
+		vidImg = {}; // switching between buffer modes
+	}
 	if(!vidImg)
 	{
-		Gfx::TextureConfig conf{desc, samplerConfig()};
-		conf.colorSpace = colSpace;
-		vidImg = renderer().makePixmapBufferTexture(conf, bufferMode, singleBuffer);
+		Gfx::TextureConfig conf{texDesc, samplerConfig()};
+		conf.colorSpace = isPaletteFmt ? Gfx::ColorSpace::LINEAR : colSpace;
+		// Android's hardware buffers have no 8-bit format
+		auto mode = isPaletteFmt && bufferMode != Gfx::TextureBufferMode::PBO ? Gfx::TextureBufferMode::SYSTEM_MEMORY : bufferMode;
+		vidImg = renderer().makePixmapBufferTexture(conf, mode, singleBuffer);
 	}
 	else
 	{
-		vidImg.setFormat(desc, colSpace, samplerConfig());
+		vidImg.setFormat(texDesc, colSpace, samplerConfig());
 	}
 	logMsg("resized to:%dx%d", desc.w(), desc.h());
 	if(taskCtx)
@@ -100,6 +122,15 @@ void EmuVideo::syncImageAccess()
 
 EmuVideoImage EmuVideo::startFrame(EmuSystemTaskContext taskCtx)
 {
+	if(!rTask)
+	{
+		return {taskCtx, *this, Gfx::LockedTextureBuffer{nullptr, headlessImg.view(), {}, 0, false}};
+	}
+	if(usesPostProcessor())
+	{
+		// render directly into the post-processor's input buffer
+		return {taskCtx, *this, Gfx::LockedTextureBuffer{nullptr, postProcessor->inputPixmap(), {}, 0, false}};
+	}
 	auto lockedTex = vidImg.lock();
 	syncImageAccess();
 	return {taskCtx, *this, lockedTex};
@@ -162,6 +193,16 @@ void EmuVideo::postFrameFinished(EmuSystemTaskContext taskCtx)
 
 void EmuVideo::finishFrame(EmuSystemTaskContext taskCtx, Gfx::LockedTextureBuffer texBuff)
 {
+	if(!rTask)
+	{
+		postFrameFinished(taskCtx);
+		return;
+	}
+	if(usesPostProcessor())
+	{
+		finishPostProcessedFrame(taskCtx, texBuff.pixmap());
+		return;
+	}
 	if(screenshotNextFrame) [[unlikely]]
 	{
 		doScreenshot(taskCtx, texBuff.pixmap());
@@ -172,6 +213,18 @@ void EmuVideo::finishFrame(EmuSystemTaskContext taskCtx, Gfx::LockedTextureBuffe
 
 void EmuVideo::finishFrame(EmuSystemTaskContext taskCtx, IG::PixmapView pix)
 {
+	if(!rTask)
+	{
+		// copy the frame like a texture upload would
+		headlessImg.view().write(pix);
+		postFrameFinished(taskCtx);
+		return;
+	}
+	if(usesPostProcessor())
+	{
+		finishPostProcessedFrame(taskCtx, pix);
+		return;
+	}
 	if(screenshotNextFrame) [[unlikely]]
 	{
 		doScreenshot(taskCtx, pix);
@@ -181,6 +234,30 @@ void EmuVideo::finishFrame(EmuSystemTaskContext taskCtx, IG::PixmapView pix)
 	postFrameFinished(taskCtx);
 }
 
+void EmuVideo::finishPostProcessedFrame(EmuSystemTaskContext taskCtx, IG::PixmapView pix)
+{
+	if(screenshotNextFrame) [[unlikely]]
+	{
+		doScreenshot(taskCtx, pix);
+	}
+	if(!taskCtx)
+	{
+		// frames rendered outside the emulation task (like when paused) are shown right away
+		auto output = postProcessor->filterFrame(pix);
+		syncImageAccess();
+		vidImg.write(output, vidImg.WRITE_FLAG_ASYNC);
+		return;
+	}
+	// upload the previous frame, then filter this one while the next frame is emulated
+	if(auto output = postProcessor->finishedFrame(); output)
+	{
+		syncImageAccess();
+		vidImg.write(output, vidImg.WRITE_FLAG_ASYNC);
+	}
+	postProcessor->submitFrame(pix);
+	postFrameFinished(taskCtx);
+}
+
 bool EmuVideo::addFence(Gfx::RendererCommands &cmds)
 {
 	if(!needsFence)
@@ -204,7 +281,22 @@ void EmuVideo::takeGameScreenshot()
 void EmuVideo::doScreenshot(EmuSystemTaskContext taskCtx, IG::PixmapView pix)
 {
 	screenshotNextFrame = false;
-	auto success = app().writeScreenshot(pix, app().makeNextScreenshotFilename());
+	bool success{};
+	if(pix.format() == IG::PIXEL_I8)
+	{
+		auto bpp = renderFmt.bytesPerPixel();
+		auto buff = std::make_unique<uint8_t[]>(pix.w() * pix.h() * bpp);
+		IG::MutablePixmapView rgbPix{{pix.size(), renderFmt}, buff.get()};
+		if(bpp == 2)
+			rgbPix.writePaletteExpanded(std::span<const uint16_t, 256>{(const uint16_t*)paletteData.data(), 256}, pix);
+		else
+			rgbPix.writePaletteExpanded(std::span<const uint32_t, 256>{(const uint32_t*)paletteData.data(), 256}, pix);
+		success = app().writeScreenshot(rgbPix, app().makeNextScreenshotFilename());
+	}
+	else
+	{
+		success = app().writeScreenshot(pix, app().makeNextScreenshotFilename());
+	}
 	if(taskCtx)
 	{
 		taskCtx.task().sendScreenshotReply(success);
@@ -259,15 +351,24 @@ void EmuVideoImage::endFrame()
 
 IG::WP EmuVideo::size() const
 {
-	if(!vidImg)
+	if(!vidImg && !headlessImg)
 		return {1, 1};
 	else
-		return vidImg.pixmapDesc().size;
+		return sourceDesc().size;
 }
 
 bool EmuVideo::formatIsEqual(IG::PixmapDesc desc) const
 {
-	return vidImg && desc == vidImg.pixmapDesc();
+	return (vidImg || headlessImg) && desc == sourceDesc();
+}
+
+IG::PixmapDesc EmuVideo::sourceDesc() const
+{
+	if(!rTask)
+		return headlessImg.desc();
+	if(usesPostProcessor())
+		return postProcessor->format();
+	return vidImg.pixmapDesc();
 }
 
 void EmuVideo::setOnFrameFinished(FrameFinishedDelegate del)
@@ -339,19 +440,24 @@ bool EmuVideo::setRenderPixelFormat(EmuSystem &sys, IG::PixelFormat fmt, Gfx::Co
 		}
 	}
 	assert(fmt);
-	assert(bufferMode != Gfx::TextureBufferMode::DEFAULT);
-	if(fmt == IG::PIXEL_RGBA8888 && renderer().hasBgraFormat(bufferMode))
-		fmt = IG::PIXEL_BGRA8888;
+	if(rTask)
+	{
+		assert(bufferMode != Gfx::TextureBufferMode::DEFAULT);
+		if(fmt == IG::PIXEL_RGBA8888 && renderer().hasBgraFormat(bufferMode))
+			fmt = IG::PIXEL_BGRA8888;
+	}
 	if(renderFmt == fmt)
 		return false;
 	logMsg("setting render pixel format:%s", fmt.name());
 	renderFmt = fmt;
+	paletteImg = {};
 	auto oldPixDesc = deleteImage();
 	if(!sys.onVideoRenderFormatChange(*this, fmt) && oldPixDesc.w())
 	{
 		setFormat({oldPixDesc.size, fmt});
 	}
-	app().renderSystemFramebuffer(*this);
+	if(rTask)
+		app().renderSystemFramebuffer(*this);
 	return true;
 }
 
@@ -366,6 +472,73 @@ IG::PixelFormat EmuVideo::internalRenderPixelFormat() const
 	return renderPixelFormat() == IG::PIXEL_BGRA8888 ? IG::PIXEL_FMT_RGBA8888 : renderPixelFormat();
 }
 
+void EmuVideo::setPostFilter(VideoPostFilter filter)
+{
+	if(filter == postFilter())
+		return;
+	auto desc = deleteImage();
+	if(!postProcessor)
+		postProcessor = std::make_unique<VideoPostProcessor>();
+	postProcessor->setFilter(filter);
+	if(!postProcessor->isEnabled())
+		postProcessor.reset();
+	if(desc.w())
+	{
+		setFormat(desc);
+		app().renderSystemFramebuffer(*this);
+	}
+}
+
+VideoPostFilter EmuVideo::postFilter() const
+{
+	return postProcessor ? postProcessor->filter() : VideoPostFilter::Off;
+}
+
+void EmuVideo::setUsePaletteFormat(EmuSystem &sys, bool on)
+{
+	if(on == usePaletteFmt)
+		return;
+	auto oldPixDesc = deleteImage();
+	usePaletteFmt = on;
+	paletteImg = {};
+	logMsg("set palette format:%s", on ? "on" : "off");
+	if(!renderFmt)
+		return;
+	if(!sys.onVideoRenderFormatChange(*this, renderFmt) && oldPixDesc.w())
+	{
+		setFormat({oldPixDesc.size, renderFmt});
+	}
+	app().renderSystemFramebuffer(*this);
+}
+
+bool EmuVideo::hasPaletteFormat() const
+{
+	return vidImg && vidImg.pixmapDesc().format == IG::PIXEL_I8;
+}
+
+void EmuVideo::setPalette(std::span<const uint16_t, 256> palette)
+{
+	assumeExpr(renderFmt.bytesPerPixel() == 2);
+	writePalette(std::as_bytes(palette));
+}
+
+void EmuVideo::setPalette(std::span<const uint32_t, 256> palette)
+{
+	assumeExpr(renderFmt.bytesPerPixel() == 4);
+	writePalette(std::as_bytes(palette));
+}
+
+void EmuVideo::writePalette(std::span<const std::byte> data)
+{
+	std::memcpy(paletteData.data(), data.data(), data.size());
+	IG::PixmapDesc desc{{256, 1}, renderFmt};
+	if(!paletteImg || paletteImg.pixmapDesc() != desc)
+	{
+		paletteImg = renderer().makeTexture({desc, Gfx::SamplerConfigs::noLinearNoMipClamp});
+	}
+	paletteImg.write(0, paletteView(), {});
+}
+
 Gfx::TextureSamplerConfig EmuVideo::samplerConfigForLinearFilter(bool useLinearFilter)
 {
 	return useLinearFilter ? Gfx::SamplerConfigs::noMipClamp : Gfx::SamplerConfigs::noLinearNoMipClamp;
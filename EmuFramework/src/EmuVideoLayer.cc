@@ -157,6 +157,8 @@ void EmuVideoLayer::draw(Gfx::RendererCommands &cmds)
 		for(auto &ePtr : effects)
 		{
 			auto &e = *ePtr;
+			if(ePtr == &paletteEffect && video.paletteImage())
+				cmds.setTexture(video.paletteImage(), VideoImageEffect::paletteTextureUnit);
 			cmds.setProgram(e.program());
 			cmds.setRenderTarget(e.renderTarget());
 			cmds.clear();
@@ -257,7 +259,9 @@ void EmuVideoLayer::setBrightness(Gfx::Vec3 b)
 void EmuVideoLayer::onVideoFormatChanged(IG::PixelFormat effectFmt)
 {
 	setEffectFormat(effectFmt);
-	if(!updateConvertColorSpaceEffect())
+	bool rebuiltChain = updatePaletteEffect();
+	rebuiltChain |= updateConvertColorSpaceEffect();
+	if(!rebuiltChain)
 	{
 		updateEffectImageSize();
 	}
@@ -298,10 +302,20 @@ void EmuVideoLayer::updateEffectImageSize()
 void EmuVideoLayer::buildEffectChain()
 {
 	effects.clear();
+	if(paletteEffect)
+	{
+		effects.emplace_back(&paletteEffect);
+	}
 	if(userEffect)
 	{
 		effects.emplace_back(&userEffect);
 	}
+	if(effects.size() > 1)
+	{
+		// only the final effect's output is filtered
+		effects.front()->setSampler(Gfx::SamplerConfigs::noLinearNoMipClamp);
+		effects.back()->setSampler(samplerConfig());
+	}
 	updateEffectImageSize();
 	updateSprite();
 	logOutputFormat();
@@ -329,6 +343,32 @@ bool EmuVideoLayer::updateConvertColorSpaceEffect()
 	return false;
 }
 
+bool EmuVideoLayer::updatePaletteEffect()
+{
+	bool needsLookup = video.hasPaletteFormat();
+	if(needsLookup && !paletteEffect)
+	{
+		paletteEffect = VideoImageEffect::makePaletteLookup(renderer(), video.internalRenderPixelFormat(),
+			video.colorSpace(), userEffect ? Gfx::SamplerConfigs::noLinearNoMipClamp : samplerConfig(), video.size());
+		logMsg("made palette lookup effect");
+		buildEffectChain();
+		return true;
+	}
+	else if(!needsLookup && paletteEffect)
+	{
+		paletteEffect = {};
+		logMsg("deleted palette lookup effect");
+		buildEffectChain();
+		return true;
+	}
+	else if(needsLookup)
+	{
+		paletteEffect.setFormat(renderer(), video.internalRenderPixelFormat(), video.colorSpace(),
+			effects.back() == &paletteEffect ? samplerConfig() : Gfx::SamplerConfigs::noLinearNoMipClamp);
+	}
+	return false;
+}
+
 void EmuVideoLayer::updateSprite()
 {
 	if(effects.size())
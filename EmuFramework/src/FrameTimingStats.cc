@@ -0,0 +1,101 @@
+/*  This file is part of EmuFramework.
+
+	Imagine is free software: you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation, either version 3 of the License, or
+	(at your option) any later version.
+
+	Imagine is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License
+	along with EmuFramework.  If not, see <http://www.gnu.org/licenses/> */
+
+#define LOGTAG "FrameTimingStats"
+#include <emuframework/FrameTimingStats.hh>
+#include <imagine/base/ApplicationContext.hh>
+#include <imagine/io/FileIO.hh>
+#include <imagine/util/format.hh>
+#include <imagine/logger/logger.h>
+
+namespace EmuEx
+{
+
+constexpr auto relaxed = std::memory_order_relaxed;
+
+static uint32_t toUSecs(SteadyClockTime t)
+{
+	return std::chrono::duration_cast<Microseconds>(t).count();
+}
+
+void FrameTimingStats::addFrame(FrameTime timestamp, FrameTime presentTime, int elapsedFrames, int emulatedFrames)
+{
+	auto count = writeCount.load(relaxed);
+	auto &s = samples[count % capacity];
+	s.timestampNSecs.store(std::chrono::duration_cast<Nanoseconds>(timestamp).count(), relaxed);
+	s.presentTimeNSecs.store(std::chrono::duration_cast<Nanoseconds>(presentTime).count(), relaxed);
+	s.emulateUSecs.store(0, relaxed);
+	s.submitUSecs.store(0, relaxed);
+	s.elapsedFrames.store(elapsedFrames, relaxed);
+	s.emulatedFrames.store(emulatedFrames, relaxed);
+	writeCount.store(count + 1, std::memory_order_release);
+}
+
+void FrameTimingStats::reset()
+{
+	writeCount.store(0, std::memory_order_release);
+}
+
+void FrameTimingStats::addEmulateTime(size_t idx, SteadyClockTime time)
+{
+	samples[idx].emulateUSecs.fetch_add(toUSecs(time), relaxed);
+}
+
+void FrameTimingStats::setSubmitTime(SteadyClockTime time)
+{
+	if(!writeCount.load(std::memory_order_acquire))
+		return;
+	samples[newestIndex()].submitUSecs.store(toUSecs(time), relaxed);
+}
+
+const FrameTimingStats::Sample &FrameTimingStats::operator[](size_t idx) const
+{
+	auto count = writeCount.load(std::memory_order_acquire);
+	auto first = count > capacity ? count - capacity : 0;
+	return samples[(first + idx) % capacity];
+}
+
+std::string FrameTimingStats::csv() const
+{
+	std::string str = fmt::format("# target frame time: {:.6f}ms\n"
+		"timestamp_ns,interval_us,present_time_ns,elapsed_frames,emulated_frames,emulate_us,submit_us\n",
+		targetFrameTime().count() * 1000.);
+	int64_t lastTimestamp{};
+	for(size_t i = 0; i < size(); i++)
+	{
+		auto &s = (*this)[i];
+		auto timestamp = s.timestampNSecs.load(relaxed);
+		auto interval = lastTimestamp ? (timestamp - lastTimestamp) / 1000 : 0;
+		lastTimestamp = timestamp;
+		str += fmt::format("{},{},{},{},{},{},{}\n", timestamp, interval, s.presentTimeNSecs.load(relaxed),
+			s.elapsedFrames.load(relaxed), s.emulatedFrames.load(relaxed),
+			s.emulateUSecs.load(relaxed), s.submitUSecs.load(relaxed));
+	}
+	return str;
+}
+
+bool FrameTimingStats::dumpToFile(ApplicationContext ctx, CStringView path) const
+{
+	auto str = csv();
+	if(FileUtils::writeToUri(ctx, path, {(const unsigned char*)str.data(), str.size()}) == -1)
+	{
+		logErr("error writing frame timing stats to:%s", path.data());
+		return false;
+	}
+	logMsg("wrote %zu frame timing samples to:%s", size(), path.data());
+	return true;
+}
+
+}
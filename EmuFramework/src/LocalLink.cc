@@ -0,0 +1,385 @@
+/*  This file is part of EmuFramework.
+
+	Imagine is free software: you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation, either version 3 of the License, or
+	(at your option) any later version.
+
+	Imagine is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License
+	along with EmuFramework.  If not, see <http://www.gnu.org/licenses/> */
+
+#define LOGTAG "LocalLink"
+#include <emuframework/LocalLink.hh>
+#include <imagine/time/Time.hh>
+#include <imagine/logger/logger.h>
+#include <imagine/util/format.hh>
+#include <atomic>
+#include <cerrno>
+#include <climits>
+#include <cstring>
+#include <stdexcept>
+#include <thread>
+#if defined __linux__ && !defined __ANDROID__
+#define HAS_SHARED_MEMORY_LINK
+#include <imagine/util/memory/UniqueFileDescriptor.hh>
+#include <linux/futex.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/syscall.h>
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+namespace EmuEx
+{
+
+constexpr uint32_t sharedBlockMagic = 0x4B4E4C45; // "ELNK"
+constexpr uint32_t replyFlag = 0x80000000;
+constexpr uint32_t ringSize = 64;
+// longest time to block the emulation thread, a peer that doesn't respond by then is
+// treated as idle (paused, in its menu, or in the background) until its clock moves again
+constexpr auto maxWait = Milliseconds{16};
+
+struct LocalLink::SharedBlock
+{
+	struct Message
+	{
+		uint32_t type;
+		uint32_t data;
+		uint32_t seq; // transfer the message or reply belongs to
+	};
+
+	// written by the other side except for clock, ringRead & waiting
+	struct Endpoint
+	{
+		std::atomic_uint32_t wakeSeq; // futex word, incremented on each new message or clock update
+		std::atomic_uint32_t ringWrite;
+		std::atomic_uint32_t ringRead;
+		std::atomic_bool waiting;
+		std::atomic_bool attached;
+		std::atomic_uint64_t clock;
+		Message ring[ringSize];
+	};
+
+	std::atomic_uint32_t magic;
+	uint32_t protocol;
+	std::atomic_uint32_t players;
+	Endpoint endpoint[2];
+};
+
+// the block starts out zero-filled so the atomics must not need construction
+static_assert(std::atomic_uint32_t::is_always_lock_free && std::atomic_uint64_t::is_always_lock_free);
+
+#ifdef HAS_SHARED_MEMORY_LINK
+static LocalLink::SharedBlock *mapSharedBlock(int fd)
+{
+	auto ptr = mmap(nullptr, sizeof(LocalLink::SharedBlock), PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+	if(ptr == MAP_FAILED)
+		throw std::runtime_error{fmt::format("Error mapping link memory: {}", std::strerror(errno))};
+	return static_cast<LocalLink::SharedBlock*>(ptr);
+}
+
+static void unmapSharedBlock(LocalLink::SharedBlock *block)
+{
+	munmap(block, sizeof(LocalLink::SharedBlock));
+}
+
+static bool futexWait(std::atomic_uint32_t &word, uint32_t val, Nanoseconds timeout)
+{
+	auto secs = std::chrono::duration_cast<Seconds>(timeout);
+	timespec ts{(time_t)secs.count(), (long)(timeout - secs).count()};
+	if(syscall(SYS_futex, &word, FUTEX_WAIT, val, &ts, nullptr, 0) == -1 && errno == ETIMEDOUT)
+		return false;
+	return true;
+}
+
+static void futexWake(std::atomic_uint32_t &word)
+{
+	syscall(SYS_futex, &word, FUTEX_WAKE, INT_MAX, nullptr, nullptr, 0);
+}
+#else
+static void futexWake(std::atomic_uint32_t &) {}
+#endif
+
+LocalLink::LocalLink(CStringView name, uint32_t protocol, uint32_t syncCycles, RequestDelegate onRequest):
+	onRequest{onRequest},
+	shmName{fmt::format("/emuex-link-{}", name.data())},
+	nextSyncClock{syncCycles},
+	syncCycles{syncCycles}
+{
+	#ifdef HAS_SHARED_MEMORY_LINK
+	for(int tries = 0; tries < 2; tries++)
+	{
+		UniqueFileDescriptor fd{shm_open(shmName.c_str(), O_RDWR | O_CREAT | O_EXCL, 0600)};
+		if(fd != -1)
+		{
+			if(ftruncate(fd, sizeof(SharedBlock)) == -1)
+			{
+				shm_unlink(shmName.c_str());
+				throw std::runtime_error{fmt::format("Error sizing link memory: {}", std::strerror(errno))};
+			}
+			shared = mapSharedBlock(fd);
+			shared->protocol = protocol;
+			shared->players.store(1);
+			shared->endpoint[0].attached.store(true);
+			shared->magic.store(sharedBlockMagic, std::memory_order_release);
+			player = 0;
+			logMsg("created link:%s, waiting for player 1", name.data());
+			return;
+		}
+		if(errno != EEXIST)
+			throw std::runtime_error{fmt::format("Error creating link memory: {}", std::strerror(errno))};
+		fd = UniqueFileDescriptor{shm_open(shmName.c_str(), O_RDWR, 0)};
+		if(fd == -1)
+			continue; // creator closed before we could open it
+		// wait for the creator to finish initializing the block
+		struct stat stats{};
+		for(int i = 0; i < 100 && !fstat(fd, &stats) && stats.st_size < (off_t)sizeof(SharedBlock); i++)
+			std::this_thread::sleep_for(Milliseconds{10});
+		if(stats.st_size < (off_t)sizeof(SharedBlock))
+			throw std::runtime_error{"Link memory wasn't initialized by player 0"};
+		shared = mapSharedBlock(fd);
+		for(int i = 0; i < 100 && shared->magic.load(std::memory_order_acquire) != sharedBlockMagic; i++)
+			std::this_thread::sleep_for(Milliseconds{10});
+		if(shared->magic.load(std::memory_order_acquire) != sharedBlockMagic)
+		{
+			unmapSharedBlock(std::exchange(shared, nullptr));
+			throw std::runtime_error{"Link memory wasn't initialized by player 0"};
+		}
+		if(shared->protocol != protocol)
+		{
+			unmapSharedBlock(std::exchange(shared, nullptr));
+			throw std::runtime_error{"Link was created by a different system"};
+		}
+		auto prevPlayers = shared->players.fetch_add(1);
+		if(prevPlayers >= 2)
+		{
+			// left over from instances that didn't close properly
+			logWarn("link:%s already has 2 players, replacing it", name.data());
+			unmapSharedBlock(std::exchange(shared, nullptr));
+			shm_unlink(shmName.c_str());
+			continue;
+		}
+		if(!prevPlayers)
+		{
+			// the last player is closing the link, create a new one
+			unmapSharedBlock(std::exchange(shared, nullptr));
+			shm_unlink(shmName.c_str());
+			continue;
+		}
+		// take the free side, the other player may have reattached as player 1
+		player = shared->endpoint[0].attached.load() ? 1 : 0;
+		auto &self = shared->endpoint[player];
+		auto &peer = shared->endpoint[!player];
+		// drop messages sent to a previous player on this side & start at the other side's clock
+		self.ringRead.store(self.ringWrite.load());
+		clock = peer.clock.load(std::memory_order_acquire);
+		nextSyncClock = clock + syncCycles;
+		self.clock.store(clock, std::memory_order_release);
+		peerAttached = true;
+		self.attached.store(true);
+		peer.wakeSeq.fetch_add(1);
+		futexWake(peer.wakeSeq);
+		logMsg("joined link:%s as player %d", name.data(), player);
+		return;
+	}
+	throw std::runtime_error{"Unable to create or join link"};
+	#else
+	throw std::runtime_error{"Local link isn't supported on this platform"};
+	#endif
+}
+
+LocalLink::~LocalLink()
+{
+	#ifdef HAS_SHARED_MEMORY_LINK
+	if(!shared)
+		return;
+	shared->endpoint[player].attached.store(false);
+	auto &peer = shared->endpoint[!player];
+	peer.wakeSeq.fetch_add(1);
+	futexWake(peer.wakeSeq);
+	// the name stays valid while a player is attached so another instance can take this side
+	if(shared->players.fetch_sub(1) == 1)
+		shm_unlink(shmName.c_str());
+	unmapSharedBlock(shared);
+	#endif
+}
+
+bool LocalLink::isConnected() const
+{
+	return shared && peerAttached && !peerIdle;
+}
+
+void LocalLink::pushMessage(uint32_t type, uint32_t data, uint32_t seq, bool isReply)
+{
+	auto &peer = shared->endpoint[!player];
+	auto write = peer.ringWrite.load(std::memory_order_relaxed);
+	if(write - peer.ringRead.load(std::memory_order_acquire) == ringSize) [[unlikely]]
+	{
+		logErr("message ring full, dropping type:%u", type);
+		return;
+	}
+	peer.ring[write % ringSize] = {isReply ? type | replyFlag : type, data, seq};
+	peer.ringWrite.store(write + 1, std::memory_order_release);
+	peer.wakeSeq.fetch_add(1);
+	if(peer.waiting.load())
+		futexWake(peer.wakeSeq);
+}
+
+void LocalLink::handleMessages(std::optional<uint32_t> *reply)
+{
+	auto &self = shared->endpoint[player];
+	auto read = self.ringRead.load(std::memory_order_relaxed);
+	while(read != self.ringWrite.load(std::memory_order_acquire))
+	{
+		auto msg = self.ring[read % ringSize];
+		self.ringRead.store(++read, std::memory_order_release);
+		if(msg.type & replyFlag)
+		{
+			// replies to transfers that timed out are dropped
+			if(reply && msg.seq == transferSeq)
+				*reply = msg.data;
+			else
+				logWarn("unexpected reply for type:%u", msg.type & ~replyFlag);
+			continue;
+		}
+		pushMessage(msg.type, onRequest(msg.type, msg.data), msg.seq, true);
+	}
+}
+
+void LocalLink::publishClock()
+{
+	auto &self = shared->endpoint[player];
+	auto &peer = shared->endpoint[!player];
+	self.clock.store(clock, std::memory_order_release);
+	peer.wakeSeq.fetch_add(1);
+	if(peer.waiting.load())
+		futexWake(peer.wakeSeq);
+}
+
+bool LocalLink::updatePeerAttached()
+{
+	auto &self = shared->endpoint[player];
+	bool attached = shared->endpoint[!player].attached.load();
+	if(attached == peerAttached)
+		return attached;
+	peerAttached = attached;
+	peerIdle = false;
+	if(attached)
+	{
+		logMsg("player %d connected", !player);
+	}
+	else
+	{
+		logMsg("player %d disconnected", !player);
+		// anything still queued was meant for the player that left
+		self.ringRead.store(self.ringWrite.load(std::memory_order_acquire), std::memory_order_release);
+	}
+	return attached;
+}
+
+void LocalLink::setPeerIdle()
+{
+	logMsg("player %d stopped responding, running without it", !player);
+	peerIdle = true;
+	idlePeerClock = shared->endpoint[!player].clock.load(std::memory_order_acquire);
+}
+
+// Returns true and resyncs to the other side's clock once it runs again after being idle
+bool LocalLink::peerResumed()
+{
+	auto peerClock = shared->endpoint[!player].clock.load(std::memory_order_acquire);
+	if(peerClock == idlePeerClock)
+		return false;
+	logMsg("player %d resumed", !player);
+	peerIdle = false;
+	clock = peerClock;
+	nextSyncClock = clock + syncCycles;
+	publishClock();
+	return true;
+}
+
+// Calls isDone() each time the other side sends a message or updates its clock until it
+// returns true, returns false if the other side detaches or doesn't respond within maxWait
+bool LocalLink::waitUntil(auto &&isDone)
+{
+	#ifdef HAS_SHARED_MEMORY_LINK
+	auto &self = shared->endpoint[player];
+	auto deadline = steadyClockTimestamp() + maxWait;
+	bool done{};
+	while(true)
+	{
+		self.waiting.store(true);
+		auto seq = self.wakeSeq.load();
+		if(!updatePeerAttached())
+			break;
+		if(isDone())
+		{
+			done = true;
+			break;
+		}
+		auto now = steadyClockTimestamp();
+		if(now >= deadline || !futexWait(self.wakeSeq, seq, deadline - now))
+		{
+			setPeerIdle();
+			break;
+		}
+	}
+	self.waiting.store(false);
+	return done;
+	#else
+	return false;
+	#endif
+}
+
+std::optional<uint32_t> LocalLink::transfer(uint32_t type, uint32_t data)
+{
+	if(!shared || !updatePeerAttached() || (peerIdle && !peerResumed()))
+		return {};
+	pushMessage(type, data, ++transferSeq, false);
+	std::optional<uint32_t> reply;
+	waitUntil([&]
+	{
+		// also answers any requests the other side sent before replying
+		handleMessages(&reply);
+		return reply.has_value();
+	});
+	return reply;
+}
+
+void LocalLink::advance(uint32_t cycles)
+{
+	clock += cycles;
+	if(clock < nextSyncClock || !shared)
+		return;
+	nextSyncClock = clock + syncCycles;
+	publishClock();
+	if(!updatePeerAttached())
+		return;
+	if(peerIdle)
+	{
+		// keep running on our own & answer requests until the other side's clock moves
+		handleMessages();
+		peerResumed();
+		return;
+	}
+	auto &peer = shared->endpoint[!player];
+	waitUntil([&]
+	{
+		handleMessages();
+		return clock <= peer.clock.load(std::memory_order_acquire) + syncCycles;
+	});
+}
+
+void LocalLink::poll()
+{
+	if(shared && updatePeerAttached())
+		handleMessages();
+}
+
+}
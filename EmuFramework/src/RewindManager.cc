@@ -0,0 +1,274 @@
+/*  This file is part of EmuFramework.
+
+	Imagine is free software: you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation, either version 3 of the License, or
+	(at your option) any later version.
+
+	Imagine is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License
+	along with EmuFramework.  If not, see <http://www.gnu.org/licenses/> */
+
+#define LOGTAG "Rewind"
+#include <emuframework/RewindManager.hh>
+#include <emuframework/EmuApp.hh>
+#include <emuframework/EmuSystem.hh>
+#include "EmuOptions.hh"
+#include <imagine/io/MapIO.hh>
+#include <imagine/io/FileIO.hh>
+#include <imagine/logger/logger.h>
+#include <algorithm>
+#include <cstring>
+
+namespace EmuEx
+{
+
+// Deltas are encoded as a sequence of [unchanged byte count][changed byte count][changed bytes XOR'd]
+// with both counts stored as LEB128 varints. Runs of unchanged bytes shorter than minUnchangedRun
+// are folded into the changed bytes since they cost more to encode than to copy.
+constexpr size_t minUnchangedRun = 4;
+
+static constexpr size_t maxDeltaSize(size_t stateSize) { return stateSize + stateSize / 2 + 16; }
+
+static uint8_t *writeVarint(uint8_t *out, size_t val)
+{
+	while(val >= 0x80)
+	{
+		*out++ = uint8_t(val) | 0x80;
+		val >>= 7;
+	}
+	*out++ = val;
+	return out;
+}
+
+static const uint8_t *readVarint(const uint8_t *in, size_t &val)
+{
+	val = 0;
+	for(unsigned shift = 0;; shift += 7)
+	{
+		auto byte = *in++;
+		val |= size_t(byte & 0x7F) << shift;
+		if(!(byte & 0x80))
+			return in;
+	}
+}
+
+// returns the index of the first differing byte at or after idx
+static size_t matchEnd(const uint8_t *a, const uint8_t *b, size_t idx, size_t size)
+{
+	for(; idx + sizeof(uint64_t) <= size; idx += sizeof(uint64_t))
+	{
+		uint64_t wordA, wordB;
+		memcpy(&wordA, a + idx, sizeof(wordA));
+		memcpy(&wordB, b + idx, sizeof(wordB));
+		if(wordA != wordB)
+			break;
+	}
+	while(idx < size && a[idx] == b[idx])
+		idx++;
+	return idx;
+}
+
+static size_t encodeDelta(const uint8_t *a, const uint8_t *b, size_t size, uint8_t *out)
+{
+	auto outStart = out;
+	size_t idx{};
+	while(idx < size)
+	{
+		auto changedStart = matchEnd(a, b, idx, size);
+		auto changedEnd = changedStart;
+		while(changedEnd < size)
+		{
+			if(a[changedEnd] != b[changedEnd])
+			{
+				changedEnd++;
+				continue;
+			}
+			auto unchangedEnd = matchEnd(a, b, changedEnd, std::min(size, changedEnd + minUnchangedRun));
+			if(unchangedEnd - changedEnd == minUnchangedRun || unchangedEnd == size)
+				break;
+			changedEnd = unchangedEnd;
+		}
+		out = writeVarint(out, changedStart - idx);
+		out = writeVarint(out, changedEnd - changedStart);
+		for(auto i = changedStart; i < changedEnd; i++)
+		{
+			*out++ = a[i] ^ b[i];
+		}
+		idx = changedEnd;
+	}
+	return out - outStart;
+}
+
+static void applyDelta(uint8_t *state, [[maybe_unused]] size_t stateSize, std::span<const uint8_t> delta)
+{
+	auto in = delta.data();
+	auto end = in + delta.size();
+	size_t idx{};
+	while(in != end)
+	{
+		size_t unchanged, changed;
+		in = readVarint(in, unchanged);
+		in = readVarint(in, changed);
+		idx += unchanged;
+		assumeExpr(idx + changed <= stateSize);
+		for(auto i = idx; i < idx + changed; i++)
+		{
+			state[i] ^= *in++;
+		}
+		idx += changed;
+	}
+}
+
+void RewindManager::reset()
+{
+	entries.clear();
+	ringBuff.reset();
+	ringSize = 0;
+	lastState.reset();
+	currState.reset();
+	deltaBuff.reset();
+	stateBuffSize = 0;
+	lastStateSize = currStateSize = 0;
+	framesUntilSave = 0;
+	rewinding = false;
+	resetPending = false;
+}
+
+void RewindManager::applyPendingReset()
+{
+	if(resetPending.exchange(false))
+		reset();
+}
+
+bool RewindManager::allocBuffers(size_t stateSize)
+{
+	if(!stateSize)
+		return false;
+	stateBuffSize = stateSize;
+	// state buffers start zeroed so any padding past the written size compares as unchanged
+	lastState = std::make_unique<uint8_t[]>(stateSize);
+	currState = std::make_unique<uint8_t[]>(stateSize);
+	deltaBuff = std::make_unique_for_overwrite<uint8_t[]>(maxDeltaSize(stateSize));
+	ringSize = size_t(maxMemoryMiB_) * 1024 * 1024;
+	ringBuff = std::make_unique_for_overwrite<uint8_t[]>(ringSize);
+	logMsg("allocated %zuMiB for rewind with %zu byte max state size", ringSize / (1024 * 1024), stateSize);
+	return true;
+}
+
+void RewindManager::saveState(EmuSystem &sys, int elapsedFrames)
+{
+	applyPendingReset();
+	if(!maxMemoryMiB_ || !sys.hasMemoryStates() || sys.hasLocalLink())
+		return;
+	framesUntilSave -= elapsedFrames;
+	if(framesUntilSave > 0)
+		return;
+	framesUntilSave = frameInterval_;
+	if(!stateBuffSize && !allocBuffers(sys.stateSize()))
+		return;
+	auto size = sys.writeState({currState.get(), stateBuffSize}, SaveStateFlags::uncompressed);
+	assumeExpr(size <= stateBuffSize);
+	if(currStateSize > size)
+		std::fill(&currState[size], &currState[currStateSize], 0);
+	currStateSize = size;
+	if(lastStateSize)
+	{
+		auto deltaSize = encodeDelta(currState.get(), lastState.get(), std::max(currStateSize, lastStateSize), deltaBuff.get());
+		addEntry({deltaBuff.get(), deltaSize}, lastStateSize);
+	}
+	std::swap(lastState, currState);
+	std::swap(lastStateSize, currStateSize);
+}
+
+bool RewindManager::rewindState(EmuApp &app)
+{
+	applyPendingReset();
+	if(!lastStateSize || app.system().hasLocalLink())
+		return false;
+	if(entries.size())
+	{
+		auto &e = entries.back();
+		applyDelta(lastState.get(), stateBuffSize, {&ringBuff[e.offset], e.size});
+		lastStateSize = e.stateSize;
+		entries.pop_back();
+	}
+	// once the history runs out, keep restoring the oldest state
+	try
+	{
+		app.system().readState(app, {lastState.get(), lastStateSize});
+	}
+	catch(std::exception &err)
+	{
+		logErr("error restoring rewind state:%s", err.what());
+		reset();
+		return false;
+	}
+	framesUntilSave = frameInterval_;
+	return true;
+}
+
+void RewindManager::addEntry(std::span<const uint8_t> delta, uint32_t stateSize)
+{
+	if(delta.size() > ringSize)
+	{
+		logWarn("%zu byte delta doesn't fit in rewind buffer", delta.size());
+		entries.clear();
+		return;
+	}
+	size_t offset = entries.size() ? entries.back().offset + entries.back().size : 0;
+	if(offset + delta.size() > ringSize)
+	{
+		// wrap around, dropping the oldest entries at the end of the buffer
+		while(entries.size() && entries.front().offset >= offset)
+			entries.pop_front();
+		offset = 0;
+	}
+	while(entries.size() && entries.front().offset < offset + delta.size() &&
+		entries.front().offset + entries.front().size > offset)
+	{
+		entries.pop_front();
+	}
+	std::ranges::copy(delta, &ringBuff[offset]);
+	entries.emplace_back(offset, uint32_t(delta.size()), stateSize);
+}
+
+bool RewindManager::setMaxMemoryMiB(uint8_t mib)
+{
+	if(mib > maxMemoryMiBLimit)
+		return false;
+	maxMemoryMiB_ = mib;
+	// called from the UI thread while frames may be running, so let the emulation thread free the buffers
+	resetPending = true;
+	return true;
+}
+
+bool RewindManager::setFrameInterval(uint8_t frames)
+{
+	if(!frames || frames > maxFrameInterval)
+		return false;
+	frameInterval_ = frames;
+	return true;
+}
+
+bool RewindManager::readConfig(MapIO &io, unsigned key, size_t size)
+{
+	switch(key)
+	{
+		default: return false;
+		case CFGKEY_REWIND_MAX_MEMORY: return readOptionValue<uint8_t>(io, size, [&](auto val){ setMaxMemoryMiB(val); });
+		case CFGKEY_REWIND_FRAME_INTERVAL: return readOptionValue<uint8_t>(io, size, [&](auto val){ setFrameInterval(val); });
+	}
+}
+
+void RewindManager::writeConfig(FileIO &io) const
+{
+	writeOptionValueIfNotDefault(io, CFGKEY_REWIND_MAX_MEMORY, maxMemoryMiB(), defaultMaxMemoryMiB);
+	writeOptionValueIfNotDefault(io, CFGKEY_REWIND_FRAME_INTERVAL, frameInterval_, defaultFrameInterval);
+}
+
+}
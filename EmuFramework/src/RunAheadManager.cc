@@ -0,0 +1,174 @@
+/*  This file is part of EmuFramework.
+
+	Imagine is free software: you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation, either version 3 of the License, or
+	(at your option) any later version.
+
+	Imagine is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License
+	along with EmuFramework.  If not, see <http://www.gnu.org/licenses/> */
+
+#define LOGTAG "RunAhead"
+#include <emuframework/RunAheadManager.hh>
+#include <emuframework/EmuApp.hh>
+#include <emuframework/EmuSystem.hh>
+#include "EmuOptions.hh"
+#include <imagine/io/MapIO.hh>
+#include <imagine/io/FileIO.hh>
+#include <imagine/time/Time.hh>
+#include <imagine/util/ranges.hh>
+#include <imagine/util/format.hh>
+#include <imagine/logger/logger.h>
+
+namespace EmuEx
+{
+
+// frames to run normally after a state error before trying run-ahead again
+constexpr int errorRetryFrames = 60;
+
+static uint64_t toUSecs(SteadyClockTime t)
+{
+	return std::chrono::duration_cast<Microseconds>(t).count();
+}
+
+void RunAheadManager::reset()
+{
+	stateBuff.reset();
+	stateBuffSize = 0;
+	framesUntilRetry = 0;
+	resetPending = false;
+	resetOverhead();
+}
+
+bool RunAheadManager::allocStateBuff(EmuSystem &sys)
+{
+	auto size = sys.stateSize();
+	if(!size)
+		return false;
+	stateBuffSize = size;
+	stateBuff = std::make_unique_for_overwrite<uint8_t[]>(stateBuffSize);
+	logMsg("allocated %zu byte run-ahead state buffer", stateBuffSize);
+	return true;
+}
+
+size_t RunAheadManager::writeState(EmuSystem &sys)
+{
+	try
+	{
+		return sys.writeState({stateBuff.get(), stateBuffSize}, SaveStateFlags::uncompressed);
+	}
+	catch(std::exception &err)
+	{
+		logErr("error saving run-ahead state:%s", err.what());
+		return 0;
+	}
+}
+
+bool RunAheadManager::runFrame(EmuApp &app, EmuSystemTaskContext taskCtx, EmuVideo &video, EmuAudio *audio)
+{
+	if(resetPending.exchange(false))
+		reset();
+	auto &sys = app.system();
+	uint8_t frames = frames_;
+	if(!frames || !EmuSystem::hasRunAhead || !sys.hasMemoryStates() || sys.hasLocalLink())
+		return false;
+	if(framesUntilRetry)
+	{
+		framesUntilRetry--;
+		return false;
+	}
+	if(!stateBuffSize && !allocStateBuff(sys))
+		return false;
+	auto startTime = IG::steadyClockTimestamp();
+	// the real frame only produces audio, its video is never shown
+	sys.runFrame(taskCtx, nullptr, audio);
+	auto aheadStartTime = IG::steadyClockTimestamp();
+	auto size = writeState(sys);
+	// a failed write clears the system's cached state size, so retry once if the state outgrew the buffer
+	if(!size && sys.stateSize() > stateBuffSize && allocStateBuff(sys))
+		size = writeState(sys);
+	if(!size)
+	{
+		// the real frame had no video, so let the caller run a normal frame to present one
+		// (advancing an extra frame this once), then keep using normal frames for a while
+		framesUntilRetry = errorRetryFrames;
+		return false;
+	}
+	for(auto i : iotaCount(frames))
+	{
+		sys.runFrame(taskCtx, i == frames - 1 ? &video : nullptr, nullptr);
+	}
+	try
+	{
+		sys.readState(app, {stateBuff.get(), size});
+	}
+	catch(std::exception &err)
+	{
+		logErr("error restoring run-ahead state:%s", err.what());
+		framesUntilRetry = errorRetryFrames;
+	}
+	auto endTime = IG::steadyClockTimestamp();
+	overheadFrames.fetch_add(1, std::memory_order_relaxed);
+	runAheadUSecs.fetch_add(toUSecs(endTime - aheadStartTime), std::memory_order_relaxed);
+	totalUSecs.fetch_add(toUSecs(endTime - startTime), std::memory_order_relaxed);
+	return true;
+}
+
+bool RunAheadManager::setFrames(uint8_t frames)
+{
+	if(frames > maxFrames)
+		return false;
+	frames_ = frames;
+	// called from the UI thread while frames may be running, so let the emulation thread free the buffer
+	resetPending = true;
+	return true;
+}
+
+RunAheadManager::Overhead RunAheadManager::overhead() const
+{
+	return
+	{
+		.frames = overheadFrames.load(std::memory_order_relaxed),
+		.runAheadUSecs = runAheadUSecs.load(std::memory_order_relaxed),
+		.totalUSecs = totalUSecs.load(std::memory_order_relaxed),
+	};
+}
+
+std::string RunAheadManager::overheadSummary() const
+{
+	auto o = overhead();
+	if(!o.frames)
+		return "No run-ahead frames measured yet";
+	auto aheadMSecs = o.runAheadUSecs / 1000. / o.frames;
+	auto totalMSecs = o.totalUSecs / 1000. / o.frames;
+	return fmt::format("Run-ahead: {:.2f}ms of {:.2f}ms per frame ({:.0f}%) over {} frames",
+		aheadMSecs, totalMSecs, o.runAheadUSecs * 100. / o.totalUSecs, o.frames);
+}
+
+void RunAheadManager::resetOverhead()
+{
+	overheadFrames.store(0, std::memory_order_relaxed);
+	runAheadUSecs.store(0, std::memory_order_relaxed);
+	totalUSecs.store(0, std::memory_order_relaxed);
+}
+
+bool RunAheadManager::readConfig(MapIO &io, unsigned key, size_t size)
+{
+	switch(key)
+	{
+		default: return false;
+		case CFGKEY_RUN_AHEAD_FRAMES: return readOptionValue<uint8_t>(io, size, [&](auto val){ setFrames(val); });
+	}
+}
+
+void RunAheadManager::writeConfig(FileIO &io) const
+{
+	writeOptionValueIfNotDefault(io, CFGKEY_RUN_AHEAD_FRAMES, frames(), defaultFrames);
+}
+
+}
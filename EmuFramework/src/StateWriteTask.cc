@@ -0,0 +1,217 @@
+/*  This file is part of EmuFramework.
+
+	Imagine is free software: you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation, either version 3 of the License, or
+	(at your option) any later version.
+
+	Imagine is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License
+	along with EmuFramework.  If not, see <http://www.gnu.org/licenses/> */
+
+#define LOGTAG "StateWriteTask"
+#include <emuframework/StateWriteTask.hh>
+#include <emuframework/EmuApp.hh>
+#include <emuframework/EmuSystem.hh>
+#include <imagine/io/FileIO.hh>
+#include <imagine/thread/Thread.hh>
+#include <imagine/logger/logger.h>
+#include <imagine/util/format.hh>
+#include <algorithm>
+
+namespace EmuEx
+{
+
+StateWriteTask::StateWriteTask(EmuApp &app):
+	appPtr{&app}
+{}
+
+StateWriteTask::~StateWriteTask()
+{
+	stop();
+}
+
+void StateWriteTask::start()
+{
+	if(taskThread.joinable())
+		return;
+	taskThread = makeThreadSync(
+		[this](auto &sem)
+		{
+			auto eventLoop = IG::EventLoop::makeForThread();
+			bool started = true;
+			commandPort.attach(eventLoop,
+				[this, &started](auto msgs)
+				{
+					for(auto msg : msgs)
+					{
+						if(msg.job)
+						{
+							std::unique_ptr<WriteJob> job{msg.job};
+							write(*job);
+						}
+						if(msg.semPtr)
+						{
+							msg.semPtr->release();
+						}
+						if(msg.exit)
+						{
+							started = false;
+							EventLoop::forThread().stop();
+							return false;
+						}
+					}
+					return true;
+				});
+			sem.release();
+			logMsg("starting thread event loop");
+			eventLoop.run(started);
+			logMsg("exiting thread");
+			commandPort.detach();
+		});
+}
+
+void StateWriteTask::stop()
+{
+	if(!taskThread.joinable())
+		return;
+	commandPort.send({.exit = true});
+	taskThread.join();
+}
+
+void StateWriteTask::saveState(EmuSystem &sys, CStringView path)
+{
+	auto job = std::make_unique<WriteJob>();
+	auto buffSize = sys.stateSize();
+	job->data = std::make_unique_for_overwrite<uint8_t[]>(buffSize);
+	job->path = path;
+	if(sys.hasStateCompression())
+	{
+		job->size = sys.writeState({job->data.get(), buffSize}, SaveStateFlags::uncompressed);
+		job->compressedSize = buffSize;
+		job->systemPtr = &sys;
+	}
+	else
+	{
+		job->size = sys.writeState({job->data.get(), buffSize});
+	}
+	queue(std::move(job));
+}
+
+void StateWriteTask::saveBackupMemory(CStringView path, std::span<const uint8_t> data)
+{
+	auto job = std::make_unique<WriteJob>();
+	job->data = std::make_unique_for_overwrite<uint8_t[]>(data.size());
+	std::ranges::copy(data, job->data.get());
+	job->size = data.size();
+	job->path = path;
+	job->type = JobType::backupMemory;
+	queue(std::move(job));
+}
+
+void StateWriteTask::removeBackupMemory(CStringView path)
+{
+	auto job = std::make_unique<WriteJob>();
+	job->path = path;
+	job->type = JobType::removeBackupMemory;
+	queue(std::move(job));
+}
+
+void StateWriteTask::queue(std::unique_ptr<WriteJob> job)
+{
+	start();
+	if(!commandPort.send({.job = job.get()}))
+	{
+		throw std::runtime_error("Error queuing file write");
+	}
+	job.release(); // now owned by the task thread
+}
+
+void StateWriteTask::wait()
+{
+	if(!taskThread.joinable())
+		return;
+	commandPort.send({}, true);
+	app().flushMainThreadMessages();
+}
+
+void StateWriteTask::write(WriteJob &job)
+{
+	if(job.type == JobType::removeBackupMemory)
+	{
+		logMsg("removing backup memory:%s", job.path.data());
+		app().appContext().removeFileUri(job.path);
+		return;
+	}
+	std::span<const uint8_t> data{job.data.get(), job.size};
+	std::unique_ptr<uint8_t[]> compressedData;
+	const char *errorStr{};
+	if(job.compressedSize)
+	{
+		compressedData = std::make_unique_for_overwrite<uint8_t[]>(job.compressedSize);
+		auto size = job.systemPtr->compressState(data, {compressedData.get(), job.compressedSize});
+		if(size)
+			data = {compressedData.get(), size};
+		else
+			errorStr = "Error compressing state";
+	}
+	if(!errorStr)
+	{
+		auto ctx = app().appContext();
+		auto tempPath = job.path;
+		tempPath += ".tmp";
+		if(FileUtils::writeToUri(ctx, tempPath, data) == -1)
+		{
+			errorStr = "Error writing file";
+		}
+		else if(!ctx.renameFileUri(tempPath, job.path))
+		{
+			// some storage providers won't rename over an existing file, so move the old file
+			// aside & only delete it once the new one is in place
+			auto backupPath = job.path;
+			backupPath += ".bak";
+			bool hasBackup = ctx.renameFileUri(job.path, backupPath);
+			if(hasBackup && ctx.renameFileUri(tempPath, job.path))
+			{
+				ctx.removeFileUri(backupPath);
+			}
+			else
+			{
+				if(hasBackup)
+					ctx.renameFileUri(backupPath, job.path);
+				ctx.removeFileUri(tempPath);
+				errorStr = "Error renaming file";
+			}
+		}
+	}
+	if(errorStr)
+	{
+		logErr("%s:%s", errorStr, job.path.data());
+		auto typeStr = job.type == JobType::state ? "state" : "backup memory";
+		app().runOnMainThread(
+			[=](IG::ApplicationContext ctx)
+			{
+				EmuApp::get(ctx).postErrorMessage(4, fmt::format("Can't save {}:\n{}", typeStr, errorStr));
+			});
+	}
+	else if(job.type == JobType::state)
+	{
+		logMsg("wrote %zu byte state:%s", data.size(), job.path.data());
+		app().runOnMainThread([](IG::ApplicationContext ctx) { EmuApp::get(ctx).dispatchStateWritten(); });
+	}
+	else
+	{
+		logMsg("wrote %zu byte backup memory:%s", data.size(), job.path.data());
+	}
+}
+
+EmuApp &StateWriteTask::app() const
+{
+	return *appPtr;
+}
+
+}
@@ -37,6 +37,8 @@ constexpr VideoImageEffect::EffectDesc prescale2xDesc{"direct-v.txt", "direct-f.
 constexpr VideoImageEffect::EffectDesc prescale3xDesc{"direct-v.txt", "direct-f.txt", {3, 3}};
 constexpr VideoImageEffect::EffectDesc prescale4xDesc{"direct-v.txt", "direct-f.txt", {4, 4}};
 
+constexpr VideoImageEffect::EffectDesc paletteLookupDesc{"direct-v.txt", "palette-f.txt", {1, 1}};
+
 static constexpr const char *effectName(ImageEffectId id)
 {
 	switch(id)
@@ -107,6 +109,20 @@ VideoImageEffect::VideoImageEffect(Gfx::Renderer &r, Id effect, IG::PixelFormat
 	compile(r, effectDesc(effect), samplerConf);
 }
 
+VideoImageEffect::VideoImageEffect(Gfx::Renderer &r, EffectDesc desc, IG::PixelFormat fmt, Gfx::ColorSpace colSpace,
+	Gfx::TextureSamplerConfig samplerConf, IG::WP size):
+		inputImgSize{size}, format{effectFormat(fmt, colSpace)}, colorSpace{colSpace}
+{
+	compile(r, desc, samplerConf);
+}
+
+VideoImageEffect VideoImageEffect::makePaletteLookup(Gfx::Renderer &r, IG::PixelFormat fmt, Gfx::ColorSpace colSpace,
+	Gfx::TextureSamplerConfig samplerConf, IG::WP size)
+{
+	logMsg("compiling palette lookup effect");
+	return {r, paletteLookupDesc, fmt, colSpace, samplerConf, size};
+}
+
 void VideoImageEffect::initRenderTargetTexture(Gfx::Renderer &r, Gfx::TextureSamplerConfig samplerConf)
 {
 	if(!renderTargetScale.x)
@@ -181,6 +197,7 @@ void VideoImageEffect::compileEffect(Gfx::Renderer &r, EffectDesc desc, bool use
 		{"srcTexelDelta", &srcTexelDeltaU},
 		{"srcTexelHalfDelta", &srcTexelHalfDeltaU},
 		{"srcPixels", &srcPixelsU},
+		{"PALETTE", &paletteU},
 	};
 	prog = {r.task(), vShader, fShader, Gfx::ProgramFlagsMask::HAS_TEXTURE, uniformDescs};
 	if(!prog)
@@ -198,6 +215,8 @@ void VideoImageEffect::updateProgramUniforms(Gfx::Renderer &r)
 		prog.uniform(srcTexelHalfDeltaU, 0.5f * (1.0f / (float)inputImgSize.x), 0.5f * (1.0f / (float)inputImgSize.y));
 	if(srcPixelsU != -1)
 		prog.uniform(srcPixelsU, (float)inputImgSize.x, (float)inputImgSize.y);
+	if(paletteU != -1)
+		prog.uniform(paletteU, paletteTextureUnit);
 }
 
 void VideoImageEffect::setImageSize(Gfx::Renderer &r, IG::WP size, Gfx::TextureSamplerConfig samplerConf)
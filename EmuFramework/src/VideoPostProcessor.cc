@@ -0,0 +1,251 @@
+/*  This file is part of EmuFramework.
+
+	Imagine is free software: you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation, either version 3 of the License, or
+	(at your option) any later version.
+
+	Imagine is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License
+	along with EmuFramework.  If not, see <http://www.gnu.org/licenses/> */
+
+#define LOGTAG "VideoPostProcessor"
+#include <emuframework/VideoPostProcessor.hh>
+#include <imagine/logger/logger.h>
+#include <algorithm>
+#include <cstdint>
+#include <utility>
+
+namespace EmuEx
+{
+
+// Scale2x/EPX, each source pixel becomes a 2x2 block where corners take the color
+// of matching orthogonal neighbors to smooth diagonal edges
+template <class Pixel>
+static void scale2x(PixmapView srcPix, MutablePixmapView destPix)
+{
+	auto w = srcPix.w(), h = srcPix.h();
+	auto srcPitch = srcPix.pitchPixels();
+	auto destPitch = destPix.pitchPixels();
+	auto src = (const Pixel*)srcPix.data();
+	auto dest = (Pixel*)destPix.data();
+	for(int y = 0; y < h; y++)
+	{
+		auto rowAbove = src + std::max(y - 1, 0) * srcPitch;
+		auto row = src + y * srcPitch;
+		auto rowBelow = src + std::min(y + 1, h - 1) * srcPitch;
+		auto destRow0 = dest + (y * 2) * destPitch;
+		auto destRow1 = destRow0 + destPitch;
+		for(int x = 0; x < w; x++)
+		{
+			auto p = row[x];
+			auto a = rowAbove[x];
+			auto d = rowBelow[x];
+			auto c = row[std::max(x - 1, 0)];
+			auto b = row[std::min(x + 1, w - 1)];
+			if(c != b && a != d)
+			{
+				destRow0[x * 2]     = c == a ? a : p;
+				destRow0[x * 2 + 1] = a == b ? b : p;
+				destRow1[x * 2]     = c == d ? c : p;
+				destRow1[x * 2 + 1] = d == b ? d : p;
+			}
+			else
+			{
+				destRow0[x * 2] = destRow0[x * 2 + 1] = destRow1[x * 2] = destRow1[x * 2 + 1] = p;
+			}
+		}
+	}
+}
+
+template <class Pixel>
+static void scale2xNearest(PixmapView srcPix, MutablePixmapView destPix)
+{
+	auto w = srcPix.w(), h = srcPix.h();
+	auto srcPitch = srcPix.pitchPixels();
+	auto destPitch = destPix.pitchPixels();
+	auto src = (const Pixel*)srcPix.data();
+	auto dest = (Pixel*)destPix.data();
+	for(int y = 0; y < h; y++)
+	{
+		auto row = src + y * srcPitch;
+		auto destRow0 = dest + (y * 2) * destPitch;
+		auto destRow1 = destRow0 + destPitch;
+		for(int x = 0; x < w; x++)
+		{
+			destRow0[x * 2] = destRow0[x * 2 + 1] = destRow1[x * 2] = destRow1[x * 2 + 1] = row[x];
+		}
+	}
+}
+
+// halve the brightness of every odd row
+static constexpr uint16_t halfBrightness(uint16_t p) { return (p >> 1) & 0x7BEF; } // RGB565
+static constexpr uint32_t halfBrightness(uint32_t p) { return ((p >> 1) & 0x007F7F7F) | (p & 0xFF000000); } // 8888, keeps alpha
+
+template <class Pixel>
+static void darkenOddRows(MutablePixmapView pix)
+{
+	auto pitch = pix.pitchPixels();
+	auto data = (Pixel*)pix.data();
+	for(int y = 1; y < pix.h(); y += 2)
+	{
+		auto row = data + y * pitch;
+		for(int x = 0; x < pix.w(); x++)
+		{
+			row[x] = halfBrightness(row[x]);
+		}
+	}
+}
+
+template <class Pixel>
+static void applyFilter(VideoPostFilter filter, PixmapView src, MutablePixmapView dest)
+{
+	switch(filter)
+	{
+		case VideoPostFilter::Off: break;
+		case VideoPostFilter::Scale2x:
+			scale2x<Pixel>(src, dest);
+			break;
+		case VideoPostFilter::Scanlines:
+			scale2xNearest<Pixel>(src, dest);
+			darkenOddRows<Pixel>(dest);
+			break;
+		case VideoPostFilter::Scale2xScanlines:
+			scale2x<Pixel>(src, dest);
+			darkenOddRows<Pixel>(dest);
+			break;
+	}
+}
+
+static void applyFilter(VideoPostFilter filter, PixmapView src, MutablePixmapView dest)
+{
+	if(src.format().bytesPerPixel() == 2)
+		applyFilter<uint16_t>(filter, src, dest);
+	else
+		applyFilter<uint32_t>(filter, src, dest);
+}
+
+VideoPostProcessor::~VideoPostProcessor()
+{
+	stop();
+}
+
+void VideoPostProcessor::setFilter(VideoPostFilter filter)
+{
+	if(filter_ == filter)
+		return;
+	wait(); // the worker reads filter_ and sets hasOutput
+	filter_ = filter;
+	logMsg("set filter:%s", wise_enum::to_string(filter).data());
+	if(!isEnabled())
+	{
+		stop();
+		setFormat({});
+	}
+	else
+	{
+		hasOutput = false;
+	}
+}
+
+void VideoPostProcessor::setFormat(PixmapDesc desc)
+{
+	wait();
+	hasOutput = false;
+	if(desc == srcDesc)
+		return;
+	srcDesc = desc;
+	for(auto i : {0, 1})
+	{
+		inBuff[i] = desc.bytes() ? std::make_unique_for_overwrite<char[]>(desc.bytes()) : nullptr;
+		outBuff[i] = desc.bytes() ? std::make_unique_for_overwrite<char[]>(outputFormat().bytes()) : nullptr;
+	}
+}
+
+MutablePixmapView VideoPostProcessor::inputPixmap() const
+{
+	return inPixmap(frameIdx);
+}
+
+PixmapView VideoPostProcessor::finishedFrame()
+{
+	wait();
+	if(!hasOutput)
+		return {};
+	return outPixmap(frameIdx ^ 1);
+}
+
+void VideoPostProcessor::submitFrame(PixmapView pix)
+{
+	assumeExpr(!busy);
+	assumeExpr(pix.desc() == srcDesc);
+	auto input = inPixmap(frameIdx);
+	if(pix.data() != input.data())
+		input.write(pix);
+	start();
+	jobIdx = std::exchange(frameIdx, frameIdx ^ 1);
+	busy = true;
+	workSem.release();
+}
+
+PixmapView VideoPostProcessor::filterFrame(PixmapView pix)
+{
+	assumeExpr(pix.desc() == srcDesc);
+	wait();
+	auto output = outPixmap(frameIdx);
+	applyFilter(filter_, pix, output);
+	frameIdx ^= 1;
+	hasOutput = false; // the result isn't queued for the next finishedFrame()
+	return output;
+}
+
+void VideoPostProcessor::start()
+{
+	if(thread.joinable())
+		return;
+	exiting = false;
+	thread = std::thread{[this]()
+	{
+		logMsg("starting filter thread");
+		while(true)
+		{
+			workSem.acquire();
+			if(exiting)
+				break;
+			run(jobIdx);
+			doneSem.release();
+		}
+		logMsg("exiting filter thread");
+	}};
+}
+
+void VideoPostProcessor::wait()
+{
+	if(!busy)
+		return;
+	doneSem.acquire();
+	busy = false;
+}
+
+void VideoPostProcessor::stop()
+{
+	if(!thread.joinable())
+		return;
+	wait();
+	exiting = true;
+	workSem.release();
+	thread.join();
+	hasOutput = false;
+}
+
+void VideoPostProcessor::run(int idx)
+{
+	applyFilter(filter_, inPixmap(idx), outPixmap(idx));
+	hasOutput = true;
+}
+
+}
@@ -102,6 +102,30 @@ AudioOptionView::AudioOptionView(ViewAttachParams attach, bool customMenu):
 			app().setAddSoundBuffersOnUnderrun(item.flipBoolValue(*this));
 		}
 	},
+	dynamicRateControl
+	{
+		"Dynamic Rate Control", &defaultFace(),
+		app().audioDynamicRateControl(),
+		[this](BoolMenuItem &item)
+		{
+			app().setAudioDynamicRateControl(item.flipBoolValue(*this));
+		}
+	},
+	resamplerQualityItem
+	{
+		{"Low",    &defaultFace(), std::to_underlying(AudioResamplerQuality::Low)},
+		{"Medium", &defaultFace(), std::to_underlying(AudioResamplerQuality::Medium)},
+		{"High",   &defaultFace(), std::to_underlying(AudioResamplerQuality::High)},
+	},
+	resamplerQuality
+	{
+		"Resampler Quality", &defaultFace(),
+		{
+			.defaultItemOnSelect = [this](TextMenuItem &item) { app().setAudioResamplerQuality(AudioResamplerQuality(item.id())); }
+		},
+		(MenuItem::Id)app().audioResamplerQuality(),
+		resamplerQualityItem
+	},
 	audioRateItem
 	{
 		[&]
@@ -138,6 +162,23 @@ AudioOptionView::AudioOptionView(ViewAttachParams attach, bool customMenu):
 			app().audioManager().setSoloMix(!item.flipBoolValue(*this));
 		}
 	},
+	showStats
+	{
+		"Show Stats Overlay", &defaultFace(),
+		app().showAudioStats(),
+		[this](BoolMenuItem &item)
+		{
+			app().setShowAudioStats(item.flipBoolValue(*this));
+		}
+	},
+	dumpStats
+	{
+		"Write Stats To File", &defaultFace(),
+		[this]
+		{
+			app().dumpAudioStats();
+		}
+	},
 	apiItem
 	{
 		[this]()
@@ -185,6 +226,8 @@ void AudioOptionView::loadStockItems()
 	}
 	item.emplace_back(&soundBuffers);
 	item.emplace_back(&addSoundBuffersOnUnderrun);
+	item.emplace_back(&dynamicRateControl);
+	item.emplace_back(&resamplerQuality);
 	if constexpr(IG::Audio::Manager::HAS_SOLO_MIX)
 	{
 		item.emplace_back(&audioSoloMix);
@@ -196,6 +239,8 @@ void AudioOptionView::loadStockItems()
 			item.emplace_back(&api);
 		}
 	});
+	item.emplace_back(&showStats);
+	item.emplace_back(&dumpStats);
 }
 
 }
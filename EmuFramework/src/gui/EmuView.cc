@@ -16,7 +16,10 @@
 #include <emuframework/EmuView.hh>
 #include <emuframework/EmuVideoLayer.hh>
 #include <emuframework/EmuSystem.hh>
+#include <emuframework/FrameTimingStats.hh>
 #include <imagine/input/Input.hh>
+#include <imagine/gfx/RendererCommands.hh>
+#include <imagine/gfx/BasicEffect.hh>
 #include <algorithm>
 
 namespace EmuEx
@@ -27,14 +30,13 @@ EmuView::EmuView() {}
 EmuView::EmuView(ViewAttachParams attach, EmuVideoLayer *layer, EmuSystem &sys):
 	View{attach},
 	layer{layer},
-	sysPtr{&sys}
+	sysPtr{&sys},
+	audioStatsText{&defaultFace()}
 {}
 
 void EmuView::prepareDraw()
 {
-	#ifdef CONFIG_EMUFRAMEWORK_AUDIO_STATS
 	audioStatsText.makeGlyphs(renderer());
-	#endif
 }
 
 void EmuView::draw(Gfx::RendererCommands &__restrict__ cmds)
@@ -44,18 +46,71 @@ void EmuView::draw(Gfx::RendererCommands &__restrict__ cmds)
 	{
 		layer->draw(cmds);
 	}
-	#ifdef CONFIG_EMUFRAMEWORK_AUDIO_STATS
 	if(audioStatsText.isVisible())
 	{
-		cmds.setCommonProgram(CommonProgram::NO_TEX);
-		cmds.setBlendMode(BLEND_MODE_ALPHA);
-		cmds.setColor(0., 0., 0., .7);
-		GeomRect::draw(cmds, audioStatsRect);
-		cmds.setCommonProgram(CommonProgram::TEX_ALPHA);
-		audioStatsText.draw(cmds, audioStatsRect.x + TableView::globalXIndent,
-			audioStatsRect.yCenter(), LC2DO, ColorName::WHITE);
+		auto &basicEffect = cmds.basicEffect();
+		basicEffect.disableTexture(cmds);
+		cmds.set(BlendMode::ALPHA);
+		cmds.setColor({0., 0., 0., .7});
+		cmds.drawRect(audioStatsRect);
+		basicEffect.enableAlphaTexture(cmds);
+		audioStatsText.draw(cmds, {audioStatsRect.x + audioStatsText.nominalHeight() / 2, audioStatsRect.yCenter()},
+			LC2DO, ColorName::WHITE);
 	}
-	#endif
+	if(frameTimingGraph)
+	{
+		drawFrameTimingGraph(cmds);
+	}
+}
+
+// Draws the most recent frame timing samples along the bottom of the view, scaled so the
+// graph height is 2 target frame times. Each sample has a screen frame interval bar, shown
+// in red if EmuTiming skipped or repeated frames, next to a bar of the emulation (green)
+// and draw submit (blue) times. The yellow line marks the target frame time.
+void EmuView::drawFrameTimingGraph(Gfx::RendererCommands &__restrict__ cmds) const
+{
+	using namespace IG::Gfx;
+	constexpr size_t graphSamples = 240;
+	auto &stats = *frameTimingGraph;
+	auto samples = std::min(stats.size(), graphSamples + 1);
+	auto targetUSecs = stats.targetFrameTime().count() * 1e6f;
+	if(samples < 2 || targetUSecs <= 0)
+		return;
+	auto rect = viewRect();
+	WRect graphRect{{rect.x, rect.y2 - rect.ySize() / 4}, {rect.x2, rect.y2}};
+	float scale = graphRect.ySize() / (targetUSecs * 2.f);
+	int barWidth = std::max(graphRect.xSize() / int(graphSamples), 2);
+	auto barHeight = [&](float usecs){ return std::min(int(usecs * scale), graphRect.ySize()); };
+	cmds.basicEffect().disableTexture(cmds);
+	cmds.set(BlendMode::ALPHA);
+	cmds.setColor({0., 0., 0., .5});
+	cmds.drawRect(graphRect);
+	auto first = stats.size() - samples;
+	auto lastTimestamp = stats[first].timestampNSecs.load(std::memory_order_relaxed);
+	for(size_t i = 1; i < samples; i++)
+	{
+		auto &s = stats[first + i];
+		auto timestamp = s.timestampNSecs.load(std::memory_order_relaxed);
+		auto intervalUSecs = (timestamp - lastTimestamp) / 1000.f;
+		lastTimestamp = timestamp;
+		int x = graphRect.x + (i - 1) * barWidth;
+		int halfWidth = barWidth / 2;
+		if(s.elapsedFrames.load(std::memory_order_relaxed) == 1)
+			cmds.setColor({1., 1., 1., .7});
+		else
+			cmds.setColor({1., 0., 0., .9});
+		cmds.drawRect({{x, graphRect.y2 - barHeight(intervalUSecs)}, {x + halfWidth, graphRect.y2}});
+		auto emulateHeight = barHeight(s.emulateUSecs.load(std::memory_order_relaxed));
+		auto submitHeight = barHeight(s.submitUSecs.load(std::memory_order_relaxed));
+		cmds.setColor({0., 1., 0., .7});
+		cmds.drawRect({{x + halfWidth, graphRect.y2 - emulateHeight}, {x + barWidth, graphRect.y2}});
+		cmds.setColor({0., .5, 1., .7});
+		cmds.drawRect({{x + halfWidth, std::max(graphRect.y2 - emulateHeight - submitHeight, graphRect.y)},
+			{x + barWidth, graphRect.y2 - emulateHeight}});
+	}
+	auto targetY = graphRect.y2 - barHeight(targetUSecs);
+	cmds.setColor({1., 1., 0., .9});
+	cmds.drawRect({{graphRect.x, targetY - 1}, {graphRect.x2, targetY + 1}});
 }
 
 void EmuView::place()
@@ -64,14 +119,11 @@ void EmuView::place()
 	{
 		layer->place(viewRect(), displayRect(), inputView, system());
 	}
-	#ifdef CONFIG_EMUFRAMEWORK_AUDIO_STATS
 	if(audioStatsText.compile(renderer()))
 	{
-		audioStatsRect = viewRect.bounds();
-		audioStatsRect.y2 = (audioStatsRect.y + audioStatsText.nominalHeight * audioStatsText.lines)
-			+ audioStatsText.nominalHeight / 2; // adjust to bottom
+		audioStatsRect = viewRect();
+		audioStatsRect.y2 = audioStatsRect.y + audioStatsText.fullHeight();
 	}
-	#endif
 }
 
 bool EmuView::inputEvent(const Input::Event &e)
@@ -84,20 +136,21 @@ void EmuView::setLayoutInputView(EmuInputView *view)
 	inputView = view;
 }
 
-void EmuView::updateAudioStats(int underruns, int overruns, int callbacks, double avgCallbackFrames, int frames)
+void EmuView::updateAudioStats(std::string_view stats)
 {
-	#ifdef CONFIG_EMUFRAMEWORK_AUDIO_STATS
-	audioStatsText.setString(fmt::format("Underruns:{}\nOverruns:{}\nCallbacks per second:{}\nFrames per callback:{:g}\nTotal frames:{}",
-		underruns, overruns, callbacks, avgCallbackFrames, frames), &View::defaultFace);
+	waitForDrawFinished();
+	audioStatsText.resetString(stats);
 	place();
-	#endif
+	postDraw();
 }
 
 void EmuView::clearAudioStats()
 {
-	#ifdef CONFIG_EMUFRAMEWORK_AUDIO_STATS
-	audioStatsText.setString(nullptr);
-	#endif
+	if(!audioStatsText.stringSize())
+		return;
+	waitForDrawFinished();
+	audioStatsText.resetString();
+	postDraw();
 }
 
 }
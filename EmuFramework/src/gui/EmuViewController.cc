@@ -296,9 +296,9 @@ void EmuViewController::updateExtraWindowViewport(IG::Window &win, IG::Viewport
 	emuView.place();
 }
 
-void EmuViewController::updateEmuAudioStats(int underruns, int overruns, int callbacks, double avgCallbackFrames, int frames)
+void EmuViewController::updateEmuAudioStats(std::string_view stats)
 {
-	emuView.updateAudioStats(underruns, overruns, callbacks, avgCallbackFrames, frames);
+	emuView.updateAudioStats(stats);
 }
 
 void EmuViewController::clearEmuAudioStats()
@@ -367,6 +367,7 @@ bool EmuViewController::drawMainWindow(IG::Window &win, IG::WindowDrawParams par
 		cmds.clear();
 		auto &winData = windowData(win);
 		cmds.basicEffect().setModelViewProjection(cmds, Gfx::Mat4::ident(), winData.projM);
+		auto startTime = IG::steadyClockTimestamp();
 		if(showingEmulation)
 		{
 			if(winData.hasEmuView)
@@ -387,6 +388,8 @@ bool EmuViewController::drawMainWindow(IG::Window &win, IG::WindowDrawParams par
 			popup.draw(cmds);
 		}
 		cmds.present();
+		if(showingEmulation)
+			app().frameTimingStats().setSubmitTime(IG::steadyClockTimestamp() - startTime);
 	});
 }
 
@@ -18,6 +18,7 @@
 #include "../EmuOptions.hh"
 #include <imagine/base/ApplicationContext.hh>
 #include <imagine/gfx/Renderer.hh>
+#include <imagine/gui/AlertView.hh>
 #include <imagine/util/format.hh>
 
 namespace EmuEx
@@ -211,6 +212,35 @@ GUIOptionView::GUIOptionView(ViewAttachParams attach, bool customMenu):
 			app().setShowHiddenFilesInPicker(item.flipBoolValue(*this));
 		}
 	},
+	archiveContentCacheItem
+	{
+		{"Off",    &defaultFace(), 0},
+		{"64MiB",  &defaultFace(), 64},
+		{"256MiB", &defaultFace(), 256},
+		{"1GiB",   &defaultFace(), 1024},
+		{"4GiB",   &defaultFace(), 4096},
+	},
+	archiveContentCache
+	{
+		"Archive Content Cache", &defaultFace(),
+		{
+			.defaultItemOnSelect = [this](TextMenuItem &item) { app().archiveContentCache().setMaxMiB(item.id()); }
+		},
+		(MenuItem::Id)app().archiveContentCache().maxMiB(),
+		archiveContentCacheItem
+	},
+	clearArchiveContentCache
+	{
+		"Clear Archive Content Cache", &defaultFace(),
+		[this](const Input::Event &e)
+		{
+			pushAndShowModal(makeView<YesNoAlertView>("Really delete all cached archive content?",
+				YesNoAlertView::Delegates
+				{
+					.onYes = [this]{ app().archiveContentCache().clear(); }
+				}), e);
+		}
+	},
 	orientationHeading
 	{
 		"Orientation", &defaultBoldFace()
@@ -309,6 +339,8 @@ void GUIOptionView::loadStockItems()
 	if(used(showBluetoothScan))
 		item.emplace_back(&showBluetoothScan);
 	item.emplace_back(&showHiddenFiles);
+	item.emplace_back(&archiveContentCache);
+	item.emplace_back(&clearArchiveContentCache);
 	item.emplace_back(&orientationHeading);
 	item.emplace_back(&emuOrientation);
 	item.emplace_back(&menuOrientation);
@@ -73,9 +73,20 @@ StateSlotView::StateSlotView(ViewAttachParams attach):
 	}
 {
 	assert(system().hasContent());
+	app().setOnStateWritten(
+		[this]()
+		{
+			refreshSlots();
+			place();
+		});
 	refreshSlots();
 }
 
+StateSlotView::~StateSlotView()
+{
+	app().setOnStateWritten(nullptr);
+}
+
 void StateSlotView::onShow()
 {
 	refreshSlots();
@@ -124,11 +135,9 @@ void StateSlotView::refreshSlots()
 
 void StateSlotView::doSaveState()
 {
-	auto slot = system().stateSlot();
-	if(app().saveStateWithSlot(slot))
+	// the slot is refreshed by setOnStateWritten() when the write completes
+	if(app().saveStateWithSlot(system().stateSlot()))
 		app().showEmulation();
-	refreshSlot(slot);
-	place();
 }
 
 }
@@ -162,6 +162,65 @@ SystemOptionView::SystemOptionView(ViewAttachParams attach, bool customMenu):
 		(MenuItem::Id)app().altSpeed(AltSpeedMode::slow),
 		slowModeSpeedItem
 	},
+	rewindMemoryItem
+	{
+		{"Off",    &defaultFace(), 0},
+		{"2MiB",   &defaultFace(), 2},
+		{"4MiB",   &defaultFace(), 4},
+		{"8MiB",   &defaultFace(), 8},
+		{"16MiB",  &defaultFace(), 16},
+		{"32MiB",  &defaultFace(), 32},
+	},
+	rewindMemory
+	{
+		"Rewind Memory", &defaultFace(),
+		{
+			.defaultItemOnSelect = [this](TextMenuItem &item) { app().rewindManager().setMaxMemoryMiB(item.id()); }
+		},
+		(MenuItem::Id)app().rewindManager().maxMemoryMiB(),
+		rewindMemoryItem
+	},
+	rewindIntervalItem
+	{
+		{"Every Frame",    &defaultFace(), 1},
+		{"Every 2 Frames", &defaultFace(), 2},
+		{"Every 4 Frames", &defaultFace(), 4},
+	},
+	rewindInterval
+	{
+		"Rewind Snapshot Rate", &defaultFace(),
+		{
+			.defaultItemOnSelect = [this](TextMenuItem &item) { app().rewindManager().setFrameInterval(item.id()); }
+		},
+		(MenuItem::Id)app().rewindManager().frameInterval(),
+		rewindIntervalItem
+	},
+	runAheadItem
+	{
+		{"Off",      &defaultFace(), 0},
+		{"1 Frame",  &defaultFace(), 1},
+		{"2 Frames", &defaultFace(), 2},
+		{"3 Frames", &defaultFace(), 3},
+		{"4 Frames", &defaultFace(), 4},
+	},
+	runAhead
+	{
+		"Run-Ahead", &defaultFace(),
+		{
+			.defaultItemOnSelect = [this](TextMenuItem &item) { app().runAheadManager().setFrames(item.id()); }
+		},
+		(MenuItem::Id)app().runAheadManager().frames(),
+		runAheadItem
+	},
+	runAheadOverhead
+	{
+		"Show Run-Ahead Overhead", &defaultFace(),
+		[this]
+		{
+			app().postMessage(4, false, app().runAheadManager().overheadSummary());
+			app().runAheadManager().resetOverhead();
+		}
+	},
 	performanceMode
 	{
 		"Performance Mode", &defaultFace(),
@@ -187,6 +246,16 @@ void SystemOptionView::loadStockItems()
 	item.emplace_back(&confirmOverwriteState);
 	item.emplace_back(&fastModeSpeed);
 	item.emplace_back(&slowModeSpeed);
+	if(system().hasMemoryStates())
+	{
+		item.emplace_back(&rewindMemory);
+		item.emplace_back(&rewindInterval);
+		if(EmuSystem::hasRunAhead)
+		{
+			item.emplace_back(&runAhead);
+			item.emplace_back(&runAheadOverhead);
+		}
+	}
 	if(used(performanceMode))
 		item.emplace_back(&performanceMode);
 }
@@ -648,6 +648,31 @@ VideoOptionView::VideoOptionView(ViewAttachParams attach, bool customMenu):
 		(MenuItem::Id)app().videoEffectPixelFormatOption().val,
 		imgEffectPixelFormatItem
 	},
+	postFilterItem
+	{
+		{"Off",                 &defaultFace(), MenuItem::Id(VideoPostFilter::Off)},
+		{"Scale2x",             &defaultFace(), MenuItem::Id(VideoPostFilter::Scale2x)},
+		{"Scanlines",           &defaultFace(), MenuItem::Id(VideoPostFilter::Scanlines)},
+		{"Scale2x + Scanlines", &defaultFace(), MenuItem::Id(VideoPostFilter::Scale2xScanlines)},
+	},
+	postFilter
+	{
+		"CPU Image Filter", &defaultFace(),
+		{
+			.defaultItemOnSelect = [this](TextMenuItem &item) { app().setVideoPostFilter(VideoPostFilter(item.id())); }
+		},
+		MenuItem::Id(app().videoPostFilter()),
+		postFilterItem
+	},
+	gpuPalette
+	{
+		"GPU Palette Lookup", &defaultFace(),
+		app().useGpuPalette(),
+		[this](BoolMenuItem &item)
+		{
+			app().setUseGpuPalette(item.flipBoolValue(*this));
+		}
+	},
 	windowPixelFormatItem
 	{
 		[&]
@@ -777,6 +802,23 @@ VideoOptionView::VideoOptionView(ViewAttachParams attach, bool customMenu):
 			app().setForceMaxScreenFrameRate(item.flipBoolValue(*this));
 		}
 	},
+	showFrameTimingGraph
+	{
+		"Show Frame Timing Graph", &defaultFace(),
+		app().showFrameTimingGraph(),
+		[this](BoolMenuItem &item)
+		{
+			app().setShowFrameTimingGraph(item.flipBoolValue(*this));
+		}
+	},
+	dumpFrameTimingStats
+	{
+		"Write Frame Timing CSV", &defaultFace(),
+		[this]
+		{
+			app().dumpFrameTimingStats();
+		}
+	},
 	brightnessItem
 	{
 		{
@@ -906,12 +948,17 @@ void VideoOptionView::loadStockItems()
 	if(EmuSystem::canRenderRGBA8888)
 		item.emplace_back(&renderPixelFormat);
 	item.emplace_back(&imgEffectPixelFormat);
+	item.emplace_back(&postFilter);
+	if(EmuSystem::canRenderPaletteIndexed)
+		item.emplace_back(&gpuPalette);
 	if(!app().videoImageBuffersOption().isConst)
 		item.emplace_back(&imageBuffers);
 	if(IG::used(presentationTime) && renderer().supportsPresentationTime())
 		item.emplace_back(&presentationTime);
 	if(IG::used(forceMaxScreenFrameRate) && Config::envIsAndroid && appContext().androidSDK() >= 30)
 		item.emplace_back(&forceMaxScreenFrameRate);
+	item.emplace_back(&showFrameTimingGraph);
+	item.emplace_back(&dumpFrameTimingStats);
 	if(IG::used(secondDisplay))
 		item.emplace_back(&secondDisplay);
 	if(IG::used(showOnSecondScreen) && !app().showOnSecondScreenOption().isConst)
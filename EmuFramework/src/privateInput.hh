@@ -111,6 +111,7 @@ enum
 	guiKeyIdxExitApp,
 	guiKeyIdxSlowMotion,
 	guiKeyIdxToggleSlowMotion,
+	guiKeyIdxRewind,
 };
 
 constexpr std::array<unsigned, 1> rightUIKeys{guiKeyIdxLastView};
@@ -19,6 +19,7 @@
 #include <mednafen/state-driver.h>
 #include <mednafen/movie.h>
 #include <mednafen/cputest/cputest.h>
+#include <emuframework/EmuApp.hh>
 #include <imagine/logger/logger.h>
 #include <imagine/config/defs.hh>
 
@@ -60,6 +61,11 @@ void MDFND_OutputNotice(MDFN_NoticeType t, const char* s) noexcept
 	logMsg("%s", s);
 }
 
+void MDFND_DumpToFile(const std::string& path, const void *data, uint64 length)
+{
+	EmuEx::gApp().saveBackupMemory(path, {static_cast<const uint8_t*>(data), size_t(length)});
+}
+
 void MDFN_indent(int indent) {}
 void MDFND_SetMovieStatus(StateStatusStruct *status) noexcept {}
 void MDFND_SetStateStatus(StateStatusStruct *status) noexcept {}
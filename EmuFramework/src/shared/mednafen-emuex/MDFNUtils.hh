@@ -18,10 +18,12 @@
 #include <imagine/util/format.hh>
 #include <imagine/util/string.h>
 #include <emuframework/EmuApp.hh>
+#include <emuframework/zlibUtils.hh>
 #include <mednafen/video/surface.h>
 #include <mednafen/hash/md5.h>
 #include <mednafen/git.h>
 #include <mednafen/MemoryStream.h>
+#include <mednafen/state.h>
 #include <string_view>
 
 namespace EmuEx
@@ -76,7 +78,9 @@ inline std::string savePathMDFN(int id1, const char *cd1)
 	return savePathMDFN(EmuEx::gApp(), id1, cd1);
 }
 
-inline void loadContent(EmuSystem &sys, Mednafen::MDFNGI &mdfnGameInfo, IO &io, size_t maxContentSize)
+// digest is optional, from EmuSystem::identifyContent() with the given offset
+inline void loadContent(EmuSystem &sys, Mednafen::MDFNGI &mdfnGameInfo, IO &io, size_t maxContentSize,
+	const ContentDigest *digest = {}, size_t digestOffset = 0)
 {
 	using namespace Mednafen;
 	auto stream = std::make_unique<MemoryStream>(maxContentSize, true);
@@ -85,12 +89,109 @@ inline void loadContent(EmuSystem &sys, Mednafen::MDFNGI &mdfnGameInfo, IO &io,
 		sys.throwFileReadError();
 	stream->setSize(size);
 	MDFNFILE fp(&NVFS, std::move(stream));
+	// a digest of the full content only applies if it wasn't truncated to maxContentSize
+	if(size != ssize_t(io.size()))
+		digest = {};
+	auto hasDigest = [&](ContentDigestMask t) { return digest && digest->has(t); };
 	GameFile gf{&NVFS, std::string{sys.contentDirectory()}, fp.stream(),
 		std::string{withoutDotExtension(sys.contentFileName())},
-		std::string{sys.contentName()}};
+		std::string{sys.contentName()}, {},
+		hasDigest(ContentDigestMask::MD5) ? digest->md5.data() : nullptr,
+		hasDigest(ContentDigestMask::CRC32) ? &digest->crc32 : nullptr,
+		digestOffset};
 	mdfnGameInfo.Load(&gf);
 }
 
+// State data uses the same gzip compressed format as MDFNI_SaveState()
+// and is serialized through one reused stream so saving only allocates until it fits the state
+struct StateCacheMDFN
+{
+	Mednafen::MemoryStream stream{65536};
+	size_t size{};
+};
+
+inline StateCacheMDFN &stateCacheMDFN()
+{
+	static StateCacheMDFN cache;
+	return cache;
+}
+
+// call when closing content since the state size depends on it
+inline void resetStateCacheMDFN()
+{
+	auto &cache = stateCacheMDFN();
+	cache.stream.truncate(0);
+	cache.stream.shrink_to_fit();
+	cache.size = 0;
+}
+
+inline Mednafen::MemoryStream &saveStateToCacheMDFN()
+{
+	using namespace Mednafen;
+	auto &s = stateCacheMDFN().stream;
+	s.truncate(0);
+	s.seek(0, SEEK_SET);
+	MDFNSS_SaveSM(&s);
+	return s;
+}
+
+inline size_t stateSizeMDFN()
+{
+	auto &cache = stateCacheMDFN();
+	if(!cache.size)
+		cache.size = gzipCompressBound(saveStateToCacheMDFN().size());
+	return cache.size;
+}
+
+inline size_t writeStateMDFN(std::span<uint8_t> buff, SaveStateFlags flags)
+{
+	auto &s = saveStateToCacheMDFN();
+	std::span<const uint8_t> stateData{s.map(), size_t(s.size())};
+	size_t size{};
+	if(to_underlying(flags & SaveStateFlags::uncompressed))
+	{
+		if(stateData.size() <= buff.size())
+		{
+			std::ranges::copy(stateData, buff.data());
+			size = stateData.size();
+		}
+	}
+	else
+	{
+		size = gzipCompress(stateData, buff);
+	}
+	if(!size)
+	{
+		// the data may have outgrown the buffer, measure it again on the next stateSizeMDFN() call
+		stateCacheMDFN().size = 0;
+		throw std::runtime_error("State buffer too small");
+	}
+	return size;
+}
+
+// maxSize limits the uncompressed size read from the gzip trailer
+inline void readStateMDFN(std::span<const uint8_t> buff, size_t maxSize)
+{
+	using namespace Mednafen;
+	auto &s = stateCacheMDFN().stream;
+	if(hasGzipHeader(buff))
+	{
+		auto size = gzipUncompressedSize(buff, maxSize);
+		if(!size)
+			throw std::runtime_error("Invalid state data size");
+		s.truncate(size);
+		if(gzipDecompress(buff, {s.map(), size}) != size)
+			throw std::runtime_error("Error uncompressing state data");
+	}
+	else
+	{
+		s.truncate(buff.size());
+		std::ranges::copy(buff, s.map());
+	}
+	s.seek(0, SEEK_SET);
+	MDFNSS_LoadSM(&s);
+}
+
 inline void runFrame(EmuSystem &sys, Mednafen::MDFNGI &mdfnGameInfo, EmuSystemTaskContext taskCtx,
 	EmuVideo *videoPtr, MutablePixmapView pixView, EmuAudio *audioPtr, size_t maxAudioFrames, size_t maxLineWidths = 0)
 {
@@ -23,6 +23,9 @@
 #include <mednafen/general.h>
 
 #include <stdio.h>
+#include <algorithm>
+#include <chrono>
+#include <random>
 
 #include "CDAccess_CHD.h"
 
@@ -59,9 +62,18 @@ static const int32_t DI_Size_Table[8] =
 
 extern FILE *fopenHelper(const char* filename, const char* mode);
 
-CDAccess_CHD::CDAccess_CHD(const std::string &path, bool image_memcache) : NumTracks(0), total_sectors(0)
+CDAccess_CHD::CDAccess_CHD(const std::string &path, bool image_memcache, unsigned cache_hunks, unsigned prefetch_hunks)
+    : NumTracks(0), total_sectors(0), hunk_cache(std::max(cache_hunks, 1u))
 {
   Load(path, image_memcache);
+
+  for (auto &entry : hunk_cache)
+    entry.data = std::make_unique<uint8_t[]>(hunkbytes);
+
+  // leave at least one entry for the hunk being read
+  this->prefetch_hunks = std::min(prefetch_hunks, (unsigned)hunk_cache.size() - 1);
+  if (this->prefetch_hunks)
+    prefetch_thread = std::thread([this]() { PrefetchThreadMain(); });
 }
 
 void CDAccess_CHD::Load(const std::string &path, bool image_memcache)
@@ -82,10 +94,9 @@ void CDAccess_CHD::Load(const std::string &path, bool image_memcache)
     }
   }
 
-  /* allocate storage for sector reads */
   const chd_header *head = chd_get_header(chd);
-  hunkmem = (uint8_t *)malloc(head->hunkbytes);
-  oldhunk = -1;
+  hunkbytes = head->hunkbytes;
+  totalhunks = head->totalhunks;
 
   MDFN_printf("chd_load '%s' hunkbytes=%d\n", path.c_str(), head->hunkbytes);
 
@@ -214,83 +225,246 @@ void CDAccess_CHD::Load(const std::string &path, bool image_memcache)
 
 CDAccess_CHD::~CDAccess_CHD()
 {
+  if (prefetch_thread.joinable())
+  {
+    {
+      std::lock_guard<std::mutex> lock(cache_mutex);
+      prefetch_quit = true;
+    }
+    prefetch_cond.notify_one();
+    prefetch_thread.join();
+  }
+
+  if (cache_stats.hits + cache_stats.misses)
+  {
+    MDFN_printf("chd hunk cache hits=%llu misses=%llu prefetched=%llu prefetch_hits=%llu prefetch_waits=%llu\n",
+                (unsigned long long)cache_stats.hits, (unsigned long long)cache_stats.misses,
+                (unsigned long long)cache_stats.prefetched, (unsigned long long)cache_stats.prefetch_hits,
+                (unsigned long long)cache_stats.prefetch_waits);
+  }
+
   if (chd != NULL)
     chd_close(chd);
+}
 
-  if (hunkmem)
-    free(hunkmem);
+CDAccess_CHD::HunkCacheStats CDAccess_CHD::GetHunkCacheStats(void)
+{
+  std::lock_guard<std::mutex> lock(cache_mutex);
+  return cache_stats;
 }
 
-bool CDAccess_CHD::Read_CHD_Hunk_RAW(uint8_t *buf, int32_t lba, CHDFILE_TRACK_INFO* track)
+int32_t CDAccess_CHD::LBA_To_Hunk(int32_t lba, const CHDFILE_TRACK_INFO* track) const
 {
-  const chd_header *head = chd_get_header(chd);
   int cad = lba - track->LBA + track->fileOffset;
-  int sph = head->hunkbytes / (2352 + 96);
-  int hunknum = cad / sph; //(cad * head->unitbytes) / head->hunkbytes;
-  int hunkofs = cad % sph; //(cad * head->unitbytes) % head->hunkbytes;
-  int err = CHDERR_NONE;
+  int sph = hunkbytes / (2352 + 96);
+  return cad / sph;
+}
 
-  /* each hunk holds ~8 sectors, optimize when reading contiguous sectors */
-  if (hunknum != oldhunk)
+// Must be called with cache_mutex locked
+CDAccess_CHD::HunkCacheEntry* CDAccess_CHD::FindHunk(int32_t hunknum)
+{
+  for (auto &entry : hunk_cache)
   {
-    err = chd_read(chd, hunknum, hunkmem);
-    if (err != CHDERR_NONE)
-    	MDFN_printf("chd_read_sector failed lba=%d error=%d\n", lba, err);
-    else
-      oldhunk = hunknum;
+    if (entry.hunknum == hunknum)
+      return &entry;
   }
+  return nullptr;
+}
 
-  memcpy(buf, hunkmem + hunkofs * (2352 + 96), 2352);
+// Must be called with cache_mutex locked, evicts the least recently used entry that isn't
+// being decompressed, returns nullptr if every entry is busy
+CDAccess_CHD::HunkCacheEntry* CDAccess_CHD::ClaimHunkEntry(int32_t hunknum)
+{
+  HunkCacheEntry *lru = nullptr;
+  for (auto &entry : hunk_cache)
+  {
+    if (!entry.loading && (!lru || entry.last_use < lru->last_use))
+      lru = &entry;
+  }
+  if (!lru)
+    return nullptr;
+  lru->hunknum = hunknum;
+  lru->last_use = ++use_counter;
+  lru->loading = true;
+  lru->prefetched = false;
+  return lru;
+}
 
-  return err;
+// Called without cache_mutex locked on an entry claimed by ClaimHunkEntry()
+bool CDAccess_CHD::DecodeHunk(HunkCacheEntry* entry)
+{
+  std::lock_guard<std::mutex> lock(chd_mutex);
+  int err = chd_read(chd, entry->hunknum, entry->data.get());
+  if (err != CHDERR_NONE)
+  {
+    MDFN_printf("chd_read failed hunk=%d error=%d\n", entry->hunknum, err);
+    return false;
+  }
+  return true;
 }
 
-bool CDAccess_CHD::Read_CHD_Hunk_M1(uint8_t *buf, int32_t lba, CHDFILE_TRACK_INFO* track)
+// Must be called with cache_mutex locked, replaces any pending prefetches
+void CDAccess_CHD::QueuePrefetch(int32_t first_hunk, int32_t direction, unsigned count)
 {
-  const chd_header *head = chd_get_header(chd);
-  int cad = lba - track->LBA + track->fileOffset;
-  int sph = head->hunkbytes / (2352 + 96);
-  int hunknum = cad / sph; //(cad * head->unitbytes) / head->hunkbytes;
-  int hunkofs = cad % sph; //(cad * head->unitbytes) % head->hunkbytes;
-  int err = CHDERR_NONE;
+  if (!prefetch_hunks)
+    return;
 
-  /* each hunk holds ~8 sectors, optimize when reading contiguous sectors */
-  if (hunknum != oldhunk)
+  prefetch_queue.clear();
+  count = std::min(count, prefetch_hunks);
+  for (unsigned i = 0; i < count; i++)
   {
-    err = chd_read(chd, hunknum, hunkmem);
-    if (err != CHDERR_NONE)
-    	MDFN_printf("chd_read_sector failed lba=%d error=%d\n", lba, err);
-    else
-      oldhunk = hunknum;
+    int32_t hunknum = first_hunk + direction * (int32_t)i;
+    if (hunknum < 0 || hunknum >= totalhunks)
+      break;
+    if (!FindHunk(hunknum))
+      prefetch_queue.push_back(hunknum);
   }
 
-  memcpy(buf + 16, hunkmem + hunkofs * (2352 + 96), 2048);
+  if (!prefetch_queue.empty())
+    prefetch_cond.notify_one();
+}
+
+void CDAccess_CHD::PrefetchThreadMain(void)
+{
+  std::unique_lock<std::mutex> lock(cache_mutex);
+  while (true)
+  {
+    prefetch_cond.wait(lock, [this]() { return prefetch_quit || !prefetch_queue.empty(); });
+    if (prefetch_quit)
+      return;
+
+    int32_t hunknum = prefetch_queue.front();
+    prefetch_queue.pop_front();
+    if (FindHunk(hunknum))
+      continue;
+
+    HunkCacheEntry *entry = ClaimHunkEntry(hunknum);
+    if (!entry)
+      continue;
 
-  return err;
+    lock.unlock();
+    bool ok = DecodeHunk(entry);
+    lock.lock();
+
+    entry->loading = false;
+    if (ok)
+    {
+      entry->prefetched = true;
+      cache_stats.prefetched++;
+    }
+    else
+      entry->hunknum = -1;
+    hunk_loaded_cond.notify_all();
+  }
 }
 
-bool CDAccess_CHD::Read_CHD_Hunk_M2(uint8_t *buf, int32_t lba, CHDFILE_TRACK_INFO* track)
+bool CDAccess_CHD::Read_CHD_Hunk(uint8_t *buf, uint32_t size, int32_t lba, CHDFILE_TRACK_INFO* track)
 {
-  const chd_header *head = chd_get_header(chd);
   int cad = lba - track->LBA + track->fileOffset;
-  int sph = head->hunkbytes / (2352 + 96);
+  int sph = hunkbytes / (2352 + 96);
   int hunknum = cad / sph; //(cad * head->unitbytes) / head->hunkbytes;
   int hunkofs = cad % sph; //(cad * head->unitbytes) % head->hunkbytes;
-  int err = CHDERR_NONE;
 
-  /* each hunk holds ~8 sectors, optimize when reading contiguous sectors */
-  if (hunknum != oldhunk)
+  std::unique_lock<std::mutex> lock(cache_mutex);
+
+  /* each hunk holds ~8 sectors, only look ahead when moving to a new one */
+  if (hunknum != last_hunk)
   {
-    err = chd_read(chd, hunknum, hunkmem);
-    if (err != CHDERR_NONE)
-    	MDFN_printf("chd_read_sector failed lba=%d error=%d\n", lba, err);
+    // reading the previous hunk continues backwards, anything else restarts forwards,
+    // the read ahead grows with the length of the run so random seeks don't waste much work
+    int32_t direction = (hunknum == last_hunk - 1) ? -1 : 1;
+    if (hunknum == last_hunk + direction && direction == read_direction)
+      sequential_hunks++;
     else
-      oldhunk = hunknum;
+      sequential_hunks = 0;
+    read_direction = direction;
+    last_hunk = hunknum;
+    QueuePrefetch(hunknum + read_direction, read_direction, sequential_hunks + 1);
+  }
+
+  HunkCacheEntry *entry;
+  bool waited = false;
+  while (true)
+  {
+    entry = FindHunk(hunknum);
+    if (entry && entry->loading)
+    {
+      if (!waited)
+        cache_stats.prefetch_waits++;
+      waited = true;
+      hunk_loaded_cond.wait(lock);
+      continue;
+    }
+
+    if (entry)
+    {
+      cache_stats.hits++;
+      if (entry->prefetched)
+      {
+        cache_stats.prefetch_hits++;
+        entry->prefetched = false;
+      }
+      break;
+    }
+
+    entry = ClaimHunkEntry(hunknum);
+    if (!entry)
+    {
+      // every entry is being decompressed
+      hunk_loaded_cond.wait(lock);
+      continue;
+    }
+
+    cache_stats.misses++;
+    lock.unlock();
+    bool ok = DecodeHunk(entry);
+    lock.lock();
+    entry->loading = false;
+    hunk_loaded_cond.notify_all();
+    if (!ok)
+    {
+      entry->hunknum = -1;
+      MDFN_printf("chd_read_sector failed lba=%d\n", lba);
+      memset(buf, 0, size);
+      return true;
+    }
+    break;
   }
 
-  memcpy(buf + 16, hunkmem + hunkofs * (2352 + 96), 2336);
+  entry->last_use = ++use_counter;
+  memcpy(buf, entry->data.get() + hunkofs * (2352 + 96), size);
 
-  return err;
+  return false;
+}
+
+bool CDAccess_CHD::Read_CHD_Hunk_RAW(uint8_t *buf, int32_t lba, CHDFILE_TRACK_INFO* track)
+{
+  return Read_CHD_Hunk(buf, 2352, lba, track);
+}
+
+bool CDAccess_CHD::Read_CHD_Hunk_M1(uint8_t *buf, int32_t lba, CHDFILE_TRACK_INFO* track)
+{
+  return Read_CHD_Hunk(buf + 16, 2048, lba, track);
+}
+
+bool CDAccess_CHD::Read_CHD_Hunk_M2(uint8_t *buf, int32_t lba, CHDFILE_TRACK_INFO* track)
+{
+  return Read_CHD_Hunk(buf + 16, 2336, lba, track);
+}
+
+void CDAccess_CHD::HintReadSector(int32 lba, int32 count)
+{
+  for (int32_t track = FirstTrack; track < (FirstTrack + NumTracks); track++)
+  {
+    CHDFILE_TRACK_INFO *ct = &Tracks[track];
+
+    if (lba >= (ct->LBA - ct->pregap_dv) && lba < (ct->LBA + ct->sectors))
+    {
+      std::lock_guard<std::mutex> lock(cache_mutex);
+      QueuePrefetch(LBA_To_Hunk(lba, ct), 1, prefetch_hunks);
+      return;
+    }
+  }
 }
 
 int CDAccess_CHD::Read_Raw_Sector(uint8 *buf, int32 lba)
@@ -541,4 +715,155 @@ void CDAccess_CHD::Read_TOC(TOC *toc)
   *toc = this->toc;
 }
 
+struct HunkCacheTrace
+{
+  std::string name;
+  std::vector<int32_t> lbas;
+};
+
+static std::vector<HunkCacheTrace> MakeSyntheticTraces(int32_t total_sectors)
+{
+  std::vector<HunkCacheTrace> traces;
+  const int32_t length = std::min(total_sectors, (int32_t)6000);
+
+  // straight data read, like loading a level
+  HunkCacheTrace sequential{"sequential"};
+  for (int32_t lba = 0; lba < length; lba++)
+    sequential.lbas.push_back(lba);
+  traces.push_back(std::move(sequential));
+
+  HunkCacheTrace reverse{"reverse"};
+  for (int32_t lba = length - 1; lba >= 0; lba--)
+    reverse.lbas.push_back(lba);
+  traces.push_back(std::move(reverse));
+
+  // two streams alternating every few sectors, like streamed audio/video with data reads
+  HunkCacheTrace interleaved{"interleaved"};
+  for (int32_t i = 0; i < length / 2; i += 4)
+  {
+    for (int32_t j = 0; j < 4; j++)
+      interleaved.lbas.push_back(i + j);
+    for (int32_t j = 0; j < 4; j++)
+      interleaved.lbas.push_back((total_sectors / 2 + i + j) % total_sectors);
+  }
+  traces.push_back(std::move(interleaved));
+
+  // short reads after random seeks
+  HunkCacheTrace seek{"random_seek"};
+  std::minstd_rand rng(1);
+  for (int32_t i = 0; i < length / 16; i++)
+  {
+    int32_t start = std::uniform_int_distribution<int32_t>(0, std::max(total_sectors - 16, (int32_t)0))(rng);
+    for (int32_t j = 0; j < 16 && start + j < total_sectors; j++)
+      seek.lbas.push_back(start + j);
+  }
+  traces.push_back(std::move(seek));
+
+  return traces;
+}
+
+static HunkCacheTrace LoadHunkCacheTrace(const std::string& path)
+{
+  FILE *file = fopenHelper(path.c_str(), "rb");
+  if (!file)
+    throw MDFN_Error(0, _("Failed to open trace: %s"), path.c_str());
+
+  HunkCacheTrace trace{path};
+  int lba;
+  while (fscanf(file, "%d", &lba) == 1)
+    trace.lbas.push_back(lba);
+  fclose(file);
+  return trace;
+}
+
+std::string CDAccess_CHD::BenchmarkHunkCache(const std::string& path, const std::vector<std::string>& trace_paths)
+{
+  using Clock = std::chrono::steady_clock;
+
+  // time spent emulating between sector reads, gives the prefetch thread something to overlap with
+  const auto emulation_gap = std::chrono::microseconds(200);
+
+  struct CacheConfig
+  {
+    const char *name;
+    unsigned cache_hunks;
+    unsigned prefetch_hunks;
+  };
+  static const CacheConfig configs[] =
+  {
+    { "single_hunk", 1, 0 },
+    { "lru", DefaultCacheHunks, 0 },
+    { "lru_prefetch", DefaultCacheHunks, DefaultPrefetchHunks },
+  };
+
+  std::vector<HunkCacheTrace> traces;
+  if (trace_paths.empty())
+  {
+    CDAccess_CHD disc(path, false, 1, 0);
+    traces = MakeSyntheticTraces(disc.total_sectors);
+  }
+  else
+  {
+    for (const auto &trace_path : trace_paths)
+      traces.push_back(LoadHunkCacheTrace(trace_path));
+  }
+
+  std::string json = "{\"traces\":[";
+  for (size_t t = 0; t < traces.size(); t++)
+  {
+    const auto &trace = traces[t];
+    char tmp[512];
+    snprintf(tmp, sizeof(tmp), "%s{\"name\":\"%s\",\"reads\":%zu,\"configs\":[", t ? "," : "", trace.name.c_str(), trace.lbas.size());
+    json += tmp;
+
+    uint32_t reference_hash = 0;
+    for (size_t c = 0; c < sizeof(configs) / sizeof(configs[0]); c++)
+    {
+      const auto &config = configs[c];
+      CDAccess_CHD disc(path, false, config.cache_hunks, config.prefetch_hunks);
+      uint8_t buf[2352 + 96];
+      uint32_t hash = 2166136261u;
+      Clock::duration read_time{}, max_read_time{};
+
+      for (int32_t lba : trace.lbas)
+      {
+        auto start = Clock::now();
+        disc.Read_Raw_Sector(buf, lba);
+        auto elapsed = Clock::now() - start;
+        read_time += elapsed;
+        max_read_time = std::max(max_read_time, elapsed);
+
+        for (uint8_t b : buf)
+          hash = (hash ^ b) * 16777619u;
+
+        auto gap_end = Clock::now() + emulation_gap;
+        while (Clock::now() < gap_end) {}
+      }
+
+      if (!c)
+        reference_hash = hash;
+
+      HunkCacheStats stats = disc.GetHunkCacheStats();
+      uint64_t lookups = stats.hits + stats.misses;
+      snprintf(tmp, sizeof(tmp),
+               "%s{\"name\":\"%s\",\"cache_hunks\":%u,\"prefetch_hunks\":%u,\"hits\":%llu,\"misses\":%llu,"
+               "\"prefetched\":%llu,\"prefetch_hits\":%llu,\"prefetch_waits\":%llu,\"hit_rate\":%.4f,"
+               "\"read_ms\":%.3f,\"avg_read_us\":%.3f,\"max_read_us\":%.3f,\"match\":%s}",
+               c ? "," : "", config.name, config.cache_hunks, config.prefetch_hunks,
+               (unsigned long long)stats.hits, (unsigned long long)stats.misses,
+               (unsigned long long)stats.prefetched, (unsigned long long)stats.prefetch_hits,
+               (unsigned long long)stats.prefetch_waits,
+               lookups ? (double)stats.hits / lookups : 0.,
+               std::chrono::duration<double, std::milli>(read_time).count(),
+               trace.lbas.empty() ? 0. : std::chrono::duration<double, std::micro>(read_time).count() / trace.lbas.size(),
+               std::chrono::duration<double, std::micro>(max_read_time).count(),
+               hash == reference_hash ? "true" : "false");
+      json += tmp;
+    }
+    json += "]}";
+  }
+  json += "]}";
+  return json;
+}
+
 }
@@ -25,6 +25,13 @@
 #include "CDAccess.h"
 #include <libchdr/chd.h>
 
+#include <condition_variable>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
 namespace Mednafen
 {
 
@@ -57,7 +64,22 @@ class CDAccess_CHD final : public CDAccess
 {
  public:
 
- CDAccess_CHD(const std::string& path, bool image_memcache);
+ // Decompressed hunks are kept in an LRU cache of cache_hunks entries, a worker thread
+ // decompresses up to prefetch_hunks hunks ahead in the current read direction
+ static constexpr unsigned DefaultCacheHunks = 16;
+ static constexpr unsigned DefaultPrefetchHunks = 4;
+
+ struct HunkCacheStats
+ {
+  uint64_t hits;
+  uint64_t misses;
+  uint64_t prefetched;      // hunks decompressed by the prefetch thread
+  uint64_t prefetch_hits;   // hits on a hunk the prefetch thread decompressed
+  uint64_t prefetch_waits;  // hits that waited for their hunk to finish decompressing
+ };
+
+ CDAccess_CHD(const std::string& path, bool image_memcache,
+   unsigned cache_hunks = DefaultCacheHunks, unsigned prefetch_hunks = DefaultPrefetchHunks);
  ~CDAccess_CHD() final;
 
  int Read_Raw_Sector(uint8 *buf, int32 lba) final;
@@ -66,12 +88,28 @@ class CDAccess_CHD final : public CDAccess
 
  void Read_TOC(CDUtility::TOC *toc) final;
 
- void HintReadSector(int32 lba, int32 count) final {};
+ void HintReadSector(int32 lba, int32 count) final;
 
  int Read_Sector(uint8 *buf, int32 lba, uint32 size) final;
 
+ HunkCacheStats GetHunkCacheStats(void);
+
+ // Replays sector access traces against the hunk cache with & without prefetching,
+ // one LBA per line in each trace file, or synthetic traces if none are given.
+ // Returns the results as JSON.
+ static std::string BenchmarkHunkCache(const std::string& path, const std::vector<std::string>& trace_paths);
+
  private:
 
+ struct HunkCacheEntry
+ {
+  std::unique_ptr<uint8_t[]> data;
+  int32_t hunknum = -1;
+  uint64_t last_use = 0;
+  bool loading = false;
+  bool prefetched = false;
+ };
+
  void Load(const std::string& path, bool image_memcache);
  void Cleanup(void);
 
@@ -81,6 +119,14 @@ class CDAccess_CHD final : public CDAccess
   bool Read_CHD_Hunk_RAW(uint8_t *buf, int32_t lba, CHDFILE_TRACK_INFO* track);
   bool Read_CHD_Hunk_M1(uint8_t *buf, int32_t lba, CHDFILE_TRACK_INFO* track);
   bool Read_CHD_Hunk_M2(uint8_t *buf, int32_t lba, CHDFILE_TRACK_INFO* track);
+  bool Read_CHD_Hunk(uint8_t *buf, uint32_t size, int32_t lba, CHDFILE_TRACK_INFO* track);
+  int32_t LBA_To_Hunk(int32_t lba, const CHDFILE_TRACK_INFO* track) const;
+
+  HunkCacheEntry* FindHunk(int32_t hunknum);
+  HunkCacheEntry* ClaimHunkEntry(int32_t hunknum);
+  bool DecodeHunk(HunkCacheEntry* entry);
+  void QueuePrefetch(int32_t first_hunk, int32_t direction, unsigned count);
+  void PrefetchThreadMain(void);
 
   int32_t NumTracks;
   int32_t FirstTrack;
@@ -97,10 +143,25 @@ class CDAccess_CHD final : public CDAccess
   int num_tracks;
 
   chd_file *chd;
-  /* hunk data cache */
-  uint8_t *hunkmem;
-  /* last hunknum read */
-  int oldhunk;
+  uint32_t hunkbytes;
+  int32_t totalhunks;
+
+  /* decompressed hunk cache, entries & prefetch state are guarded by cache_mutex */
+  std::vector<HunkCacheEntry> hunk_cache;
+  uint64_t use_counter = 0;
+  int32_t last_hunk = -1;
+  int32_t read_direction = 1;
+  unsigned sequential_hunks = 0;
+  unsigned prefetch_hunks;
+  std::deque<int32_t> prefetch_queue;
+  bool prefetch_quit = false;
+  HunkCacheStats cache_stats{};
+  std::mutex cache_mutex;
+  std::condition_variable hunk_loaded_cond;
+  std::condition_variable prefetch_cond;
+  /* libchdr's decompressors aren't thread-safe, chd_read() is serialized with this */
+  std::mutex chd_mutex;
+  std::thread prefetch_thread;
 };
 
 }
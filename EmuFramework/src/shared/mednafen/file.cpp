@@ -221,15 +221,16 @@ void MDFNFILE::Close(void) noexcept
 
 static INLINE void MDFN_DumpToFileReal(const std::string& path, const std::vector<PtrLengthPair> &pearpairs)
 {
- FileStream fp(path, FileStream::MODE_WRITE_INPLACE);
+ std::vector<uint8> data;
 
  for(unsigned int i = 0; i < pearpairs.size(); i++)
  {
-  fp.write(pearpairs[i].GetData(), pearpairs[i].GetLength());
+  const uint8* p = (const uint8*)pearpairs[i].GetData();
+
+  data.insert(data.end(), p, p + pearpairs[i].GetLength());
  }
 
- fp.truncate(fp.tell());
- fp.close();
+ MDFND_DumpToFile(path, data.data(), data.size());
 }
 
 bool MDFN_DumpToFile(const std::string& path, const std::vector<PtrLengthPair> &pearpairs, bool throw_on_error)
@@ -552,6 +552,11 @@ struct GameFile
   const std::string dir;
   const std::string fbase;
  } outside;
+
+ // EmuEx: digests of the stream's data starting at digest_offset if already computed by the driver code, otherwise null.
+ const uint8* const md5{};
+ const uint32* const crc32{};
+ const uint64 digest_offset{};
 };
 
 struct DesiredInputType
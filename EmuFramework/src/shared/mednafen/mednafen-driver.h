@@ -65,6 +65,9 @@ void MDFN_printf(const char *format, ...) noexcept MDFN_FORMATSTR(gnu_printf, 1,
 // MDFN_NOTICE_ERROR may block(e.g. for user confirmation), other notice types should be as non-blocking as possible.
 void MDFND_OutputNotice(MDFN_NoticeType t, const char* s) noexcept;
 
+// Called by MDFN_DumpToFile() with the concatenated data, the driver can write it asynchronously.
+void MDFND_DumpToFile(const std::string& path, const void *data, uint64 length);
+
 // Output from MDFN_printf(); fairly verbose informational messages.
 void MDFND_OutputInfo(const char* s) noexcept;
 
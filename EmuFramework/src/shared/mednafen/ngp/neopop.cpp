@@ -187,10 +187,15 @@ static MDFN_COLD void Load(GameFile* gf)
   ngpc_rom.data = new uint8[ngpc_rom.length];
   gf->stream->read(ngpc_rom.data, ngpc_rom.length);
 
-  md5_context md5;
-  md5.starts();
-  md5.update(ngpc_rom.data, ngpc_rom.length);
-  md5.finish(MDFNGameInfo->MD5);
+  if(gf->md5 && !gf->digest_offset)
+   memcpy(MDFNGameInfo->MD5, gf->md5, sizeof(MDFNGameInfo->MD5));
+  else
+  {
+   md5_context md5;
+   md5.starts();
+   md5.update(ngpc_rom.data, ngpc_rom.length);
+   md5.finish(MDFNGameInfo->MD5);
+  }
 
   rom_loaded();
   MDFN_printf(_("ROM:       %uKiB\n"), (ngpc_rom.length + 1023) / 1024);
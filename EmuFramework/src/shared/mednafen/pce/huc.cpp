@@ -209,7 +209,7 @@ static void LoadSaveMemory(const std::string& path, uint8* const data, const uin
  }
 }
 
-uint32 HuC_Load(Stream* s, bool DisableBRAM, SysCardType syscard)
+uint32 HuC_Load(Stream* s, bool DisableBRAM, SysCardType syscard, const GameFile* gf)
 {
  uint32 crc = 0;
  const uint32 sf2_threshold = 2048 * 1024;
@@ -222,6 +222,7 @@ uint32 HuC_Load(Stream* s, bool DisableBRAM, SysCardType syscard)
   uint64 len, m_len;
 
   len = s->size();
+  const uint64 header_len = len & 512;
   if(len & 512)	// Skip copier header.
   {
    len &= ~512;
@@ -259,6 +260,9 @@ uint32 HuC_Load(Stream* s, bool DisableBRAM, SysCardType syscard)
    //printf("%d %d, %02x\n", len, m_len, HuCSF2BankMask);
   }
 
+  // EmuEx: use the driver's digests if they cover the same data
+  const bool use_gf_digest = gf && gf->digest_offset == header_len && m_len >= len;
+
   IsPopulous = 0;
   PCE_IsCD = 0;
 
@@ -313,14 +317,22 @@ uint32 HuC_Load(Stream* s, bool DisableBRAM, SysCardType syscard)
   HuCROM = new uint8[m_len];
   memset(HuCROM, 0xFF, m_len);
   s->read(HuCROM, std::min<uint64>(m_len, len));
-  crc = crc32(0, HuCROM, std::min<uint64>(m_len, len));
+  if(use_gf_digest && gf->crc32)
+   crc = *gf->crc32;
+  else
+   crc = crc32(0, HuCROM, std::min<uint64>(m_len, len));
 
   if(syscard == SYSCARD_NONE)
   {
-   md5_context md5;
-   md5.starts();
-   md5.update(HuCROM, std::min<uint64>(m_len, len));
-   md5.finish(MDFNGameInfo->MD5);
+   if(use_gf_digest && gf->md5)
+    memcpy(MDFNGameInfo->MD5, gf->md5, sizeof(MDFNGameInfo->MD5));
+   else
+   {
+    md5_context md5;
+    md5.starts();
+    md5.update(HuCROM, std::min<uint64>(m_len, len));
+    md5.finish(MDFNGameInfo->MD5);
+   }
 
    MDFN_printf(_("ROM:       %lluKiB\n"), (unsigned long long)(std::min<uint64>(m_len, len) / 1024));
    MDFN_printf(_("ROM CRC32: 0x%08x\n"), crc);
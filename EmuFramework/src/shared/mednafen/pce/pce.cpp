@@ -375,7 +375,7 @@ static MDFN_COLD void Load(GameFile* gf)
   {
    uint32 crc;
 
-   crc = HuC_Load(gf->stream, MDFN_GetSettingB("pce.disable_bram_hucard"));
+   crc = HuC_Load(gf->stream, MDFN_GetSettingB("pce.disable_bram_hucard"), SYSCARD_NONE, gf);
 
    if(gf->ext == "sgx")
     IsSGX = true;
@@ -145,7 +145,7 @@ static void LoadSaveMemory(const std::string& path, uint8* const data, const uin
  }
 }
 
-uint32 HuC_Load(Stream* fp)
+uint32 HuC_Load(Stream* fp, const GameFile* gf)
 {
  uint32 crc = 0;
 
@@ -154,6 +154,7 @@ uint32 HuC_Load(Stream* fp)
   uint32 sf2_threshold = 2048 * 1024;
   uint32 sf2_required_size = 2048 * 1024 + 512 * 1024;
   uint64 len = fp->size();
+  const uint64 header_len = len & 512;
 
   if(len & 512) // Skip copier header.
   {
@@ -180,12 +181,22 @@ uint32 HuC_Load(Stream* fp)
   memset(HuCROM, 0xFF, m_len);
   fp->read(HuCROM, std::min<uint64>(m_len, len));
 
-  md5_context md5;
-  md5.starts();
-  md5.update(HuCROM, std::min<uint64>(m_len, len));
-  md5.finish(MDFNGameInfo->MD5);
+  // EmuEx: use the driver's digests if they cover the same data
+  const bool use_gf_digest = gf && gf->digest_offset == header_len && m_len >= len;
+  if(use_gf_digest && gf->md5)
+   memcpy(MDFNGameInfo->MD5, gf->md5, sizeof(MDFNGameInfo->MD5));
+  else
+  {
+   md5_context md5;
+   md5.starts();
+   md5.update(HuCROM, std::min<uint64>(m_len, len));
+   md5.finish(MDFNGameInfo->MD5);
+  }
 
-  crc = crc32(0, HuCROM, std::min<uint64>(m_len, len));
+  if(use_gf_digest && gf->crc32)
+   crc = *gf->crc32;
+  else
+   crc = crc32(0, HuCROM, std::min<uint64>(m_len, len));
 
   MDFN_printf(_("ROM:       %lluKiB\n"), (unsigned long long)(std::min<uint64>(m_len, len) / 1024));
   MDFN_printf(_("ROM CRC32: 0x%04x\n"), crc);
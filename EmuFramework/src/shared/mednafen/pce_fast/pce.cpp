@@ -252,7 +252,7 @@ static MDFN_COLD void Load(GameFile* gf)
   {
    uint32 crc;
 
-   crc = HuC_Load(gf->stream);
+   crc = HuC_Load(gf->stream, gf);
 
    if(gf->ext == "sgx")
     IsSGX = true;
@@ -27,6 +27,8 @@ gba/EEprom.cpp \
 gba/Flash.cpp \
 gba/GBA-arm.cpp \
 gba/GBA.cpp \
+gba/GBAComposite.cpp \
+gba/GBALocalLink.cpp \
 gba/gbafilter.cpp \
 gba/RTC.cpp \
 gba/Sound.cpp \
@@ -184,7 +184,8 @@ struct GBAMem
 	IoMem ioMem;
 	uint8_t internalRAM[0x8000] __attribute__ ((aligned(4)));
 	uint8_t workRAM[0x40000] __attribute__ ((aligned(4)));
-	uint8_t rom[0x2000000] __attribute__ ((aligned(4)));
+	// page aligned so the content's file mapping can replace these pages, see FileUtils::mapOrRead()
+	uint8_t rom[0x2000000] __attribute__ ((aligned(0x4000)));
 };
 
 struct GBADMA
@@ -277,6 +278,19 @@ struct GBALCD
 	int layerEnableDelay{};
 	int lcdTicks{};
 	uint16_t gfxLastVCOUNT{};
+	// source of the last line drawn into line0-3 by each text BG, see gfxDrawTextScreenCached()
+	uint64_t gfxTextLineKey[4]{};
+	// set when VRAM, palette RAM or the line buffers change outside of the text BG renderer
+	bool gfxTextLinesDirty{true};
+
+	void updateTextLineCache()
+	{
+		if(!gfxTextLinesDirty)
+			return;
+		gfxTextLinesDirty = false;
+		for(auto &key : gfxTextLineKey)
+			key = 0;
+	}
 
 	void registerRamReset(uint32_t flags)
 	{
@@ -292,6 +306,7 @@ struct GBALCD
       // clean OAM
       memset(oam, 0, 0x400);
     }
+    gfxTextLinesDirty = true;
 	}
 
 	void reset()
@@ -300,6 +315,7 @@ struct GBALCD
 		memset(vram, 0, sizeof(vram));
 		memset(oam, 0, sizeof(oam));
 		memset(pix, 0, sizeof(pix));
+		gfxTextLinesDirty = true;
 	}
 
 	void resetAll(bool useBios, bool skipBios, GBAMem::IoMem &ioMem)
@@ -16,12 +16,15 @@
 #define LOGTAG "main"
 #include <emuframework/EmuAppInlines.hh>
 #include <emuframework/EmuSystemInlines.hh>
+#include <emuframework/zlibUtils.hh>
 #include <imagine/fs/FS.hh>
 #include <imagine/io/FileIO.hh>
 #include <imagine/util/format.hh>
 #include <imagine/util/string.h>
+#include <imagine/vmem/memory.hh>
 #include <vbam/gba/GBA.h>
 #include <vbam/gba/GBAGfx.h>
+#include <vbam/gba/GBALocalLink.h>
 #include <vbam/gba/Sound.h>
 #include <vbam/gba/RTC.h>
 #include <vbam/common/SoundDriver.h>
@@ -35,6 +38,7 @@ namespace EmuEx
 const char *EmuSystem::creditsViewStr = CREDITS_INFO_STRING "(c) 2012-2022\nRobert Broglia\nwww.explusalpha.com\n\nPortions (c) the\nVBA-m Team\nvba-m.com";
 bool EmuSystem::hasBundledGames = true;
 bool EmuSystem::hasCheats = true;
+bool EmuSystem::hasRunAhead = true;
 bool EmuApp::needsGlobalInstance = true;
 constexpr IG::WP lcdSize{240, 160};
 
@@ -75,29 +79,44 @@ FS::FileString GbaSystem::stateFilename(int slot, std::string_view name) const
 	return IG::format<FS::FileString>("{}{}.sgm", name, saveSlotChar(slot));
 }
 
-void GbaSystem::saveState(IG::CStringView path)
+// memgzio prefixes its gzip data with an 8 byte header holding the data size,
+// it's stripped from the state data so the data matches the regular gzip file format
+static constexpr size_t memGzHeaderSize = 8;
+// uncompressed state data is under 1MiB even with all optional hardware in use
+static constexpr size_t maxStateSize = gzipCompressBound(0x100000) + memGzHeaderSize;
+
+size_t GbaSystem::stateSize() { return maxStateSize; }
+
+void GbaSystem::readState(EmuApp &, std::span<const uint8_t> buff)
 {
-	if(!CPUWriteState(appContext(), gGba, path))
-		return throwFileWriteError();
+	auto memGzBuff = std::make_unique_for_overwrite<char[]>(buff.size() + memGzHeaderSize);
+	memcpy(memGzBuff.get(), "VBA ", 4);
+	int size = buff.size();
+	memcpy(&memGzBuff[4], &size, sizeof(size));
+	memcpy(&memGzBuff[memGzHeaderSize], buff.data(), buff.size());
+	if(!CPUReadMemState(gGba, memGzBuff.get(), buff.size() + memGzHeaderSize))
+		throw std::runtime_error("Invalid state data");
 }
 
-void GbaSystem::loadState(EmuApp &app, IG::CStringView path)
+size_t GbaSystem::writeState(std::span<uint8_t> buff, SaveStateFlags flags)
 {
-	if(!CPUReadState(app.appContext(), gGba, path))
-		return throwFileReadError();
+	long reserved{};
+	if(!CPUWriteMemState(gGba, (char*)buff.data(), buff.size(), reserved, !to_underlying(flags & SaveStateFlags::uncompressed)))
+		throw std::runtime_error("State buffer too small");
+	int size;
+	memcpy(&size, &buff[4], sizeof(size));
+	memmove(buff.data(), &buff[memGzHeaderSize], size);
+	return size;
 }
 
 void GbaSystem::loadBackupMemory(EmuApp &app)
 {
 	if(coreOptions.saveType == GBA_SAVE_NONE)
 		return;
-	if(!saveFileIO)
-		saveFileIO = staticBackupMemoryFile(app.contentSaveFilePath(".sav"), saveMemorySize(), 0xFF);
+	auto saveFileIO = staticBackupMemoryFile(app.contentSaveFilePath(".sav"), saveMemorySize(), 0xFF);
 	if(!saveFileIO)
 		throw std::runtime_error("Error accessing .sav file, please verify it has write access");
 	auto buff = saveFileIO.buffer(IOBufferMode::Release);
-	if(buff.isMappedFile())
-		saveFileIO = {};
 	saveMemoryIsMappedFile = buff.isMappedFile();
 	setSaveMemory(std::move(buff));
 }
@@ -109,13 +128,14 @@ void GbaSystem::onFlushBackupMemory(EmuApp &app, BackupMemoryDirtyFlags)
 	const ByteBuffer &saveData = eepromInUse ? eepromData : flashSaveMemory;
 	if(saveMemoryIsMappedFile)
 	{
+		// only schedule the write-back so the calling thread doesn't wait on storage
 		logMsg("flushing backup memory");
-		msync(saveData.data(), saveData.size(), MS_SYNC);
+		msync(saveData.data(), saveData.size(), MS_ASYNC);
 	}
 	else
 	{
 		logMsg("saving backup memory");
-		saveFileIO.write(saveData.span(), 0);
+		app.saveBackupMemory(app.contentSaveFilePath(".sav"), saveData.span());
 	}
 }
 
@@ -128,7 +148,8 @@ void GbaSystem::closeSystem()
 {
 	assert(hasContent());
 	CPUCleanUp();
-	saveFileIO = {};
+	// drop the content's file mapping & any patched pages
+	IG::resetVMem(gGba.mem.rom, sizeof(gGba.mem.rom));
 	coreOptions.saveType = GBA_SAVE_NONE;
 	detectedRtcGame = 0;
 	detectedSensorType = {};
@@ -202,6 +223,16 @@ void GbaSystem::renderFramebuffer(EmuVideo &video)
 	systemDrawScreen({}, video);
 }
 
+std::string GbaSystem::benchmarkCore(std::span<const char * const>)
+{
+	return benchmarkGfxComposite();
+}
+
+void GbaSystem::openLocalLink(CStringView name)
+{
+	openGBALocalLink(gGba, name);
+}
+
 void GbaSystem::runFrame(EmuSystemTaskContext taskCtx, EmuVideo *video, EmuAudio *audio)
 {
 	CPULoop(gGba, taskCtx, video, audio);
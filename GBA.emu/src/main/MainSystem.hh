@@ -57,7 +57,6 @@ public:
 	[[no_unique_address]] IG::SensorListener sensorListener;
 	Byte1Option optionRtcEmulation{CFGKEY_RTC_EMULATION, std::to_underlying(RtcMode::AUTO), 0, optionIsValidWithMax<2>};
 	Byte4Option optionSaveTypeOverride{CFGKEY_SAVE_TYPE_OVERRIDE, GBA_SAVE_AUTO, 0, optionSaveTypeOverrideIsValid};
-	FileIO saveFileIO;
 	int detectedSaveSize{};
 	int sensorX{}, sensorY{}, sensorZ{};
 	float lightSensorScaleLux{lightSensorScaleLuxDefault};
@@ -83,8 +82,9 @@ public:
 	[[gnu::hot]] void runFrame(EmuSystemTaskContext task, EmuVideo *video, EmuAudio *audio);
 	FS::FileString stateFilename(int slot, std::string_view name) const;
 	std::string_view stateFilenameExt() const { return ".gqs"; }
-	void loadState(EmuApp &, CStringView uri);
-	void saveState(CStringView path);
+	size_t stateSize();
+	void readState(EmuApp &, std::span<const uint8_t> buff);
+	size_t writeState(std::span<uint8_t> buff, SaveStateFlags = {});
 	bool readConfig(ConfigType, MapIO &, unsigned key, size_t readSize);
 	void writeConfig(ConfigType, FileIO &);
 	void reset(EmuApp &, ResetMode mode);
@@ -106,6 +106,8 @@ public:
 	void closeSystem();
 	bool onVideoRenderFormatChange(EmuVideo &, IG::PixelFormat);
 	void renderFramebuffer(EmuVideo &);
+	std::string benchmarkCore(std::span<const char * const> args);
+	void openLocalLink(CStringView name);
 
 private:
 	void applyGamePatches(uint8_t *rom, int &romSize);
@@ -117,5 +119,3 @@ using MainSystem = GbaSystem;
 
 void CPULoop(GBASys &, EmuEx::EmuSystemTaskContext, EmuEx::EmuVideo *, EmuEx::EmuAudio *);
 void CPUCleanUp();
-bool CPUReadState(IG::ApplicationContext, GBASys &gba, const char *);
-bool CPUWriteState(IG::ApplicationContext, GBASys &gba, const char *);
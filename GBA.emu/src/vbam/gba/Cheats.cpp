@@ -2843,6 +2843,14 @@ static uint8_t cheatsGetType(uint32_t address)
 #endif
 
 #ifdef BKPT_SUPPORT
+// the debugger writes go through map[] instead of CPUWriteMemory(), so they also
+// need to clear the text BG line cache when they change palette RAM or VRAM
+static void cheatsMarkVideoWrite(uint32_t address)
+{
+  if ((address >> 24) == 5 || (address >> 24) == 6)
+    gGba.lcd.gfxTextLinesDirty = true;
+}
+
 void cheatsWriteMemory(uint32_t address, uint32_t value)
 {
   if (cheatsNumber == 0) {
@@ -2853,6 +2861,7 @@ void cheatsWriteMemory(uint32_t address, uint32_t value)
       cpuNextEvent = 0;
     }
     debuggerWriteMemory(address, value);
+    cheatsMarkVideoWrite(address);
   }
 }
 
@@ -2866,6 +2875,7 @@ void cheatsWriteHalfWord(uint32_t address, uint16_t value)
       cpuNextEvent = 0;
     }
     debuggerWriteHalfWord(address, value);
+    cheatsMarkVideoWrite(address);
   }
 }
 
@@ -2879,6 +2889,7 @@ void cheatsWriteByte(uint32_t address, uint8_t value)
       cpuNextEvent = 0;
     }
     debuggerWriteByte(address, value);
+    cheatsMarkVideoWrite(address);
   }
 }
 #endif
@@ -18,6 +18,7 @@
 #include "GBA.h"
 #include "GBAGfx.h"
 #include "GBALink.h"
+#include "GBALocalLink.h"
 #include "GBAcpu.h"
 #include "GBAinline.h"
 #include "Globals.h"
@@ -700,6 +701,7 @@ static void CPUUpdateRenderBuffers(GBASys &gba, bool force)
   if (!(layerEnable & 0x0800) || force) {
   	CLEAR_ARRAY(line3);
   }
+  gba.lcd.gfxTextLinesDirty = true;
 }
 
 #define CPUUpdateRenderBuffers(force) CPUUpdateRenderBuffers(gba, force)
@@ -857,25 +859,9 @@ static bool CPUWriteState(GBASys &gba, gzFile gzFile)
   return true;
 }
 
-bool CPUWriteState(IG::ApplicationContext ctx, GBASys &gba, const char* file)
+bool CPUWriteMemState(GBASys &gba, char *memory, int available, long& reserved, bool compress)
 {
-  gzFile gzFile = utilGzOpen(ctx.openFileUriFd(file, IG::OpenFlagsMask::New | IG::OpenFlagsMask::Test).release(), "wb");
-
-  if (gzFile == NULL) {
-    systemMessage(MSG_ERROR_CREATING_FILE, N_("Error creating file %s"), file);
-    return false;
-  }
-
-  bool res = CPUWriteState(gba, gzFile);
-
-  utilGzClose(gzFile);
-
-  return res;
-}
-
-bool CPUWriteMemState(GBASys &gba, char *memory, int available, long& reserved)
-{
-  gzFile gzFile = utilMemGzOpen(memory, available, "w");
+  gzFile gzFile = utilMemGzOpen(memory, available, compress ? "w" : "w0");
 
   if (gzFile == NULL) {
     return false;
@@ -1051,20 +1037,6 @@ bool CPUReadMemState(GBASys &gba, char *memory, int available)
 
   return res;
 }
-
-bool CPUReadState(IG::ApplicationContext ctx, GBASys &gba, const char * file)
-{
-  gzFile gzFile = utilGzOpen(ctx.openFileUriFd(file).release(), "rb");
-
-  if (gzFile == NULL)
-    return false;
-
-  bool res = CPUReadState(gba, gzFile);
-
-  utilGzClose(gzFile);
-
-  return res;
-}
 #endif
 
 bool CPUExportEepromFile(const char* fileName)
@@ -1730,7 +1702,7 @@ int CPULoadRomData(const char* data, int size)
 int CPULoadRomWithIO(GBASys &gba, IG::IO &io)
 {
 	preLoadRomSetup(gba);
-	romSize = io.read(rom, romSize);
+	romSize = IG::FileUtils::mapOrRead(io, {rom, (size_t)romSize});
   postLoadRomSetup(gba);
   return romSize;
 }
@@ -1799,6 +1771,8 @@ void SetSaveDotCodeFile(const char* szFile)
 
 void CPUUpdateRender(GBASys &gba)
 {
+  // a new mode may draw other layers into line0-3
+  gba.lcd.gfxTextLinesDirty = true;
   if (DISPCNT & 0x80)
   {
 	  systemMessage(0, "Set forced blank");
@@ -3074,6 +3048,8 @@ void CPUUpdateRegister(ARM7TDMI &cpu, uint32_t address, uint16_t value)
 #ifndef NO_LINK
     StartLink(value);
 #else
+    if (gbaLocalLinkActive() && gbaLocalLinkStart(gba, value))
+      break;
     if (value & 0x80) {
         value &= 0xff7f;
         if (value & 1 && (value & 0x4000)) {
@@ -4049,6 +4025,7 @@ void CPULoop(GBASys &gba, EmuEx::EmuSystemTaskContext taskCtx, EmuEx::EmuVideo *
             	else
             	{
             	}*/
+              gba.lcd.updateTextLineCache();
               (*gba.lcd.renderLine)(gba.lcd.lineMix, gba.lcd, ioMem);
             }
             if (VCOUNT == 159)
@@ -4216,6 +4193,8 @@ void CPULoop(GBASys &gba, EmuEx::EmuSystemTaskContext taskCtx, EmuEx::EmuVideo *
     if (GetLinkMode() != LINK_DISCONNECTED)
 		  LinkUpdate(clockTicks);
 #endif
+      if (gbaLocalLinkActive())
+        gbaLocalLinkUpdate(gba, clockTicks);
 
       cpuNextEvent = CPUUpdateTicks();
 
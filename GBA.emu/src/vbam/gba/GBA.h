@@ -161,7 +161,7 @@ extern void CPUCleanUp();
 extern void CPUUpdateRender(GBASys &gba);
 extern void CPUUpdateRenderBuffers(bool);
 extern bool CPUReadMemState(GBASys &gba, char *, int);
-extern bool CPUWriteMemState(GBASys &gba, char *, int);
+extern bool CPUWriteMemState(GBASys &gba, char *, int, long &reserved, bool compress = true);
 #ifdef __LIBRETRO__
 extern bool CPUReadState(const uint8_t*);
 extern unsigned int CPUWriteState(uint8_t* data, unsigned int size);
@@ -0,0 +1,745 @@
+#include <chrono>
+#include <cstdio>
+#include <memory>
+#include <random>
+#include <vector>
+
+#include "GBA.h"
+#include "GBAGfx.h"
+#include "Globals.h"
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#define GBA_COMPOSITE_AVX2
+#elif defined(__aarch64__)
+#include <arm_neon.h>
+#define GBA_COMPOSITE_NEON
+#endif
+
+// Layer mixing of the modeNRenderLine functions. Each pixel picks the layer with
+// the lowest priority byte among BG0-3, OBJ and the backdrop, then applies OBJ
+// semi-transparency and the BLDMOD effect if the window allows it. The SIMD
+// versions compute the same selections with masks over 8 pixels at a time and do
+// the blend arithmetic on 16-bit colors, so their output is identical.
+
+struct CompositeLine {
+  const uint32_t* line[5]; // enabled layers in mixing order, BGs first and OBJ last
+  uint8_t bit[5];
+  int layers;
+  int bgLayers;
+  uint32_t backdrop;
+  uint32_t bldmod;
+  int effect;
+  int ca, cb, cy;
+  // only used by GfxCompositeType::all
+  const uint32_t* lineOBJWin;
+  const bool* inWin0;
+  const bool* inWin1;
+  bool inWindow0, inWindow1;
+  uint8_t outMask, objWinMask, win0Mask, win1Mask;
+};
+
+static bool useSIMD = true; // cleared by the benchmark to time the scalar version
+
+static bool gfxInWindowV(uint16_t winV, uint16_t VCOUNT)
+{
+  uint8_t v0 = winV >> 8;
+  uint8_t v1 = winV & 255;
+  bool inWindow = ((v0 == v1) && (v0 >= 0xe8));
+  if (v1 >= v0)
+    inWindow |= (VCOUNT >= v0 && VCOUNT < v1);
+  else
+    inWindow |= (VCOUNT >= v0 || VCOUNT < v1);
+  return inWindow;
+}
+
+static CompositeLine makeCompositeLine(const GBALCD& lcd, const GBAMem::IoMem& ioMem,
+                                       GfxCompositeType type, unsigned bgLayers)
+{
+  CompositeLine c{};
+  const uint16_t* palette = (const uint16_t*)lcd.paletteRAM;
+  if (customBackdropColor == -1) {
+    c.backdrop = (READ16LE(&palette[0]) | 0x30000000);
+  } else {
+    c.backdrop = ((customBackdropColor & 0x7FFF) | 0x30000000);
+  }
+
+  // disabled layers can be skipped since CPUUpdateRenderBuffers() and
+  // gfxDrawSprites() leave their lines transparent
+  const uint32_t* bgLines[4]{lcd.line0, lcd.line1, lcd.line2, lcd.line3};
+  unsigned enabledBGs = bgLayers & (lcd.layerEnable >> 8);
+  for (int i = 0; i < 4; i++) {
+    if (enabledBGs & (1 << i)) {
+      c.line[c.layers] = bgLines[i];
+      c.bit[c.layers] = 1 << i;
+      c.layers++;
+    }
+  }
+  c.bgLayers = c.layers;
+  if (lcd.layerEnable & 0x1000) {
+    c.line[c.layers] = lcd.lineOBJ;
+    c.bit[c.layers] = 0x10;
+    c.layers++;
+  }
+
+  c.bldmod = ioMem.BLDMOD;
+  c.effect = (ioMem.BLDMOD >> 6) & 3;
+  c.ca = coeff[ioMem.COLEV & 0x1F];
+  c.cb = coeff[(ioMem.COLEV >> 8) & 0x1F];
+  c.cy = coeff[ioMem.COLY & 0x1F];
+
+  if (type == GfxCompositeType::all) {
+    c.lineOBJWin = lcd.lineOBJWin;
+    c.inWin0 = lcd.gfxInWin0;
+    c.inWin1 = lcd.gfxInWin1;
+    c.inWindow0 = (lcd.layerEnable & 0x2000) && gfxInWindowV(ioMem.WIN0V, ioMem.VCOUNT);
+    c.inWindow1 = (lcd.layerEnable & 0x4000) && gfxInWindowV(ioMem.WIN1V, ioMem.VCOUNT);
+    c.win0Mask = ioMem.WININ & 0xFF;
+    c.win1Mask = ioMem.WININ >> 8;
+    c.outMask = ioMem.WINOUT & 0xFF;
+    c.objWinMask = ioMem.WINOUT >> 8;
+  }
+  return c;
+}
+
+template <GfxCompositeType type>
+static void compositeLineScalar(MixColorType* lineMix, const CompositeLine& c)
+{
+  for (int x = 0; x < 240; x++) {
+    uint8_t mask = 0x3F;
+    if constexpr (type == GfxCompositeType::all) {
+      mask = c.outMask;
+      if (!(c.lineOBJWin[x] & 0x80000000))
+        mask = c.objWinMask;
+      if (c.inWindow1 && c.inWin1[x])
+        mask = c.win1Mask;
+      if (c.inWindow0 && c.inWin0[x])
+        mask = c.win0Mask;
+    }
+
+    uint32_t color = c.backdrop;
+    uint8_t top = 0x20;
+    for (int i = 0; i < c.layers; i++) {
+      if ((mask & c.bit[i]) && (uint8_t)(c.line[i][x] >> 24) < (uint8_t)(color >> 24)) {
+        color = c.line[i][x];
+        top = c.bit[i];
+      }
+    }
+
+    bool semiTransparent = color & 0x00010000;
+    if constexpr (type == GfxCompositeType::normal)
+      semiTransparent = semiTransparent && (top & 0x10);
+
+    if (semiTransparent) {
+      // semi-transparent OBJ
+      uint32_t back = c.backdrop;
+      uint8_t top2 = 0x20;
+      for (int i = 0; i < c.bgLayers; i++) {
+        if ((mask & c.bit[i]) && (uint8_t)(c.line[i][x] >> 24) < (uint8_t)(back >> 24)) {
+          back = c.line[i][x];
+          top2 = c.bit[i];
+        }
+      }
+
+      if (top2 & (c.bldmod >> 8))
+        color = gfxAlphaBlend(color, back, c.ca, c.cb);
+      else if (c.effect == 2 && (c.bldmod & top))
+        color = gfxIncreaseBrightness(color, c.cy);
+      else if (c.effect == 3 && (c.bldmod & top))
+        color = gfxDecreaseBrightness(color, c.cy);
+    } else if (type != GfxCompositeType::normal && (mask & 32)) {
+      // special FX on in the window
+      switch (c.effect) {
+      case 0:
+        break;
+      case 1: {
+          if (top & c.bldmod) {
+            uint32_t back = c.backdrop;
+            uint8_t top2 = 0x20;
+            for (int i = 0; i < c.layers; i++) {
+              if ((mask & c.bit[i]) && top != c.bit[i] &&
+                  (uint8_t)(c.line[i][x] >> 24) < (uint8_t)(back >> 24)) {
+                back = c.line[i][x];
+                top2 = c.bit[i];
+              }
+            }
+
+            if (top2 & (c.bldmod >> 8))
+              color = gfxAlphaBlend(color, back, c.ca, c.cb);
+          }
+        } break;
+      case 2:
+        if (c.bldmod & top)
+          color = gfxIncreaseBrightness(color, c.cy);
+        break;
+      case 3:
+        if (c.bldmod & top)
+          color = gfxDecreaseBrightness(color, c.cy);
+        break;
+      }
+    }
+
+    lineMix[x] = color;
+  }
+}
+
+#ifdef GBA_COMPOSITE_AVX2
+static bool cpuHasAVX2()
+{
+  static const bool hasAVX2 = __builtin_cpu_supports("avx2");
+  return hasAVX2;
+}
+
+struct CompositeAVX2 {
+  __m256i color, back, alphaSel, brightSel;
+};
+
+[[gnu::target("avx2")]]
+static inline __m256i nonZeroAVX2(__m256i v)
+{
+  return _mm256_xor_si256(_mm256_cmpeq_epi32(v, _mm256_setzero_si256()), _mm256_set1_epi32(-1));
+}
+
+// 8 pixels of the scalar loop, returning the top color, the second target for
+// alpha blending and which pixels need alpha blending or the brightness effect
+template <GfxCompositeType type>
+[[gnu::target("avx2")]]
+static inline CompositeAVX2 composite8AVX2(const CompositeLine& c, int x)
+{
+  const __m256i zero = _mm256_setzero_si256();
+  __m256i mask = _mm256_set1_epi32(0x3F);
+  if constexpr (type == GfxCompositeType::all) {
+    __m256i outOBJWin = _mm256_srai_epi32(_mm256_loadu_si256((const __m256i*)&c.lineOBJWin[x]), 31);
+    mask = _mm256_blendv_epi8(_mm256_set1_epi32(c.objWinMask), _mm256_set1_epi32(c.outMask), outOBJWin);
+    if (c.inWindow1) {
+      __m256i inWin = _mm256_cvtepu8_epi32(_mm_loadl_epi64((const __m128i*)&c.inWin1[x]));
+      mask = _mm256_blendv_epi8(mask, _mm256_set1_epi32(c.win1Mask), _mm256_cmpgt_epi32(inWin, zero));
+    }
+    if (c.inWindow0) {
+      __m256i inWin = _mm256_cvtepu8_epi32(_mm_loadl_epi64((const __m128i*)&c.inWin0[x]));
+      mask = _mm256_blendv_epi8(mask, _mm256_set1_epi32(c.win0Mask), _mm256_cmpgt_epi32(inWin, zero));
+    }
+  }
+
+  __m256i layerOn[5];
+  __m256i color = _mm256_set1_epi32(c.backdrop);
+  __m256i prio = _mm256_set1_epi32(c.backdrop >> 24);
+  __m256i top = _mm256_set1_epi32(0x20);
+  for (int i = 0; i < c.layers; i++) {
+    __m256i bit = _mm256_set1_epi32(c.bit[i]);
+    __m256i layer = _mm256_loadu_si256((const __m256i*)&c.line[i][x]);
+    __m256i layerPrio = _mm256_srli_epi32(layer, 24);
+    __m256i sel = _mm256_cmpgt_epi32(prio, layerPrio);
+    if constexpr (type == GfxCompositeType::all) {
+      layerOn[i] = _mm256_cmpeq_epi32(_mm256_and_si256(mask, bit), bit);
+      sel = _mm256_and_si256(sel, layerOn[i]);
+    }
+    color = _mm256_blendv_epi8(color, layer, sel);
+    prio = _mm256_blendv_epi8(prio, layerPrio, sel);
+    top = _mm256_blendv_epi8(top, bit, sel);
+  }
+
+  const __m256i secondTarget = _mm256_set1_epi32(c.bldmod >> 8);
+  __m256i semi = _mm256_cmpeq_epi32(_mm256_and_si256(color, _mm256_set1_epi32(0x10000)), _mm256_set1_epi32(0x10000));
+  if constexpr (type == GfxCompositeType::normal)
+    semi = _mm256_and_si256(semi, _mm256_cmpeq_epi32(top, _mm256_set1_epi32(0x10)));
+
+  CompositeAVX2 r{color, color, zero, zero};
+  if (!_mm256_testz_si256(semi, semi)) {
+    // semi-transparent OBJ
+    __m256i back = _mm256_set1_epi32(c.backdrop);
+    __m256i backPrio = _mm256_set1_epi32(c.backdrop >> 24);
+    __m256i top2 = _mm256_set1_epi32(0x20);
+    for (int i = 0; i < c.bgLayers; i++) {
+      __m256i layer = _mm256_loadu_si256((const __m256i*)&c.line[i][x]);
+      __m256i layerPrio = _mm256_srli_epi32(layer, 24);
+      __m256i sel = _mm256_cmpgt_epi32(backPrio, layerPrio);
+      if constexpr (type == GfxCompositeType::all)
+        sel = _mm256_and_si256(sel, layerOn[i]);
+      back = _mm256_blendv_epi8(back, layer, sel);
+      backPrio = _mm256_blendv_epi8(backPrio, layerPrio, sel);
+      top2 = _mm256_blendv_epi8(top2, _mm256_set1_epi32(c.bit[i]), sel);
+    }
+    r.back = back;
+    r.alphaSel = _mm256_and_si256(semi, nonZeroAVX2(_mm256_and_si256(top2, secondTarget)));
+    if (c.effect >= 2)
+      r.brightSel = _mm256_andnot_si256(r.alphaSel, semi);
+  }
+
+  if constexpr (type != GfxCompositeType::normal) {
+    // special FX on in the window
+    __m256i fx = _mm256_andnot_si256(semi, _mm256_set1_epi32(-1));
+    if constexpr (type == GfxCompositeType::all)
+      fx = _mm256_and_si256(fx, _mm256_cmpeq_epi32(_mm256_and_si256(mask, _mm256_set1_epi32(32)), _mm256_set1_epi32(32)));
+    if (c.effect == 1) {
+      __m256i fxAlpha = _mm256_and_si256(fx, nonZeroAVX2(_mm256_and_si256(top, _mm256_set1_epi32(c.bldmod))));
+      if (!_mm256_testz_si256(fxAlpha, fxAlpha)) {
+        __m256i back = _mm256_set1_epi32(c.backdrop);
+        __m256i backPrio = _mm256_set1_epi32(c.backdrop >> 24);
+        __m256i top2 = _mm256_set1_epi32(0x20);
+        for (int i = 0; i < c.layers; i++) {
+          __m256i bit = _mm256_set1_epi32(c.bit[i]);
+          __m256i layer = _mm256_loadu_si256((const __m256i*)&c.line[i][x]);
+          __m256i layerPrio = _mm256_srli_epi32(layer, 24);
+          __m256i sel = _mm256_andnot_si256(_mm256_cmpeq_epi32(top, bit), _mm256_cmpgt_epi32(backPrio, layerPrio));
+          if constexpr (type == GfxCompositeType::all)
+            sel = _mm256_and_si256(sel, layerOn[i]);
+          back = _mm256_blendv_epi8(back, layer, sel);
+          backPrio = _mm256_blendv_epi8(backPrio, layerPrio, sel);
+          top2 = _mm256_blendv_epi8(top2, bit, sel);
+        }
+        fxAlpha = _mm256_and_si256(fxAlpha, nonZeroAVX2(_mm256_and_si256(top2, secondTarget)));
+        r.back = _mm256_blendv_epi8(r.back, back, fxAlpha);
+        r.alphaSel = _mm256_or_si256(r.alphaSel, fxAlpha);
+      }
+    } else if (c.effect >= 2) {
+      r.brightSel = _mm256_or_si256(r.brightSel, fx);
+    }
+  }
+  if (c.effect >= 2)
+    r.brightSel = _mm256_and_si256(r.brightSel, nonZeroAVX2(_mm256_and_si256(top, _mm256_set1_epi32(c.bldmod))));
+  return r;
+}
+
+[[gnu::target("avx2")]]
+static inline __m256i packColorsAVX2(__m256i lo, __m256i hi)
+{
+  const __m256i lowHalf = _mm256_set1_epi32(0xFFFF);
+  return _mm256_permute4x64_epi64(_mm256_packus_epi32(_mm256_and_si256(lo, lowHalf), _mm256_and_si256(hi, lowHalf)), 0xD8);
+}
+
+[[gnu::target("avx2")]]
+static inline __m256i packMasksAVX2(__m256i lo, __m256i hi)
+{
+  return _mm256_permute4x64_epi64(_mm256_packs_epi32(lo, hi), 0xD8);
+}
+
+// gfxAlphaBlend() on each 5-bit channel
+[[gnu::target("avx2")]]
+static inline __m256i alphaBlendAVX2(__m256i a, __m256i b, __m256i ca, __m256i cb)
+{
+  const __m256i c31 = _mm256_set1_epi16(31);
+  __m256i out = _mm256_setzero_si256();
+  for (int shift = 0; shift <= 10; shift += 5) {
+    __m256i ch = _mm256_and_si256(_mm256_srli_epi16(a, shift), c31);
+    __m256i ch2 = _mm256_and_si256(_mm256_srli_epi16(b, shift), c31);
+    ch = _mm256_add_epi16(_mm256_mullo_epi16(ch, ca), _mm256_mullo_epi16(ch2, cb));
+    out = _mm256_or_si256(out, _mm256_slli_epi16(_mm256_min_epu16(_mm256_srli_epi16(ch, 4), c31), shift));
+  }
+  return out;
+}
+
+// gfxIncreaseBrightness() & gfxDecreaseBrightness() on each 5-bit channel
+[[gnu::target("avx2")]]
+static inline __m256i brightnessAVX2(__m256i a, __m256i cy, bool increase)
+{
+  const __m256i c31 = _mm256_set1_epi16(31);
+  __m256i out = _mm256_setzero_si256();
+  for (int shift = 0; shift <= 10; shift += 5) {
+    __m256i ch = _mm256_and_si256(_mm256_srli_epi16(a, shift), c31);
+    if (increase)
+      ch = _mm256_add_epi16(ch, _mm256_srli_epi16(_mm256_mullo_epi16(_mm256_sub_epi16(c31, ch), cy), 4));
+    else
+      ch = _mm256_sub_epi16(ch, _mm256_srli_epi16(_mm256_mullo_epi16(ch, cy), 4));
+    out = _mm256_or_si256(out, _mm256_slli_epi16(ch, shift));
+  }
+  return out;
+}
+
+template <GfxCompositeType type>
+[[gnu::target("avx2")]]
+static void compositeLineAVX2(MixColorType* lineMix, const CompositeLine& c)
+{
+  const __m256i ca = _mm256_set1_epi16(c.ca);
+  const __m256i cb = _mm256_set1_epi16(c.cb);
+  const __m256i cy = _mm256_set1_epi16(c.cy);
+  for (int x = 0; x < 240; x += 16) {
+    CompositeAVX2 lo = composite8AVX2<type>(c, x);
+    CompositeAVX2 hi = composite8AVX2<type>(c, x + 8);
+    __m256i color = packColorsAVX2(lo.color, hi.color);
+    __m256i alphaSel = packMasksAVX2(lo.alphaSel, hi.alphaSel);
+    __m256i brightSel = packMasksAVX2(lo.brightSel, hi.brightSel);
+    if (!_mm256_testz_si256(alphaSel, alphaSel)) {
+      __m256i back = packColorsAVX2(lo.back, hi.back);
+      color = _mm256_blendv_epi8(color, alphaBlendAVX2(color, back, ca, cb), alphaSel);
+    }
+    if (!_mm256_testz_si256(brightSel, brightSel)) {
+      color = _mm256_blendv_epi8(color, brightnessAVX2(color, cy, c.effect == 2), brightSel);
+    }
+    _mm256_storeu_si256((__m256i*)&lineMix[x], color);
+  }
+}
+#endif
+
+#ifdef GBA_COMPOSITE_NEON
+struct CompositeNEON {
+  uint32x4_t color, back, alphaSel, brightSel;
+};
+
+static inline uint32x4_t nonZeroNEON(uint32x4_t v)
+{
+  return vtstq_u32(v, v);
+}
+
+static inline bool anySetNEON(uint32x4_t v)
+{
+  return vmaxvq_u32(v);
+}
+
+// 4 pixels of the scalar loop, inWin0/1 hold the gfxInWin0/1 values as 0 or 1
+template <GfxCompositeType type>
+static inline CompositeNEON composite4NEON(const CompositeLine& c, int x, uint32x4_t inWin0, uint32x4_t inWin1)
+{
+  const uint32x4_t zero = vdupq_n_u32(0);
+  uint32x4_t mask = vdupq_n_u32(0x3F);
+  if constexpr (type == GfxCompositeType::all) {
+    uint32x4_t outOBJWin = vreinterpretq_u32_s32(vshrq_n_s32(vreinterpretq_s32_u32(vld1q_u32(&c.lineOBJWin[x])), 31));
+    mask = vbslq_u32(outOBJWin, vdupq_n_u32(c.outMask), vdupq_n_u32(c.objWinMask));
+    if (c.inWindow1)
+      mask = vbslq_u32(vcgtq_u32(inWin1, zero), vdupq_n_u32(c.win1Mask), mask);
+    if (c.inWindow0)
+      mask = vbslq_u32(vcgtq_u32(inWin0, zero), vdupq_n_u32(c.win0Mask), mask);
+  }
+
+  uint32x4_t layerOn[5];
+  uint32x4_t color = vdupq_n_u32(c.backdrop);
+  uint32x4_t prio = vdupq_n_u32(c.backdrop >> 24);
+  uint32x4_t top = vdupq_n_u32(0x20);
+  for (int i = 0; i < c.layers; i++) {
+    uint32x4_t bit = vdupq_n_u32(c.bit[i]);
+    uint32x4_t layer = vld1q_u32(&c.line[i][x]);
+    uint32x4_t layerPrio = vshrq_n_u32(layer, 24);
+    uint32x4_t sel = vcltq_u32(layerPrio, prio);
+    if constexpr (type == GfxCompositeType::all) {
+      layerOn[i] = vtstq_u32(mask, bit);
+      sel = vandq_u32(sel, layerOn[i]);
+    }
+    color = vbslq_u32(sel, layer, color);
+    prio = vbslq_u32(sel, layerPrio, prio);
+    top = vbslq_u32(sel, bit, top);
+  }
+
+  const uint32x4_t secondTarget = vdupq_n_u32(c.bldmod >> 8);
+  uint32x4_t semi = vtstq_u32(color, vdupq_n_u32(0x10000));
+  if constexpr (type == GfxCompositeType::normal)
+    semi = vandq_u32(semi, vceqq_u32(top, vdupq_n_u32(0x10)));
+
+  CompositeNEON r{color, color, zero, zero};
+  if (anySetNEON(semi)) {
+    // semi-transparent OBJ
+    uint32x4_t back = vdupq_n_u32(c.backdrop);
+    uint32x4_t backPrio = vdupq_n_u32(c.backdrop >> 24);
+    uint32x4_t top2 = vdupq_n_u32(0x20);
+    for (int i = 0; i < c.bgLayers; i++) {
+      uint32x4_t layer = vld1q_u32(&c.line[i][x]);
+      uint32x4_t layerPrio = vshrq_n_u32(layer, 24);
+      uint32x4_t sel = vcltq_u32(layerPrio, backPrio);
+      if constexpr (type == GfxCompositeType::all)
+        sel = vandq_u32(sel, layerOn[i]);
+      back = vbslq_u32(sel, layer, back);
+      backPrio = vbslq_u32(sel, layerPrio, backPrio);
+      top2 = vbslq_u32(sel, vdupq_n_u32(c.bit[i]), top2);
+    }
+    r.back = back;
+    r.alphaSel = vandq_u32(semi, vtstq_u32(top2, secondTarget));
+    if (c.effect >= 2)
+      r.brightSel = vbicq_u32(semi, r.alphaSel);
+  }
+
+  if constexpr (type != GfxCompositeType::normal) {
+    // special FX on in the window
+    uint32x4_t fx = vmvnq_u32(semi);
+    if constexpr (type == GfxCompositeType::all)
+      fx = vandq_u32(fx, vtstq_u32(mask, vdupq_n_u32(32)));
+    if (c.effect == 1) {
+      uint32x4_t fxAlpha = vandq_u32(fx, vtstq_u32(top, vdupq_n_u32(c.bldmod)));
+      if (anySetNEON(fxAlpha)) {
+        uint32x4_t back = vdupq_n_u32(c.backdrop);
+        uint32x4_t backPrio = vdupq_n_u32(c.backdrop >> 24);
+        uint32x4_t top2 = vdupq_n_u32(0x20);
+        for (int i = 0; i < c.layers; i++) {
+          uint32x4_t bit = vdupq_n_u32(c.bit[i]);
+          uint32x4_t layer = vld1q_u32(&c.line[i][x]);
+          uint32x4_t layerPrio = vshrq_n_u32(layer, 24);
+          uint32x4_t sel = vbicq_u32(vcltq_u32(layerPrio, backPrio), vceqq_u32(top, bit));
+          if constexpr (type == GfxCompositeType::all)
+            sel = vandq_u32(sel, layerOn[i]);
+          back = vbslq_u32(sel, layer, back);
+          backPrio = vbslq_u32(sel, layerPrio, backPrio);
+          top2 = vbslq_u32(sel, bit, top2);
+        }
+        fxAlpha = vandq_u32(fxAlpha, vtstq_u32(top2, secondTarget));
+        r.back = vbslq_u32(fxAlpha, back, r.back);
+        r.alphaSel = vorrq_u32(r.alphaSel, fxAlpha);
+      }
+    } else if (c.effect >= 2) {
+      r.brightSel = vorrq_u32(r.brightSel, fx);
+    }
+  }
+  if (c.effect >= 2)
+    r.brightSel = vandq_u32(r.brightSel, nonZeroNEON(vandq_u32(top, vdupq_n_u32(c.bldmod))));
+  return r;
+}
+
+// gfxAlphaBlend() on each 5-bit channel
+static inline uint16x8_t alphaBlendNEON(uint16x8_t a, uint16x8_t b, uint16x8_t ca, uint16x8_t cb)
+{
+  const uint16x8_t c31 = vdupq_n_u16(31);
+  uint16x8_t out = vdupq_n_u16(0);
+  for (int shift = 0; shift <= 10; shift += 5) {
+    uint16x8_t ch = vandq_u16(vshlq_u16(a, vdupq_n_s16(-shift)), c31);
+    uint16x8_t ch2 = vandq_u16(vshlq_u16(b, vdupq_n_s16(-shift)), c31);
+    ch = vmlaq_u16(vmulq_u16(ch, ca), ch2, cb);
+    out = vorrq_u16(out, vshlq_u16(vminq_u16(vshrq_n_u16(ch, 4), c31), vdupq_n_s16(shift)));
+  }
+  return out;
+}
+
+// gfxIncreaseBrightness() & gfxDecreaseBrightness() on each 5-bit channel
+static inline uint16x8_t brightnessNEON(uint16x8_t a, uint16x8_t cy, bool increase)
+{
+  const uint16x8_t c31 = vdupq_n_u16(31);
+  uint16x8_t out = vdupq_n_u16(0);
+  for (int shift = 0; shift <= 10; shift += 5) {
+    uint16x8_t ch = vandq_u16(vshlq_u16(a, vdupq_n_s16(-shift)), c31);
+    if (increase)
+      ch = vaddq_u16(ch, vshrq_n_u16(vmulq_u16(vsubq_u16(c31, ch), cy), 4));
+    else
+      ch = vsubq_u16(ch, vshrq_n_u16(vmulq_u16(ch, cy), 4));
+    out = vorrq_u16(out, vshlq_u16(ch, vdupq_n_s16(shift)));
+  }
+  return out;
+}
+
+template <GfxCompositeType type>
+static void compositeLineNEON(MixColorType* lineMix, const CompositeLine& c)
+{
+  const uint16x8_t ca = vdupq_n_u16(c.ca);
+  const uint16x8_t cb = vdupq_n_u16(c.cb);
+  const uint16x8_t cy = vdupq_n_u16(c.cy);
+  uint32x4_t inWin0[2]{}, inWin1[2]{};
+  for (int x = 0; x < 240; x += 8) {
+    if constexpr (type == GfxCompositeType::all) {
+      uint16x8_t win0 = vmovl_u8(vld1_u8((const uint8_t*)&c.inWin0[x]));
+      uint16x8_t win1 = vmovl_u8(vld1_u8((const uint8_t*)&c.inWin1[x]));
+      inWin0[0] = vmovl_u16(vget_low_u16(win0));
+      inWin0[1] = vmovl_u16(vget_high_u16(win0));
+      inWin1[0] = vmovl_u16(vget_low_u16(win1));
+      inWin1[1] = vmovl_u16(vget_high_u16(win1));
+    }
+    CompositeNEON lo = composite4NEON<type>(c, x, inWin0[0], inWin1[0]);
+    CompositeNEON hi = composite4NEON<type>(c, x + 4, inWin0[1], inWin1[1]);
+    uint16x8_t color = vcombine_u16(vmovn_u32(lo.color), vmovn_u32(hi.color));
+    uint16x8_t alphaSel = vcombine_u16(vmovn_u32(lo.alphaSel), vmovn_u32(hi.alphaSel));
+    uint16x8_t brightSel = vcombine_u16(vmovn_u32(lo.brightSel), vmovn_u32(hi.brightSel));
+    if (vmaxvq_u16(alphaSel)) {
+      uint16x8_t back = vcombine_u16(vmovn_u32(lo.back), vmovn_u32(hi.back));
+      color = vbslq_u16(alphaSel, alphaBlendNEON(color, back, ca, cb), color);
+    }
+    if (vmaxvq_u16(brightSel)) {
+      color = vbslq_u16(brightSel, brightnessNEON(color, cy, c.effect == 2), color);
+    }
+    vst1q_u16(&lineMix[x], color);
+  }
+}
+#endif
+
+template <GfxCompositeType type>
+static void compositeLine(MixColorType* lineMix, const CompositeLine& c)
+{
+#if defined GBA_COMPOSITE_AVX2
+  if (useSIMD && cpuHasAVX2())
+    return compositeLineAVX2<type>(lineMix, c);
+#elif defined GBA_COMPOSITE_NEON
+  if (useSIMD)
+    return compositeLineNEON<type>(lineMix, c);
+#endif
+  compositeLineScalar<type>(lineMix, c);
+}
+
+void gfxCompositeLine(MixColorType* lineMix, const GBALCD& lcd, const GBAMem::IoMem& ioMem,
+                      GfxCompositeType type, unsigned bgLayers)
+{
+  CompositeLine c = makeCompositeLine(lcd, ioMem, type, bgLayers);
+  switch (type) {
+  case GfxCompositeType::normal:
+    compositeLine<GfxCompositeType::normal>(lineMix, c);
+    break;
+  case GfxCompositeType::noWindow:
+    compositeLine<GfxCompositeType::noWindow>(lineMix, c);
+    break;
+  case GfxCompositeType::all:
+    compositeLine<GfxCompositeType::all>(lineMix, c);
+    break;
+  }
+}
+
+// Benchmark scenes, each one sets up fixed register values over the same
+// pseudo-random VRAM, palette and OAM contents and renders whole frames with the
+// mode's render function so the BG and OBJ drawing is included. frameHash is the
+// compositeFrameHash() of the frame rendered by the per-mode loops the compositor
+// replaced, with the scenes set up in this order.
+struct CompositeTrace {
+  const char* name;
+  GBALCD::RenderLineFunc renderLine;
+  uint16_t DISPCNT;
+  uint16_t BLDMOD, COLEV, COLY;
+  uint16_t WININ, WINOUT;
+  uint16_t MOSAIC;
+  uint16_t objMode; // OBJ mode bits set on every other sprite
+  uint64_t frameHash;
+};
+
+static constexpr CompositeTrace compositeTraces[]{
+  {"mode0-4bg", mode0RenderLine, 0x1F40, 0, 0, 0, 0, 0, 0, 0, 0x4111BCC2FB9B1543},
+  {"mode0-semi-obj", mode0RenderLine, 0x1F40, 0x3F40, 0x0808, 0, 0, 0, 0, 0x0400, 0x7710A28608BAAB27},
+  {"mode0-alpha", mode0RenderLineNoWindow, 0x1F40, 0x3E41, 0x0A06, 0, 0, 0, 0, 0, 0x3E0B61C64F00A100},
+  {"mode0-fade", mode0RenderLineNoWindow, 0x1F40, 0x00FF, 0, 8, 0, 0, 0, 0x0400, 0x8CEB70C37B9771E0},
+  {"mode0-window", mode0RenderLineAll, 0xFF40, 0x3E41, 0x0A06, 0, 0x1F3F, 0x3F13, 0, 0x0800, 0xC8FAD98B566F47C8},
+  {"mode0-mosaic", mode0RenderLine, 0x1F40, 0, 0, 0, 0, 0, 0x0033, 0, 0x2077EA0D63AD6F70},
+  {"mode1-alpha", mode1RenderLineNoWindow, 0x1741, 0x3E42, 0x0C04, 0, 0, 0, 0, 0x0400, 0x1689963FD8D7EB46},
+  {"mode2-window", mode2RenderLineAll, 0x7C42, 0x3C44, 0x0808, 0, 0x1C3C, 0x3C18, 0, 0x0800, 0xE089A0DA1F72B3C3},
+  {"mode3-window", mode3RenderLineAll, 0x3443, 0x00D0, 0, 6, 0x0034, 0x0014, 0, 0x0400, 0x2972BE6AC0511921},
+  {"mode4-fade", mode4RenderLineNoWindow, 0x1444, 0x00D4, 0, 10, 0, 0, 0, 0x0400, 0xD3E67ECCFF80B41D},
+  {"mode5-semi-obj", mode5RenderLine, 0x1445, 0x3F50, 0x0A06, 0, 0, 0, 0, 0x0400, 0x0F2FF6396D86D14F},
+};
+
+static void setupCompositeTrace(GBALCD& lcd, GBAMem::IoMem& ioMem, const CompositeTrace& trace)
+{
+  std::minstd_rand rng{1};
+  // BG and OBJ tiles with about half their pixels transparent
+  for (auto& b : lcd.vram) {
+    uint8_t lo = (rng() & 1) ? rng() & 0xF : 0;
+    uint8_t hi = (rng() & 1) ? rng() & 0xF : 0;
+    b = (hi << 4) | lo;
+  }
+  // text BG maps in the last 4 screen blocks of BG VRAM
+  uint16_t* maps = (uint16_t*)&lcd.vram[28 * 0x800];
+  for (int i = 0; i < 4 * 0x400; i++)
+    maps[i] = rng() & 0xF3FF;
+  for (auto& b : lcd.paletteRAM)
+    b = rng();
+  uint16_t* sprites = (uint16_t*)lcd.oam;
+  for (int i = 0; i < 128; i++) {
+    uint16_t objMode = (i & 1) ? trace.objMode : 0;
+    if (i < 48) {
+      sprites[i * 4] = (rng() % 160) | objMode;
+      sprites[i * 4 + 1] = (rng() % 240) | 0x4000; // 16x16
+      sprites[i * 4 + 2] = (rng() & 0x3FF) | ((rng() & 3) << 10) | ((rng() & 0xF) << 12);
+    } else {
+      sprites[i * 4] = 0x0200; // disabled
+      sprites[i * 4 + 1] = 0;
+      sprites[i * 4 + 2] = 0;
+    }
+  }
+
+  ioMem = {};
+  ioMem.DISPCNT = trace.DISPCNT;
+  for (int i = 0; i < 4; i++) {
+    (&ioMem.BG0CNT)[i] = i | (((i * 2) & 3) << 2) | ((28 + i) << 8);
+    (&ioMem.BG0HOFS)[i * 2] = i * 37;
+    (&ioMem.BG0VOFS)[i * 2] = i * 11;
+  }
+  ioMem.BG2PA = ioMem.BG2PD = 0x100;
+  ioMem.BLDMOD = trace.BLDMOD;
+  ioMem.COLEV = trace.COLEV;
+  ioMem.COLY = trace.COLY;
+  ioMem.WIN0H = (40 << 8) | 200;
+  ioMem.WIN0V = (32 << 8) | 128;
+  ioMem.WIN1H = (0 << 8) | 120;
+  ioMem.WIN1V = (0 << 8) | 160;
+  ioMem.WININ = trace.WININ;
+  ioMem.WINOUT = trace.WINOUT;
+  ioMem.MOSAIC = trace.MOSAIC;
+  if (trace.MOSAIC) {
+    for (int i = 0; i < 4; i++)
+      (&ioMem.BG0CNT)[i] |= 0x40;
+  }
+
+  lcd.layerEnable = coreOptions.layerSettings & trace.DISPCNT;
+  for (int x = 0; x < 240; x++) {
+    lcd.gfxInWin0[x] = x >= 40 && x < 200;
+    lcd.gfxInWin1[x] = x < 120;
+  }
+  gfxClearArray(lcd.line0);
+  gfxClearArray(lcd.line1);
+  gfxClearArray(lcd.line2);
+  gfxClearArray(lcd.line3);
+  lcd.gfxTextLinesDirty = true;
+}
+
+static void renderCompositeTrace(GBALCD& lcd, GBAMem::IoMem& ioMem, const CompositeTrace& trace,
+                                 MixColorType* frame, bool useTextLineCache)
+{
+  for (int y = 0; y < 160; y++) {
+    ioMem.VCOUNT = y;
+    if (!useTextLineCache)
+      lcd.gfxTextLinesDirty = true;
+    lcd.updateTextLineCache();
+    trace.renderLine(&frame[y * 240], lcd, ioMem);
+  }
+}
+
+// FNV-1a over the little-endian bytes of each pixel
+static uint64_t compositeFrameHash(const std::vector<MixColorType>& frame)
+{
+  uint64_t hash = 0xCBF29CE484222325;
+  for (auto p : frame) {
+    hash = (hash ^ (p & 0xFF)) * 0x100000001B3;
+    hash = (hash ^ (p >> 8)) * 0x100000001B3;
+  }
+  return hash;
+}
+
+static double compositeMegapixelsPerSec(auto&& func)
+{
+  using namespace std::chrono;
+  constexpr int minIterations = 16;
+  constexpr auto minDuration = milliseconds{250};
+  int iterations{};
+  auto start = steady_clock::now();
+  auto elapsed = steady_clock::duration{};
+  do {
+    func();
+    iterations++;
+    elapsed = steady_clock::now() - start;
+  } while (iterations < minIterations || elapsed < minDuration);
+  return 240. * 160. * iterations / duration_cast<duration<double>>(elapsed).count() / 1e6;
+}
+
+std::string benchmarkGfxComposite()
+{
+#if defined GBA_COMPOSITE_AVX2
+  const char* simdName = cpuHasAVX2() ? "avx2" : "none";
+#elif defined GBA_COMPOSITE_NEON
+  const char* simdName = "neon";
+#else
+  const char* simdName = "none";
+#endif
+  auto lcd = std::make_unique<GBALCD>();
+  GBAMem::IoMem ioMem{};
+  std::vector<MixColorType> scalarFrame(240 * 160), simdFrame(240 * 160), cachedFrame(240 * 160);
+  std::string json = std::string{"{\"simd\":\""} + simdName + "\",\"results\":[";
+  for (const auto& trace : compositeTraces) {
+    setupCompositeTrace(*lcd, ioMem, trace);
+    useSIMD = false;
+    renderCompositeTrace(*lcd, ioMem, trace, scalarFrame.data(), false);
+    double scalar = compositeMegapixelsPerSec([&] { renderCompositeTrace(*lcd, ioMem, trace, scalarFrame.data(), false); });
+    useSIMD = true;
+    renderCompositeTrace(*lcd, ioMem, trace, simdFrame.data(), false);
+    double simd = compositeMegapixelsPerSec([&] { renderCompositeTrace(*lcd, ioMem, trace, simdFrame.data(), false); });
+    renderCompositeTrace(*lcd, ioMem, trace, cachedFrame.data(), true);
+    double cached = compositeMegapixelsPerSec([&] { renderCompositeTrace(*lcd, ioMem, trace, cachedFrame.data(), true); });
+    bool match = compositeFrameHash(scalarFrame) == trace.frameHash && scalarFrame == simdFrame &&
+      scalarFrame == cachedFrame;
+    char result[256];
+    snprintf(result, sizeof(result),
+             "%s{\"trace\":\"%s\",\"scalar_mpix_per_sec\":%.1f,\"simd_mpix_per_sec\":%.1f,"
+             "\"simd_text_cache_mpix_per_sec\":%.1f,\"speedup\":%.2f,\"match\":%s}",
+             &trace == compositeTraces ? "" : ",", trace.name, scalar, simd, cached,
+             cached / scalar, match ? "true" : "false");
+    json += result;
+  }
+  json += "]}";
+  return json;
+}
@@ -1,6 +1,8 @@
 #ifndef GFX_H
 #define GFX_H
 
+#include <string>
+
 #include "GBA.h"
 #include "Globals.h"
 
@@ -79,6 +81,19 @@ void mode5RenderLine(MixColorType *, GBALCD &lcd, const GBAMem::IoMem &ioMem);
 void mode5RenderLineNoWindow(MixColorType *, GBALCD &lcd, const GBAMem::IoMem &ioMem);
 void mode5RenderLineAll(MixColorType *, GBALCD &lcd, const GBAMem::IoMem &ioMem);
 
+// Layer mixing variants matching the modeNRenderLine, modeNRenderLineNoWindow and
+// modeNRenderLineAll functions
+enum class GfxCompositeType : uint8_t { normal, noWindow, all };
+
+// Mixes the BG layer lines selected by bgLayers (0x01 = line0 ... 0x08 = line3) with
+// lineOBJ into lineMix, applying windows and color special effects for the current VCOUNT
+void gfxCompositeLine(MixColorType *lineMix, const GBALCD &lcd, const GBAMem::IoMem &ioMem,
+                      GfxCompositeType type, unsigned bgLayers);
+
+// Renders a fixed set of scenes with the scalar and SIMD compositors, returns the
+// results as JSON
+std::string benchmarkGfxComposite();
+
 constexpr int coeff[32]{
   0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15,
   16, 16, 16, 16, 16, 16, 16, 16, 16, 16, 16, 16, 16, 16, 16, 16};
@@ -219,6 +234,34 @@ static inline void gfxDrawTextScreen(uint8_t vram[0x20000], uint16_t control, ui
     }
   }
 }
+
+static inline uint64_t gfxTextLineKey(uint16_t control, uint16_t hofs, uint16_t vofs,
+                                      const uint16_t VCOUNT, const uint16_t MOSAIC)
+{
+  int maskY = (control & 0x8000) ? 511 : 255;
+  int y = VCOUNT;
+  uint64_t mosaicX = 0;
+  if (control & 0x40) {
+    y -= VCOUNT % (((MOSAIC & 0x00F0) >> 4) + 1);
+    mosaicX = MOSAIC & 0x000F;
+  }
+  uint64_t yyy = (vofs + y) & maskY;
+  return (1ull << 63) | (mosaicX << 48) | (yyy << 32) | ((uint64_t)hofs << 16) | control;
+}
+
+// Skips drawing a text BG line when it would read the same map row with the same
+// registers as the previous line, which happens with vertical mosaic or per-line
+// VOFS effects. gfxTextLinesDirty clears the cache when video memory changes.
+static inline void gfxDrawTextScreenCached(GBALCD &lcd, int bg, uint16_t control, uint16_t hofs, uint16_t vofs,
+                                           uint32_t* line, const uint16_t VCOUNT, const uint16_t MOSAIC,
+                                           const uint16_t *palette)
+{
+  uint64_t key = gfxTextLineKey(control, hofs, vofs, VCOUNT, MOSAIC);
+  if (lcd.gfxTextLineKey[bg] == key)
+    return;
+  lcd.gfxTextLineKey[bg] = key;
+  gfxDrawTextScreen(lcd.vram, control, hofs, vofs, line, VCOUNT, MOSAIC, palette);
+}
 #endif // !__TILED_RENDERING
 
 static inline void gfxDrawRotScreen(uint8_t vram[0x20000], uint16_t control,
@@ -0,0 +1,165 @@
+#include <string>
+
+#include "GBA.h"
+#include "GBALink.h"
+#include "GBALocalLink.h"
+#include <emuframework/LocalLink.hh>
+#include <imagine/logger/logger.h>
+
+std::unique_ptr<EmuEx::LocalLink> gbaLocalLink;
+
+static GBASys* linkGba;
+static int transferTicks; // remaining ticks of the transfer started by this side
+static uint32_t transferData; // data received for it
+static int transferMode;
+
+enum LinkRequest : uint32_t {
+  LINK_REQUEST_NORMAL = 1,
+  LINK_REQUEST_MULTI = 2,
+};
+
+static const uint32_t linkProtocol = 0x47424131; // "GBA1"
+static const uint32_t linkSyncTicks = 1232; // one scanline
+
+enum SioMode {
+  SIO_NORMAL8,
+  SIO_NORMAL32,
+  SIO_MULTI,
+  SIO_UART,
+  SIO_GENERAL_PURPOSE,
+};
+
+static SioMode getSioMode(const GBAMem::IoMem& ioMem, uint16_t siocnt)
+{
+  if (READ16LE(&ioMem.b[COMM_RCNT]) & 0x8000)
+    return SIO_GENERAL_PURPOSE;
+  return (SioMode)((siocnt >> 12) & 3);
+}
+
+static void finishTransfer(GBAMem::IoMem& ioMem, uint16_t siocnt)
+{
+  WRITE16LE(&ioMem.b[COMM_SIOCNT], siocnt & ~0x80);
+  if (siocnt & 0x4000)
+    ioMem.IF |= 0x80;
+}
+
+static void setMultiData(GBAMem::IoMem& ioMem, uint16_t parent, uint16_t child)
+{
+  WRITE16LE(&ioMem.b[COMM_SIOMULTI0], parent);
+  WRITE16LE(&ioMem.b[COMM_SIOMULTI1], child);
+  WRITE16LE(&ioMem.b[COMM_SIOMULTI2], 0xFFFF);
+  WRITE16LE(&ioMem.b[COMM_SIOMULTI3], 0xFFFF);
+}
+
+// Called when the other side's clock drives a transfer, returns our outgoing data
+static uint32_t onLinkRequest(uint32_t type, uint32_t data)
+{
+  auto& ioMem = linkGba->mem.ioMem;
+  uint16_t siocnt = READ16LE(&ioMem.b[COMM_SIOCNT]);
+  SioMode mode = getSioMode(ioMem, siocnt);
+  switch (type) {
+  case LINK_REQUEST_NORMAL: {
+    // only shifts if waiting for an external clock, otherwise the line stays high
+    if ((mode != SIO_NORMAL8 && mode != SIO_NORMAL32) || (siocnt & 0x81) != 0x80)
+      return 0xFFFFFFFF;
+    uint32_t out;
+    if (mode == SIO_NORMAL32) {
+      out = READ32LE(&ioMem.b[COMM_SIODATA32_L]);
+      WRITE32LE(&ioMem.b[COMM_SIODATA32_L], data);
+    } else {
+      out = ioMem.b[COMM_SIODATA8];
+      ioMem.b[COMM_SIODATA8] = data;
+    }
+    finishTransfer(ioMem, siocnt);
+    return out;
+  }
+  case LINK_REQUEST_MULTI: {
+    if (mode != SIO_MULTI)
+      return 0xFFFF;
+    uint16_t out = READ16LE(&ioMem.b[COMM_SIOMLT_SEND]);
+    setMultiData(ioMem, data, out);
+    // child 1, no error
+    finishTransfer(ioMem, (siocnt & ~0x70) | 0x10);
+    return out;
+  }
+  }
+  logWarn("unknown link request:%u", type);
+  return 0xFFFFFFFF;
+}
+
+void openGBALocalLink(GBASys& gba, const char* name)
+{
+  linkGba = &gba;
+  transferTicks = 0;
+  gbaLocalLink = std::make_unique<EmuEx::LocalLink>(name, linkProtocol, linkSyncTicks,
+    [](uint32_t type, uint32_t data) { return onLinkRequest(type, data); });
+}
+
+bool gbaLocalLinkStart(GBASys& gba, uint16_t value)
+{
+  auto& ioMem = gba.mem.ioMem;
+  SioMode mode = getSioMode(ioMem, value);
+  if (mode == SIO_UART || mode == SIO_GENERAL_PURPOSE)
+    return false;
+  if (mode == SIO_MULTI) {
+    // SI is low on the parent, SD is high while the other side is connected
+    value = (value & ~0xC) | (gbaLocalLink->playerId() ? 0x4 : 0) | (gbaLocalLink->isConnected() ? 0x8 : 0);
+  }
+  if (transferTicks > 0) {
+    // busy until the current transfer ends
+    WRITE16LE(&ioMem.b[COMM_SIOCNT], value | 0x80);
+    return true;
+  }
+  bool startsTransfer = (value & 0x80) &&
+    (mode == SIO_MULTI ? gbaLocalLink->playerId() == 0 : value & 1);
+  if (!startsTransfer) {
+    // the child or an external clock transfer waits for onLinkRequest()
+    if (mode == SIO_MULTI)
+      value &= ~0x80;
+    WRITE16LE(&ioMem.b[COMM_SIOCNT], value);
+    return true;
+  }
+  if (mode == SIO_MULTI) {
+    auto reply = gbaLocalLink->transfer(LINK_REQUEST_MULTI, READ16LE(&ioMem.b[COMM_SIOMLT_SEND]));
+    transferData = reply ? *reply : 0xFFFF;
+    // start, data & stop bit for each player
+    static const int baudTicks[4]{ 16777216 / 9600, 16777216 / 38400, 16777216 / 57600, 16777216 / 115200 };
+    transferTicks = baudTicks[value & 3] * 18 * 2;
+  } else {
+    uint32_t out = mode == SIO_NORMAL32 ? READ32LE(&ioMem.b[COMM_SIODATA32_L]) : ioMem.b[COMM_SIODATA8];
+    auto reply = gbaLocalLink->transfer(LINK_REQUEST_NORMAL, out);
+    transferData = reply ? *reply : 0xFFFFFFFF;
+    // 256KHz or 2MHz shift clock
+    transferTicks = (mode == SIO_NORMAL32 ? 32 : 8) * (value & 2 ? 8 : 64);
+  }
+  transferMode = mode;
+  WRITE16LE(&ioMem.b[COMM_SIOCNT], value);
+  return true;
+}
+
+void gbaLocalLinkUpdate(GBASys& gba, int ticks)
+{
+  if (transferTicks > 0) {
+    transferTicks -= ticks;
+    if (transferTicks <= 0) {
+      auto& ioMem = gba.mem.ioMem;
+      uint16_t siocnt = READ16LE(&ioMem.b[COMM_SIOCNT]);
+      switch (transferMode) {
+      case SIO_NORMAL8:
+        ioMem.b[COMM_SIODATA8] = transferData;
+        finishTransfer(ioMem, siocnt);
+        break;
+      case SIO_NORMAL32:
+        WRITE32LE(&ioMem.b[COMM_SIODATA32_L], transferData);
+        finishTransfer(ioMem, siocnt);
+        break;
+      case SIO_MULTI:
+        setMultiData(ioMem, READ16LE(&ioMem.b[COMM_SIOMLT_SEND]), transferData);
+        // parent, no error
+        finishTransfer(ioMem, siocnt & ~0x70);
+        break;
+      }
+    }
+  }
+  gbaLocalLink->advance(ticks);
+}
@@ -0,0 +1,43 @@
+#ifndef GBA_GBALOCALLINK_H
+#define GBA_GBALOCALLINK_H
+
+#include <stdint.h>
+#include <memory>
+
+namespace EmuEx {
+class LocalLink;
+}
+struct GBASys;
+
+// Link cable to another instance on the same machine through EmuEx::LocalLink,
+// used when the socket based link in GBALink.cpp is disabled with NO_LINK.
+// Supports normal 8/32-bit and 2 player multi-player transfers.
+
+extern std::unique_ptr<EmuEx::LocalLink> gbaLocalLink;
+
+/**
+ * Connect to the instance opening the same name
+ *
+ * Throws std::runtime_error on failure
+ */
+extern void openGBALocalLink(GBASys& gba, const char* name);
+
+inline bool gbaLocalLinkActive()
+{
+  return (bool)gbaLocalLink;
+}
+
+/**
+ * Handle a write to SIOCNT
+ *
+ * @return false if the current SIO mode isn't supported
+ */
+extern bool gbaLocalLinkStart(GBASys& gba, uint16_t siocnt);
+
+/**
+ * Run the link for the given CPU ticks, completing transfers and keeping the
+ * other instance in lockstep
+ */
+extern void gbaLocalLinkUpdate(GBASys& gba, int ticks);
+
+#endif
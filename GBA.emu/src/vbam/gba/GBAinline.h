@@ -529,6 +529,7 @@ static inline void CPUWriteMemory(ARM7TDMI &cpu, uint32_t address, uint32_t valu
         else
 #endif
             WRITE32LE(((uint32_t*)&paletteRAM[address & 0x3FC]), value);
+        cpu.gba->lcd.gfxTextLinesDirty = true;
         break;
     case 0x06:
         address = (address & 0x1fffc);
@@ -544,6 +545,7 @@ static inline void CPUWriteMemory(ARM7TDMI &cpu, uint32_t address, uint32_t valu
 #endif
 
             WRITE32LE(((uint32_t*)&vram[address]), value);
+        cpu.gba->lcd.gfxTextLinesDirty = true;
         break;
     case 0x07:
 #ifdef BKPT_SUPPORT
@@ -632,6 +634,7 @@ static inline void CPUWriteHalfWord(ARM7TDMI &cpu, uint32_t address, uint16_t va
         else
 #endif
             WRITE16LE(((uint16_t*)&paletteRAM[address & 0x3fe]), value);
+        cpu.gba->lcd.gfxTextLinesDirty = true;
         break;
     case 6:
         address = (address & 0x1fffe);
@@ -645,6 +648,7 @@ static inline void CPUWriteHalfWord(ARM7TDMI &cpu, uint32_t address, uint16_t va
         else
 #endif
             WRITE16LE(((uint16_t*)&vram[address]), value);
+        cpu.gba->lcd.gfxTextLinesDirty = true;
         break;
     case 7:
 #ifdef BKPT_SUPPORT
@@ -787,6 +791,7 @@ static inline void CPUWriteByte(ARM7TDMI &cpu, uint32_t address, uint8_t b)
     case 5:
         // no need to switch
         *((uint16_t*)&paletteRAM[address & 0x3FE]) = (b << 8) | b;
+        cpu.gba->lcd.gfxTextLinesDirty = true;
         break;
     case 6:
         address = (address & 0x1fffe);
@@ -804,6 +809,7 @@ static inline void CPUWriteByte(ARM7TDMI &cpu, uint32_t address, uint8_t b)
             else
 #endif
                 *((uint16_t*)&vram[address]) = (b << 8) | b;
+            cpu.gba->lcd.gfxTextLinesDirty = true;
         }
         break;
     case 7:
@@ -21,6 +21,7 @@
 
 #include "gbint.h"
 #include "inputgetter.h"
+#include "linkcable.h"
 #include "loadres.h"
 #include <cstddef>
 #include <string>
@@ -109,6 +110,16 @@ public:
 	/** Sets the callback used for getting input state. */
 	void setInputGetter(InputGetter *getInput);
 
+	/** Sets the link cable used by serial transfers with the internal clock, or 0 to disconnect. */
+	void setLinkCable(LinkCable *linkCable);
+
+	/**
+	  * Clocks a serial transfer from a linked Game Boy. Completes the transfer if the serial
+	  * port is waiting for an external clock.
+	  * @return outgoing byte, 0xFF if no transfer was started
+	  */
+	unsigned serialExternalClockTransfer(unsigned data);
+
 	/**
 	  * Sets the directory used for storing save data. The default is the same directory as
 	  * the ROM Image file.
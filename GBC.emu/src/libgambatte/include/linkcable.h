@@ -0,0 +1,36 @@
+//
+//   This program is free software; you can redistribute it and/or modify
+//   it under the terms of the GNU General Public License version 2 as
+//   published by the Free Software Foundation.
+//
+//   This program is distributed in the hope that it will be useful,
+//   but WITHOUT ANY WARRANTY; without even the implied warranty of
+//   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//   GNU General Public License version 2 for more details.
+//
+//   You should have received a copy of the GNU General Public License
+//   version 2 along with this program; if not, write to the
+//   Free Software Foundation, Inc.,
+//   51 Franklin St, Fifth Floor, Boston, MA  02110-1301, USA.
+//
+
+#ifndef GAMBATTE_LINKCABLE_H
+#define GAMBATTE_LINKCABLE_H
+
+namespace gambatte {
+
+class LinkCable {
+public:
+	virtual ~LinkCable() {}
+
+	/**
+	  * Called when the serial port starts a transfer using its internal clock.
+	  * @param data outgoing byte from SB
+	  * @return byte shifted in from the other side, 0xFF if nothing is connected
+	  */
+	virtual unsigned transfer(unsigned data) = 0;
+};
+
+}
+
+#endif
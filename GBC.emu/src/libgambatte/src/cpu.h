@@ -44,6 +44,14 @@ public:
 		mem_.setInputGetter(getInput);
 	}
 
+	void setLinkCable(LinkCable *linkCable) {
+		mem_.setLinkCable(linkCable);
+	}
+
+	unsigned serialExternalClockTransfer(unsigned data) {
+		return mem_.serialExternalClockTransfer(data);
+	}
+
 	void setSaveDir(std::string const &sdir) {
 		mem_.setSaveDir(sdir);
 	}
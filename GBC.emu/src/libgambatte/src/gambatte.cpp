@@ -96,6 +96,14 @@ void GB::setInputGetter(InputGetter *getInput) {
 	p_->cpu.setInputGetter(getInput);
 }
 
+void GB::setLinkCable(LinkCable *linkCable) {
+	p_->cpu.setLinkCable(linkCable);
+}
+
+unsigned GB::serialExternalClockTransfer(unsigned data) {
+	return p_->cpu.serialExternalClockTransfer(data);
+}
+
 void GB::setSaveDir(std::string const &sdir) {
 	p_->cpu.setSaveDir(sdir);
 }
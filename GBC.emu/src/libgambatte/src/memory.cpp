@@ -18,6 +18,7 @@
 
 #include "memory.h"
 #include "inputgetter.h"
+#include "linkcable.h"
 #include "savestate.h"
 #include "sound.h"
 #include "video.h"
@@ -43,6 +44,7 @@ int serialCntFrom(unsigned long cyclesUntilDone, bool cgbFast) {
 
 Memory::Memory(Interrupter const &interrupter)
 : getInput_(0)
+, linkCable_(0)
 , lastOamDmaUpdate_(disabled_time)
 , lcd_(ioamhram_, 0, VideoInterruptRequester(intreq_))
 , interrupter_(interrupter)
@@ -51,6 +53,7 @@ Memory::Memory(Interrupter const &interrupter)
 , oamDmaPos_(-2u & 0xFF)
 , oamDmaStartPos_(0)
 , serialCnt_(0)
+, serialIn_(0xFF)
 , blanklcd_(false)
 , haltHdmaState_(hdma_low)
 {
@@ -109,6 +112,7 @@ void Memory::loadState(SaveState const &state) {
 	oamDmaPos_ = state.mem.oamDmaPos;
 	oamDmaStartPos_ = 0;
 	haltHdmaState_ = static_cast<HdmaState>(std::min(1u * state.mem.haltHdmaState, 1u * hdma_requested));
+	serialIn_ = 0xFF;
 	serialCnt_ = intreq_.eventTime(intevent_serial) != disabled_time
 		? serialCntFrom(intreq_.eventTime(intevent_serial) - state.cpu.cycleCounter,
 			ioamhram_[0x102] & isCgb() * 2)
@@ -148,22 +152,38 @@ void Memory::setEndtime(unsigned long cc, unsigned long inc) {
 	intreq_.setEventTime<intevent_end>(cc + (inc << isDoubleSpeed()));
 }
 
+// shifts the next bits of serialIn_ into SB
+static unsigned serialShiftIn(unsigned sb, unsigned in, int shifts, int remaining) {
+	return (sb << shifts | (in >> remaining & ((1 << shifts) - 1))) & 0xFF;
+}
+
 void Memory::updateSerial(unsigned long const cc) {
 	if (intreq_.eventTime(intevent_serial) != disabled_time) {
 		if (intreq_.eventTime(intevent_serial) <= cc) {
-			ioamhram_[0x101] = (((ioamhram_[0x101] + 1) << serialCnt_) - 1) & 0xFF;
+			ioamhram_[0x101] = serialShiftIn(ioamhram_[0x101], serialIn_, serialCnt_, 0);
 			ioamhram_[0x102] &= 0x7F;
 			intreq_.flagIrq(8, intreq_.eventTime(intevent_serial));
 			intreq_.setEventTime<intevent_serial>(disabled_time);
 		} else {
 			int const targetCnt = serialCntFrom(intreq_.eventTime(intevent_serial) - cc,
 				ioamhram_[0x102] & isCgb() * 2);
-			ioamhram_[0x101] = (((ioamhram_[0x101] + 1) << (serialCnt_ - targetCnt)) - 1) & 0xFF;
+			ioamhram_[0x101] = serialShiftIn(ioamhram_[0x101], serialIn_, serialCnt_ - targetCnt, targetCnt);
 			serialCnt_ = targetCnt;
 		}
 	}
 }
 
+unsigned Memory::serialExternalClockTransfer(unsigned data) {
+	if ((ioamhram_[0x102] & 0x81) != 0x80)
+		return 0xFF;
+
+	unsigned const out = ioamhram_[0x101];
+	ioamhram_[0x101] = data & 0xFF;
+	ioamhram_[0x102] &= 0x7F;
+	intreq_.flagIrq(8);
+	return out;
+}
+
 void Memory::updateTimaIrq(unsigned long cc) {
 	while (intreq_.eventTime(intevent_tima) <= cc)
 		tima_.doIrqEvent(TimaInterruptRequester(intreq_));
@@ -682,6 +702,7 @@ void Memory::nontrivial_ff_write(unsigned const p, unsigned data, unsigned long
 		updateSerial(cc);
 		serialCnt_ = 8;
 		if ((data & 0x81) == 0x81) {
+			serialIn_ = linkCable_ ? linkCable_->transfer(ioamhram_[0x101]) & 0xFF : 0xFF;
 			intreq_.setEventTime<intevent_serial>(data & isCgb() * 2
 				? cc - (cc - tima_.divLastUpdate()) % 8 + 0x10 * serialCnt_
 				: cc - (cc - tima_.divLastUpdate()) % 0x100 + 0x200 * serialCnt_);
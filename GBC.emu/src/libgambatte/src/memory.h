@@ -29,6 +29,7 @@
 namespace gambatte {
 
 class InputGetter;
+class LinkCable;
 class FilterInfo;
 
 class Memory {
@@ -101,6 +102,8 @@ public:
 	LoadRes loadROM(const void *romdata, std::size_t size, std::string const &romfilename, bool forceDmg, bool multicartCompat);
 	void setSaveDir(std::string const &dir) { cart_.setSaveDir(dir); }
 	void setInputGetter(InputGetter *getInput) { getInput_ = getInput; }
+	void setLinkCable(LinkCable *linkCable) { linkCable_ = linkCable; }
+	unsigned serialExternalClockTransfer(unsigned data);
 	void setEndtime(unsigned long cc, unsigned long inc);
 	void setSoundBuffer(uint_least32_t *buf) { psg_.setBuffer(buf); }
 	std::size_t fillSoundBuffer(unsigned long cc);
@@ -123,6 +126,7 @@ private:
 	Cartridge cart_;
 	unsigned char ioamhram_[0x200];
 	InputGetter *getInput_;
+	LinkCable *linkCable_;
 	unsigned long lastOamDmaUpdate_;
 	InterruptRequester intreq_;
 	Tima tima_;
@@ -134,6 +138,7 @@ private:
 	unsigned char oamDmaPos_;
 	unsigned char oamDmaStartPos_;
 	unsigned char serialCnt_;
+	unsigned char serialIn_;
 	bool blanklcd_;
 	enum HdmaState { hdma_low, hdma_high, hdma_requested } haltHdmaState_;
 
@@ -20,6 +20,7 @@
 #include <imagine/util/format.hh>
 #include <imagine/fs/FS.hh>
 #include <imagine/io/IOStream.hh>
+#include <imagine/io/MapIO.hh>
 #include <resample/resampler.h>
 #include <resample/resamplerinfo.h>
 #include <libgambatte/src/mem/cartridge.h>
@@ -30,6 +31,7 @@ namespace EmuEx
 
 const char *EmuSystem::creditsViewStr = CREDITS_INFO_STRING "(c) 2011-2023\nRobert Broglia\nwww.explusalpha.com\n\n\nPortions (c) the\nGambatte Team\ngambatte.sourceforge.net";
 bool EmuSystem::hasCheats = true;
+bool EmuSystem::hasRunAhead = true;
 constexpr IG::WP lcdSize{gambatte::lcd_hres, gambatte::lcd_vres};
 
 EmuSystem::NameFilterFunc EmuSystem::defaultFsFilter =
@@ -79,6 +81,7 @@ void GbcSystem::reset(EmuApp &app, ResetMode mode)
 {
 	flushBackupMemory(app);
 	gbEmu.reset();
+	app.waitForStateWrites();
 	loadBackupMemory(app);
 }
 
@@ -87,18 +90,36 @@ FS::FileString GbcSystem::stateFilename(int slot, std::string_view name) const
 	return IG::format<FS::FileString>("{}.0{}.gqs", name, saveSlotCharUpper(slot));
 }
 
-void GbcSystem::saveState(IG::CStringView path)
+size_t GbcSystem::stateSize()
 {
-	OFStream stream{appContext().openFileUri(path, OpenFlagsMask::New)};
+	// count the bytes written without storing them
+	struct SizeCounterStreamBuf final : public std::streambuf
+	{
+		std::streamsize size{};
+
+		int_type overflow(int_type ch) final { size++; return ch; }
+		std::streamsize xsputn(const char_type *, std::streamsize count) final { size += count; return count; }
+	};
+	SizeCounterStreamBuf counter;
+	std::ostream stream{&counter};
 	if(!gbEmu.saveState(frameBuffer, gambatte::lcd_hres, stream))
 		throwFileWriteError();
+	return counter.size;
 }
 
-void GbcSystem::loadState(EmuApp &app, IG::CStringView path)
+void GbcSystem::readState(EmuApp &, std::span<const uint8_t> buff)
 {
-	IFStream stream{app.appContext().openFileUri(path, IO::AccessHint::All)};
+	IStream<MapIO> stream{MapIO{IOBuffer{{const_cast<uint8_t*>(buff.data()), buff.size()}, 0}}};
 	if(!gbEmu.loadState(stream))
-		throwFileReadError();
+		throw std::runtime_error("Invalid state data");
+}
+
+size_t GbcSystem::writeState(std::span<uint8_t> buff, SaveStateFlags)
+{
+	OStream<MapIO> stream{MapIO{IOBuffer{buff, 0}}};
+	if(!gbEmu.saveState(frameBuffer, gambatte::lcd_hres, stream) || !stream)
+		throw std::runtime_error("State buffer too small");
+	return stream.tellp();
 }
 
 void GbcSystem::loadBackupMemory(EmuApp &app)
@@ -107,8 +128,7 @@ void GbcSystem::loadBackupMemory(EmuApp &app)
 		sram.size())
 	{
 		logMsg("loading sram");
-		if(!saveFileIO)
-			saveFileIO = staticBackupMemoryFile(app.contentSaveFilePath(".sav"), sram.size(), 0xFF);
+		auto saveFileIO = staticBackupMemoryFile(app.contentSaveFilePath(".sav"), sram.size(), 0xFF);
 		if(!saveFileIO)
 			throw std::runtime_error("Error accessing .sav file, please verify it has write access");
 		saveFileIO.read(sram, 0);
@@ -117,8 +137,7 @@ void GbcSystem::loadBackupMemory(EmuApp &app)
 		timeOpt)
 	{
 		logMsg("loading rtc");
-		if(!rtcFileIO)
-			rtcFileIO = staticBackupMemoryFile(app.contentSaveFilePath(".rtc"), 4);
+		auto rtcFileIO = staticBackupMemoryFile(app.contentSaveFilePath(".rtc"), 4);
 		if(!rtcFileIO)
 			throw std::runtime_error("Error accessing .rtc file, please verify it has write access");
 		auto rtcData = rtcFileIO.get<std::array<uint8_t, 4>>(0);
@@ -126,25 +145,26 @@ void GbcSystem::loadBackupMemory(EmuApp &app)
 	}
 }
 
-void GbcSystem::onFlushBackupMemory(EmuApp &, BackupMemoryDirtyFlags)
+void GbcSystem::onFlushBackupMemory(EmuApp &app, BackupMemoryDirtyFlags)
 {
 	if(auto sram = gbEmu.srambank();
 		sram.size())
 	{
 		logMsg("saving sram");
-		saveFileIO.write(sram, 0);
+		app.saveBackupMemory(app.contentSaveFilePath(".sav"), sram);
 	}
 	if(auto timeOpt = gbEmu.rtcTime();
 		timeOpt)
 	{
 		logMsg("saving rtc");
-		rtcFileIO.put(std::array<uint8_t, 4>
-			{
-				uint8_t(*timeOpt >> 24 & 0xFF),
-				uint8_t(*timeOpt >> 16 & 0xFF),
-				uint8_t(*timeOpt >>  8 & 0xFF),
-				uint8_t(*timeOpt       & 0xFF)
-			}, 0);
+		std::array<uint8_t, 4> rtcData
+		{
+			uint8_t(*timeOpt >> 24 & 0xFF),
+			uint8_t(*timeOpt >> 16 & 0xFF),
+			uint8_t(*timeOpt >>  8 & 0xFF),
+			uint8_t(*timeOpt       & 0xFF)
+		};
+		app.saveBackupMemory(app.contentSaveFilePath(".rtc"), rtcData);
 	}
 }
 
@@ -156,8 +176,6 @@ IG::Time GbcSystem::backupMemoryLastWriteTime(const EmuApp &app) const
 void GbcSystem::closeSystem()
 {
 	cheatList.clear();
-	saveFileIO = {};
-	rtcFileIO = {};
 	gameBuiltinPalette = nullptr;
 	totalFrames = 0;
 	totalSamples = 0;
@@ -223,7 +241,6 @@ size_t GbcSystem::runUntilVideoFrame(gambatte::uint_least32_t *videoBuf, std::pt
 	EmuAudio *audio, gambatte::VideoFrameDelegate videoFrameCallback)
 {
 	size_t samplesEmulated = 0;
-	constexpr unsigned samplesPerRun = 2064;
 	bool didOutputFrame;
 	do
 	{
@@ -231,6 +248,8 @@ size_t GbcSystem::runUntilVideoFrame(gambatte::uint_least32_t *videoBuf, std::pt
 		size_t samples = samplesPerRun;
 		didOutputFrame = gbEmu.runFor(videoBuf, pitch, snd.data(), samples, videoFrameCallback) != -1;
 		samplesEmulated += samples;
+		if(linkCable.link)
+			linkCable.link->advance(samples);
 		if(audio)
 		{
 			constexpr size_t buffSize = (snd.size() / (2097152./48000.) + 1); // TODO: std::ceil() is constexpr with GCC but not Clang yet
@@ -275,6 +294,14 @@ void GbcSystem::runFrame(EmuSystemTaskContext taskCtx, EmuVideo *video, EmuAudio
 	}
 }
 
+void GbcSystem::openLocalLink(CStringView name)
+{
+	// sync once per runFor() call in runUntilVideoFrame()
+	linkCable.link = std::make_unique<LocalLink>(name, GbcLinkCable::protocol, samplesPerRun,
+		[this](uint32_t, uint32_t data) -> uint32_t { return gbEmu.serialExternalClockTransfer(data); });
+	gbEmu.setLinkCable(&linkCable);
+}
+
 void GbcSystem::renderFramebuffer(EmuVideo &video)
 {
 	renderVideo({}, video);
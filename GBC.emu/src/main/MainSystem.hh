@@ -2,6 +2,7 @@
 
 #include <emuframework/EmuSystem.hh>
 #include <emuframework/Option.hh>
+#include <emuframework/LocalLink.hh>
 #include <main/Palette.hh>
 #include <gambatte.h>
 #include <libgambatte/src/video/lcddef.h>
@@ -32,15 +33,24 @@ public:
 	constexpr unsigned operator()() final { return bits; }
 };
 
+class GbcLinkCable final : public gambatte::LinkCable
+{
+public:
+	static constexpr uint32_t protocol = 0x47424331; // "GBC1"
+	static constexpr uint32_t serialTransfer = 1;
+	std::unique_ptr<LocalLink> link;
+
+	unsigned transfer(unsigned data) final { return link->transfer(serialTransfer, data).value_or(0xFF); }
+};
+
 class GbcSystem final: public EmuSystem
 {
 public:
 	gambatte::GB gbEmu;
 	GbcInput gbcInput;
+	GbcLinkCable linkCable;
 	std::unique_ptr<Resampler> resampler;
 	const GBPalette *gameBuiltinPalette{};
-	FileIO saveFileIO;
-	FileIO rtcFileIO;
 	std::string cheatsDir;
 	uint64_t totalSamples{};
 	uint32_t totalFrames{};
@@ -53,6 +63,7 @@ public:
 	Byte1Option optionAudioResampler{CFGKEY_AUDIO_RESAMPLER, 1};
 	Byte1Option optionFullGbcSaturation{CFGKEY_FULL_GBC_SATURATION, 0};
 	static constexpr FloatSeconds staticFrameTime{70224. / 4194304.}; // ~59.7275Hz
+	static constexpr unsigned samplesPerRun = 2064;
 
 	GbcSystem(ApplicationContext ctx):
 		EmuSystem{ctx}
@@ -68,8 +79,9 @@ public:
 	[[gnu::hot]] void runFrame(EmuSystemTaskContext task, EmuVideo *video, EmuAudio *audio);
 	FS::FileString stateFilename(int slot, std::string_view name) const;
 	std::string_view stateFilenameExt() const { return ".sta"; }
-	void loadState(EmuApp &, CStringView uri);
-	void saveState(CStringView path);
+	size_t stateSize();
+	void readState(EmuApp &, std::span<const uint8_t> buff);
+	size_t writeState(std::span<uint8_t> buff, SaveStateFlags = {});
 	bool readConfig(ConfigType, MapIO &, unsigned key, size_t readSize);
 	void writeConfig(ConfigType, FileIO &);
 	void reset(EmuApp &, ResetMode mode);
@@ -90,6 +102,7 @@ public:
 	bool resetSessionOptions(EmuApp &);
 	bool onVideoRenderFormatChange(EmuVideo &, IG::PixelFormat);
 	void renderFramebuffer(EmuVideo &);
+	void openLocalLink(CStringView name);
 protected:
 	uint_least32_t makeOutputColor(uint_least32_t rgb888) const;
 	size_t runUntilVideoFrame(gambatte::uint_least32_t *videoBuf, std::ptrdiff_t pitch,
@@ -36,6 +36,7 @@ namespace EmuEx
 {
 
 const char *EmuSystem::creditsViewStr = CREDITS_INFO_STRING "(c) 2011-2023\nRobert Broglia\nwww.explusalpha.com\n\nPortions (c) the\nMednafen Team\nmednafen.github.io";
+bool EmuSystem::hasRunAhead = true;
 bool EmuApp::needsGlobalInstance = true;
 
 EmuSystem::NameFilterFunc EmuSystem::defaultFsFilter =
@@ -60,21 +61,29 @@ FS::FileString LynxSystem::stateFilename(int slot, std::string_view name) const
 	return stateFilenameMDFN(*MDFNGameInfo, slot, name, 'a');
 }
 
-void LynxSystem::saveState(IG::CStringView path)
+static constexpr size_t maxStateSize = 0x400000;
+
+size_t LynxSystem::stateSize() { return stateSizeMDFN(); }
+
+void LynxSystem::readState(EmuApp &, std::span<const uint8_t> buff)
+{
+	readStateMDFN(buff, maxStateSize);
+}
+
+size_t LynxSystem::writeState(std::span<uint8_t> buff, SaveStateFlags flags)
 {
-	if(!MDFNI_SaveState(path, 0, 0, 0, 0))
-		throwFileWriteError();
+	return writeStateMDFN(buff, flags);
 }
 
-void LynxSystem::loadState(EmuApp &, IG::CStringView path)
+size_t LynxSystem::compressState(std::span<const uint8_t> src, std::span<uint8_t> dest) const
 {
-	if(!MDFNI_LoadState(path, 0))
-		throwFileReadError();
+	return gzipCompress(src, dest);
 }
 
 void LynxSystem::closeSystem()
 {
 	mdfnGameInfo.CloseGame();
+	resetStateCacheMDFN();
 	mdfnGameInfo.rotated = MDFN_ROTATE0;
 }
 
@@ -38,12 +38,12 @@ ifeq ($(ENV), android)
 else
  gplusSrc += m68k/musashi/m68kcpu.cc
 endif
+gplusSrc += m68k/musashi/M68KRecompiler.cc
 
 gplusSrc += z80/z80.cc
 
 gplusSrc += sound/sound.cc \
 sound/ym2612.cc \
-sound/Fir_Resampler.cc \
 sound/ym2413.cc \
 sound/sn76489.cc \
 sound/blip.cc
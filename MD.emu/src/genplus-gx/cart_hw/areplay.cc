@@ -253,6 +253,9 @@ void areplay_set_status(int status)
 
     /* update status */
     action_replay.status = status;
+
+    /* drop any blocks recompiled from the old ROM data */
+    m68k_flush_recompiler(mm68k);
   }
 }
 
@@ -150,6 +150,9 @@ void ggenie_switch(int enable)
       }
     }
   }
+
+  /* drop any blocks recompiled from the old ROM data */
+  m68k_flush_recompiler(mm68k);
 }
 
 static unsigned int ggenie_read_byte(unsigned int address)
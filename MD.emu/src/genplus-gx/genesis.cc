@@ -23,6 +23,9 @@
 
 #include "shared.h"
 #include "InstructionCycleTable.hh"
+#ifdef M68K_RECOMPILER
+#include <musashi/M68KRecompiler.hh>
+#endif
 
 uint8 tmss[4];            /* TMSS security register */
 uint8 bios_rom[0x800];    /* OS ROM   */
@@ -40,6 +43,9 @@ uint8 pico_page[7];
 #endif
 
 M68KCPU mm68k(m68kCycles, 0);
+#ifdef M68K_RECOMPILER
+static M68KRecompiler mm68kRecompiler;
+#endif
 
 /*--------------------------------------------------------------------------*/
 /* Init, reset, shutdown functions                                          */
@@ -53,6 +59,15 @@ void gen_init(void)
   m68k_init(mm68k);
   mm68k.setID(0);
   m68k_set_int_ack_callback(mm68k, vdp_68k_irq_ack);
+
+#ifdef M68K_RECOMPILER
+  /* recompile code in the cartridge area while it's mapped to ROM,
+     pages remapped to SRAM or RAM fall back to the interpreter */
+  mm68kRecompiler.setCodePages(0x00, 0x7f);
+  mm68kRecompiler.setCodeRange(cart.rom, sizeof(cart.rom));
+  mm68kRecompiler.invalidate();
+  mm68k.recompiler = &mm68kRecompiler;
+#endif
 	#ifndef NO_SCD
 		if(sCD.isActive) scd_init();
 	#endif
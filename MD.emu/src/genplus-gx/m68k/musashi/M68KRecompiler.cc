@@ -0,0 +1,261 @@
+/* Loop recompiler for the Musashi 68000 core, see M68KRecompiler.hh */
+
+#include "m68kops.h"
+#include "m68kcpu.h"
+
+/* Only built when m68k.h enables M68K_RECOMPILER, other hosts don't compile any of this */
+#ifdef M68K_RECOMPILER
+#include "M68KRecompiler.hh"
+#include <algorithm>
+#include <cstring>
+#include <sys/mman.h>
+#include <unistd.h>
+
+/* Every op is at most ~110 bytes of code, plus the prologue & epilogue */
+static constexpr size_t maxBlockBytes = M68KRecompiler::maxBlockOps * 128 + 128;
+
+/* rbx points this far into M68KCPU so the members used by every op fit in a 8-bit displacement */
+static constexpr int32_t cpuBias = 128;
+
+namespace
+{
+
+/* Minimal x86-64 code emitter, the generated block is called as
+ * void(M68KCPU &cpu, int32_t endCycles) with the SysV ABI and keeps:
+ * rbx = &cpu + cpuBias, r12d = endCycles, r13 = cycle table,
+ * rbp = the page's base pointer, r15 = &pageGeneration[page] */
+struct X64Emitter
+{
+  uint8_t *p;
+  std::array<uint8_t*, M68KRecompiler::maxBlockOps * 5> exitFixups{};
+  unsigned exitFixupCount{};
+
+  void byte(uint8_t b) { *p++ = b; }
+  void bytes(std::initializer_list<uint8_t> b) { for(auto v : b) byte(v); }
+  void u32(uint32_t v) { std::memcpy(p, &v, 4); p += 4; }
+  void u64(uint64_t v) { std::memcpy(p, &v, 8); p += 8; }
+
+  /* ModRM (and displacement) for [rbx+disp] with the given reg field */
+  void rbxMem(unsigned reg, int32_t disp)
+  {
+    if(disp >= -128 && disp <= 127)
+    {
+      byte(0x43 | (reg & 7) << 3);
+      byte(uint8_t(disp));
+    }
+    else
+    {
+      byte(0x83 | (reg & 7) << 3);
+      u32(disp);
+    }
+  }
+
+  void rel32To(const uint8_t *target) { u32(uint32_t(target - (p + 4))); }
+  void rel32ToExit() { exitFixups[exitFixupCount++] = p; u32(0); }
+  void jgeExit() { bytes({0x0F, 0x8D}); rel32ToExit(); }
+  void jneExit() { bytes({0x0F, 0x85}); rel32ToExit(); }
+  void jmpExit() { byte(0xE9); rel32ToExit(); }
+  void je(const uint8_t *target) { bytes({0x0F, 0x84}); rel32To(target); }
+
+  void call(const void *func)
+  {
+    intptr_t rel = (intptr_t)func - (intptr_t)(p + 5);
+    if(rel == int32_t(rel))
+    {
+      byte(0xE8); /* call rel32 */
+      u32(uint32_t(rel));
+    }
+    else
+    {
+      bytes({0x48, 0xB8}); u64(uint64_t(func)); /* mov rax, func */
+      bytes({0xFF, 0xD0}); /* call rax */
+    }
+  }
+
+  void patchExits(const uint8_t *exit)
+  {
+    for(unsigned i = 0; i < exitFixupCount; i++)
+    {
+      uint32_t rel = uint32_t(exit - (exitFixups[i] + 4));
+      std::memcpy(exitFixups[i], &rel, 4);
+    }
+  }
+};
+
+struct RecordedOp
+{
+  uint32_t pc;
+  uint16_t ir;
+  M68KRecompiler::OpHandler handler;
+};
+
+static int32_t memberOffset(const M68KCPU &cpu, const void *member)
+{
+  return int32_t((const uint8_t*)member - (const uint8_t*)&cpu);
+}
+
+}
+
+static size_t hostPageSize() { return sysconf(_SC_PAGESIZE); }
+
+static bool setCodeProtection(uint8_t *begin, uint8_t *end, uint8_t *bufferEnd, bool writable)
+{
+  auto pageMask = ~uintptr_t(hostPageSize() - 1);
+  auto pageBegin = (uint8_t*)(uintptr_t(begin) & pageMask);
+  auto pageEnd = std::min(bufferEnd, (uint8_t*)((uintptr_t(end) + hostPageSize() - 1) & pageMask));
+  return mprotect(pageBegin, pageEnd - pageBegin, writable ? PROT_READ | PROT_WRITE : PROT_READ | PROT_EXEC) == 0;
+}
+
+M68KRecompiler::M68KRecompiler()
+{
+  /* ask for a buffer below this module so blocks can reach the opcode handlers with a rel32 call */
+  auto hint = (void*)((uintptr_t(&hostPageSize) & ~uintptr_t(0xffffff)) - codeBufferSize - 0x1000000);
+  void *mem = mmap(hint, codeBufferSize, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+  if(mem == MAP_FAILED)
+  {
+    logErr("error mapping 68000 recompiler code buffer, using the interpreter");
+    return;
+  }
+  code = (uint8_t*)mem;
+}
+
+M68KRecompiler::~M68KRecompiler()
+{
+  if(code)
+    munmap(code, codeBufferSize);
+}
+
+void M68KRecompiler::flushCode()
+{
+  blocks.fill({});
+  codeSize = 0;
+}
+
+bool M68KRecompiler::recordBlock(M68KCPU &m68ki_cpu, const OpHandler *opTable, int32_t cycles, unsigned page, const unsigned char *base)
+{
+  if(!code)
+    return false;
+  const uint32_t startPc = REG_PC;
+  const uint32_t generation = pageGeneration[page];
+  auto &b = block(startPc);
+  if(b.pc == startPc && b.base == base && b.generation == generation && b.retries)
+  {
+    b.retries--;
+    return false;
+  }
+
+  /* Run the path through the interpreter, same as the loop in m68k_run(), up to the next
+   * taken jump. Any PC change outside the 2-10 byte length of an instruction counts. */
+  std::array<RecordedOp, maxBlockOps> ops;
+  unsigned opCount = 0;
+  int loopOp = -1;
+  bool jumped = false;
+  do
+  {
+    auto &op = ops[opCount++];
+    op.pc = REG_PC;
+    REG_IR = m68ki_read_imm_16(m68ki_cpu);
+    op.ir = REG_IR;
+    op.handler = opTable[REG_IR];
+    op.handler(m68ki_cpu);
+    USE_CYCLES(CYC_INSTRUCTION[REG_IR]);
+    if(REG_PC <= op.pc || REG_PC > op.pc + 10)
+    {
+      jumped = true;
+      for(unsigned i = 0; i < opCount; i++)
+      {
+        if(ops[i].pc == REG_PC)
+        {
+          loopOp = i;
+          break;
+        }
+      }
+    }
+  } while(!jumped && opCount < maxBlockOps && m68ki_cpu.cycleCount < cycles
+    && ((REG_PC >> 16) & 0xff) == page && m68ki_cpu.memory_map[page].base == base
+    && pageGeneration[page] == generation);
+
+  if(loopOp < 0)
+  {
+    /* leave code that doesn't loop to the interpreter for a while, unless
+       the timeslice or page ended before the path was complete */
+    if(jumped || opCount == maxBlockOps)
+      b = {startPc, generation, base, {}, retryDelay};
+    return true;
+  }
+
+  if(codeSize + maxBlockBytes > codeBufferSize)
+  {
+    logMsg("68000 recompiler code buffer full, flushing");
+    flushCode();
+  }
+  uint8_t *blockCode = code + codeSize;
+  uint8_t *bufferEnd = code + codeBufferSize;
+  if(!setCodeProtection(blockCode, blockCode + maxBlockBytes, bufferEnd, true))
+    return true;
+
+  /* Translate the recorded loop */
+  const auto irDisp = memberOffset(m68ki_cpu, &m68ki_cpu.ir) - cpuBias;
+  const auto pcDisp = memberOffset(m68ki_cpu, &m68ki_cpu.pc) - cpuBias;
+  const auto cycleCountDisp = memberOffset(m68ki_cpu, &m68ki_cpu.cycleCount) - cpuBias;
+  const auto mapBaseDisp = memberOffset(m68ki_cpu, &m68ki_cpu.memory_map[page].base) - cpuBias;
+  X64Emitter e{blockCode};
+  e.bytes({0x53, 0x55, 0x41, 0x54, 0x41, 0x55, 0x41, 0x57}); /* push rbx, rbp, r12, r13, r15 */
+  e.bytes({0x48, 0x8D, 0x9F}); e.u32(cpuBias); /* lea rbx, [rdi+cpuBias] */
+  e.bytes({0x41, 0x89, 0xF4}); /* mov r12d, esi */
+  e.bytes({0x49, 0xBD}); e.u64(uint64_t(&CYC_INSTRUCTION[0])); /* mov r13, cycle table */
+  e.bytes({0x48, 0xBD}); e.u64(uint64_t(base)); /* mov rbp, base */
+  e.bytes({0x49, 0xBF}); e.u64(uint64_t(&pageGeneration[page])); /* mov r15, &pageGeneration[page] */
+  std::array<uint8_t*, maxBlockOps> opLabel;
+  for(unsigned i = 0; i < opCount; i++)
+  {
+    const auto &op = ops[i];
+    opLabel[i] = e.p;
+    /* REG_IR = op.ir; REG_PC += 2; handler(cpu); REG_PC already matches op.pc here */
+    e.byte(0xC7); e.rbxMem(0, irDisp); e.u32(op.ir); /* mov dword [rbx+ir], op.ir */
+    e.byte(0x83); e.rbxMem(0, pcDisp); e.byte(2); /* add dword [rbx+pc], 2 */
+    e.bytes({0x48, 0x8D}); e.rbxMem(7, -cpuBias); /* lea rdi, [rbx-cpuBias] */
+    e.call((const void*)op.handler);
+    /* USE_CYCLES(CYC_INSTRUCTION[REG_IR]), the handler may change IR (setIRQDelay) */
+    e.byte(0x8B); e.rbxMem(0, irDisp); /* mov eax, [rbx+ir] */
+    e.bytes({0x41, 0x0F, 0xB6, 0x44, 0x05, 0x00}); /* movzx eax, byte [r13+rax] */
+    e.byte(0x01); e.rbxMem(0, cycleCountDisp); /* add [rbx+cycleCount], eax */
+    e.bytes({0x44, 0x39}); e.rbxMem(4, cycleCountDisp); /* cmp [rbx+cycleCount], r12d */
+    e.jgeExit();
+    /* exit if the page was remapped or invalidated */
+    e.bytes({0x48, 0x39}); e.rbxMem(5, mapBaseDisp); /* cmp [rbx+mapBase], rbp */
+    e.jneExit();
+    e.bytes({0x41, 0x81, 0x3F}); e.u32(generation); /* cmp dword [r15], generation */
+    e.jneExit();
+    /* continue only along the recorded path */
+    bool isLast = i == opCount - 1;
+    auto nextPc = isLast ? ops[loopOp].pc : ops[i + 1].pc;
+    e.byte(0x81); e.rbxMem(7, pcDisp); e.u32(nextPc); /* cmp dword [rbx+pc], nextPc */
+    if(isLast)
+    {
+      e.je(opLabel[loopOp]);
+      e.jmpExit();
+    }
+    else
+    {
+      e.jneExit();
+    }
+  }
+  e.patchExits(e.p);
+  e.bytes({0x41, 0x5F, 0x41, 0x5D, 0x41, 0x5C, 0x5D, 0x5B, 0xC3}); /* pop r15, r13, r12, rbp, rbx, ret */
+  assert(size_t(e.p - blockCode) <= maxBlockBytes);
+  __builtin___clear_cache((char*)blockCode, (char*)e.p);
+  if(!setCodeProtection(blockCode, blockCode + maxBlockBytes, bufferEnd, false))
+  {
+    logErr("error making 68000 recompiler code executable, using the interpreter");
+    flushCode();
+    munmap(code, codeBufferSize);
+    code = {};
+    return true;
+  }
+  codeSize += ((e.p - blockCode) + 15) & ~size_t(15);
+  block(startPc) = {startPc, generation, base, (BlockFunc)blockCode};
+  return true;
+}
+
+#endif
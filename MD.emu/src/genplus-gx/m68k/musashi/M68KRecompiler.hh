@@ -0,0 +1,114 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+
+struct M68KCPU;
+
+/* Loop recompiler used by m68k_run().
+ * When execution takes a backward jump in a code page, up to maxBlockOps
+ * instructions from the jump target are run through the interpreter while their
+ * opcode handlers and PCs are recorded, until the next taken jump. If that jump
+ * goes back into the recorded path, the loop is translated to host code that
+ * calls each handler directly, adds its cycles from the core's
+ * InstructionCycleTable, and checks the same end of timeslice condition as the
+ * interpreter loop. After every instruction the block exits to the dispatcher
+ * unless the PC matches the recorded path, so branches, exceptions, and
+ * interrupts leave a block at exactly the instruction the interpreter would
+ * have stopped at.
+ *
+ * Straight line code stays in the interpreter since its translation costs more
+ * in instruction cache misses than it saves in opcode dispatch. Jump targets
+ * that didn't form a loop are remembered and only recorded again after
+ * retryDelay more visits.
+ *
+ * Only pages marked with setCodePages() are translated. A block is dropped when
+ * its page's base pointer changes (mapper bank switch) or the page is
+ * invalidated, so code running from RAM (self-modifying or copied routines)
+ * always goes through the interpreter. Only x86-64 Linux/Android has a code
+ * generator, m68k.h defines M68K_RECOMPILER there and this class is only
+ * available when it's set.
+ */
+class M68KRecompiler
+{
+public:
+	using BlockFunc = void (*)(M68KCPU &, int32_t endCycles);
+	using OpHandler = void (*)(M68KCPU &);
+	static constexpr unsigned maxBlockOps = 64;
+	static constexpr unsigned blockCountBits = 12;
+	static constexpr unsigned blockCount = 1 << blockCountBits;
+	static constexpr unsigned retryDelay = 64;
+	static constexpr size_t codeBufferSize = 8 * 1024 * 1024;
+
+	struct Block
+	{
+		uint32_t pc = ~0u;
+		uint32_t generation{};
+		const unsigned char *base{};
+		BlockFunc func{};
+		uint32_t retries{};
+	};
+
+	M68KRecompiler();
+	~M68KRecompiler();
+	M68KRecompiler(const M68KRecompiler &) = delete;
+	M68KRecompiler &operator=(const M68KRecompiler &) = delete;
+	bool isSupported() const { return code; }
+
+	/* Mark pages whose opcodes only change via a base pointer switch or invalidatePage() */
+	void setCodePages(unsigned firstPage, unsigned lastPage, bool on = true)
+	{
+		for(unsigned i = firstPage; i <= lastPage; i++)
+			codePage[i & 0xff] = on;
+	}
+
+	/* For cores that map RAM over code pages, also require a page's base pointer to be in this block */
+	void setCodeRange(const unsigned char *begin, size_t size)
+	{
+		rangeBegin = begin;
+		rangeEnd = begin + size;
+	}
+
+	bool isCodePage(unsigned page, const unsigned char *base) const
+	{
+		if(!codePage[page])
+			return false;
+		return !rangeBegin || (base >= rangeBegin && base < rangeEnd);
+	}
+
+	void invalidatePage(unsigned page) { pageGeneration[page & 0xff]++; }
+
+	void invalidate()
+	{
+		for(auto &g : pageGeneration)
+			g++;
+	}
+
+	BlockFunc findBlock(uint32_t pc, unsigned page, const unsigned char *base) const
+	{
+		auto &b = block(pc);
+		if(b.pc == pc && b.base == base && b.generation == pageGeneration[page])
+			return b.func;
+		return {};
+	}
+
+	/* Interprets from the current PC, a backward jump target, with the core's opcode handler table
+	 * and translates the path if it loops. Returns false if nothing was run because the target
+	 * is waiting for a retry or the code buffer couldn't be written. */
+	bool recordBlock(M68KCPU &, const OpHandler *opTable, int32_t endCycles, unsigned page, const unsigned char *base);
+
+private:
+	std::array<Block, blockCount> blocks{};
+	std::array<uint32_t, 256> pageGeneration{};
+	std::array<bool, 256> codePage{};
+	const unsigned char *rangeBegin{};
+	const unsigned char *rangeEnd{};
+	uint8_t *code{};
+	size_t codeSize{};
+
+	static constexpr unsigned blockIndex(uint32_t pc) { return (pc * 0x9E3779B1u) >> (32 - blockCountBits); }
+	Block &block(uint32_t pc) { return blocks[blockIndex(pc)]; }
+	const Block &block(uint32_t pc) const { return blocks[blockIndex(pc)]; }
+	void flushCode();
+};
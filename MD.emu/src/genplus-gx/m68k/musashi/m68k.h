@@ -34,6 +34,13 @@
 #include <stdlib.h>
 #include "m68kconf.h"
 
+/* The loop recompiler (M68KRecompiler.hh) only has an x86-64 code generator and skips
+ * the opcode fetch, other hosts, or builds emulating trace, address errors, prefetch or
+ * function codes, run the plain interpreter without any of its hooks */
+#if defined __x86_64__ && defined __linux__ && !M68K_EMULATE_TRACE && !M68K_EMULATE_ADDRESS_ERROR && !M68K_EMULATE_PREFETCH && !M68K_EMULATE_FC
+#define M68K_RECOMPILER
+#endif
+
 /* ======================================================================== */
 /* ============================ GENERAL DEFINES =========================== */
 
@@ -189,6 +196,10 @@ struct _m68k_memory_map
  */
 void m68k_write_memory_32_pd(unsigned int address, unsigned int value);
 
+#ifdef M68K_RECOMPILER
+class M68KRecompiler;
+#endif
+
 typedef union
 {
   uint64_t i;
@@ -283,7 +294,13 @@ struct M68KCPU
   int irqLatency = 0;
   int32_t cycleCount = 0;
   int32_t endCycles = 0;
+#ifdef M68K_RECOMPILER
+  int32_t dispatchCycles = 0; /* Run target of the recompiler's interpreter loop, backward jumps end it early */
+#endif
   _m68k_memory_map memory_map[256]{};
+#ifdef M68K_RECOMPILER
+  M68KRecompiler *recompiler{}; /* Loop recompiler, set by the core to enable it (M68KRecompiler.hh) */
+#endif
 
   /* Set the IPL0-IPL2 pins on the CPU (IRQ).
    * A transition from < 7 to 7 will cause a non-maskable interrupt (NMI).
@@ -477,6 +494,13 @@ void m68k_pulse_reset(M68KCPU &m68ki_cpu);
 /* run until global cycle count is reached */
 void m68k_run(M68KCPU &m68ki_cpu, int cycles) __attribute__((hot));
 
+/* Drop all recompiled blocks, call after patching code in memory the CPU may have run */
+#ifdef M68K_RECOMPILER
+void m68k_flush_recompiler(M68KCPU &m68ki_cpu);
+#else
+static inline void m68k_flush_recompiler(M68KCPU &) {}
+#endif
+
 /* These functions let you read/write/modify the number of cycles left to run
  * while m68k_execute() is running.
  * These are useful if the 68k accesses a memory-mapped port on another device
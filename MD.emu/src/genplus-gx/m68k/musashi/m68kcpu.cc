@@ -34,6 +34,9 @@ static const char copyright_notice[] =
 
 #include "m68kops.h"
 #include "m68kcpu.h"
+#ifdef M68K_RECOMPILER
+#include "M68KRecompiler.hh"
+#endif
 
 #include <imagine/logger/logger.h>
 
@@ -927,6 +930,50 @@ void M68KCPU::setIRQDelay(unsigned int mask)
   m68ki_check_interrupts(*this); /* Level triggered (IRQ) */
 }
 
+#ifdef M68K_RECOMPILER
+/* Same as the interpreter loop in m68k_run(), but loops in code pages run as
+ * recompiled blocks. The interpreter runs until a backward jump, where a loop
+ * can start, so other code doesn't pay for a block lookup. */
+static void m68ki_run_recompiled(M68KCPU &m68ki_cpu, M68KRecompiler &rec, int cycles)
+{
+  bool atLoopHead = false;
+  while (m68ki_cpu.cycleCount < cycles)
+  {
+    unsigned page = (REG_PC >> 16) & 0xff;
+    const unsigned char *base = m68ki_cpu.memory_map[page].base;
+    if (rec.isCodePage(page, base))
+    {
+      if (auto block = rec.findBlock(REG_PC, page, base))
+      {
+        block(m68ki_cpu, cycles);
+        atLoopHead = false;
+        continue;
+      }
+      if (atLoopHead && rec.recordBlock(m68ki_cpu, m68ki_instruction_jump_table, cycles, page, base))
+      {
+        atLoopHead = false;
+        continue;
+      }
+    }
+
+    m68ki_cpu.dispatchCycles = cycles;
+    do
+    {
+      REG_IR = m68ki_read_imm_16(m68ki_cpu);
+      m68ki_instruction_jump_table[REG_IR](m68ki_cpu);
+      USE_CYCLES(CYC_INSTRUCTION[REG_IR]);
+    } while (m68ki_cpu.cycleCount < m68ki_cpu.dispatchCycles);
+    atLoopHead = m68ki_cpu.dispatchCycles == INT32_MIN;
+  }
+}
+
+void m68k_flush_recompiler(M68KCPU &m68ki_cpu)
+{
+  if (m68ki_cpu.recompiler)
+    m68ki_cpu.recompiler->invalidate();
+}
+#endif
+
 void m68k_run(M68KCPU &m68ki_cpu, int cycles)
 {
   /* Make sure we're not stopped */
@@ -942,6 +989,14 @@ void m68k_run(M68KCPU &m68ki_cpu, int cycles)
   /* Save end cycles count for when CPU is stopped */
   m68ki_cpu.endCycles = cycles;
 
+#ifdef M68K_RECOMPILER
+  if (m68ki_cpu.recompiler && m68ki_cpu.recompiler->isSupported())
+  {
+    m68ki_run_recompiled(m68ki_cpu, *m68ki_cpu.recompiler, cycles);
+    return;
+  }
+#endif
+
   while (m68ki_cpu.cycleCount < cycles)
   {
     /* Set tracing accodring to T1. */
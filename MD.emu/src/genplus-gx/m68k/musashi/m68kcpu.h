@@ -1395,6 +1395,15 @@ SINLINE void m68ki_fake_pull_32(M68KCPU &m68ki_cpu)
 
 /* ----------------------------- Program Flow ----------------------------- */
 
+#ifdef M68K_RECOMPILER
+/* A backward jump may close a loop, end the interpreter loop of m68ki_run_recompiled()
+ * so it can look for one at the target. The regular run loop ignores this. */
+SINLINE void m68ki_backward_jump(M68KCPU &m68ki_cpu)
+{
+  m68ki_cpu.dispatchCycles = INT32_MIN;
+}
+#endif
+
 /* Jump to a new program location or vector.
  * These functions will also call the pc_changed callback if it was enabled
  * in m68kconf.h.
@@ -1403,6 +1412,10 @@ SINLINE void m68ki_jump(M68KCPU &m68ki_cpu, uint new_pc)
 {
 	uint old = REG_PC;
   REG_PC = new_pc;
+#ifdef M68K_RECOMPILER
+  if (new_pc <= old)
+    m68ki_backward_jump(m68ki_cpu);
+#endif
   CALLBACK_PC_CHANGED(m68ki_cpu, old, REG_PC);
 }
 
@@ -1427,16 +1440,28 @@ SINLINE void m68ki_jump_vector(M68KCPU &m68ki_cpu, uint vector)
 SINLINE void m68ki_branch_8(M68KCPU &m68ki_cpu, uint offset)
 {
   REG_PC += MAKE_INT_8(offset);
+#ifdef M68K_RECOMPILER
+  if (MAKE_INT_8(offset) < 0)
+    m68ki_backward_jump(m68ki_cpu);
+#endif
 }
 
 SINLINE void m68ki_branch_16(M68KCPU &m68ki_cpu, uint offset)
 {
   REG_PC += MAKE_INT_16(offset);
+#ifdef M68K_RECOMPILER
+  if (MAKE_INT_16(offset) < 0)
+    m68ki_backward_jump(m68ki_cpu);
+#endif
 }
 
 SINLINE void m68ki_branch_32(M68KCPU &m68ki_cpu, uint offset)
 {
   REG_PC += offset;
+#ifdef M68K_RECOMPILER
+  if (MAKE_INT_32(offset) < 0)
+    m68ki_backward_jump(m68ki_cpu);
+#endif
   CALLBACK_PC_CHANGED(m68ki_cpu, REG_PC - offset, REG_PC);
 }
 
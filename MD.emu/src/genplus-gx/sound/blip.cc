@@ -2,9 +2,10 @@
 
 #include "blip.h"
 
+#include <math.h>
 #include <string.h>
 #include <stdlib.h>
-#include <stddef.h>
+#include <stdint.h>
 
 /* Copyright (C) 2003-2008 Shay Green. This module is free software; you
 can redistribute it and/or modify it under the terms of the GNU Lesser
@@ -17,36 +18,99 @@ details. You should have received a copy of the GNU Lesser General Public
 License along with this module; if not, write to the Free Software Foundation,
 Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA */
 
-enum { buf_extra   = 2 };  /* extra samples to save past end */
-enum { time_bits   = 16 }; /* bits in fraction of fixed-point sample counts */
-enum { time_unit   = 1 << time_bits };
-enum { phase_bits  = 15 }; /* bits in fraction of deltas in buffer */
-enum { phase_count = 1 << phase_bits };
-enum { phase_shift = time_bits - phase_bits };
+typedef uint64_t fixed_t;
+
+static const int pre_shift   = 32;
+static const int time_bits   = pre_shift + 20; /* bits in fraction of fixed-point sample counts */
+static const fixed_t time_unit = (fixed_t) 1 << time_bits;
+static const int frac_bits   = time_bits - pre_shift;
+static const int bass_shift  = 9;  /* affects high-pass filter breakpoint frequency */
+static const int end_frame_extra = 2; /* allows deltas slightly after frame length */
+static const int half_width  = 8;  /* half the width of the step kernel, in samples */
+static const int buf_extra   = half_width * 2 + end_frame_extra; /* extra samples to save past end */
+static const int phase_bits  = 5;  /* bits in fraction of sample position selecting a kernel */
+static const int phase_count = 1 << phase_bits;
+static const int phase_shift = frac_bits - phase_bits;
+static const int delta_bits  = 15; /* bits in fraction of deltas in buffer */
+static const int delta_unit  = 1 << delta_bits;
 
 typedef int buf_t; /* type of element in delta buffer */
 
 struct blip_buffer_t
 {
-  int factor; /* clocks to samples conversion factor */
-  int offset; /* fractional position of clock 0 in delta buffer */
-  int amp;    /* current output amplitude (sum of all deltas up to now) */
-  int size;   /* size of delta buffer */
-  buf_t buf [65536]; /* delta buffer, only size elements actually allocated */
+  fixed_t factor;     /* clocks to samples conversion factor */
+  fixed_t offset;     /* fractional position of clock 0 in delta buffer */
+  int avail;          /* number of samples ready to be read */
+  int size;           /* size of delta buffers */
+  int integrator [2]; /* current output amplitudes (sum of all deltas up to now) */
+  buf_t* buf [2];     /* left & right delta buffers */
 };
 
+/* Band-limited step kernels, one per sample phase. Row p holds the first
+half of the kernel for a step p/phase_count of a sample into the buffer, the
+second half is row phase_count - p reversed. Each kernel sums to delta_unit. */
+static short bl_step [phase_count + 1] [half_width];
+static int bl_step_ready;
+
+static double step_kernel( double x )
+{
+  /* Blackman windowed sinc, cut off slightly below Nyquist */
+  static const double cutoff = 0.9;
+  const double pi = 3.14159265358979323846;
+  double w = 0.42 + 0.5 * cos( pi * x / half_width ) + 0.08 * cos( 2 * pi * x / half_width );
+  double s = (x == 0) ? cutoff : sin( pi * cutoff * x ) / (pi * x);
+  return s * w;
+}
+
+static void init_step_table( void )
+{
+  int p, i;
+  for ( p = 0; p <= phase_count / 2; ++p )
+  {
+    double kernel [half_width * 2];
+    double sum = 0;
+    int total = 0;
+    for ( i = 0; i < half_width * 2; ++i )
+    {
+      kernel [i] = step_kernel( i - (half_width - 1) - (double) p / phase_count );
+      sum += kernel [i];
+    }
+    for ( i = 0; i < half_width; ++i )
+    {
+      bl_step [p] [i] = (short) floor( kernel [i] * delta_unit / sum + 0.5 );
+      bl_step [phase_count - p] [half_width - 1 - i] =
+          (short) floor( kernel [half_width + i] * delta_unit / sum + 0.5 );
+    }
+
+    /* Put rounding error on the center tap so every kernel keeps unity gain */
+    for ( i = 0; i < half_width; ++i )
+      total += bl_step [p] [i] + bl_step [phase_count - p] [i];
+    if ( p == phase_count / 2 )
+      bl_step [p] [half_width - 1] += (delta_unit - total) / 2;
+    else
+      bl_step [p] [half_width - 1] += delta_unit - total;
+  }
+  bl_step_ready = 1;
+}
+
 blip_buffer_t* blip_alloc( double clock_rate, double sample_rate, int size )
 {
-  /* Allocate space for structure and delta buffer */
+  /* Allocate space for structure and both delta buffers */
   blip_buffer_t* s = (blip_buffer_t*) malloc(
-      offsetof (blip_buffer_t, buf) + (size + buf_extra) * sizeof (buf_t) );
+      sizeof (blip_buffer_t) + (size + buf_extra) * 2 * sizeof (buf_t) );
   if ( s != NULL )
   {
-    /* Calculate output:input ratio and convert to fixed-point */
-	  double ratio = sample_rate / clock_rate;
-    s->factor = (int) (ratio * time_unit + 0.5);
-    
+    /* Calculate output:input ratio and convert to fixed-point, rounding up */
+    double factor = time_unit * sample_rate / clock_rate;
+    s->factor = (fixed_t) factor;
+    if ( s->factor < factor )
+      s->factor++;
+
     s->size = size;
+    s->buf [0] = (buf_t*) (s + 1);
+    s->buf [1] = s->buf [0] + size + buf_extra;
+    if ( !bl_step_ready )
+      init_step_table();
     blip_clear( s );
   }
   return s;
@@ -59,97 +123,116 @@ void blip_free( blip_buffer_t* s )
 
 void blip_clear( blip_buffer_t* s )
 {
-  s->offset = 0;
-  s->amp    = 0;
-  memset( s->buf, 0, (s->size + buf_extra) * sizeof (buf_t) );
+  /* Start at the middle of a sample to make rounding of clock times symmetric */
+  s->offset = s->factor / 2;
+  s->avail  = 0;
+  s->integrator [0] = 0;
+  s->integrator [1] = 0;
+  memset( s->buf [0], 0, (s->size + buf_extra) * 2 * sizeof (buf_t) );
+}
+
+static inline void add_step( buf_t* out, const short* in, const short* rev, int delta, int delta2 )
+{
+  int i;
+  for ( i = 0; i < half_width; ++i )
+    out [i] += in [i] * delta + in [half_width + i] * delta2;
+  for ( i = 0; i < half_width; ++i )
+    out [half_width + i] += rev [half_width - 1 - i] * delta + rev [-1 - i] * delta2;
 }
 
-void blip_add( blip_buffer_t* s, int clocks, int delta )
+void blip_add_delta( blip_buffer_t* s, unsigned int time, int delta_l, int delta_r )
 {
   /* Convert to fixed-point time in terms of output samples */
-  int fixed_time = clocks * s->factor + s->offset;
-  
-  /* Extract whole and fractional parts */
-  int index = fixed_time >> time_bits; /* whole */
-  int phase = fixed_time >> phase_shift & (phase_count - 1); /* fraction */
-  
-  /* Split delta between first and second samples */
-  int second = delta * phase;
-  int first  = delta * phase_count - second;
-  
-  /* Add deltas to buffer */
-  s->buf [index  ] += first;
-  s->buf [index+1] += second;
+  unsigned int fixed = (unsigned int) ((time * s->factor + s->offset) >> pre_shift);
+  int index = s->avail + (fixed >> frac_bits);
+
+  /* Select the kernels surrounding the exact phase and interpolate between them */
+  int phase = fixed >> phase_shift & (phase_count - 1);
+  const short* in  = bl_step [phase];
+  const short* rev = bl_step [phase_count - phase];
+  int interp = fixed & ((1 << phase_shift) - 1);
+
+  if ( delta_l )
+  {
+    int delta2 = (int) (((int64_t) delta_l * interp) >> phase_shift);
+    add_step( s->buf [0] + index, in, rev, delta_l - delta2, delta2 );
+  }
+  if ( delta_r )
+  {
+    int delta2 = (int) (((int64_t) delta_r * interp) >> phase_shift);
+    add_step( s->buf [1] + index, in, rev, delta_r - delta2, delta2 );
+  }
 }
 
-int blip_clocks_needed( const blip_buffer_t* s, int samples )
+void blip_add( blip_buffer_t* s, unsigned int time, int delta )
 {
-  int fixed_needed;
-  if ( samples > s->size )
-    samples = s->size;
-  
-  /* Fixed-point number of samples needed in addition to those in buffer */
-  fixed_needed = samples * time_unit - s->offset;
-  
-  /* If more are needed, convert to clocks and round up */
-  return (fixed_needed <= 0) ? 0 : (fixed_needed - 1) / s->factor + 1;
+  blip_add_delta( s, time, delta, delta );
 }
 
-void blip_end_frame( blip_buffer_t* s, int clocks )
+void blip_end_frame( blip_buffer_t* s, unsigned int clocks )
 {
-  s->offset += clocks * s->factor;
+  fixed_t off = clocks * s->factor + s->offset;
+  s->avail += (int) (off >> time_bits);
+  s->offset = off & (time_unit - 1);
 }
 
 int blip_samples_avail( const blip_buffer_t* s )
 {
-  return s->offset >> time_bits;
+  return s->avail;
 }
 
 /* Removes n samples from buffer */
 static void remove_samples( blip_buffer_t* s, int n )
 {
-  int remain = blip_samples_avail( s ) + buf_extra - n;
-  
-  s->offset -= n * time_unit;
-  
+  int remain = s->avail + buf_extra - n;
+  int ch;
+
+  s->avail -= n;
+
   /* Copy remaining samples to beginning of buffer and clear the rest */
-  memmove( s->buf, &s->buf [n], remain * sizeof (buf_t) );
-  memset( &s->buf [remain], 0, n * sizeof (buf_t) );
+  for ( ch = 0; ch < 2; ++ch )
+  {
+    memmove( s->buf [ch], &s->buf [ch] [n], remain * sizeof (buf_t) );
+    memset( &s->buf [ch] [remain], 0, n * sizeof (buf_t) );
+  }
 }
 
-int blip_read_samples( blip_buffer_t* s, short out [], int count, int stereo )
+int blip_read_samples( blip_buffer_t* s, short out [], int count )
 {
   /* can't read more than available */
-  int avail = blip_samples_avail( s );
-  if ( count > avail )
-    count = avail;
-  
+  if ( count > s->avail )
+    count = s->avail;
+
   if ( count )
   {
-    /* Sum deltas and write out */
-    int i;
-    for ( i = 0; i < count; ++i )
+    int ch;
+    for ( ch = 0; ch < 2; ++ch )
     {
-      int sample;
-      
-      /* Apply slight high-pass filter */
-      s->amp -= s->amp >> 9;
-      
-      /* Add next delta */
-      s->amp += s->buf [i];
-      
-      /* Calculate output sample */
-      sample = s->amp >> phase_bits;
-      
-      /* Keep within 16-bit sample range */
-      if ( sample < -32768 ) sample = -32768;
-      if ( sample > +32767 ) sample = +32767;
-      
-      out [i << stereo] = sample;
+      const buf_t* in = s->buf [ch];
+      int sum = s->integrator [ch];
+      int i;
+      for ( i = 0; i < count; ++i )
+      {
+        /* Calculate output sample */
+        int sample = sum >> delta_bits;
+
+        /* Add next delta */
+        sum += in [i];
+
+        /* Keep within 16-bit sample range */
+        if ( sample < -32768 ) sample = -32768;
+        if ( sample > +32767 ) sample = +32767;
+
+        out [i * 2 + ch] = sample;
+
+        /* Apply slight high-pass filter */
+        sum -= sample << (delta_bits - bass_shift);
+      }
+      s->integrator [ch] = sum;
     }
-    
+
     remove_samples( s, count );
   }
-  
+
   return count;
 }
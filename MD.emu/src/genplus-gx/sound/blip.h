@@ -1,7 +1,8 @@
-/* Fast sound synthesis buffer for use in real-time emulators of electronic
-sound generator chips like those in early video game consoles. Uses linear
-interpolation. Higher-quality versions are available that use sinc-based
-band-limited synthesis. */
+/* Band-limited sound synthesis buffer for use in real-time emulators of
+electronic sound generator chips like those in early video game consoles.
+Amplitude changes are added as steps at a source clock time and converted to
+stereo samples at the output rate through a windowed sinc kernel, so chips
+can be clocked at their native rate without a separate resampling stage. */
 
 #ifndef BLIP_H
 #define BLIP_H
@@ -10,7 +11,7 @@ band-limited synthesis. */
   extern "C" {
 #endif
 
-/* Creates a new blip_buffer with specified input clock rate, output
+/* Creates a new stereo blip_buffer with specified input clock rate, output
 sample rate, and size (in samples), or returns NULL if out of memory. */
 typedef struct blip_buffer_t blip_buffer_t;
 blip_buffer_t* blip_alloc( double clock_rate, double sample_rate, int size );
@@ -21,28 +22,26 @@ void blip_free( blip_buffer_t* );
 /* Removes all samples and clears buffer. */
 void blip_clear( blip_buffer_t* );
 
-/* Adds an amplitude transition of delta at specified time in source clocks.
-Delta can be negative. */
-void blip_add( blip_buffer_t*, int time, int delta );
+/* Adds amplitude transitions of delta_l and delta_r at specified time in
+source clocks. Deltas can be negative and should stay within 16-bit range. */
+void blip_add_delta( blip_buffer_t*, unsigned int time, int delta_l, int delta_r );
 
-/* Number of additional clocks needed until n samples will be available.
-If buffer cannot even hold n samples, returns number of clocks until buffer
-becomes full. */
-int blip_clocks_needed( const blip_buffer_t*, int samples_needed );
+/* Same as blip_add_delta() with the same delta on both channels. */
+void blip_add( blip_buffer_t*, unsigned int time, int delta );
 
 /* Ends current time frame of specified duration and make its samples available
 (along with any still-unread samples) for reading with read_samples(), then
-begins a new time frame at the end of the current frame. */
-void blip_end_frame( blip_buffer_t*, int duration );
+begins a new time frame at the end of the current frame. Deltas added up to
+two output samples past the end of the frame carry over to the next one. */
+void blip_end_frame( blip_buffer_t*, unsigned int duration );
 
 /* Number of samples available for reading with read(). */
 int blip_samples_avail( const blip_buffer_t* );
 
-/* Reads at most n samples out of buffer into out, removing them from from
-the buffer. Returns number of samples actually read and removed. If stereo is
-true, increments 'out' one extra time after writing each sample, to allow
-easy interleving of two channels into a stereo output buffer. */
-int blip_read_samples( blip_buffer_t*, short out [], int n, int stereo );
+/* Reads at most n stereo samples out of buffer into out as interleaved left
+and right values, removing them from the buffer. Returns number of samples
+actually read and removed. */
+int blip_read_samples( blip_buffer_t*, short out [], int n );
 
 #ifdef __cplusplus
   }
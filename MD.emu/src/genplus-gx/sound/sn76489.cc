@@ -32,6 +32,9 @@
     - Removed alternate volume table, panning & mute support (unused)
     - Removed configurable Feedback and Shift Register Width (always use Sega ones)
     - Added linear resampling using Blip Buffer (based on Blargg's implementation: http://www.smspower.org/forums/viewtopic.php?t=11376)
+
+    Transitions are now added as band-limited steps at their M-cycle time to the
+    Blip Buffer shared with the FM chip (see sound.cc)
 */
 
 #include "shared.h"
@@ -76,18 +79,14 @@ static const unsigned PSGVolumeValues[16] = {
   1516,1205,957,760,603,479,381,303,240,191,152,120,96,76,60,0
 };
 
-static struct blip_buffer_t* blip;  /* delta resampler */
+static struct blip_buffer_t* blip;  /* shared delta resampler, clocked in M-cycles */
+static unsigned int blip_time;      /* M-cycle time of the first clock of the current update */
 
 static SN76489_Context SN76489;
 
-void SN76489_Init(double PSGClockValue, int SamplingRate)
+void SN76489_Init(struct blip_buffer_t *buffer)
 {
-  SN76489_Shutdown();
-  
-  /* SamplingRate*16 instead of PSGClockValue/16 since division would lose some
-      precision. blip_alloc doesn't care about the absolute sampling rate, just the
-      ratio to clock rate. */
-  blip = blip_alloc(PSGClockValue, SamplingRate * 16.0, SamplingRate / 4);
+  blip = buffer;
 }
 
 void SN76489_Reset()
@@ -119,14 +118,10 @@ void SN76489_Reset()
   SN76489.NoiseShiftRegister=NoiseInitialState;
   SN76489.NoiseFreq = 0x10;
   SN76489.BoostNoise = config_psgBoostNoise;
-
-  /* Clear Blip delta buffer */
-  if (blip) blip_clear(blip);
 }
 
 void SN76489_Shutdown(void)
 {
-  if (blip) blip_free(blip);
   blip = NULL;
 }
 
@@ -212,7 +207,7 @@ static void UpdateToneAmplitude(int i, int time)
   if (delta != 0)
   {
     SN76489.chan_amp[i] += delta;
-    blip_add(blip, time, delta);
+    blip_add(blip, blip_time + time * PSG_MCYCLES_RATIO, delta * config_psg_preamp / 100);
   }
 }
 
@@ -223,7 +218,7 @@ static void UpdateNoiseAmplitude(int time)
   if (delta != 0)
   {
     SN76489.chan_amp[3] += delta;
-    blip_add(blip, time, delta);
+    blip_add(blip, blip_time + time * PSG_MCYCLES_RATIO, delta * config_psg_preamp / 100);
   }
 }
 
@@ -310,12 +305,12 @@ static void RunNoise(int clock_length)
   SN76489.ToneFreqVals[3] = time - clock_length;
 }
 
-void SN76489_Update(INT16 *buffer, int length)
+/* Runs the PSG for clock_length clocks starting at M-cycle 'time' of the current frame */
+void SN76489_Update(unsigned int time, int clock_length)
 {
   int i;
 
-  /* Determine how many clocks we need to run until 'length' samples are available */
-  int clock_length = blip_clocks_needed(blip, length);
+  blip_time = time;
 
   /* Run noise first, since it might use current value of third tone frequency counter */
   RunNoise(clock_length);
@@ -323,8 +318,4 @@ void SN76489_Update(INT16 *buffer, int length)
   /* Run tone channels */
   for( i = 0; i <= 2; ++i )
     RunTone(i, clock_length);
-
-  /* Read samples into output buffer */
-  blip_end_frame(blip, clock_length);
-  blip_read_samples(blip, buffer, length, 0);
 }
@@ -6,9 +6,12 @@
 #ifndef _SN76489_H_
 #define _SN76489_H_
 
+/* PSG output is clocked in M-cycles: one tone/noise counter step every 16 PSG clocks (PSG clock = MCLK / 15) */
+#define PSG_MCYCLES_RATIO (16 * 15)
+
 /* Function prototypes */
 
-extern void SN76489_Init(double PSGClockValue, int SamplingRate);
+extern void SN76489_Init(struct blip_buffer_t *buffer);
 extern void SN76489_Reset(void);
 extern void SN76489_Shutdown(void);
 extern void SN76489_SetContext(uint8 *data);
@@ -16,7 +19,7 @@ extern void SN76489_GetContext(uint8 *data);
 extern uint8 *SN76489_GetContextPtr(void);
 extern int SN76489_GetContextSize(void);
 extern void SN76489_Write(int data);
-extern void SN76489_Update(INT16 *buffer, int length);
+extern void SN76489_Update(unsigned int time, int clocks);
 extern void SN76489_BoostNoise(int boost);
 
 #endif /* _SN76489_H_ */
@@ -21,92 +21,241 @@
  *  Sound Hardware
  ****************************************************************************************/
 
-#include "shared.h"
-#include "Fir_Resampler.h"
 
-/* Cycle-accurate samples */
-static unsigned int psg_cycles_ratio;
+#include "shared.h"
+#include "blip.h"
+#include <algorithm>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+/* M-cycles run by each chip since the start of the frame */
 static uint32 psg_cycles_count;
 static unsigned int fm_cycles_ratio;
 static uint32 fm_cycles_count;
 
+/* FM output goes to the shared blip buffer, or to its own while synthesized on the FM thread */
+static blip_buffer_t *fm_blip;
+static int fm_last[2];
+
 /* YM chip function pointers */
 static void (*YM_Reset)(void);
 static void (*YM_Update)(FMSampleType *buffer, int length);
 static void (*YM_Write)(unsigned int a, unsigned int v);
 
 /* Run FM chip for required M-cycles */
-static inline void fm_update(unsigned int cycles)
+static void fm_update(unsigned int cycles)
 {
   if (cycles > fm_cycles_count)
   {
-    /* period to run */
-    cycles -= fm_cycles_count;
-
-    /* update cycle count */
-    fm_cycles_count += cycles;
+    /* number of samples during period (one sample ahead if not a whole number) */
+    unsigned int cnt = (cycles - fm_cycles_count + fm_cycles_ratio - 1) / fm_cycles_ratio;
 
-    /* number of samples during period */
-    unsigned int cnt = cycles / fm_cycles_ratio;
-
-    /* remaining cycles */
-    unsigned int remain = cycles % fm_cycles_ratio;
-    if (remain)
+    do
     {
-      /* one sample ahead */
-      fm_cycles_count += fm_cycles_ratio - remain;
-      cnt++;
+      /* run FM chip & get samples */
+      FMSampleType buffer[256 * 2];
+      unsigned int length = std::min(cnt, 256u);
+      YM_Update(buffer, length);
+      cnt -= length;
+
+      /* add output changes as band-limited steps at the time of each sample */
+      for (unsigned int i = 0; i < length; i++)
+      {
+        int l = (buffer[i * 2] * config_fm_preamp) / 100;
+        int r = (buffer[i * 2 + 1] * config_fm_preamp) / 100;
+        blip_add_delta(fm_blip, fm_cycles_count, l - fm_last[0], r - fm_last[1]);
+        fm_last[0] = l;
+        fm_last[1] = r;
+        fm_cycles_count += fm_cycles_ratio;
+      }
     }
+    while (cnt);
+  }
+}
 
-    /* select input sample buffer */
-    FMSampleType *buffer = Fir_Resampler_buffer();
-    if (buffer)
-    {
-      Fir_Resampler_write(cnt << 1);
-    }
-    else
+/* Run PSG chip for required M-cycles */
+static inline void psg_update(unsigned int cycles)
+{
+  if (cycles > psg_cycles_count)
+  {
+    /* number of PSG clocks during period (one clock ahead if not a whole number) */
+    unsigned int clocks = (cycles - psg_cycles_count + PSG_MCYCLES_RATIO - 1) / PSG_MCYCLES_RATIO;
+
+    /* run PSG chip & add output changes */
+    SN76489_Update(psg_cycles_count, clocks);
+    psg_cycles_count += clocks * PSG_MCYCLES_RATIO;
+  }
+}
+
+/****************************************************************
+ * YM2612 synthesis thread
+ *
+ * Register writes are queued with their M-cycle time and replayed
+ * on the FM thread, which renders into snd.blips[1] while the CPUs
+ * keep running. The timers have a copy on the emulation thread so
+ * status reads don't wait for the FM thread.
+ ****************************************************************/
+
+enum { FM_EVENT_WRITE, FM_EVENT_RESET, FM_EVENT_RUN };
+
+struct fm_event
+{
+  unsigned int cycles;
+  uint8 type;
+  uint8 address;
+  uint8 data;
+};
+
+static struct
+{
+  std::mutex mutex;
+  std::condition_variable cond;
+  std::vector<fm_event> queue; /* events passed to the FM thread */
+  bool busy;                   /* FM thread is running events */
+  bool started;
+} fm_thread;
+
+static bool fm_thread_enabled;           /* user setting */
+static bool fm_threaded;                 /* YM2612 currently runs on the FM thread */
+static std::vector<fm_event> fm_pending; /* events not yet passed to the FM thread */
+static uint32 timers_cycles_count;       /* M-cycles run by the timers copy */
+
+static void fm_thread_func(void)
+{
+  std::vector<fm_event> events;
+  std::unique_lock lock{fm_thread.mutex};
+  while (1)
+  {
+    fm_thread.cond.wait(lock, []{ return !fm_thread.queue.empty(); });
+    events.swap(fm_thread.queue);
+    fm_thread.busy = 1;
+    lock.unlock();
+
+    for (const auto &e : events)
     {
-      buffer = snd.fm.pos;
-      snd.fm.pos += (cnt << 1);
+      switch (e.type)
+      {
+        case FM_EVENT_WRITE:
+          if (e.address & 1) fm_update(e.cycles);
+          YM_Write(e.address, e.data);
+          break;
+        case FM_EVENT_RESET:
+          fm_update(e.cycles);
+          YM_Reset();
+          break;
+        case FM_EVENT_RUN:
+          fm_update(e.cycles);
+          break;
+      }
     }
+    events.clear();
 
-    /* run FM chip & get samples */
-    YM_Update(buffer, cnt);
+    lock.lock();
+    fm_thread.busy = 0;
+    fm_thread.cond.notify_all();
   }
 }
 
-/* Run PSG chip for required M-cycles */
-static inline void psg_update(unsigned int cycles)
+/* Pass pending events to the FM thread */
+static void fm_thread_flush(void)
 {
-  if (cycles > psg_cycles_count)
+  if (fm_pending.empty())
+    return;
+  bool wake;
   {
-    /* period to run */
-    cycles -= psg_cycles_count;
+    std::scoped_lock lock{fm_thread.mutex};
+    wake = fm_thread.queue.empty();
+    fm_thread.queue.insert(fm_thread.queue.end(), fm_pending.begin(), fm_pending.end());
+  }
+  fm_pending.clear();
+  if (wake)
+    fm_thread.cond.notify_all();
+}
 
-    /* update cycle count */
-    psg_cycles_count += cycles;
+/* Wait until the FM thread ran all events, the YM2612 state & FM blip buffer can then be used here */
+static void fm_thread_sync(void)
+{
+  if (!fm_threaded)
+    return;
+  fm_thread_flush();
+  std::unique_lock lock{fm_thread.mutex};
+  fm_thread.cond.wait(lock, []{ return fm_thread.queue.empty() && !fm_thread.busy; });
+}
 
-    /* number of samples during period */
-    unsigned int cnt = cycles / psg_cycles_ratio;
+/* Run the YM2612 timers copy for required M-cycles */
+static inline void timers_update(unsigned int cycles)
+{
+  if (cycles > timers_cycles_count)
+  {
+    unsigned int cnt = (cycles - timers_cycles_count + fm_cycles_ratio - 1) / fm_cycles_ratio;
+    timers_cycles_count += cnt * fm_cycles_ratio;
+    YM2612TimersUpdate(cnt);
+  }
+}
+
+/* Move FM synthesis to the FM thread or back, only between frames */
+static void fm_set_threaded(bool threaded)
+{
+  threaded = threaded && (system_hw != SYSTEM_PBC) && snd.blips[1];
+  if (threaded == fm_threaded)
+    return;
 
-    /* remaining cycles */
-    unsigned int remain = cycles % psg_cycles_ratio;
-    if (remain)
+  blip_buffer_t *blip;
+  if (threaded)
+  {
+    if (!fm_thread.started)
     {
-      /* one sample ahead */
-      psg_cycles_count += psg_cycles_ratio - remain;
-      cnt++;
+      std::thread{fm_thread_func}.detach();
+      fm_thread.started = 1;
     }
+    YM2612TimersSync();
+    timers_cycles_count = fm_cycles_count;
+    blip_clear(snd.blips[1]);
+    blip = snd.blips[1];
+  }
+  else
+  {
+    fm_thread_sync();
+    YM2612TimersRestore();
+    blip = snd.blips[0];
+  }
+
+  /* carry the current FM output level over to the new buffer */
+  blip_add_delta(fm_blip, fm_cycles_count, -fm_last[0], -fm_last[1]);
+  blip_add_delta(blip, fm_cycles_count, fm_last[0], fm_last[1]);
+  fm_blip = blip;
+  fm_threaded = threaded;
+}
 
-    /* run PSG chip & get samples */
-    SN76489_Update(snd.psg.pos, cnt);
-    snd.psg.pos += cnt;
+void sound_set_fm_thread(int enable)
+{
+  fm_thread_enabled = enable;
+  fm_set_threaded(enable);
+}
+
+void sound_sync(void)
+{
+  fm_thread_sync();
+}
+
+void sound_update_line(unsigned int cycles)
+{
+  if (fm_threaded)
+  {
+    /* let the FM thread run up to this point */
+    fm_pending.push_back({cycles, FM_EVENT_RUN});
+    fm_thread_flush();
   }
 }
 
 /* Initialize sound chips emulation */
 void sound_init(void)
 {
+  /* chips are reinitialized on this thread */
+  fm_set_threaded(0);
+
   /* Number of M-cycles executed per second.                                              */
   /*                                                                                      */
   /* The original Genesis would run exactly 53693175 M-cycles (53203424 for PAL), with    */
@@ -126,66 +275,76 @@ void sound_init(void)
   /*                                                                                      */
 	double mclk = MCYCLES_PER_LINE * lines_per_frame * snd.frame_rate;
 
-  /* For better accuracy, sound chips run in synchronization with 68k and Z80 cpus        */
-  /* These values give the exact number of M-cycles between 2 rendered samples.           */
-  /* we use 21.11 fixed point precision (max. mcycle value is 3420*313 i.e 21 bits max)   */
-  psg_cycles_ratio  = (unsigned int)(mclk / (double) snd.sample_rate * 2048.0);
-  fm_cycles_ratio   = psg_cycles_ratio;
+  /* Both chips run at their original rate and add their output changes as band-limited  */
+  /* steps, clocked in M-cycles, to a blip buffer that outputs directly at the output    */
+  /* samplerate. A second buffer receives FM output when rendered on the FM thread.      */
+  int size = (int)(snd.sample_rate / snd.frame_rate) + 32;
+  for (int i = 0; i < 2; i++)
+  {
+    blip_free(snd.blips[i]);
+    snd.blips[i] = blip_alloc(mclk, snd.sample_rate, size);
+  }
+  fm_blip = snd.blips[0];
+  fm_last[0] = fm_last[1] = 0;
   fm_cycles_count   = 0;
   psg_cycles_count  = 0;
 
   /* Initialize core emulation (input clock based on input frequency for 100% accuracy)   */
-  /* By default, both chips are running at the output frequency.                          */
-  SN76489_Init(mclk/15.0,snd.sample_rate);
+  SN76489_Init(snd.blips[0]);
 
   #ifndef NO_SYSTEM_PBC
   if (system_hw == SYSTEM_PBC)
   {
-	/* YM2413 */
+	/* YM2413 (one sample each 72*15 M-cycles) */
 	YM2413Init(mclk/15.0,snd.sample_rate);
 	YM_Reset = YM2413ResetChip;
 	YM_Update = YM2413Update;
 	YM_Write = YM2413Write;
-
-	/* In HQ mode, YM2413 is running at its original rate (one sample each 72*15 M-cycles)  */
-	/* FM stream is resampled to the output frequency at the end of a frame.                */
-	if (config_hq_fm)
-	{
-	  fm_cycles_ratio = 72 * 15 * (1 << 11);
-	  Fir_Resampler_time_ratio(mclk / (double)snd.sample_rate / (72.0 * 15.0), config_rolloff);
-	}
+	fm_cycles_ratio = 72 * 15;
   }
   else
   #endif
   {
-    /* YM2612 */
+    /* YM2612 (one sample each 144*7 M-cycles) */
 	YM2612Init(mclk/7.0,snd.sample_rate);
 	YM_Reset = YM2612ResetChip;
 	YM_Update = YM2612Update;
 	YM_Write = YM2612Write;
-
-	/* In HQ mode, YM2612 is running at its original rate (one sample each 144*7 M-cycles)  */
-	/* FM stream is resampled to the output frequency at the end of a frame.                */
-	if (config_hq_fm)
-	{
-	fm_cycles_ratio = 144 * 7 * (1 << 11);
-	Fir_Resampler_time_ratio(mclk / (double)snd.sample_rate / (144.0 * 7.0), config_rolloff);
-	}
+	fm_cycles_ratio = 144 * 7;
   }
 
 #ifdef LOGSOUND
-  error("%d mcycles per PSG samples\n", psg_cycles_ratio);
   error("%d mcycles per FM samples\n", fm_cycles_ratio);
 #endif
+
+  fm_set_threaded(fm_thread_enabled);
+}
+
+void sound_shutdown(void)
+{
+  fm_set_threaded(0);
+  for (int i = 0; i < 2; i++)
+  {
+    blip_free(snd.blips[i]);
+    snd.blips[i] = NULL;
+  }
+  fm_blip = NULL;
 }
 
 /* Reset sound chips emulation */
 void sound_reset(void)
 {
+  fm_thread_sync();
   YM_Reset();
   SN76489_Reset();
   fm_cycles_count = 0;
   psg_cycles_count = 0;
+  fm_last[0] = fm_last[1] = 0;
+  if (fm_threaded)
+  {
+    YM2612TimersSync();
+    timers_cycles_count = 0;
+  }
 }
 
 void sound_restore()
@@ -193,6 +352,9 @@ void sound_restore()
   int size;
   uint8 *ptr, *temp;
 
+  /* get YM state from the FM thread */
+  fm_set_threaded(0);
+
   /* save YM context */
   #ifndef NO_SYSTEM_PBC
   if (system_hw == SYSTEM_PBC)
@@ -218,6 +380,8 @@ void sound_restore()
   /* restore YM context */
   if (temp)
   {
+    /* synthesis is moved back to the FM thread by sound_init() */
+    fm_thread_sync();
     #ifndef NO_SYSTEM_PBC
     if (system_hw == SYSTEM_PBC)
     {
@@ -227,6 +391,7 @@ void sound_restore()
     #endif
     {
     	YM2612RestoreContext(temp);
+    	if (fm_threaded) YM2612TimersSync();
     }
     free(temp);
   }
@@ -236,6 +401,8 @@ int sound_context_save(uint8 *state)
 {
   int bufferptr = 0;
   
+  fm_thread_sync();
+
   #ifndef NO_SYSTEM_PBC
   if (system_hw == SYSTEM_PBC)
   {
@@ -244,6 +411,7 @@ int sound_context_save(uint8 *state)
   else
   #endif
   {
+	 if (fm_threaded) YM2612TimersRestore();
 	 bufferptr = YM2612SaveContext(state);
   }
 
@@ -258,6 +426,8 @@ int sound_context_load(uint8 *state, char *version, bool hasExcessYM2612Data, un
 {
   int bufferptr = 0;
 
+  fm_thread_sync();
+
   #ifndef NO_SYSTEM_PBC
   //if ((system_hw != SYSTEM_PBC) || (version[15] == 0x30))
   if ((system_hw == SYSTEM_PBC) & (version[15] != 0x30))
@@ -276,7 +446,15 @@ int sound_context_load(uint8 *state, char *version, bool hasExcessYM2612Data, un
 
   load_param(&fm_cycles_count,sizeof(fm_cycles_count));
   load_param(&psg_cycles_count,sizeof(psg_cycles_count));
-  fm_cycles_count = psg_cycles_count;
+
+  /* the counts only hold the fraction of a sample run ahead of the frame, older states  */
+  /* stored them in 21.11 fixed point so restart both chips on a sample boundary instead */
+  fm_cycles_count = psg_cycles_count = 0;
+  if (fm_threaded)
+  {
+    YM2612TimersSync();
+    timers_cycles_count = 0;
+  }
 
   return bufferptr;
 }
@@ -285,47 +463,18 @@ int sound_context_load(uint8 *state, char *version, bool hasExcessYM2612Data, un
 int sound_update(unsigned int cycles)
 {
   /* run PSG & FM chips until end of frame */
-  cycles <<= 11;
   psg_update(cycles);
-  fm_update(cycles);
-
-  int size = snd.psg.pos - snd.psg.buffer;
-
-#ifdef LOGSOUND
-    error("%d PSG samples available\n",size);
-#endif
-
-  /* FM resampling */
-  if (config_hq_fm)
+  if (fm_threaded)
   {
-    /* get available FM samples */
-    int avail = Fir_Resampler_avail();
-
-    /* resynchronize FM & PSG chips */
-    if (avail < size)
-    {
-      /* FM chip is late for one (or two) samples */
-      do
-      {
-        YM_Update(Fir_Resampler_buffer(), 1);
-        Fir_Resampler_write(2);
-        avail = Fir_Resampler_avail();
-      }
-      while (avail < size);
-    }
-    else
-    {
-      /* FM chip is ahead */
-      fm_cycles_count += (avail - size) * psg_cycles_ratio;
-    }
+    timers_update(cycles);
+    timers_cycles_count -= cycles;
+    fm_pending.push_back({cycles, FM_EVENT_RUN});
+    fm_thread_sync();
   }
-
-#ifdef LOGSOUND
-  if (config_hq_fm)
-    error("%d FM samples (%d) available\n",Fir_Resampler_avail(), Fir_Resampler_written() >> 1);
   else
-    error("%d FM samples available\n",(snd.fm.pos - snd.fm.buffer)>>1);
-#endif
+  {
+    fm_update(cycles);
+  }
 
 #ifdef LOGSOUND
   error("%lu PSG cycles run\n",psg_cycles_count);
@@ -336,38 +485,80 @@ int sound_update(unsigned int cycles)
   psg_cycles_count -= cycles;
   fm_cycles_count  -= cycles;
 
+  /* make samples of this frame available */
+  blip_end_frame(snd.blips[0], cycles);
+  int size = blip_samples_avail(snd.blips[0]);
+  if (fm_threaded)
+  {
+    blip_end_frame(snd.blips[1], cycles);
+    size = std::min(size, blip_samples_avail(snd.blips[1]));
+  }
+
 #ifdef LOGSOUND
-  error("%lu PSG cycles left\n",psg_cycles_count);
-  error("%lu FM cycles left\n",fm_cycles_count);
+  error("%d samples available\n",size);
 #endif
 
   return size;
 }
 
+/* Read mixed PSG & FM samples (stereo) */
+void sound_read_samples(int16 *sb, int size)
+{
+  blip_read_samples(snd.blips[0], sb, size);
+  if (fm_threaded)
+  {
+    int16 fm[size * 2];
+    blip_read_samples(snd.blips[1], fm, size);
+    for (int i = 0; i < size * 2; i++)
+    {
+      sb[i] = std::clamp(sb[i] + fm[i], -32768, 32767);
+    }
+  }
+}
+
 /* Reset FM chip */
 void fm_reset(unsigned int cycles)
 {
-  fm_update(cycles << 11);
+  if (fm_threaded)
+  {
+    timers_update(cycles);
+    YM2612TimersReset();
+    fm_pending.push_back({cycles, FM_EVENT_RESET});
+    return;
+  }
+  fm_update(cycles);
   YM_Reset();
 }
 
 /* Write FM chip */
 void fm_write(unsigned int cycles, unsigned int address, unsigned int data)
 {
-  if (address & 1) fm_update(cycles << 11);
+  if (fm_threaded)
+  {
+    if (address & 1) timers_update(cycles);
+    YM2612TimersWrite(address, data);
+    fm_pending.push_back({cycles, FM_EVENT_WRITE, (uint8)address, (uint8)data});
+    return;
+  }
+  if (address & 1) fm_update(cycles);
   YM_Write(address, data);
 }
 
 /* Read FM status (YM2612 only) */
 unsigned int fm_read(unsigned int cycles, unsigned int address)
 {
-  fm_update(cycles << 11);
+  if (fm_threaded)
+  {
+    timers_update(cycles);
+    return YM2612TimersRead();
+  }
+  fm_update(cycles);
   return YM2612Read();
 }
 
 /* Write PSG chip */
 void psg_write(unsigned int cycles, unsigned int data)
 {
-  psg_update(cycles << 11);
+  psg_update(cycles);
   SN76489_Write(data);
 }
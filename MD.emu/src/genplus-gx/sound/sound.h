@@ -30,7 +30,12 @@ extern void sound_reset(void);
 extern void sound_restore(void);
 extern int sound_context_save(uint8 *state);
 extern int sound_context_load(uint8 *state, char *version, bool hasExcessYM2612Data, unsigned ptrSize);
+extern void sound_shutdown(void);
 extern int sound_update(unsigned int cycles);
+extern void sound_read_samples(int16 *sb, int size);
+extern void sound_update_line(unsigned int cycles);
+extern void sound_set_fm_thread(int enable);
+extern void sound_sync(void);
 extern void fm_reset(unsigned int cycles);
 extern void fm_write(unsigned int cycles, unsigned int address, unsigned int data);
 extern unsigned int fm_read(unsigned int cycles, unsigned int address);
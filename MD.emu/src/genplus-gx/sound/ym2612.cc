@@ -2033,6 +2033,138 @@ unsigned int YM2612Read(void)
   return ym2612.OPN.ST.status & 0xff;
 }
 
+/* Copy of the timers state, so the status register can be read while YM2612Update() runs  */
+/* on another thread. Register writes are replayed to both at the same sample positions,   */
+/* which keeps them in step (timer B is only accurate to the update granularity anyway).   */
+static struct
+{
+  UINT16  address;
+  UINT8   status;
+  UINT32  mode;
+  INT32   TimerBase;
+  INT32   TA, TAL, TAC;
+  INT32   TBL, TBC;
+} timers;
+
+/* Reload the copy from the chip state, synthesis must not be running */
+void YM2612TimersSync(void)
+{
+  timers.address   = ym2612.OPN.ST.address;
+  timers.status    = ym2612.OPN.ST.status;
+  timers.mode      = ym2612.OPN.ST.mode;
+  timers.TimerBase = ym2612.OPN.ST.TimerBase;
+  timers.TA        = ym2612.OPN.ST.TA;
+  timers.TAL       = ym2612.OPN.ST.TAL;
+  timers.TAC       = ym2612.OPN.ST.TAC;
+  timers.TBL       = ym2612.OPN.ST.TBL;
+  timers.TBC       = ym2612.OPN.ST.TBC;
+}
+
+static void timers_write_mode(int r, int v)
+{
+  switch( r )
+  {
+    case 0x24:
+      timers.TA  = (timers.TA & 0x03)|(((int)v)<<2);
+      timers.TAL = (1024 - timers.TA) << TIMER_SH;
+      break;
+    case 0x25:
+      timers.TA  = (timers.TA & 0x3fc)|(v&3);
+      timers.TAL = (1024 - timers.TA) << TIMER_SH;
+      break;
+    case 0x26:
+      timers.TBL = (256 - v) << (TIMER_SH + 4);
+      break;
+    case 0x27:
+      if ((v&1) && !(timers.mode&1))
+        timers.TAC = timers.TAL;
+      if ((v&2) && !(timers.mode&2))
+        timers.TBC = timers.TBL;
+      timers.status &= (~v >> 4);
+      timers.mode = v;
+      break;
+  }
+}
+
+/* Same as the timer part of YM2612ResetChip() */
+void YM2612TimersReset(void)
+{
+  timers.TAC = 0;
+  timers.TBC = 0;
+  timers_write_mode(0x27,0x30);
+  timers_write_mode(0x26,0x00);
+  timers_write_mode(0x25,0x00);
+  timers_write_mode(0x24,0x00);
+}
+
+/* Same as YM2612Write() but only for the address latch and timer registers */
+void YM2612TimersWrite(unsigned int a, unsigned int v)
+{
+  v &= 0xff;
+
+  switch( a )
+  {
+    case 0:
+      timers.address = v;
+      break;
+
+    case 2:
+      timers.address = v | 0x100;
+      break;
+
+    default:
+      timers_write_mode(timers.address, v);
+  }
+}
+
+/* Same as the timer part of YM2612Update() */
+void YM2612TimersUpdate(int length)
+{
+  int i;
+
+  if (timers.mode & 0x01)
+  {
+    for(i=0; i < length ; i++)
+    {
+      if ((timers.TAC -= timers.TimerBase) <= 0)
+      {
+        if (timers.mode & 0x04)
+          timers.status |= 0x01;
+        if (timers.TAL)
+          timers.TAC += timers.TAL;
+        else
+          timers.TAC = timers.TAL;
+      }
+    }
+  }
+
+  if (timers.mode & 0x02)
+  {
+    if ((timers.TBC -= (timers.TimerBase * length)) <= 0)
+    {
+      if (timers.mode & 0x08)
+        timers.status |= 0x02;
+      if (timers.TBL)
+        timers.TBC += timers.TBL;
+      else
+        timers.TBC = timers.TBL;
+    }
+  }
+}
+
+unsigned int YM2612TimersRead(void)
+{
+  return timers.status & 0xff;
+}
+
+/* Write the copy back to the chip state, synthesis must not be running */
+void YM2612TimersRestore(void)
+{
+  ym2612.OPN.ST.status = timers.status;
+  ym2612.OPN.ST.TAC    = timers.TAC;
+  ym2612.OPN.ST.TBC    = timers.TBC;
+}
+
 /* Generate 16 bits samples for ym2612 */
 void YM2612Update(FMSampleType *buffer, int length)
 {
@@ -29,5 +29,11 @@ extern int YM2612Restore(unsigned char *state, bool hasExcessData, unsigned ptrS
 extern void YM2612RestoreContext(unsigned char *buffer);
 extern int YM2612LoadContext(unsigned char *state, bool hasExcessData, unsigned ptrSize);
 extern int YM2612SaveContext(unsigned char *state);
+extern void YM2612TimersSync(void);
+extern void YM2612TimersRestore(void);
+extern void YM2612TimersReset(void);
+extern void YM2612TimersWrite(unsigned int a, unsigned int v);
+extern void YM2612TimersUpdate(int length);
+extern unsigned int YM2612TimersRead(void);
 
 #endif /* _YM2612_ */
@@ -97,21 +97,40 @@ static unsigned oldStateSizeAfterVDP(int exVersion, bool is64Bit)
   return size;
 }
 
-void state_load(const unsigned char *buffer)
+void state_load(const unsigned char *buffer, size_t size)
 {
 	auto state = std::make_unique<unsigned char[]>(STATE_SIZE);
 
   /* buffer size */
   unsigned bufferptr = 0;
 
-  /* uncompress savestate */
-  uint32 inbytes32;
-  memcpy(&inbytes32, buffer, 4);
-  unsigned long inbytes = inbytes32;
   unsigned long outbytes = STATE_SIZE;
-  logMsg("uncompressing %d bytes to buffer of %d size", (int)inbytes, (int)outbytes);
+  if(size >= 16 && !memcmp(buffer, STATE_VERSION, 11))
   {
-  	int result = uncompress((Bytef *)state.get(), &outbytes, (Bytef *)(buffer + 4), inbytes);
+    /* uncompressed savestate */
+    if(size > STATE_SIZE)
+    {
+      throw std::runtime_error(fmt::format("State size {} is too large", size));
+    }
+    memcpy(state.get(), buffer, size);
+    outbytes = size;
+  }
+  else
+  {
+    /* uncompress savestate */
+    if(size < 4)
+    {
+      throw std::runtime_error("Truncated state data");
+    }
+    uint32 inbytes32;
+    memcpy(&inbytes32, buffer, 4);
+    unsigned long inbytes = inbytes32;
+    if(inbytes > size - 4)
+    {
+      throw std::runtime_error("Truncated state data");
+    }
+    logMsg("uncompressing %d bytes to buffer of %d size", (int)inbytes, (int)outbytes);
+    int result = uncompress((Bytef *)state.get(), &outbytes, (Bytef *)(buffer + 4), inbytes);
 		if(result != Z_OK)
 		{
 			//logErr("error %d in uncompress loading state", result);
@@ -294,9 +313,16 @@ void state_load(const unsigned char *buffer)
 	}
 }
 
-int state_save(unsigned char *buffer)
+int state_save(unsigned char *buffer, bool compressed)
 {
-	auto state = std::make_unique<unsigned char[]>(STATE_SIZE);
+	/* uncompressed states are written directly to the output buffer */
+	std::unique_ptr<unsigned char[]> stateBuff;
+	unsigned char *state = buffer;
+	if(compressed)
+	{
+		stateBuff = std::make_unique<unsigned char[]>(STATE_SIZE);
+		state = stateBuff.get();
+	}
 
   /* buffer size */
   int bufferptr = 0;
@@ -392,12 +418,22 @@ int state_save(unsigned char *buffer)
 	}
 	#endif
 
+  if(!compressed)
+    return bufferptr;
+
+  return state_compress(state, bufferptr, buffer);
+}
+
+int state_compress(const unsigned char *state, size_t size, unsigned char *buffer)
+{
   /* compress state file */
-  unsigned long inbytes   = bufferptr;
+  unsigned long inbytes   = size;
   unsigned long outbytes  = STATE_SIZE;
   logMsg("compressing %d bytes to buffer of %d size", (int)inbytes, (int)outbytes);
-  int ret = compress2 ((Bytef *)(buffer + 4), &outbytes, (Bytef *)state.get(), inbytes, 9);
+  int ret = compress2 ((Bytef *)(buffer + 4), &outbytes, (Bytef *)state, inbytes, 9);
   logMsg("compress2 returned %d, reduced to %d bytes", ret, (int)outbytes);
+  if(ret != Z_OK)
+    return 0;
   uint32 outbytes32 = outbytes; // assumes no save states will ever be over 4GB
   memcpy(buffer, &outbytes32, 4);
 
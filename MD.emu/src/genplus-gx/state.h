@@ -40,7 +40,8 @@
   bufferptr+= size;
 
 /* Function prototypes */
-void state_load(const unsigned char *buffer);
-int state_save(unsigned char *buffer);
+void state_load(const unsigned char *buffer, size_t size);
+int state_save(unsigned char *buffer, bool compressed = true);
+int state_compress(const unsigned char *state, size_t size, unsigned char *buffer);
 
 #endif
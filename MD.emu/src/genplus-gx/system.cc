@@ -25,7 +25,7 @@
 #include <emuframework/EmuApp.hh>
 #include "shared.h"
 #include "vdp_render.h"
-#include "Fir_Resampler.h"
+#include "blip.h"
 #include "eq.h"
 #include "assert.h"
 
@@ -71,21 +71,10 @@ int audio_init (int samplerate, float framerate)
   /* Calculate the sound buffer size (for one frame) */
   snd.buffer_size = (int)(samplerate / framerate) + 32;
 
-  /* SN76489 stream buffers */
-  snd.psg.buffer = (int16 *) malloc(snd.buffer_size * sizeof(int16));
-  if (!snd.psg.buffer) return (-1);
-
-  /* YM2612 stream buffers */
-  snd.fm.buffer = (FMSampleType*) malloc(snd.buffer_size * sizeof(FMSampleType) * 2);
-  if (!snd.fm.buffer) return (-1);
-
 	#ifndef NO_SCD
 		scd_pcm_setRate(samplerate);
 	#endif
 
-  /* Resampling buffer */
-  if (config_hq_fm && !Fir_Resampler_initialize(4096)) return (-1);
-
   /* Set audio enable flag */
   snd.enabled = 1;
 
@@ -104,14 +93,10 @@ void audio_reset(void)
   /* 3 band EQ */
   audio_set_equalizer();
 
-  /* Resampling buffer */
-  Fir_Resampler_clear();
-
   /* Audio buffers */
-  snd.psg.pos = snd.psg.buffer;
-  snd.fm.pos  = snd.fm.buffer;
-  if (snd.psg.buffer) memset (snd.psg.buffer, 0, snd.buffer_size * sizeof(int16));
-  if (snd.fm.buffer) memset (snd.fm.buffer, 0, snd.buffer_size * sizeof(FMSampleType) * 2);
+  sound_sync();
+  if (snd.blips[0]) blip_clear(snd.blips[0]);
+  if (snd.blips[1]) blip_clear(snd.blips[1]);
 }
 
 void audio_set_equalizer(void)
@@ -125,11 +110,7 @@ void audio_set_equalizer(void)
 void audio_shutdown(void)
 {
   /* Sound buffers */
-  if (snd.fm.buffer) free(snd.fm.buffer);
-  if (snd.psg.buffer) free(snd.psg.buffer);
-
-  /* Resampling buffer */
-  Fir_Resampler_shutdown();
+  sound_shutdown();
 }
 
 template <bool hasSegaCD>
@@ -139,21 +120,13 @@ int audioUpdateAll(int16 *sb)
   int32 ll = llp;
   int32 rr = rrp;
 
-  int psg_preamp  = config_psg_preamp;
-  int fm_preamp   = config_fm_preamp;
   int filter      = config_filter;
   uint32 factora  = (config_lp_range << 16) / 100;
   uint32 factorb  = 0x10000 - factora;
 
-  FMSampleType *fm       = snd.fm.buffer;
-  int16 *psg      = snd.psg.buffer;
-
   /* get number of available samples */
   int size = sound_update(mcycles_vdp);
 
-  /* return an aligned number of samples */
-  size &= ~7;
-
 	#ifndef NO_SCD
 	int16 cdPCMBuff[size*2];
 	int16 *cdPCM = cdPCMBuff;
@@ -187,42 +160,16 @@ int audioUpdateAll(int16 *sb)
 	}
 	#endif
 
-  if (config_hq_fm)
-  {
-    /* resample into FM output buffer */
-    Fir_Resampler_read(fm, size);
-
-#ifdef LOGSOUND
-    error("%d FM samples remaining\n",Fir_Resampler_written() >> 1);
-#endif
-  }
-  else
-  {  
-    /* adjust remaining samples in FM output buffer*/
-    snd.fm.pos -= (size * 2);
-
-#ifdef LOGSOUND
-    error("%d FM samples remaining\n",(snd.fm.pos - snd.fm.buffer)>>1);
-#endif
-  }
-
-  /* adjust remaining samples in PSG output buffer*/
-  snd.psg.pos -= size;
+  assert(size < snd.buffer_size);
 
-#ifdef LOGSOUND
-  error("%d PSG samples remaining\n",snd.psg.pos - snd.psg.buffer);
-#endif
+  /* PSG & FM samples (stereo, already mixed at output rate) */
+  sound_read_samples(sb, size);
 
-  assert(size < snd.buffer_size);
   /* mix samples */
   for (i = 0; i < size; i ++)
   {
-    /* PSG samples (mono) */
-    l = r = (((*psg++) * psg_preamp) / 100);
-
-    /* FM samples (stereo) */
-    l += ((*fm++ * fm_preamp) / 100);
-    r += ((*fm++ * fm_preamp) / 100);
+    l = sb[0];
+    r = sb[1];
 
 		#ifndef NO_SCD
     if(doPCM)
@@ -276,10 +223,6 @@ int audioUpdateAll(int16 *sb)
   llp = ll;
   rrp = rr;
 
-  /* keep remaining samples for next frame */
-  memcpy(snd.fm.buffer, fm, (snd.fm.pos - snd.fm.buffer) * sizeof(FMSampleType));
-  memcpy(snd.psg.buffer, psg, (snd.psg.pos - snd.psg.buffer) * sizeof(int16));
-
 #ifdef LOGSOUND
   error("%d samples returned\n\n",size);
 #endif
@@ -490,6 +433,7 @@ static void system_frame_md(EmuEx::EmuSystemTaskContext taskCtx, EmuEx::EmuVideo
 
   /* update line cycle count */
   mcycles_vdp += MCYCLES_PER_LINE;
+  sound_update_line(mcycles_vdp);
 
   /* Active Display */
   do
@@ -556,6 +500,7 @@ static void system_frame_md(EmuEx::EmuSystemTaskContext taskCtx, EmuEx::EmuVideo
 
     /* update line cycle count */
     mcycles_vdp += MCYCLES_PER_LINE;
+    sound_update_line(mcycles_vdp);
   }
   while (++line < bitmap.viewport.h);
 
@@ -672,6 +617,7 @@ static void system_frame_md(EmuEx::EmuSystemTaskContext taskCtx, EmuEx::EmuVideo
 
   /* update line cycle count */
   mcycles_vdp += MCYCLES_PER_LINE;
+  sound_update_line(mcycles_vdp);
 
   /* increment line count */
   line++;
@@ -738,6 +684,7 @@ static void system_frame_md(EmuEx::EmuSystemTaskContext taskCtx, EmuEx::EmuVideo
 
     /* update line cycle count */
     mcycles_vdp += MCYCLES_PER_LINE;
+    sound_update_line(mcycles_vdp);
   }
   while (++line < (lines_per_frame - 1));
 
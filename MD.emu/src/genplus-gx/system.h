@@ -66,16 +66,7 @@ typedef struct
   float cddaRatio;
   int enabled;      /* 1= sound emulation is enabled */
   int buffer_size;  /* Size of sound buffer (in bytes) */
-  struct
-  {
-	FMSampleType *pos;
-	FMSampleType *buffer;
-  } fm;
-  struct
-  {
-    int16 *pos;
-    int16 *buffer;
-  } psg;
+  struct blip_buffer_t *blips[2]; /* PSG & FM output, FM on its own when synthesized on the FM thread */
 } t_snd;
 
 
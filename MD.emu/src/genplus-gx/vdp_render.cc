@@ -3778,11 +3778,7 @@ void remap_line(int line, IG::MutablePixmapView pix)
   /* Pixel line buffer */
   uint8 *src = &linebuf[0][0x20 - x_offset];
 	auto *dst = (Pixel*)pix.pixel({0, line});
-	do
-	{
-		*dst++ = pixel[*src++];
-	}
-	while (--width);
+	IG::expandPalette8({src, size_t(width)}, dst, pixel);
 }
 
 static bool isValidPixelFormat(IG::PixelFormat fmt)
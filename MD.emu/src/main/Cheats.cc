@@ -335,6 +335,7 @@ void applyCheats()
   {
   	logMsg("%zu RAM cheats, %zu ROM cheats active", ramCheatList.size(), romCheatList.size());
   }
+  m68k_flush_recompiler(mm68k);
 }
 
 void clearCheats()
@@ -373,6 +374,7 @@ void clearCheats()
       e.setApplied(0);
     }
   }
+  m68k_flush_recompiler(mm68k);
   logMsg("done");
 }
 
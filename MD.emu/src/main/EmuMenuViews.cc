@@ -27,6 +27,7 @@
 #include "input.h"
 #include "io_ctrl.h"
 #include "vdp_ctrl.h"
+#include "sound.h"
 
 namespace EmuEx
 {
@@ -236,11 +237,23 @@ class CustomAudioOptionView : public AudioOptionView, public MainAppHelper<Custo
 		}
 	};
 
+	BoolMenuItem fmThread
+	{
+		"Threaded YM2612 Synthesis", &defaultFace(),
+		(bool)system().optionFMThread,
+		[this](BoolMenuItem &item, View &, Input::Event e)
+		{
+			system().optionFMThread = item.flipBoolValue(*this);
+			sound_set_fm_thread(system().optionFMThread);
+		}
+	};
+
 public:
 	CustomAudioOptionView(ViewAttachParams attach): AudioOptionView{attach, true}
 	{
 		loadStockItems();
 		item.emplace_back(&smsFM);
+		item.emplace_back(&fmThread);
 	}
 };
 
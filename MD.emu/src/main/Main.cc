@@ -51,6 +51,7 @@ bool EmuSystem::hasCheats = true;
 bool EmuSystem::hasPALVideoSystem = true;
 bool EmuSystem::canRenderRGBA8888 = RENDER_BPP == 32;
 bool EmuSystem::hasRectangularPixels = true;
+bool EmuSystem::hasRunAhead = true;
 bool EmuApp::needsGlobalInstance = true;
 
 static bool hasBinExtension(std::string_view name)
@@ -144,20 +145,26 @@ static FS::PathString bramSaveFilename(EmuApp &app)
 
 static const unsigned maxSaveStateSize = STATE_SIZE+4;
 
-void MdSystem::saveState(IG::CStringView path)
+size_t MdSystem::stateSize() { return maxSaveStateSize; }
+
+void MdSystem::readState(EmuApp &, std::span<const uint8_t> buff)
+{
+	state_load(buff.data(), buff.size());
+}
+
+size_t MdSystem::writeState(std::span<uint8_t> buff, SaveStateFlags flags)
 {
-	auto stateData = std::make_unique<uint8_t[]>(maxSaveStateSize);
-	logMsg("saving state data");
-	size_t size = state_save(stateData.get());
-	logMsg("writing to file");
-	if(FileUtils::writeToUri(appContext(), path, {stateData.get(), size}) == -1)
-		throwFileWriteError();
-	logMsg("wrote %zu byte state", size);
+	assert(buff.size() >= maxSaveStateSize);
+	auto size = state_save(buff.data(), !to_underlying(flags & SaveStateFlags::uncompressed));
+	if(!size)
+		throw std::runtime_error("Error compressing state");
+	return size;
 }
 
-void MdSystem::loadState(EmuApp &app, IG::CStringView path)
+size_t MdSystem::compressState(std::span<const uint8_t> src, std::span<uint8_t> dest) const
 {
-	state_load(FileUtils::bufferFromUri(app.appContext(), path).data());
+	assert(dest.size() >= maxSaveStateSize);
+	return state_compress(src.data(), src.size(), dest.data());
 }
 
 static bool sramHasContent(std::span<uint8> sram)
@@ -229,21 +236,15 @@ void MdSystem::onFlushBackupMemory(EmuApp &app, BackupMemoryDirtyFlags)
 	if(sCD.isActive)
 	{
 		logMsg("saving BRAM");
-		auto saveStr = bramSaveFilename(app);
-		auto bramFile = appContext().openFileUri(saveStr, OpenFlagsMask::New | OpenFlagsMask::Test);
-		if(!bramFile)
-			logMsg("error creating bram file");
-		else
+		auto bramTemp = std::make_unique_for_overwrite<uint8_t[]>(sizeof(bram) + 0x10000);
+		memcpy(bramTemp.get(), bram, sizeof(bram));
+		auto sramTemp = bramTemp.get() + sizeof(bram);
+		memcpy(sramTemp, sram.sram, 0x10000); // make a temp copy to byte-swap
+		for(unsigned i = 0; i < 0x10000; i += 2)
 		{
-			bramFile.write(bram, sizeof(bram));
-			char sramTemp[0x10000];
-			memcpy(sramTemp, sram.sram, 0x10000); // make a temp copy to byte-swap
-			for(unsigned i = 0; i < 0x10000; i += 2)
-			{
-				std::swap(sramTemp[i], sramTemp[i+1]);
-			}
-			bramFile.write(sramTemp, 0x10000);
+			std::swap(sramTemp[i], sramTemp[i+1]);
 		}
+		app.saveBackupMemory(bramSaveFilename(app), {bramTemp.get(), sizeof(bram) + 0x10000});
 	}
 	else
 	#endif
@@ -264,19 +265,12 @@ void MdSystem::onFlushBackupMemory(EmuApp &app, BackupMemoryDirtyFlags)
 				}
 				sramPtr = sramTemp;
 			}
-			try
-			{
-				FileUtils::writeToUri(appContext(), saveStr, {sramPtr, 0x10000});
-			}
-			catch(...)
-			{
-				logMsg("error creating sram file");
-			}
+			app.saveBackupMemory(saveStr, {sramPtr, 0x10000});
 		}
 		else
 		{
 			logMsg("SRAM wasn't written to");
-			appContext().removeFileUri(saveStr);
+			app.removeBackupMemory(saveStr);
 		}
 	}
 }
@@ -25,6 +25,7 @@ enum
 	CFGKEY_MD_REGION = 284, CFGKEY_VIDEO_SYSTEM = 285,
 	CFGKEY_INPUT_PORT_1 = 286, CFGKEY_INPUT_PORT_2 = 287,
 	CFGKEY_MULTITAP = 288, CFGKEY_CHEATS_PATH = 289,
+	CFGKEY_FM_THREAD = 290,
 };
 
 bool hasMDExtension(std::string_view name);
@@ -40,6 +41,7 @@ public:
 	int8_t savedVControllerPlayer = -1;
 	Byte1Option optionBigEndianSram{CFGKEY_BIG_ENDIAN_SRAM, 0};
 	Byte1Option optionSmsFM{CFGKEY_SMS_FM, 1};
+	Byte1Option optionFMThread{CFGKEY_FM_THREAD, 0};
 	Byte1Option option6BtnPad{CFGKEY_6_BTN_PAD, 0};
 	Byte1Option optionMultiTap{CFGKEY_MULTITAP, 0};
 	SByte1Option optionInputPort1{CFGKEY_INPUT_PORT_1, -1, false, optionIsValidWithMinMax<-1, 4>};
@@ -61,8 +63,10 @@ public:
 	[[gnu::hot]] void runFrame(EmuSystemTaskContext task, EmuVideo *video, EmuAudio *audio);
 	FS::FileString stateFilename(int slot, std::string_view name) const;
 	std::string_view stateFilenameExt() const { return ".gp"; }
-	void loadState(EmuApp &, CStringView uri);
-	void saveState(CStringView path);
+	size_t stateSize();
+	void readState(EmuApp &, std::span<const uint8_t> buff);
+	size_t writeState(std::span<uint8_t> buff, SaveStateFlags = {});
+	size_t compressState(std::span<const uint8_t> src, std::span<uint8_t> dest) const;
 	bool readConfig(ConfigType, MapIO &, unsigned key, size_t readSize);
 	void writeConfig(ConfigType, FileIO &);
 	void reset(EmuApp &, ResetMode mode);
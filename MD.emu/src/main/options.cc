@@ -16,6 +16,7 @@
 #include <emuframework/EmuApp.hh>
 #include <emuframework/EmuInput.hh>
 #include "MainSystem.hh"
+#include "sound.h"
 
 namespace EmuEx
 {
@@ -35,6 +36,7 @@ std::span<const AspectRatioInfo> MdSystem::aspectRatioInfos()
 void MdSystem::onOptionsLoaded()
 {
 	config_ym2413_enabled = optionSmsFM;
+	sound_set_fm_thread(optionFMThread);
 }
 
 void MdSystem::onSessionOptionsLoaded(EmuApp &app)
@@ -65,6 +67,7 @@ bool MdSystem::readConfig(ConfigType type, MapIO &io, unsigned key, size_t readS
 		{
 			case CFGKEY_BIG_ENDIAN_SRAM: return optionBigEndianSram.readFromIO(io, readSize);
 			case CFGKEY_SMS_FM: return optionSmsFM.readFromIO(io, readSize);
+			case CFGKEY_FM_THREAD: return optionFMThread.readFromIO(io, readSize);
 			#ifndef NO_SCD
 			case CFGKEY_MD_CD_BIOS_USA_PATH: return readStringOptionValue(io, readSize, cdBiosUSAPath);
 			case CFGKEY_MD_CD_BIOS_JPN_PATH: return readStringOptionValue(io, readSize, cdBiosJpnPath);
@@ -94,6 +97,7 @@ void MdSystem::writeConfig(ConfigType type, FileIO &io)
 	{
 		optionBigEndianSram.writeWithKeyIfNotDefault(io);
 		optionSmsFM.writeWithKeyIfNotDefault(io);
+		optionFMThread.writeWithKeyIfNotDefault(io);
 		#ifndef NO_SCD
 		writeStringOptionValue(io, CFGKEY_MD_CD_BIOS_USA_PATH, cdBiosUSAPath);
 		writeStringOptionValue(io, CFGKEY_MD_CD_BIOS_JPN_PATH, cdBiosJpnPath);
@@ -7,6 +7,7 @@ SRC += main/Main.cc \
 main/input.cc \
 main/options.cc \
 main/unzip.cc \
+main/threads.cc \
 main/EmuControls.cc \
 main/EmuMenuViews.cc
 
@@ -55,6 +56,7 @@ else
  CPPFLAGS += -I$(M68K_PATH)
  VPATH +=  $(M68K_PATH)
  SRC += musashi/m68kcpu.cc \
+ musashi/M68KRecompiler.cc \
  $(GEO)/musashi_interf.cc
 endif
 
@@ -38,6 +38,7 @@
 //#include "streams.h"
 #include "ym2610/2610intf.h"
 #include "sound.h"
+#include "threads.h"
 #include "screen.h"
 #include "neocrypt.h"
 #include "conf.h"
@@ -283,10 +284,23 @@ static inline int update_scanline(int skip_this_frame, void *emuTaskCtxPtr, void
 	return memory.vid.irq2taken;
 }
 
+void run_z80_frame(void) {
+	unsigned z80_overclk = 0;
+	const Uint32 cpu_z80_timeslice = (z80_overclk == 0 ? 73333 : 73333 + (z80_overclk
+			* 73333 / 100.0));
+
+	const Uint32 cpu_z80_timeslice_interlace = cpu_z80_timeslice
+			/ (float) nb_interlace;
+
+	for (int i = 0; i < nb_interlace; i++) {
+		cpu_z80_run(cpu_z80_timeslice_interlace);
+		my_timer();
+	}
+}
+
 void main_frame(void *emuTaskCtxPtr, void *neoSystemPtr, void *emuVideoPtr) {
 	const int skip_this_frame = !emuVideoPtr;
 	unsigned m68k_overclk = 0;
-	unsigned z80_overclk = 0;
 	#ifdef USE_MUSASHI
 	const Uint32 baseTimeslice = 250000;
 	#else
@@ -295,11 +309,6 @@ void main_frame(void *emuTaskCtxPtr, void *neoSystemPtr, void *emuVideoPtr) {
 	const Uint32 cpu_68k_timeslice = (m68k_overclk == 0 ? baseTimeslice : baseTimeslice
 			+ (m68k_overclk * baseTimeslice / 100.0));
 	const Uint32 cpu_68k_timeslice_scanline = cpu_68k_timeslice / 264.0;
-	const Uint32 cpu_z80_timeslice = (z80_overclk == 0 ? 73333 : 73333 + (z80_overclk
-			* 73333 / 100.0));
-
-	const Uint32 cpu_z80_timeslice_interlace = cpu_z80_timeslice
-			/ (float) nb_interlace;
 
 	// run one frame
 	{
@@ -307,10 +316,11 @@ void main_frame(void *emuTaskCtxPtr, void *neoSystemPtr, void *emuVideoPtr) {
 			if (conf.sound) {
 				PROFILER_START(PROF_Z80);
 
-				for (int i = 0; i < nb_interlace; i++) {
-					cpu_z80_run(cpu_z80_timeslice_interlace);
-					my_timer();
-				}
+				/* the sound thread runs the Z80 frame while the 68k runs below */
+				if (gn_sound_thread_running())
+					gn_sound_thread_run_z80_frame();
+				else
+					run_z80_frame();
 
 				//cpu_z80_run(cpu_z80_timeslice);
 				PROFILER_STOP(PROF_Z80);
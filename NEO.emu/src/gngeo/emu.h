@@ -141,6 +141,7 @@ extern int last_line;
 
 void debug_loop(void);
 void main_loop(void);
+void run_z80_frame(void);
 void init_neo(void);
 void cpu_68k_dpg_step(int skip_this_frame, void *emuTaskPtr, void *neoSystemPtr, void *emuVideoPtr);
 void setup_misc_patch(char *name);
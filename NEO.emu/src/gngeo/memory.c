@@ -25,6 +25,7 @@
 #include "memory.h"
 #include "pd4990a.h"
 #include "transpack.h"
+#include "threads.h"
 #include <imagine/logger/logger.h>
 
 #ifdef GP2X
@@ -189,6 +190,15 @@ void z80_port_write(Uint16 PortNb, Uint8 Value)
 		break;
 	}
 }
+
+/* Latch a 68k sound command and let the Z80 start handling it */
+void z80_sound_command(Uint8 code)
+{
+	sound_code = code;
+	pending_command = 1;
+	cpu_z80_nmi();
+	cpu_z80_run(300);
+}
 #endif
 
 /* Protection hack */
@@ -410,6 +420,8 @@ Uint8 mem68k_fetch_coin_byte(Uint32 addr) {
 			if (shared_ctl->pending_command)
 				res &= 0x7f;
 #else
+			/* wait for the sound thread to catch up before reading the Z80 reply */
+			gn_sound_thread_sync();
 			res |= result_code;
 			if (pending_command)
 			res &= 0x7f;
@@ -639,6 +651,12 @@ void mem68k_store_pd4990_long(Uint32 addr, Uint32 data) {
 /**** Z80 ****/
 void mem68k_store_z80_byte(Uint32 addr, Uint8 data) {
 	if (addr == 0x320000) {
+#ifndef ENABLE_940T
+		if (conf.sound && gn_sound_thread_running()) {
+			gn_sound_thread_send_command(data & 0xff);
+			return;
+		}
+#endif
 		sound_code = data & 0xff;
 		pending_command = 1;
 		//printf("B Pending command. Sound_code=%02x\n",sound_code);
@@ -670,6 +688,12 @@ void mem68k_store_z80_byte(Uint32 addr, Uint8 data) {
 void mem68k_store_z80_word(Uint32 addr, Uint16 data) {
 	/* tpgolf use word store for sound */
 	if (addr == 0x320000) {
+#ifndef ENABLE_940T
+		if (conf.sound && gn_sound_thread_running()) {
+			gn_sound_thread_send_command(data >> 8);
+			return;
+		}
+#endif
 		sound_code = data >> 8;
 		pending_command = 1;
 		//printf("W Pending command. Sound_code=%02x\n",sound_code);
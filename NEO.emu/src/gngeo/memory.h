@@ -168,6 +168,7 @@ void cpu_z80_init(void);
 void cpu_z80_switchbank(Uint8 bank, Uint16 PortNo);
 Uint8 z80_port_read(Uint16 PortNo);
 void z80_port_write(Uint16 PortNb, Uint8 Value);
+void z80_sound_command(Uint8 code);
 void cpu_z80_set_state(Z80_STATE *st);
 void cpu_z80_fill_state(Z80_STATE *st);
 
@@ -12,10 +12,16 @@ extern "C"
 #undef READ_BYTE
 #undef WRITE_BYTE
 #include <musashi/m68k.h>
+#ifdef M68K_RECOMPILER
+#include <musashi/M68KRecompiler.hh>
+#endif
 #include "InstructionCycleTable.hh"
 #include <imagine/util/utility.h>
 
 static M68KCPU mm68k(m68ki_cycles, true);
+#ifdef M68K_RECOMPILER
+static M68KRecompiler mm68kRecompiler;
+#endif
 
 int neogeo68KIrqAck(M68KCPU &m68ki_cpu, int int_level)
 {
@@ -314,6 +320,16 @@ CLINK void cpu_68k_init(void)
 	{
 		bankaddress = 0x100000;
 	}
+
+	#ifdef M68K_RECOMPILER
+	// Recompile code from CPU ROM, the banked ROM window, and the system ROM.
+	// Only the vector table at the start of CPU ROM is ever rewritten, which never runs as code.
+	mm68kRecompiler.setCodePages(0x00, 0x0f);
+	mm68kRecompiler.setCodePages(0x20, 0x2f);
+	mm68kRecompiler.setCodePages(0xc0, 0xcf);
+	mm68kRecompiler.invalidate();
+	mm68k.recompiler = &mm68kRecompiler;
+	#endif
 }
 
 CLINK void cpu_68k_reset(void)
@@ -325,6 +341,12 @@ CLINK void cpu_68k_bankswitch(Uint32 address)
 {
 	//logMsg("bank switch:0x%X", address);
 	bankaddress = address;
+	#ifdef M68K_RECOMPILER
+	for(int i = 0x20; i < 0x30; i++)
+	{
+		mm68kRecompiler.invalidatePage(i);
+	}
+	#endif
 }
 
 CLINK int cpu_68k_run(Uint32 nb_cycle)
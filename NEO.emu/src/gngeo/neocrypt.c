@@ -52,6 +52,7 @@
 #include "mame_layer.h"
 #include "menu.h"
 #include "neocrypt.h"
+#include "threads.h"
 
 /***************************************************************************
 
@@ -534,38 +535,41 @@ static void decrypt(UINT8 *r0, UINT8 *r1,
 #include <stdio.h>
 
 
-static void neogeo_gfx_decrypt(running_machine *machine, int extra_xor)
-{
-	UINT8 *buf;
+typedef struct {
 	UINT8 *rom;
-	unsigned rpos;
-	const unsigned rom_size = memory_region_length(machine, "sprites");
-
-	buf = alloc_array_or_die(UINT8, rom_size);
+	UINT8 *buf;
+	unsigned rom_size;
+	int extra_xor;
+} GFX_DECRYPT;
 
-	rom = memory_region(machine, "sprites");
-	const unsigned pbarUpdateCount = 20;
-	const unsigned pbarSteps = (rom_size/4)/pbarUpdateCount;
-	gn_init_pbar(PBAR_ACTION_DECRYPT, rom_size/2);
-	// Data xor
-	for (rpos = 0;rpos < rom_size/4;rpos++)
+// Data xor
+static void gfx_decrypt_data(void *arg, uint32_t start, uint32_t end)
+{
+	GFX_DECRYPT *d = arg;
+	UINT8 *buf = d->buf;
+	const UINT8 *rom = d->rom;
+	unsigned rpos;
+	for (rpos = start;rpos < end;rpos++)
 	{
 		decrypt(buf+4*rpos+0, buf+4*rpos+3, rom[4*rpos+0], rom[4*rpos+3], type0_t03, type0_t12, type1_t03, rpos, (rpos>>8) & 1);
 		decrypt(buf+4*rpos+1, buf+4*rpos+2, rom[4*rpos+1], rom[4*rpos+2], type0_t12, type0_t03, type1_t12, rpos, ((rpos>>16) ^ address_16_23_xor2[(rpos>>8) & 0xff]) & 1);
-		if (rpos % pbarSteps == 0) {
-			gn_update_pbar(rpos);
-		}
 	}
-	// Address xor
-	for (rpos = 0;rpos < rom_size/4;rpos++)
+}
+
+// Address xor
+static void gfx_decrypt_address(void *arg, uint32_t start, uint32_t end)
+{
+	GFX_DECRYPT *d = arg;
+	const UINT8 *buf = d->buf;
+	UINT8 *rom = d->rom;
+	const unsigned rom_size = d->rom_size;
+	unsigned rpos;
+	for (rpos = start;rpos < end;rpos++)
 	{
 		int baser;
-		if (rpos % pbarSteps == 0) {
-			gn_update_pbar(rpos + (rom_size >> 2));
-		}
 		baser = rpos;
 
-		baser ^= extra_xor;
+		baser ^= d->extra_xor;
 
 		baser ^= address_8_15_xor1[(baser >> 16) & 0xff] << 8;
 		baser ^= address_8_15_xor2[baser & 0xff] << 8;
@@ -596,8 +600,24 @@ static void neogeo_gfx_decrypt(running_machine *machine, int extra_xor)
 		rom[4*rpos+2] = buf[4*baser+2];
 		rom[4*rpos+3] = buf[4*baser+3];
 	}
+}
+
+static void neogeo_gfx_decrypt(running_machine *machine, int extra_xor)
+{
+	GFX_DECRYPT d;
+	d.rom_size = memory_region_length(machine, "sprites");
+	d.buf = alloc_array_or_die(UINT8, d.rom_size);
+	d.rom = memory_region(machine, "sprites");
+	d.extra_xor = extra_xor;
+
+	/* Each pass only writes the words at its own positions, so both can be
+	 split across threads, the address pass just has to wait for all the data */
+	gn_init_pbar(PBAR_ACTION_DECRYPT, d.rom_size/2);
+	gn_parallel_for(d.rom_size/4, 1, gfx_decrypt_data, &d);
+	gn_update_pbar(d.rom_size/4);
+	gn_parallel_for(d.rom_size/4, 1, gfx_decrypt_address, &d);
 	gn_terminate_pbar();
-	free(buf);
+	free(d.buf);
 }
 
 
@@ -30,6 +30,7 @@
 #include "resfile.h"
 #include "menu.h"
 #include "neocrypt.h"
+#include "threads.h"
 #ifdef GP2X
 #include "gp2x.h"
 #include "ym2610-940/940shared.h"
@@ -38,6 +39,11 @@
 
 static int need_decrypt = 1;
 
+/* Memory map of an uncompressed .gno file, regions pointing into it aren't freed */
+static struct GNOMAP *gno_map = NULL;
+static Uint8 *gno_map_data = NULL;
+static Uint32 gno_map_size = 0;
+
 int neogeo_fix_bank_type = 0;
 
 int bankoffset_kof99[64] = {
@@ -914,9 +920,13 @@ static int allocate_region(ROM_REGION *r, Uint32 size, int region) {
 	return 0;
 }
 
+static int region_is_mapped(const ROM_REGION *r) {
+	return gno_map && r->p >= gno_map_data && r->p < gno_map_data + gno_map_size;
+}
+
 static void free_region(ROM_REGION *r) {
 	DEBUG_LOG("Free Region %p %p %d", r, r->p, r->size);
-	if (r->p)
+	if (r->p && !region_is_mapped(r))
 		free(r->p);
 	r->size = 0;
 	r->p = NULL;
@@ -1098,15 +1108,21 @@ static int convert_roms_tile(Uint8 *g, int tileno) {
 
 }
 
-void convert_all_tile(GAME_ROMS *r) {
+static void convert_tile_range(void *arg, Uint32 start, Uint32 end) {
+	GAME_ROMS *r = arg;
 	Uint32 i;
-	allocate_region(&r->spr_usage, (r->tiles.size >> 11) * sizeof (Uint32), REGION_SPR_USAGE);
-	memset(r->spr_usage.p, 0, r->spr_usage.size);
-	for (i = 0; i < r->tiles.size >> 7; i++) {
+	for (i = start; i < end; i++) {
 		((Uint32*) r->spr_usage.p)[i >> 4] |= convert_roms_tile(r->tiles.p, i);
 	}
 }
 
+void convert_all_tile(GAME_ROMS *r) {
+	allocate_region(&r->spr_usage, (r->tiles.size >> 11) * sizeof (Uint32), REGION_SPR_USAGE);
+	memset(r->spr_usage.p, 0, r->spr_usage.size);
+	/* Tiles are independent, but 16 of them share a usage word */
+	gn_parallel_for(r->tiles.size >> 7, 16, convert_tile_range, r);
+}
+
 void convert_all_char(Uint8 *Ptr, int Taille,
 		Uint8 *usage_ptr) {
 	int i, j;
@@ -1527,6 +1543,20 @@ int dr_load_game(void *contextPtr, char *name, char romerror[1024]) {
 
 #if defined(HAVE_LIBZ)//&& defined (HAVE_MMAP)
 
+/* Region types:
+ * 0: raw data
+ * 1: zlib compressed blocks, decompressed on demand through the sprite cache (v1 only)
+ * 2: raw data starting on a page boundary, memory mapped when possible (v2 only) */
+#define GNO_PAGE_SIZE 4096
+
+static Uint32 gno_page_padding(long pos) {
+	return (GNO_PAGE_SIZE - (pos & (GNO_PAGE_SIZE - 1))) & (GNO_PAGE_SIZE - 1);
+}
+
+static int is_gno_id(const char *fid) {
+	return strncmp(fid, "gnodmpv1", 8) == 0 || strncmp(fid, "gnodmpv2", 8) == 0;
+}
+
 static int dump_region(FILE *gno, const ROM_REGION *rom, Uint8 id, Uint8 type,
 		Uint32 block_size, unsigned verbose) {
 	if (rom->p == NULL)
@@ -1537,6 +1567,12 @@ static int dump_region(FILE *gno, const ROM_REGION *rom, Uint8 id, Uint8 type,
 	if (type == 0) {
 		if(verbose) logMsg("Dump %d %08x", id, rom->size);
 		fwrite(rom->p, rom->size, 1, gno);
+	} else if (type == 2) {
+		static const Uint8 pad[GNO_PAGE_SIZE];
+		long pos = ftell(gno);
+		if(verbose) logMsg("Dump page aligned %d %08x", id, rom->size);
+		fwrite(pad, gno_page_padding(pos), 1, gno);
+		fwrite(rom->p, rom->size, 1, gno);
 	} else {
 		Uint32 nb_block = rom->size / block_size;
 		Uint32 *block_offset;
@@ -1595,7 +1631,7 @@ static int dump_region(FILE *gno, const ROM_REGION *rom, Uint8 id, Uint8 type,
 
 int dr_save_gno(GAME_ROMS *r, char *filename) {
 	FILE *gno;
-	char *fid = "gnodmpv1";
+	char *fid = "gnodmpv2";
 	char fname[9];
 	Uint8 nb_sec = 0;
 	int i;
@@ -1647,9 +1683,9 @@ int dr_save_gno(GAME_ROMS *r, char *filename) {
 	dump_region(gno, &r->cpu_m68k, REGION_MAIN_CPU_CARTRIDGE, 0, 0, 0);
 	dump_region(gno, &r->cpu_z80, REGION_AUDIO_CPU_CARTRIDGE, 0, 0, 0);
 	gn_update_pbar(1);
-	dump_region(gno, &r->adpcma, REGION_AUDIO_DATA_1, 0, 0, 0);
+	dump_region(gno, &r->adpcma, REGION_AUDIO_DATA_1, 2, 0, 0);
 	if (r->adpcma.p != r->adpcmb.p)
-		dump_region(gno, &r->adpcmb, REGION_AUDIO_DATA_2, 0, 0, 0);
+		dump_region(gno, &r->adpcmb, REGION_AUDIO_DATA_2, 2, 0, 0);
 	gn_update_pbar(2);
 	dump_region(gno, &r->game_sfix, REGION_FIXED_LAYER_CARTRIDGE, 0, 0, 0);
 	dump_region(gno, &r->spr_usage, REGION_SPR_USAGE, 0, 0, 0);
@@ -1661,9 +1697,9 @@ int dr_save_gno(GAME_ROMS *r, char *filename) {
 		dump_region(gno, &r->bios_sfix, REGION_FIXED_LAYER_BIOS, 0, 0, 0);
 	}
 	gn_update_pbar(3);
-	/* TODO, there is a bug in the loading routine, only one compressed (type 1)
-	 * region can be present at the end of the file */
-	dump_region(gno, &r->tiles, REGION_SPRITES, 1, 4096, 0);
+	/* Sprites are stored uncompressed so the loader can map them and let the OS
+	 * page tiles in as they're drawn instead of decompressing into a cache */
+	dump_region(gno, &r->tiles, REGION_SPRITES, 2, 0, 0);
 
 
 	fclose(gno);
@@ -1725,6 +1761,20 @@ int read_region(FILE *gno, GAME_ROMS *roms) {
 		allocate_region(r, size, lid);
 		logMsg("Load %d %08x\n", lid, r->size);
 		totread += fread(r->p, r->size, 1, gno);
+	} else if (type == 2) {
+		long pos = ftell(gno);
+		pos += gno_page_padding(pos);
+		if (gno_map && pos + (long)size <= (long)gno_map_size) {
+			logMsg("Map %d %08x at offset %08lx\n", lid, size, pos);
+			r->p = gno_map_data + pos;
+			r->size = size;
+		} else {
+			allocate_region(r, size, lid);
+			logMsg("Load %d %08x\n", lid, r->size);
+			fseek(gno, pos, SEEK_SET);
+			totread += fread(r->p, r->size, 1, gno);
+		}
+		fseek(gno, pos + size, SEEK_SET);
 	} else {
 		Uint32 nb_block, block_size;
 		Uint32 cmp_size;
@@ -1769,6 +1819,7 @@ int dr_open_gno(void *contextPtr, char *filename, char romerror[1024]) {
 	memory.bksw_offset = NULL;
 
 	need_decrypt = 0;
+	memory.vid.spr_cache.gno = NULL;
 
 	gno = fopen(filename, "rb");
 	if (!gno)
@@ -1778,11 +1829,16 @@ int dr_open_gno(void *contextPtr, char *filename, char romerror[1024]) {
 	}
 
 	totread += fread(fid, 8, 1, gno);
-	if (strncmp(fid, "gnodmpv1", 8) != 0) {
+	if (!is_gno_id(fid)) {
 		fclose(gno);
 		sprintf(romerror, "Invalid GNO file");
 		return false;
 	}
+	if (strncmp(fid, "gnodmpv2", 8) == 0) {
+		gno_map = gn_map_file(contextPtr, filename, &gno_map_data, &gno_map_size);
+		if (!gno_map)
+			logMsg("Can't map GNO file, reading it instead");
+	}
 	totread += fread(name, 8, 1, gno);
 	a = strchr(name, ' ');
 	if (a) a[0] = 0;
@@ -1802,7 +1858,9 @@ int dr_open_gno(void *contextPtr, char *filename, char romerror[1024]) {
 		r->adpcmb.p = r->adpcma.p;
 		r->adpcmb.size = r->adpcma.size;
 	}
-	//fclose(gno);
+	/* The file stays open only when the sprite cache reads from it */
+	if (memory.vid.spr_cache.gno != gno)
+		fclose(gno);
 
 	memory.fix_game_usage = r->gfix_usage.p;
 	/*	memory.pen_usage = malloc((r->tiles.size >> 11) * sizeof(Uint32));
@@ -1836,7 +1894,7 @@ char *dr_gno_romname(char *filename) {
 		return NULL;
 
 	totread += fread(fid, 8, 1, gno);
-	if (strncmp(fid, "gnodmpv1", 8) != 0) {
+	if (!is_gno_id(fid)) {
 		fclose(gno);
 		logMsg("Invalid GNO file");
 		return NULL;
@@ -1893,6 +1951,13 @@ void dr_free_roms(GAME_ROMS *r) {
 	free(memory.fix_game_usage);
 	free_region(&r->spr_usage);
 
+	if (gno_map) {
+		gn_unmap_file(gno_map);
+		gno_map = NULL;
+		gno_map_data = NULL;
+		gno_map_size = 0;
+	}
+
 	//free(r->info.name);
 	//free(r->info.longname);
 
@@ -444,43 +444,74 @@ bool save_state(char *game,int slot) {
 
 #else
 
-static gzFile open_state(void *contextPtr, const char *st_name, int mode) {
-	char string[20];
-	char *m=(mode==STWRITE?"wb":"rb");
-	gzFile gzf;
-	int  flags;
-	Uint32 rate;
+/* In-memory states run through the same mkstate functions with a NULL gzFile */
+typedef struct MEM_STATE {
+	Uint8 *data; /* NULL when only computing the state size */
+	int size;
+	int pos;
+	bool error;
+} MEM_STATE;
+
+static MEM_STATE *mem_state;
+
+static int mem_state_data(void *data, int size, int mode) {
+	if (mem_state->error)
+		return 0;
+	if (mem_state->data && mem_state->pos + size > mem_state->size) {
+		mem_state->error = true;
+		return 0;
+	}
+	if (mode == STREAD)
+		memcpy(data, mem_state->data + mem_state->pos, size);
+	else if (mem_state->data)
+		memcpy(mem_state->data + mem_state->pos, data, size);
+	mem_state->pos += size;
+	return size;
+}
 
-	if ((gzf = gzopenHelper(contextPtr, st_name, m)) == NULL) {
-		logMsg("%s not found\n", st_name);
-		return NULL;
-    }
+static const char *stateSig = "GNGST3";
 
-	static const char *stateSig = "GNGST3";
+static bool mkstate_header(gzFile gzf, int mode) {
+	char string[20];
+	int flags = m68k_flag | z80_flag | endian_flag;
 
 	if(mode==STREAD) {
 
 		memset(string, 0, 20);
-		gzread(gzf, string, 6);
+		mkstate_data(gzf, string, 6, mode);
 
 		if (strcmp(string, stateSig)) {
-			logMsg("%s is not a valid gngeo st file", st_name);
-			gzclose(gzf);
-			return NULL;
+			logMsg("not a valid gngeo st file");
+			return false;
 		}
 
-		gzread(gzf, &flags, sizeof (int));
+		mkstate_data(gzf, &flags, sizeof (int), mode);
 
 		if (flags != (m68k_flag | z80_flag | endian_flag)) {
 			logMsg("This save state comes from a different endian architecture.\n"
 					"This is not currently supported :(");
-			gzclose(gzf);
-			return NULL;
+			return false;
 		}
 	} else {
-		int flags=m68k_flag | z80_flag | endian_flag;
-		gzwrite(gzf, stateSig, 6);
-		gzwrite(gzf, &flags, sizeof(int));
+		mkstate_data(gzf, (void*)stateSig, 6, mode);
+		mkstate_data(gzf, &flags, sizeof(int), mode);
+	}
+	return true;
+}
+
+static gzFile open_state(void *contextPtr, const char *st_name, int mode) {
+	char *m=(mode==STWRITE?"wb":"rb");
+	gzFile gzf;
+
+	if ((gzf = gzopenHelper(contextPtr, st_name, m)) == NULL) {
+		logMsg("%s not found\n", st_name);
+		return NULL;
+    }
+
+	if (!mkstate_header(gzf, mode)) {
+		logMsg("error with header of %s", st_name);
+		gzclose(gzf);
+		return NULL;
 	}
 	return gzf;
 }
@@ -492,6 +523,8 @@ static gzFile open_state(void *contextPtr, const char *st_name, int mode) {
 }*/
 
 int mkstate_data(gzFile gzf,void *data,int size,int mode) {
+	if (mem_state)
+		return mem_state_data(data, size, mode);
 	if (mode==STREAD)
 		return gzread(gzf,data,size);
 	return gzwrite(gzf,data,size);
@@ -553,8 +586,7 @@ int save_stateWithName(void *contextPtr, const char *name) {
 	return true;
 }
 
-int load_stateWithName(void *contextPtr, const char *name) {
-	gzFile gzf;
+static void neogeo_load_state(gzFile gzf) {
 	/* Save pointers */
 	Uint8 *ng_lo = memory.ng_lo;
 	Uint8 *fix_game_usage=memory.fix_game_usage;
@@ -562,9 +594,6 @@ int load_stateWithName(void *contextPtr, const char *name) {
 	int *bksw_offset=memory.bksw_offset;
 //	GAME_ROMS r;
 //	memcpy(&r,&memory.rom,sizeof(GAME_ROMS));
-	
-	if ((gzf = open_state(contextPtr, name, STREAD))==NULL)
-		return false;
 
 	//gzread(gzf,state_img_tmp->pixels,304*224*2);
 
@@ -599,10 +628,44 @@ int load_stateWithName(void *contextPtr, const char *name) {
 		current_fix = memory.rom.bios_sfix.p;
 		fix_usage = memory.fix_board_usage;
 	}
+}
+
+int load_stateWithName(void *contextPtr, const char *name) {
+	gzFile gzf;
+
+	if ((gzf = open_state(contextPtr, name, STREAD))==NULL)
+		return false;
+
+	neogeo_load_state(gzf);
 
 	gzclose(gzf);
 	return true;
 }
+
+int save_stateToMem(Uint8 *data, int size) {
+	MEM_STATE mem = {data, size, 0, false};
+	mem_state = &mem;
+	mkstate_header(NULL, STWRITE);
+	neogeo_mkstate(NULL, STWRITE);
+	mem_state = NULL;
+	return mem.error ? 0 : mem.pos;
+}
+
+int load_stateFromMem(const Uint8 *data, int size) {
+	MEM_STATE mem = {(Uint8*)data, size, 0, false};
+	mem_state = &mem;
+	if (!mkstate_header(NULL, STREAD) || mem.error) {
+		mem_state = NULL;
+		return false;
+	}
+	neogeo_load_state(NULL);
+	mem_state = NULL;
+	if (mem.error) {
+		logMsg("truncated state data");
+		return false;
+	}
+	return true;
+}
 #endif
 
 #if 0
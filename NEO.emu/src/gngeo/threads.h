@@ -0,0 +1,25 @@
+#ifndef THREADS_H
+#define THREADS_H
+
+#include <stdint.h>
+
+typedef void (*gn_range_func)(void *arg, uint32_t start, uint32_t end);
+
+/* Calls func over [0, count) split into one range per core and returns once all
+ * ranges are done. Range boundaries are multiples of grain so items sharing
+ * output data (like the 16 tiles of a pen usage word) stay on one thread. */
+void gn_parallel_for(uint32_t count, uint32_t grain, gn_range_func func, void *arg);
+
+/* Sound thread running the Z80 & YM2610. Z80 frames, sound commands and audio
+ * renders are queued in emulation order and run while the 68k keeps going, the
+ * emulation thread only waits on it with gn_sound_thread_sync() before reading
+ * Z80 replies or touching sound state. */
+void gn_sound_thread_start(void);
+void gn_sound_thread_stop(void);
+int gn_sound_thread_running(void);
+void gn_sound_thread_run_z80_frame(void);
+void gn_sound_thread_send_command(uint8_t code);
+void gn_sound_thread_render(uint16_t *buff, uint32_t frames);
+void gn_sound_thread_sync(void);
+
+#endif
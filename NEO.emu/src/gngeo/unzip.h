@@ -60,4 +60,10 @@ void gn_close_zip(struct PKZIP *zf);
 int gn_strictROMChecking();
 struct PKZIP *open_rom_zip(void *contextPtr, char *romPath, char *name);
 
+/* Memory maps a whole file read-only, pages are loaded by the OS on first access.
+ * Returns NULL if the file can't be mapped. */
+struct GNOMAP;
+struct GNOMAP *gn_map_file(void *contextPtr, const char *path, uint8_t **data, uint32_t *size);
+void gn_unmap_file(struct GNOMAP *map);
+
 #endif /* UNZIP_H_ */
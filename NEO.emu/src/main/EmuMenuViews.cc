@@ -171,6 +171,16 @@ class CustomSystemOptionView : public SystemOptionView, public MainAppHelper<Cus
 		}
 	};
 
+	BoolMenuItem soundThread
+	{
+		"Run Sound CPU On Worker Thread", &defaultFace(),
+		(bool)system().optionSoundThread,
+		[this](BoolMenuItem &item, View &, Input::Event e)
+		{
+			system().setSoundThread(item.flipBoolValue(*this));
+		}
+	};
+
 public:
 	CustomSystemOptionView(ViewAttachParams attach): SystemOptionView{attach, true}
 	{
@@ -179,6 +189,7 @@ public:
 		item.emplace_back(&region);
 		item.emplace_back(&createAndUseCache);
 		item.emplace_back(&strictROMChecking);
+		item.emplace_back(&soundThread);
 	}
 };
 
@@ -16,6 +16,7 @@
 #define LOGTAG "main"
 #include <emuframework/EmuSystemInlines.hh>
 #include <emuframework/EmuAppInlines.hh>
+#include <emuframework/zlibUtils.hh>
 #include <imagine/fs/ArchiveFS.hh>
 #include <imagine/fs/FS.hh>
 #include <imagine/io/FileIO.hh>
@@ -34,6 +35,7 @@ extern "C"
 	#include <gngeo/screen.h>
 	#include <gngeo/menu.h>
 	#include <gngeo/resfile.h>
+	#include <gngeo/threads.h>
 
 	CONFIG conf{};
 	GN_Rect visible_area;
@@ -137,6 +139,7 @@ EmuSystem::NameFilterFunc EmuSystem::defaultFsFilter = hasNeoGeoExtension;
 void NeoSystem::reset(EmuApp &, ResetMode mode)
 {
 	assert(hasContent());
+	gn_sound_thread_sync();
 	neogeo_reset();
 	cpu_z80_init();
 	YM2610Reset();
@@ -147,18 +150,56 @@ FS::FileString NeoSystem::stateFilename(int slot, std::string_view name) const
 	return IG::format<FS::FileString>("{}.0{}.sta", name, saveSlotCharUpper(slot));
 }
 
-void NeoSystem::saveState(IG::CStringView path)
+static constexpr size_t maxStateSize = 0x400000;
+
+size_t NeoSystem::stateSize()
 {
-	auto ctx = appContext();
-	if(!save_stateWithName(&ctx, path))
-		return EmuSystem::throwFileWriteError();
+	return gzipCompressBound(save_stateToMem(nullptr, 0));
+}
+
+void NeoSystem::readState(EmuApp &, std::span<const uint8_t> buff)
+{
+	gn_sound_thread_sync();
+	if(hasGzipHeader(buff))
+	{
+		auto size = gzipUncompressedSize(buff, maxStateSize);
+		if(!size)
+			throw std::runtime_error("Invalid state data size");
+		auto stateBuff = std::make_unique_for_overwrite<uint8_t[]>(size);
+		if(gzipDecompress(buff, {stateBuff.get(), size}) != size)
+			throw std::runtime_error("Error uncompressing state data");
+		if(!load_stateFromMem(stateBuff.get(), size))
+			throw std::runtime_error("Invalid state data");
+	}
+	else
+	{
+		if(!load_stateFromMem(buff.data(), buff.size()))
+			throw std::runtime_error("Invalid state data");
+	}
+}
+
+size_t NeoSystem::writeState(std::span<uint8_t> buff, SaveStateFlags flags)
+{
+	gn_sound_thread_sync();
+	if(to_underlying(flags & SaveStateFlags::uncompressed))
+	{
+		auto size = save_stateToMem(buff.data(), buff.size());
+		if(!size)
+			throw std::runtime_error("State buffer too small");
+		return size;
+	}
+	size_t size = save_stateToMem(nullptr, 0);
+	auto stateBuff = std::make_unique_for_overwrite<uint8_t[]>(size);
+	save_stateToMem(stateBuff.get(), size);
+	auto compressedSize = gzipCompress({stateBuff.get(), size}, buff);
+	if(!compressedSize)
+		throw std::runtime_error("State buffer too small");
+	return compressedSize;
 }
 
-void NeoSystem::loadState(EmuApp &app, IG::CStringView path)
+size_t NeoSystem::compressState(std::span<const uint8_t> src, std::span<uint8_t> dest) const
 {
-	auto ctx = app.appContext();
-	if(!load_stateWithName(&ctx, path))
-		return EmuSystem::throwFileReadError();
+	return gzipCompress(src, dest);
 }
 
 static auto nvramPath(EmuApp &app)
@@ -174,10 +215,8 @@ static auto memcardPath(EmuApp &app)
 void NeoSystem::loadBackupMemory(EmuApp &app)
 {
 	logMsg("loading nvram & memcard");
-	if(!nvramFileIO)
-		nvramFileIO = staticBackupMemoryFile(nvramPath(app), 0x10000);
-	if(!memcardFileIO)
-		memcardFileIO = staticBackupMemoryFile(memcardPath(app), 0x800);
+	auto nvramFileIO = staticBackupMemoryFile(nvramPath(app), 0x10000);
+	auto memcardFileIO = staticBackupMemoryFile(memcardPath(app), 0x800);
 	if(!nvramFileIO || !memcardFileIO)
 		throw std::runtime_error("Error accessing .nv or .memcard file, please verify it has write access");
 	nvramFileIO.read(memory.sram, 0x10000, 0);
@@ -189,12 +228,12 @@ void NeoSystem::onFlushBackupMemory(EmuApp &app, BackupMemoryDirtyFlags flags)
 	if(flags & SRAM_DIRTY_BIT)
 	{
 		logMsg("saving nvram");
-		nvramFileIO.write(memory.sram, 0x10000, 0);
+		app.saveBackupMemory(nvramPath(app), {memory.sram, 0x10000});
 	}
 	if(flags & MEMCARD_DIRTY_BIT)
 	{
 		logMsg("saving memcard");
-		memcardFileIO.write(memory.memcard, 0x800, 0);
+		app.saveBackupMemory(memcardPath(app), {memory.memcard, 0x800});
 	}
 }
 
@@ -205,9 +244,9 @@ IG::Time NeoSystem::backupMemoryLastWriteTime(const EmuApp &app) const
 
 void NeoSystem::closeSystem()
 {
+	gn_sound_thread_sync();
+	threadAudioFrames = 0;
 	close_game();
-	nvramFileIO = {};
-	memcardFileIO = {};
 }
 
 static auto openGngeoDataIO(IG::ApplicationContext ctx, IG::CStringView filename)
@@ -285,9 +324,20 @@ void NeoSystem::configAudioRate(FloatSeconds outputFrameTime, int outputRate)
 		return;
 	conf.sample_rate = mixRate;
 	logMsg("set sound mix rate:%d", (int)mixRate);
+	gn_sound_thread_sync();
 	YM2610ChangeSamplerate(mixRate);
 }
 
+void NeoSystem::setSoundThread(bool on)
+{
+	optionSoundThread = on;
+	if(on)
+		gn_sound_thread_start();
+	else
+		gn_sound_thread_stop();
+	logMsg("sound thread %s", on ? "on" : "off");
+}
+
 void NeoSystem::renderFramebuffer(EmuVideo &video)
 {
 	video.startFrameWithFormat({}, videoPixmap());
@@ -300,6 +350,23 @@ void NeoSystem::runFrame(EmuSystemTaskContext taskCtx, EmuVideo *video, EmuAudio
 		std::ranges::fill(screenBuff, (uint16_t)current_pc_pal[4095]);
 	main_frame(&taskCtx, this, video);
 	auto audioFrames = updateAudioFramesPerVideoFrame();
+	if(gn_sound_thread_running())
+	{
+		// output the previous frame's audio, rendered while this frame ran, and queue this frame's
+		gn_sound_thread_sync();
+		if(audio && threadAudioFrames)
+			audio->writeFrames(threadAudioBuff.data(), threadAudioFrames);
+		threadAudioBuff.resize(audioFrames * 2);
+		threadAudioFrames = audioFrames;
+		gn_sound_thread_render(threadAudioBuff.data(), audioFrames);
+		return;
+	}
+	if(threadAudioFrames)
+	{
+		if(audio)
+			audio->writeFrames(threadAudioBuff.data(), threadAudioFrames);
+		threadAudioFrames = 0;
+	}
 	Uint16 audioBuff[audioFrames * 2];
 	YM2610Update_stream(audioFrames, audioBuff);
 	if(audio)
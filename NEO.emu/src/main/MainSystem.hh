@@ -21,7 +21,8 @@ enum
 	CFGKEY_LIST_ALL_GAMES = 275, CFGKEY_BIOS_TYPE = 276,
 	CFGKEY_MVS_COUNTRY = 277, CFGKEY_TIMER_INT = 278,
 	CFGKEY_CREATE_USE_CACHE = 279,
-	CFGKEY_NEOGEOKEY_TEST_SWITCH = 280, CFGKEY_STRICT_ROM_CHECKING = 281
+	CFGKEY_NEOGEOKEY_TEST_SWITCH = 280, CFGKEY_STRICT_ROM_CHECKING = 281,
+	CFGKEY_SOUND_THREAD = 282
 };
 
 inline bool systemEnumIsValid(uint8_t val)
@@ -39,8 +40,6 @@ class NeoSystem final: public EmuSystem
 public:
 	static constexpr auto pixFmt = IG::PIXEL_FMT_RGB565;
 	static constexpr int FBResX = 352;
-	FileIO nvramFileIO;
-	FileIO memcardFileIO;
 	GN_Surface sdlSurf{};
 	uint16_t screenBuff[FBResX*256] __attribute__ ((aligned (8))){};
 	FS::PathString datafilePath{};
@@ -51,10 +50,14 @@ public:
 	Byte1Option optionTimerInt{CFGKEY_TIMER_INT, 2};
 	Byte1Option optionCreateAndUseCache{CFGKEY_CREATE_USE_CACHE, 0};
 	Byte1Option optionStrictROMChecking{CFGKEY_STRICT_ROM_CHECKING, 0};
+	Byte1Option optionSoundThread{CFGKEY_SOUND_THREAD, 0};
+	std::vector<uint16_t> threadAudioBuff; // audio rendered by the sound thread, output on the next frame
+	int threadAudioFrames{};
 	static constexpr FloatSeconds staticFrameTime{264. / 15625.}; // ~59.18Hz
 
 	NeoSystem(ApplicationContext ctx);
 	void setTimerIntOption();
+	void setSoundThread(bool on);
 	PixmapView videoPixmap()
 	{
 		// start image on y 16, x 24, size 304x224, 48 pixel padding on the right
@@ -66,8 +69,10 @@ public:
 	[[gnu::hot]] void runFrame(EmuSystemTaskContext task, EmuVideo *video, EmuAudio *audio);
 	FS::FileString stateFilename(int slot, std::string_view name) const;
 	std::string_view stateFilenameExt() const { return ".sta"; }
-	void loadState(EmuApp &, CStringView uri);
-	void saveState(CStringView path);
+	size_t stateSize();
+	void readState(EmuApp &, std::span<const uint8_t> buff);
+	size_t writeState(std::span<uint8_t> buff, SaveStateFlags = {});
+	size_t compressState(std::span<const uint8_t> src, std::span<uint8_t> dest) const;
 	bool readConfig(ConfigType, MapIO &, unsigned key, size_t readSize);
 	void writeConfig(ConfigType, FileIO &);
 	void reset(EmuApp &, ResetMode mode);
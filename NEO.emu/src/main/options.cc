@@ -56,6 +56,7 @@ void NeoSystem::onOptionsLoaded()
 {
 	conf.system = (SYSTEM)optionBIOSType.val;
 	conf.country = (COUNTRY)optionMVSCountry.val;
+	setSoundThread(optionSoundThread);
 }
 
 bool NeoSystem::resetSessionOptions(EmuApp &app)
@@ -76,6 +77,7 @@ bool NeoSystem::readConfig(ConfigType type, MapIO &io, unsigned key, size_t read
 			case CFGKEY_MVS_COUNTRY: return optionMVSCountry.readFromIO(io, readSize);
 			case CFGKEY_CREATE_USE_CACHE: return optionCreateAndUseCache.readFromIO(io, readSize);
 			case CFGKEY_STRICT_ROM_CHECKING: return optionStrictROMChecking.readFromIO(io, readSize);
+			case CFGKEY_SOUND_THREAD: return optionSoundThread.readFromIO(io, readSize);
 		}
 	}
 	else if(type == ConfigType::SESSION)
@@ -97,6 +99,7 @@ void NeoSystem::writeConfig(ConfigType type, FileIO &io)
 		optionMVSCountry.writeWithKeyIfNotDefault(io);
 		optionCreateAndUseCache.writeWithKeyIfNotDefault(io);
 		optionStrictROMChecking.writeWithKeyIfNotDefault(io);
+		optionSoundThread.writeWithKeyIfNotDefault(io);
 	}
 	else if(type == ConfigType::SESSION)
 	{
@@ -0,0 +1,171 @@
+/*  This file is part of NEO.emu.
+
+	NEO.emu is free software: you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation, either version 3 of the License, or
+	(at your option) any later version.
+
+	NEO.emu is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License
+	along with NEO.emu.  If not, see <http://www.gnu.org/licenses/> */
+
+#include <imagine/util/ranges.hh>
+#include <imagine/thread/Semaphore.hh>
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <thread>
+#include <vector>
+
+extern "C"
+{
+	#include <gngeo/threads.h>
+	#include <gngeo/emu.h>
+	#include <gngeo/memory.h>
+	#include <gngeo/ym2610/ym2610.h>
+}
+
+using namespace IG;
+
+constexpr uint32_t maxThreads = 8;
+
+void gn_parallel_for(uint32_t count, uint32_t grain, gn_range_func func, void *arg)
+{
+	grain = std::max(grain, 1u);
+	uint32_t groups = (count + grain - 1) / grain;
+	uint32_t threads = std::min({std::max(std::thread::hardware_concurrency(), 1u), maxThreads, groups});
+	if(threads <= 1)
+	{
+		func(arg, 0, count);
+		return;
+	}
+	std::vector<std::thread> workers;
+	workers.reserve(threads - 1);
+	uint32_t start = 0;
+	for(auto i : iotaCount(threads))
+	{
+		uint32_t rangeGroups = groups / threads + (i < groups % threads);
+		uint32_t end = std::min(count, start + rangeGroups * grain);
+		if(i == threads - 1)
+			func(arg, start, end); // last range runs on the calling thread
+		else
+			workers.emplace_back(func, arg, start, end);
+		start = end;
+	}
+	for(auto &w : workers)
+		w.join();
+}
+
+namespace
+{
+
+// Single producer/consumer job queue, the emulation thread pushes jobs and the
+// sound thread runs them in order
+class SoundThread
+{
+public:
+	enum class JobType : uint8_t { Z80Frame, Command, Render, Sync, Quit };
+
+	struct Job
+	{
+		JobType type{};
+		uint8_t code{};
+		uint32_t frames{};
+		uint16_t *buff{};
+	};
+
+	~SoundThread() { stop(); }
+
+	void start()
+	{
+		if(thread.joinable())
+			return;
+		thread = std::thread{[this](){ run(); }};
+	}
+
+	void stop()
+	{
+		if(!thread.joinable())
+			return;
+		push({JobType::Quit});
+		thread.join();
+	}
+
+	bool running() const { return thread.joinable(); }
+
+	void push(Job job)
+	{
+		if(tail - head.load(std::memory_order_acquire) == queueSize - 1)
+			sync(); // keep the last slot free for the sync job
+		queue[tail % queueSize] = job;
+		tail++;
+		jobSem.release();
+	}
+
+	void sync()
+	{
+		if(head.load(std::memory_order_acquire) == tail)
+			return;
+		queue[tail % queueSize] = {JobType::Sync};
+		tail++;
+		jobSem.release();
+		syncSem.acquire();
+	}
+
+private:
+	static constexpr uint32_t queueSize = 64;
+	std::array<Job, queueSize> queue;
+	std::atomic_uint32_t head{}; // next job to run, only written by the sound thread
+	uint32_t tail{}; // next free slot, only used by the emulation thread
+	std::counting_semaphore<queueSize> jobSem{0};
+	std::binary_semaphore syncSem{0};
+	std::thread thread;
+
+	void run()
+	{
+		while(true)
+		{
+			jobSem.acquire();
+			auto idx = head.load(std::memory_order_relaxed);
+			auto job = queue[idx % queueSize];
+			switch(job.type)
+			{
+				case JobType::Z80Frame: run_z80_frame(); break;
+				case JobType::Command: z80_sound_command(job.code); break;
+				case JobType::Render: YM2610Update_stream(job.frames, job.buff); break;
+				case JobType::Sync:
+				case JobType::Quit: break;
+			}
+			head.store(idx + 1, std::memory_order_release);
+			if(job.type == JobType::Sync)
+				syncSem.release();
+			else if(job.type == JobType::Quit)
+				return;
+		}
+	}
+};
+
+SoundThread soundThread;
+
+}
+
+void gn_sound_thread_start(void) { soundThread.start(); }
+
+void gn_sound_thread_stop(void) { soundThread.stop(); }
+
+int gn_sound_thread_running(void) { return soundThread.running(); }
+
+void gn_sound_thread_run_z80_frame(void) { soundThread.push({SoundThread::JobType::Z80Frame}); }
+
+void gn_sound_thread_send_command(uint8_t code) { soundThread.push({SoundThread::JobType::Command, code}); }
+
+void gn_sound_thread_render(uint16_t *buff, uint32_t frames)
+{
+	soundThread.push({SoundThread::JobType::Render, 0, frames, buff});
+}
+
+void gn_sound_thread_sync(void) { soundThread.sync(); }
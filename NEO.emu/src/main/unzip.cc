@@ -139,6 +139,39 @@ struct PKZIP *open_rom_zip(void *contextPtr, char *romPath, char *name)
 	return nullptr;
 }
 
+struct GNOMAP
+{
+	IOBuffer buff;
+};
+
+struct GNOMAP *gn_map_file(void *contextPtr, const char *path, uint8_t **data, uint32_t *size)
+{
+	auto &ctx = *((IG::ApplicationContext*)contextPtr);
+	try
+	{
+		auto io = ctx.openFileUri(path, IOAccessHint::Random, OpenFlagsMask::Test);
+		if(!io || !io.map().data())
+		{
+			logMsg("can't map file:%s", path);
+			return nullptr;
+		}
+		auto map = new GNOMAP{io.releaseBuffer()};
+		*data = map->buff.data();
+		*size = map->buff.size();
+		return map;
+	}
+	catch(...)
+	{
+		logErr("error mapping file:%s", path);
+		return nullptr;
+	}
+}
+
+void gn_unmap_file(struct GNOMAP *map)
+{
+	delete map;
+}
+
 gzFile gzopenHelper(void *contextPtr, const char *filename, const char *mode)
 {
 	auto &ctx = *((IG::ApplicationContext*)contextPtr);
@@ -537,22 +537,15 @@ void FCEU_SaveGameSave(CartInfo *LocalHWInfo)
 {
 	if (LocalHWInfo->battery && !LocalHWInfo->SaveGame.empty())
 	{
-		FILE *sp;
+		std::vector<uint8> saveData;
 
-		std::string soot = FCEU_MakeFName(FCEUMKF_SAV, 0, "sav");
-		if ((sp = FCEUD_UTF8fopen(soot, "wb")) == NULL)
-		{
-			FCEU_PrintError("WRAM file \"%s\" cannot be written to.\n", soot.c_str());
-		}
-		else
-		{
-			for (size_t x = 0; x < LocalHWInfo->SaveGame.size(); x++)
-				if (LocalHWInfo->SaveGame[x].bufptr)
-				{
-					fwrite(LocalHWInfo->SaveGame[x].bufptr, 1,
-						     LocalHWInfo->SaveGame[x].buflen, sp);
-				}
-		}
+		for (size_t x = 0; x < LocalHWInfo->SaveGame.size(); x++)
+			if (LocalHWInfo->SaveGame[x].bufptr)
+			{
+				saveData.insert(saveData.end(), LocalHWInfo->SaveGame[x].bufptr,
+					LocalHWInfo->SaveGame[x].bufptr + LocalHWInfo->SaveGame[x].buflen);
+			}
+		FCEUD_WriteBackupMemory(FCEU_MakeFName(FCEUMKF_SAV, 0, "sav"), saveData.data(), saveData.size());
 	}
 }
 
@@ -948,19 +948,10 @@ void FCEU_FDSReadModifiedDisk() {
 void FCEU_FDSWriteModifiedDisk() {
 	if (!DiskWritten) return;
 
-	FILE *fp;
-	std::string fn = FCEU_MakeFName(FCEUMKF_FDS, 0, 0);
-	if (!(fp = FCEUD_UTF8fopen(fn.c_str(), "wb"))) {
-		return;
-	}
-
+	std::vector<uint8> diskData(TotalSides * 65500);
 	for (int x = 0; x < TotalSides; x++) {
-		if (fwrite(diskdata[x], 1, 65500, fp) != 65500) {
-			FCEU_PrintError("Error saving FDS image!");
-			fclose(fp);
-			return;
-		}
+		memcpy(&diskData[x * 65500], diskdata[x], 65500);
 	}
 
-	fclose(fp);
+	FCEUD_WriteBackupMemory(FCEU_MakeFName(FCEUMKF_FDS, 0, 0), diskData.data(), diskData.size());
 }
@@ -37,6 +37,10 @@ struct FCEUFILE {
 	//the size of the file
 	size_t size;
 
+	//EmuEx: digests of the data after the iNES header & trainer if already computed by the driver code, otherwise null
+	const uint8 *contentMD5 = nullptr;
+	const uint32 *contentCRC32 = nullptr;
+
 	//whether the file is contained in an archive
 	bool isArchive() { return archiveCount > 0; }
 
@@ -968,16 +968,23 @@ int iNESLoad(const char *name, FCEUFILE *fp, int OverwriteVidMode) {
 	if (VROM_size)
 		FCEU_fread(VROM, 0x2000, VROM_size, fp);
 
-	md5_starts(&md5); 
-	md5_update(&md5, ROM, ROM_size << 14);
-
-	iNESGameCRC32 = CalcCRC32(0, ROM, ROM_size << 14);
-
-	if (VROM_size) {
-		iNESGameCRC32 = CalcCRC32(iNESGameCRC32, VROM, VROM_size << 13);
-		md5_update(&md5, VROM, VROM_size << 13);
+	//EmuEx: use the driver's digests if the file holds exactly the hashed PRG & CHR data, without any 0xFF padding
+	if (fp->contentMD5 && fp->contentCRC32 && (round || not_round_size == ROM_size)
+		&& fp->size == 16 + (trainerpoo ? 512 : 0) + (ROM_size << 14) + (VROM_size << 13)) {
+		memcpy(iNESCart.MD5, fp->contentMD5, sizeof(iNESCart.MD5));
+		iNESGameCRC32 = *fp->contentCRC32;
+	} else {
+		md5_starts(&md5);
+		md5_update(&md5, ROM, ROM_size << 14);
+
+		iNESGameCRC32 = CalcCRC32(0, ROM, ROM_size << 14);
+
+		if (VROM_size) {
+			iNESGameCRC32 = CalcCRC32(iNESGameCRC32, VROM, VROM_size << 13);
+			md5_update(&md5, VROM, VROM_size << 13);
+		}
+		md5_finish(&md5, iNESCart.MD5);
 	}
-	md5_finish(&md5, iNESCart.MD5);
 	memcpy(&GameInfo->MD5, &iNESCart.MD5, sizeof(iNESCart.MD5));
 	for (int x = 0; x < 8; x++)
 		partialmd5 |= (uint64)iNESCart.MD5[7 - x] << (x * 8);
@@ -29,6 +29,15 @@ EmuFileIO::EmuFileIO(IG::IO &srcIO):
 	}
 }
 
+EmuFileIO::EmuFileIO(IG::MapIO srcIO):
+	io{std::move(srcIO)}
+{
+	if(!io) [[unlikely]]
+	{
+		failbit = true;
+	}
+}
+
 int EmuFileIO::fgetc() { return IG::fgetc(io); }
 
 size_t EmuFileIO::_fread(const void *ptr, size_t bytes)
@@ -39,6 +48,20 @@ size_t EmuFileIO::_fread(const void *ptr, size_t bytes)
 	return ret;
 }
 
+int EmuFileIO::fputc(int c)
+{
+	uint8_t byte = c;
+	fwrite(&byte, 1);
+	return failbit ? EOF : byte;
+}
+
+void EmuFileIO::fwrite(const void *ptr, size_t bytes)
+{
+	ssize_t ret = io.write(ptr, bytes);
+	if(ret < (ssize_t)bytes)
+		failbit = true;
+}
+
 int EmuFileIO::fseek(long int offset, int origin)
 {
 	return IG::fseek(io, offset, origin);
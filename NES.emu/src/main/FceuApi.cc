@@ -75,6 +75,11 @@ FILE *FCEUD_UTF8fopen(const char *fn, const char *mode)
 	return IG::FileUtils::fopenUri(EmuEx::gAppContext(), fn, mode);
 }
 
+void FCEUD_WriteBackupMemory(const std::string &fn, const void *data, size_t size)
+{
+	EmuEx::gApp().saveBackupMemory(fn, {static_cast<const uint8_t*>(data), size});
+}
+
 void FCEU_printf(const char *format, ...)
 {
 	if(!Config::DEBUG_BUILD)
@@ -30,6 +30,8 @@
 #include <fceu/video.h>
 #include <fceu/sound.h>
 #include <fceu/x6502.h>
+#include <fceu/movie.h>
+#include <zlib.h>
 
 void ApplyDeemphasisComplete(pal* pal512);
 void FCEU_setDefaultPalettePtr(pal *ptr);
@@ -53,6 +55,8 @@ bool EmuSystem::hasCheats = true;
 bool EmuSystem::hasPALVideoSystem = true;
 bool EmuSystem::hasResetModes = true;
 bool EmuSystem::hasRectangularPixels = true;
+bool EmuSystem::hasRunAhead = true;
+bool EmuSystem::canRenderPaletteIndexed = true;
 bool EmuApp::needsGlobalInstance = true;
 unsigned fceuCheats = 0;
 
@@ -112,16 +116,47 @@ FS::FileString NesSystem::stateFilename(int slot, std::string_view name) const
 	return IG::format<FS::FileString>("{}.fc{}", name, saveSlotCharNES(slot));
 }
 
-void NesSystem::saveState(IG::CStringView path)
+static constexpr size_t stateHeaderSize = 16;
+
+size_t NesSystem::stateSize()
+{
+	// the state size only depends on the loaded game, so measure it once
+	if(!stateSize_)
+	{
+		EMUFILE_MEMORY stateData;
+		FCEUSS_SaveMS(&stateData, Z_NO_COMPRESSION);
+		size_t dataSize = stateData.size() - stateHeaderSize;
+		// worst case compressed size as calculated in FCEUSS_SaveMS()
+		stateSize_ = stateHeaderSize + (dataSize >> 9) + 12 + dataSize;
+	}
+	return stateSize_;
+}
+
+void NesSystem::readState(EmuApp &, std::span<const uint8_t> buff)
 {
-	if(!FCEUI_SaveState(path))
-		EmuSystem::throwFileWriteError();
+	if(!FCEU_IsValidUI(FCEUI_LOADSTATE))
+		throw std::runtime_error("Can't load state at this time");
+	EmuFileIO stateData{MapIO{IOBuffer{{const_cast<uint8_t*>(buff.data()), buff.size()}, 0}}};
+	if(!FCEUSS_LoadFP(&stateData, SSLOADPARAM_NOBACKUP))
+		throw std::runtime_error("Invalid state data");
+	newppu_hacky_emergency_reset();
 }
 
-void NesSystem::loadState(EmuApp &app, IG::CStringView path)
+size_t NesSystem::writeState(std::span<uint8_t> buff, SaveStateFlags flags)
 {
-	if(!FCEUI_LoadState(path))
-		EmuSystem::throwFileReadError();
+	if(!FCEU_IsValidUI(FCEUI_SAVESTATE) || geniestage == 1)
+		throw std::runtime_error("Can't save state at this time");
+	EmuFileIO stateData{MapIO{IOBuffer{buff, 0}}};
+	bool compress = !to_underlying(flags & SaveStateFlags::uncompressed) && FCEUMOV_Mode(MOVIEMODE_INACTIVE);
+	if(!FCEUSS_SaveMS(&stateData, compress ? -1 : Z_NO_COMPRESSION))
+		throw std::runtime_error("Error saving state data");
+	if(stateData.fail())
+	{
+		// the data may have outgrown the buffer, measure it again on the next stateSize() call
+		stateSize_ = 0;
+		throw std::runtime_error("State buffer too small");
+	}
+	return stateData.ftell();
 }
 
 void NesSystem::loadBackupMemory(EmuApp &app)
@@ -163,6 +198,7 @@ void NesSystem::closeSystem()
 	FCEUI_CloseGame();
 	fceuCheats = 0;
 	fdsIsAccessing = false;
+	stateSize_ = 0;
 }
 
 void FCEUD_GetPalette(uint8 index, uint8 *r, uint8 *g, uint8 *b)
@@ -346,17 +382,29 @@ void setRegion(int region, int defaultRegion, int detectedRegion)
 
 void NesSystem::loadContent(IO &io, EmuSystemCreateParams, OnLoadProgressDelegate)
 {
+	auto ipsFile = FileUtils::fopenUri(appContext(), userFilePath(patchesDir, ".ips"), "r");
+	// iNESLoad() hashes the PRG & CHR data following the header & optional trainer for its game database
+	ContentDigest digest;
+	if(auto header = io.get<std::array<uint8_t, 16>>(0);
+		!ipsFile && !memcmp(header.data(), "NES\x1A", 4))
+	{
+		digest = identifyContent(io, ContentDigestMask::CRC32 | ContentDigestMask::MD5, (header[6] & 4) ? 16 + 512 : 16);
+	}
 	auto ioStream = new EmuFileIO(io);
 	auto file = new FCEUFILE();
 	file->filename = contentFileName();
 	file->archiveIndex = -1;
 	file->stream = ioStream;
 	file->size = ioStream->size();
-	if(auto ipsFile = FileUtils::fopenUri(appContext(), userFilePath(patchesDir, ".ips"), "r");
-		ipsFile)
+	if(ipsFile)
 	{
 		ApplyIPS(ipsFile, file);
 	}
+	else if(digest.has(ContentDigestMask::CRC32 | ContentDigestMask::MD5))
+	{
+		file->contentMD5 = digest.md5.data();
+		file->contentCRC32 = &digest.crc32;
+	}
 	if(!FCEUI_LoadGameWithFile(file, contentFileName().data(), 0))
 	{
 		throw std::runtime_error("Error loading game");
@@ -406,7 +454,7 @@ void emulateSound(EmuAudio *audio)
 void NesSystem::updateVideoPixmap(EmuVideo &video, bool horizontalCrop, int lines)
 {
 	int xPixels = horizontalCrop ? 240 : 256;
-	video.setFormat({{xPixels, lines}, pixFmt});
+	video.setFormat({{xPixels, lines}, video.usePaletteFormat() ? IG::PIXEL_FMT_I8 : pixFmt});
 }
 
 void NesSystem::renderVideo(EmuSystemTaskContext taskCtx, EmuVideo &video, uint8 *buf)
@@ -418,14 +466,26 @@ void NesSystem::renderVideo(EmuSystemTaskContext taskCtx, EmuVideo &video, uint8
 	int yStart = optionStartVideoLine;
 	auto ppuPixRegion = ppuPix.subView({xStart, yStart}, pix.size());
 	assumeExpr(pix.size() == ppuPixRegion.size());
-	if(pix.format() == IG::PIXEL_RGB565)
+	if(pix.format() == IG::PIXEL_FMT_I8)
+	{
+		// colors are resolved by the renderer
+		if(std::exchange(nativeColChanged, false))
+		{
+			if(pixFmt == IG::PIXEL_RGB565)
+				video.setPalette(nativeCol.col16);
+			else
+				video.setPalette(nativeCol.col32);
+		}
+		pix.write(ppuPixRegion);
+	}
+	else if(pix.format() == IG::PIXEL_RGB565)
 	{
-		pix.writeTransformed([&](uint8 p){ return nativeCol.col16[p]; }, ppuPixRegion);
+		pix.writePaletteExpanded(nativeCol.col16, ppuPixRegion);
 	}
 	else
 	{
 		assumeExpr(pix.format().bytesPerPixel() == 4);
-		pix.writeTransformed([&](uint8 p){ return nativeCol.col32[p]; }, ppuPixRegion);
+		pix.writePaletteExpanded(nativeCol.col32, ppuPixRegion);
 	}
 	img.endFrame();
 }
@@ -473,6 +533,7 @@ void FCEUD_SetPalette(uint8 index, uint8 r, uint8 g, uint8 b)
 		auto desc = sys.pixFmt == IG::PIXEL_BGRA8888 ? IG::PIXEL_DESC_BGRA8888.nativeOrder() : IG::PIXEL_DESC_RGBA8888_NATIVE;
 		sys.nativeCol.col32[index] = desc.build(r, g, b, (uint8)0);
 	}
+	sys.nativeColChanged = true;
 	//logMsg("set palette %d %X", index, nativeCol[index]);
 }
 
@@ -73,6 +73,7 @@ public:
 		uint16_t col16[256];
 		uint32_t col32[256];
 	} nativeCol;
+	bool nativeColChanged{};
 	std::string cheatsDir;
 	std::string patchesDir;
 	std::string palettesDir;
@@ -117,8 +118,9 @@ public:
 	[[gnu::hot]] void runFrame(EmuSystemTaskContext task, EmuVideo *video, EmuAudio *audio);
 	FS::FileString stateFilename(int slot, std::string_view name) const;
 	std::string_view stateFilenameExt() const { return ".fcs"; }
-	void loadState(EmuApp &, CStringView uri);
-	void saveState(CStringView path);
+	size_t stateSize();
+	void readState(EmuApp &, std::span<const uint8_t> buff);
+	size_t writeState(std::span<uint8_t> buff, SaveStateFlags = {});
 	bool readConfig(ConfigType, MapIO &, unsigned key, size_t readSize);
 	void writeConfig(ConfigType, FileIO &);
 	void reset(EmuApp &, ResetMode mode);
@@ -147,6 +149,8 @@ public:
 	bool shouldFastForward() const;
 
 private:
+	size_t stateSize_{};
+
 	void cacheUsingZapper();
 	void setDefaultPalette(IO &io);
 };
@@ -38,6 +38,7 @@ namespace EmuEx
 {
 
 const char *EmuSystem::creditsViewStr = CREDITS_INFO_STRING "(c) 2011-2023\nRobert Broglia\nwww.explusalpha.com\n\nPortions (c) the\nMednafen Team\nmednafen.github.io";
+bool EmuSystem::hasRunAhead = true;
 bool EmuApp::needsGlobalInstance = true;
 
 EmuSystem::NameFilterFunc EmuSystem::defaultFsFilter =
@@ -67,16 +68,24 @@ FS::FileString NgpSystem::stateFilename(int slot, std::string_view name) const
 	return stateFilenameMDFN(*MDFNGameInfo, slot, name, 'a');
 }
 
-void NgpSystem::saveState(IG::CStringView path)
+// cartridge flash data is stored in states, so allow for the largest ROM
+static constexpr size_t maxStateSize = 0x400000 + 0x100000;
+
+size_t NgpSystem::stateSize() { return stateSizeMDFN(); }
+
+void NgpSystem::readState(EmuApp &, std::span<const uint8_t> buff)
+{
+	readStateMDFN(buff, maxStateSize);
+}
+
+size_t NgpSystem::writeState(std::span<uint8_t> buff, SaveStateFlags flags)
 {
-	if(!MDFNI_SaveState(path, 0, 0, 0, 0))
-		throwFileWriteError();
+	return writeStateMDFN(buff, flags);
 }
 
-void NgpSystem::loadState(EmuApp &, IG::CStringView path)
+size_t NgpSystem::compressState(std::span<const uint8_t> src, std::span<uint8_t> dest) const
 {
-	if(!MDFNI_LoadState(path, 0))
-		throwFileReadError();
+	return gzipCompress(src, dest);
 }
 
 static FS::PathString saveFilename(const EmuApp &app)
@@ -104,12 +113,14 @@ IG::Time NgpSystem::backupMemoryLastWriteTime(const EmuApp &app) const
 void NgpSystem::closeSystem()
 {
 	mdfnGameInfo.CloseGame();
+	resetStateCacheMDFN();
 }
 
 void NgpSystem::loadContent(IO &io, EmuSystemCreateParams, OnLoadProgressDelegate)
 {
 	static constexpr size_t maxRomSize = 0x400000;
-	EmuEx::loadContent(*this, mdfnGameInfo, io, maxRomSize);
+	auto digest = identifyContent(io, ContentDigestMask::MD5);
+	EmuEx::loadContent(*this, mdfnGameInfo, io, maxRomSize, &digest);
 	MDFN_IEN_NGP::SetPixelFormat(toMDFNSurface(mSurfacePix).format);
 }
 
@@ -168,7 +179,7 @@ void system_io_flash_write(uint8_t* buffer, uint32 len)
 		return;
 	auto saveStr = saveFilename(gApp());
 	logMsg("writing flash %s", saveStr.data());
-	IG::FileUtils::writeToUri(gAppContext(), saveStr, {buffer, len}) != -1;
+	gApp().saveBackupMemory(saveStr, {buffer, len});
 }
 
 }
@@ -21,6 +21,7 @@
 #include <imagine/util/format.hh>
 #include <imagine/util/string.h>
 #include <mednafen/cdrom/CDInterface.h>
+#include <mednafen/cdrom/CDAccess_CHD.h>
 #include <mednafen/state-driver.h>
 #include <mednafen/hash/md5.h>
 #include <mednafen/MemoryStream.h>
@@ -34,6 +35,7 @@ namespace EmuEx
 
 const char *EmuSystem::creditsViewStr = CREDITS_INFO_STRING "(c) 2011-2023\nRobert Broglia\nwww.explusalpha.com\n\nPortions (c) the\nMednafen Team\nmednafen.github.io";
 bool EmuSystem::hasRectangularPixels = true;
+bool EmuSystem::hasRunAhead = true;
 constexpr double masterClockFrac = 21477272.727273 / 3.;
 constexpr FloatSeconds staticFrameTimeWith262Lines{455. * 262. / masterClockFrac}; // ~60.05Hz
 constexpr FloatSeconds staticFrameTime{455. * 263. / masterClockFrac}; //~59.82Hz
@@ -99,6 +101,7 @@ FS::FileString PceSystem::stateFilename(int slot, std::string_view name) const
 void PceSystem::closeSystem()
 {
 	mdfnGameInfo.CloseGame();
+	resetStateCacheMDFN();
 	if(CDInterfaces.size())
 	{
 		assert(CDInterfaces.size() == 1);
@@ -170,7 +173,10 @@ void PceSystem::loadContent(IO &io, EmuSystemCreateParams, OnLoadProgressDelegat
 	else
 	{
 		static constexpr size_t maxRomSize = 0x300000;
-		EmuEx::loadContent(*this, mdfnGameInfo, io, maxRomSize);
+		// HuC_Load() hashes the data after any copier header for its CRC32 database & MD5 game ID
+		size_t digestOffset = io.size() & 512;
+		auto digest = identifyContent(io, ContentDigestMask::CRC32 | ContentDigestMask::MD5, digestOffset);
+		EmuEx::loadContent(*this, mdfnGameInfo, io, maxRomSize, &digest, digestOffset);
 	}
 	unloadCD.cancel();
 	//logMsg("%d input ports", MDFNGameInfo->InputInfo->InputPorts);
@@ -234,16 +240,24 @@ void PceSystem::reset(EmuApp &, ResetMode mode)
 	mdfnGameInfo.DoSimpleCommand(MDFN_MSC_RESET);
 }
 
-void PceSystem::saveState(IG::CStringView path)
+// allows for CD system RAM and the Arcade Card's 2MiB of RAM
+static constexpr size_t maxStateSize = 0x1000000;
+
+size_t PceSystem::stateSize() { return stateSizeMDFN(); }
+
+void PceSystem::readState(EmuApp &, std::span<const uint8_t> buff)
+{
+	readStateMDFN(buff, maxStateSize);
+}
+
+size_t PceSystem::writeState(std::span<uint8_t> buff, SaveStateFlags flags)
 {
-	if(!MDFNI_SaveState(path, 0, 0, 0, 0))
-		throwFileWriteError();
+	return writeStateMDFN(buff, flags);
 }
 
-void PceSystem::loadState(EmuApp &, CStringView path)
+size_t PceSystem::compressState(std::span<const uint8_t> src, std::span<uint8_t> dest) const
 {
-	if(!MDFNI_LoadState(path, 0))
-		throwFileReadError();
+	return gzipCompress(src, dest);
 }
 
 double PceSystem::videoAspectRatioScale() const
@@ -255,6 +269,15 @@ double PceSystem::videoAspectRatioScale() const
 	return correctLineAspect ? lineAspectScaler : 1.;
 }
 
+// args: <disc.chd> [sector trace files...], replays the traces against the CHD hunk cache
+std::string PceSystem::benchmarkCore(std::span<const char * const> args)
+{
+	if(args.empty())
+		return {};
+	std::vector<std::string> tracePaths{args.begin() + 1, args.end()};
+	return CDAccess_CHD::BenchmarkHunkCache(args[0], tracePaths);
+}
+
 void EmuApp::onCustomizeNavView(EmuApp::NavView &view)
 {
 	const Gfx::LGradientStopDesc navViewGrad[] =
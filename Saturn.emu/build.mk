@@ -4,6 +4,7 @@ inc_main := 1
 ccNoStrictAliasing := 1
 
 include $(IMAGINE_PATH)/make/imagineAppBase.mk
+include $(EMUFRAMEWORK_PATH)/make/mednafenCommon.mk
 
 ifeq ($(SUBARCH), armv6)
  # compile app code in ARMv7, link to ARMv6 libs so dynarec works
@@ -25,14 +26,22 @@ SRC += main/Main.cc \
 main/input.cc \
 main/options.cc \
 main/EmuMenuViews.cc \
-main/EmuControls.cc
+main/EmuControls.cc \
+main/threads.cc \
+main/MDFNCD.cc \
+mednafen-emuex/MThreading.cc \
+$(MDFN_CDROM_STANDALONE_SRC)
+
+VPATH += $(EMUFRAMEWORK_PATH)/src/shared
 
 CPPFLAGS += -I$(projectPath)/src \
 -DHAVE_SYS_TIME_H=1 \
 -DHAVE_GETTIMEOFDAY=1 \
 -DHAVE_STDINT_H=1 \
 -DVERSION=\"0.9.10\" \
--DHAVE_STRCASECMP=1
+-DHAVE_STRCASECMP=1 \
+$(MDFN_COMMON_CPPFLAGS) \
+$(MDFN_CDROM_CPPFLAGS)
 
 ifeq ($(ARCH), arm)
  ifneq ($(ENV), ios)
@@ -96,6 +105,9 @@ CPPFLAGS += -DHAVE_Q68=1
 # TODO: -DQ68_USE_JIT=1
 
 include $(EMUFRAMEWORK_PATH)/package/emuframework.mk
+include $(IMAGINE_PATH)/make/package/libvorbis.mk
+include $(IMAGINE_PATH)/make/package/flac.mk
+include $(IMAGINE_PATH)/make/package/zlib.mk
 
 include $(IMAGINE_PATH)/make/imagineAppTarget.mk
 
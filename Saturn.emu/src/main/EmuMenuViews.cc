@@ -69,6 +69,31 @@ class CustomSystemOptionView : public SystemOptionView
 		sh2CoreItem
 	};
 
+	TextMenuItem renderThreadsItem[maxRenderThreads + 1]
+	{
+		{"Auto", &defaultFace(), setRenderThreadsDel(), 0},
+		{"1",    &defaultFace(), setRenderThreadsDel(), 1},
+		{"2",    &defaultFace(), setRenderThreadsDel(), 2},
+		{"3",    &defaultFace(), setRenderThreadsDel(), 3},
+		{"4",    &defaultFace(), setRenderThreadsDel(), 4},
+	};
+
+	TextMenuItem::SelectDelegate setRenderThreadsDel()
+	{
+		return [](TextMenuItem &item)
+		{
+			optionRenderThreads = item.id();
+			setRenderThreads(optionRenderThreads);
+		};
+	}
+
+	MultiChoiceMenuItem renderThreads
+	{
+		"Renderer Threads", &defaultFace(),
+		MenuItem::Id(optionRenderThreads.val),
+		renderThreadsItem
+	};
+
 public:
 	CustomSystemOptionView(ViewAttachParams attach): SystemOptionView{attach, true}
 	{
@@ -87,6 +112,7 @@ public:
 			}
 			item.emplace_back(&sh2Core);
 		}
+		item.emplace_back(&renderThreads);
 		item.emplace_back(&bios);
 	}
 };
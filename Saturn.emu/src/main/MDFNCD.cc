@@ -0,0 +1,129 @@
+/*  This file is part of Saturn.emu.
+
+	Saturn.emu is free software: you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation, either version 3 of the License, or
+	(at your option) any later version.
+
+	Saturn.emu is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License
+	along with Saturn.emu.  If not, see <http://www.gnu.org/licenses/> */
+
+#define LOGTAG "MDFNCD"
+#include <mednafen/mednafen.h>
+#include <mednafen/cdrom/CDInterface.h>
+#include "MainSystem.hh"
+#include <imagine/logger/logger.h>
+#include <cstring>
+#include <memory>
+
+// CD interface backed by Mednafen's disc image readers, supporting CUE/TOC/CCD/CHD images
+// & content URIs. Mednafen's multi-threaded CDInterface reads sectors ahead of the
+// CD block on its own thread, so sequential reads like FMV streaming don't block
+// emulation on file access or CHD decompression.
+
+namespace Mednafen
+{
+
+bool MDFN_GetSettingB(const char *name) { return 0; }
+
+}
+
+namespace EmuEx
+{
+
+std::string mdfnCDError;
+
+}
+
+static std::unique_ptr<Mednafen::CDInterface> disc;
+static u32 discTOC[102];
+
+static void buildTOC(const Mednafen::CDUtility::TOC &toc)
+{
+	std::memset(discTOC, 0xFF, sizeof(discTOC));
+	for(int track = toc.first_track; track <= toc.last_track; track++)
+	{
+		auto &t = toc.tracks[track];
+		discTOC[track - 1] = (((t.control << 4) | t.adr) << 24) | (t.lba + 150);
+	}
+	discTOC[99] = (discTOC[toc.first_track - 1] & 0xFF000000) | (toc.first_track << 16);
+	discTOC[100] = (discTOC[toc.last_track - 1] & 0xFF000000) | (toc.last_track << 16);
+	discTOC[101] = (discTOC[toc.last_track - 1] & 0xFF000000) | (toc.tracks[100].lba + 150);
+}
+
+static int MDFNCDInit(const char *path)
+{
+	EmuEx::mdfnCDError.clear();
+	if(!path)
+		return -1;
+	try
+	{
+		disc.reset(Mednafen::CDInterface::Open(&Mednafen::NVFS, path, false, 0));
+	}
+	catch(std::exception &err)
+	{
+		logErr("error opening disc:%s", err.what());
+		EmuEx::mdfnCDError = err.what();
+		return -1;
+	}
+	Mednafen::CDUtility::TOC toc;
+	disc->ReadTOC(&toc);
+	buildTOC(toc);
+	logMsg("opened disc with %d tracks", toc.last_track - toc.first_track + 1);
+	return 0;
+}
+
+static void MDFNCDDeInit()
+{
+	disc.reset();
+}
+
+static int MDFNCDGetStatus()
+{
+	return disc ? 0 : 2;
+}
+
+static s32 MDFNCDReadTOC(u32 *TOC)
+{
+	std::memcpy(TOC, discTOC, sizeof(discTOC));
+	return sizeof(discTOC);
+}
+
+static int MDFNCDReadSectorFAD(u32 FAD, void *buffer)
+{
+	uint8_t data[2352 + 96];
+	if(!disc || (s32)FAD - 150 > Mednafen::CDInterface::LBA_Read_Maximum)
+	{
+		std::memset(buffer, 0, 2448);
+		return 0;
+	}
+	disc->ReadRawSector(data, FAD - 150);
+	std::memcpy(buffer, data, 2352);
+	// subcodes aren't generated, same as the ISO core with BIN/CUE images
+	std::memset((uint8_t*)buffer + 2352, 0, 96);
+	return 1;
+}
+
+static void MDFNCDReadAheadFAD(u32 FAD)
+{
+	// called when the CD block starts seeking, lets the read thread start buffering
+	if(disc)
+		disc->HintReadSector(FAD - 150);
+}
+
+CDInterface MDFNCD
+{
+	CDCORE_MDFN,
+	"Mednafen Virtual Drive",
+	MDFNCDInit,
+	MDFNCDDeInit,
+	MDFNCDGetStatus,
+	MDFNCDReadTOC,
+	MDFNCDReadSectorFAD,
+	MDFNCDReadAheadFAD,
+};
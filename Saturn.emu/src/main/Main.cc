@@ -53,6 +53,7 @@ CDInterface *CDCoreList[] =
 {
 	&DummyCD,
 	&ISOCD,
+	&MDFNCD,
 	nullptr
 };
 
@@ -150,7 +151,7 @@ PerPad_struct *pad[2];
 
 static bool hasCDExtension(std::string_view name)
 {
-	return IG::endsWithAnyCaseless(name, ".cue", ".iso", ".bin");
+	return IG::endsWithAnyCaseless(name, ".cue", ".iso", ".bin", ".toc", ".ccd", ".chd");
 }
 
 bool hasBIOSExtension(std::string_view name)
@@ -175,7 +176,7 @@ yabauseinit_struct yinit
 	#else
 	M68KCORE_C68K,
 	#endif
-	CDCORE_ISO,
+	CDCORE_MDFN,
 	CART_NONE,
 	REGION_AUTODETECT,
 	biosPath.data(),
@@ -267,12 +268,13 @@ void SaturnSystem::loadState(EmuApp &, IG::CStringView path)
 		throwFileReadError();
 }
 
-void SaturnSystem::onFlushBackupMemory(EmuApp &, BackupMemoryDirtyFlags)
+void SaturnSystem::onFlushBackupMemory(EmuApp &app, BackupMemoryDirtyFlags)
 {
 	if(hasContent())
 	{
 		logMsg("saving backup memory");
-		T123Save(BupRam, 0x10000, 1, bupPath.data());
+		// same layout T123Save() writes for type 1 (byte) memory
+		app.saveBackupMemory(bupPath, {BupRam, 0x10000});
 	}
 }
 
@@ -293,7 +295,7 @@ void SaturnSystem::loadContent(IO &, EmuSystemCreateParams, OnLoadProgressDelega
 	if(YabauseInit(&yinit) != 0)
 	{
 		logErr("YabauseInit failed");
-		throw std::runtime_error("Error loading game");
+		throw std::runtime_error(mdfnCDError.size() ? mdfnCDError : "Error loading game");
 	}
 	logMsg("YabauseInit done");
 	yabauseIsInit = 1;
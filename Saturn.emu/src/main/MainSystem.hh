@@ -8,6 +8,7 @@ extern "C"
 	#include <yabause/yabause.h>
 	#include <yabause/sh2core.h>
 	#include <yabause/peripheral.h>
+	#include <yabause/cdbase.h>
 }
 
 namespace EmuEx::Controls
@@ -18,14 +19,20 @@ static const unsigned gamepadKeys = 23;
 extern const int defaultSH2CoreID;
 extern SH2Interface_struct *SH2CoreList[];
 
+#define CDCORE_MDFN 3
+extern CDInterface MDFNCD;
+
 namespace EmuEx
 {
 
 extern Byte1Option optionSH2Core;
+extern Byte1Option optionRenderThreads;
 extern FS::PathString biosPath;
 extern unsigned SH2Cores;
+constexpr uint8_t maxRenderThreads = 4;
 extern yabauseinit_struct yinit;
 extern PerPad_struct *pad[2];
+extern std::string mdfnCDError;
 
 class SaturnSystem final: public EmuSystem
 {
@@ -63,5 +70,6 @@ public:
 using MainSystem = SaturnSystem;
 
 bool hasBIOSExtension(std::string_view name);
+void setRenderThreads(uint8_t threads);
 
 }
@@ -15,10 +15,13 @@
 
 #include <emuframework/EmuApp.hh>
 #include "MainSystem.hh"
+#include <algorithm>
+#include <thread>
 
 extern "C"
 {
 	#include <yabause/sh2int.h>
+	#include <yabause/vidsoft.h>
 }
 
 SH2Interface_struct *SH2CoreList[]
@@ -36,7 +39,8 @@ namespace EmuEx
 
 enum
 {
-	CFGKEY_BIOS_PATH = 279, CFGKEY_SH2_CORE = 280
+	CFGKEY_BIOS_PATH = 279, CFGKEY_SH2_CORE = 280,
+	CFGKEY_RENDER_THREADS = 281
 };
 
 static bool OptionSH2CoreIsValid(uint8_t val)
@@ -55,6 +59,7 @@ static bool OptionSH2CoreIsValid(uint8_t val)
 
 const char *EmuSystem::configFilename = "SaturnEmu.config";
 Byte1Option optionSH2Core{CFGKEY_SH2_CORE, (uint8_t)defaultSH2CoreID, false, OptionSH2CoreIsValid};
+Byte1Option optionRenderThreads{CFGKEY_RENDER_THREADS, 0, false, optionIsValidWithMax<maxRenderThreads>};
 unsigned SH2Cores = std::size(SH2CoreList) - 1;
 bool EmuApp::hasIcon = false;
 bool EmuSystem::hasSound = !(Config::envIsAndroid || Config::envIsIOS);
@@ -70,9 +75,19 @@ std::span<const AspectRatioInfo> SaturnSystem::aspectRatioInfos()
 	return aspectRatioInfo;
 }
 
+void setRenderThreads(uint8_t threads)
+{
+	// 0 picks one thread per core, the VDP1 thread only runs when there's more than 1
+	unsigned num = threads ? threads : std::clamp(std::thread::hardware_concurrency(), 1u, unsigned(maxRenderThreads));
+	logMsg("using %u render threads", num);
+	VIDSoftSetNumLayerThreads(num);
+	VIDSoftSetVdp1ThreadEnable(num > 1);
+}
+
 void SaturnSystem::onOptionsLoaded()
 {
 	yinit.sh2coretype = optionSH2Core;
+	setRenderThreads(optionRenderThreads);
 }
 
 bool SaturnSystem::readConfig(ConfigType type, MapIO &io, unsigned key, size_t readSize)
@@ -84,6 +99,7 @@ bool SaturnSystem::readConfig(ConfigType type, MapIO &io, unsigned key, size_t r
 			case CFGKEY_BIOS_PATH:
 				return readStringOptionValue(io, readSize, biosPath);
 			case CFGKEY_SH2_CORE: return optionSH2Core.readFromIO(io, readSize);
+			case CFGKEY_RENDER_THREADS: return optionRenderThreads.readFromIO(io, readSize);
 		}
 	}
 	return false;
@@ -95,6 +111,7 @@ void SaturnSystem::writeConfig(ConfigType type, FileIO &io)
 	{
 		writeStringOptionValue(io, CFGKEY_BIOS_PATH, biosPath);
 		optionSH2Core.writeWithKeyIfNotDefault(io);
+		optionRenderThreads.writeWithKeyIfNotDefault(io);
 	}
 }
 
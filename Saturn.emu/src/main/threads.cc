@@ -0,0 +1,128 @@
+/*  This file is part of Saturn.emu.
+
+	Saturn.emu is free software: you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation, either version 3 of the License, or
+	(at your option) any later version.
+
+	Saturn.emu is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License
+	along with Saturn.emu.  If not, see <http://www.gnu.org/licenses/> */
+
+#define LOGTAG "threads"
+#include <imagine/logger/logger.h>
+#include <array>
+#include <condition_variable>
+#include <mutex>
+#include <semaphore>
+#include <thread>
+
+extern "C"
+{
+	#include <yabause/threads.h>
+}
+
+struct YabSem_struct : public std::counting_semaphore<>
+{
+	using counting_semaphore::counting_semaphore;
+};
+
+struct YabThread
+{
+	std::thread thread;
+	std::mutex mutex;
+	std::condition_variable cond;
+	bool woken{};
+
+	~YabThread()
+	{
+		// threads still running at exit are blocked waiting for work
+		if(thread.joinable())
+			thread.detach();
+	}
+};
+
+static std::array<YabThread, YAB_NUM_THREADS> threads;
+static thread_local YabThread *thisThread{};
+
+int YabThreadStart(unsigned int id, void (*func)(void *), void *arg)
+{
+	if(id >= YAB_NUM_THREADS)
+		return -1;
+	auto &t = threads[id];
+	if(t.thread.joinable())
+	{
+		logErr("thread id:%u already started", id);
+		return -1;
+	}
+	t.thread = std::thread
+	{
+		[&t, func, arg]()
+		{
+			thisThread = &t;
+			func(arg);
+		}
+	};
+	return 0;
+}
+
+void YabThreadWait(unsigned int id)
+{
+	if(id >= YAB_NUM_THREADS)
+		return;
+	auto &t = threads[id];
+	if(t.thread.joinable())
+		t.thread.join();
+}
+
+void YabThreadYield(void)
+{
+	std::this_thread::yield();
+}
+
+void YabThreadSleep(void)
+{
+	if(!thisThread)
+		return;
+	std::unique_lock lock{thisThread->mutex};
+	thisThread->cond.wait(lock, []{ return thisThread->woken; });
+	thisThread->woken = false;
+}
+
+void YabThreadRemoteSleep(unsigned int) {}
+
+void YabThreadWake(unsigned int id)
+{
+	if(id >= YAB_NUM_THREADS)
+		return;
+	auto &t = threads[id];
+	{
+		std::scoped_lock lock{t.mutex};
+		t.woken = true;
+	}
+	t.cond.notify_one();
+}
+
+YabSem *YabThreadCreateSem(int val)
+{
+	return new YabSem{val};
+}
+
+void YabSemPost(YabSem *sem)
+{
+	sem->release();
+}
+
+void YabSemWait(YabSem *sem)
+{
+	sem->acquire();
+}
+
+void YabThreadFreeSem(YabSem *sem)
+{
+	delete sem;
+}
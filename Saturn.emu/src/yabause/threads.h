@@ -33,6 +33,10 @@ enum {
    YAB_THREAD_NETLINKLISTENER,
    YAB_THREAD_NETLINKCONNECT,
    YAB_THREAD_NETLINKCLIENT,
+   YAB_THREAD_VIDSOFT_VDP1,     // Software renderer VDP1 command list
+   YAB_THREAD_VIDSOFT_BAND1,    // Software renderer VDP2 line bands (band 0
+   YAB_THREAD_VIDSOFT_BAND2,    // always runs on the emulation thread)
+   YAB_THREAD_VIDSOFT_BAND3,
    YAB_NUM_THREADS      // Total number of subthreads
 };
 
@@ -65,6 +69,22 @@ void YabThreadRemoteSleep(unsigned int id);
 // YabThreadWake:  Wake up the given thread if it is asleep.
 void YabThreadWake(unsigned int id);
 
+// YabSem:  Counting semaphore, may be posted and waited on from any thread.
+typedef struct YabSem_struct YabSem;
+
+// YabThreadCreateSem:  Create a semaphore with the given initial count.
+// Returns NULL on error.
+YabSem * YabThreadCreateSem(int val);
+
+// YabSemPost:  Increment the semaphore, waking one waiting thread.
+void YabSemPost(YabSem * sem);
+
+// YabSemWait:  Wait until the semaphore count is non-zero, then decrement it.
+void YabSemWait(YabSem * sem);
+
+// YabThreadFreeSem:  Destroy a semaphore, no thread may be waiting on it.
+void YabThreadFreeSem(YabSem * sem);
+
 ///////////////////////////////////////////////////////////////////////////
 
 #endif  // THREADS_H
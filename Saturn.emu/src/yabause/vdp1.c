@@ -75,8 +75,17 @@ void FASTCALL Vdp1RamWriteLong(u32 addr, u32 val) {
 
 //////////////////////////////////////////////////////////////////////////////
 
+static INLINE void Vdp1SyncFrameBuffer(void) {
+   // the video core may still be drawing on another thread
+   if (VIDCore && VIDCore->Vdp1Sync)
+      VIDCore->Vdp1Sync();
+}
+
+//////////////////////////////////////////////////////////////////////////////
+
 u8 FASTCALL Vdp1FrameBufferReadByte(u32 addr) {
    addr &= 0x3FFFF;
+   Vdp1SyncFrameBuffer();
    return T1ReadByte(Vdp1FrameBuffer, addr);
 }
 
@@ -84,6 +93,7 @@ u8 FASTCALL Vdp1FrameBufferReadByte(u32 addr) {
 
 u16 FASTCALL Vdp1FrameBufferReadWord(u32 addr) {
    addr &= 0x3FFFF;
+   Vdp1SyncFrameBuffer();
    return T1ReadWord(Vdp1FrameBuffer, addr);
 }
 
@@ -91,6 +101,7 @@ u16 FASTCALL Vdp1FrameBufferReadWord(u32 addr) {
 
 u32 FASTCALL Vdp1FrameBufferReadLong(u32 addr) {
    addr &= 0x3FFFF;
+   Vdp1SyncFrameBuffer();
    return T1ReadLong(Vdp1FrameBuffer, addr);
 }
 
@@ -98,6 +109,7 @@ u32 FASTCALL Vdp1FrameBufferReadLong(u32 addr) {
 
 void FASTCALL Vdp1FrameBufferWriteByte(u32 addr, u8 val) {
    addr &= 0x3FFFF;
+   Vdp1SyncFrameBuffer();
    T1WriteByte(Vdp1FrameBuffer, addr, val);
 }
 
@@ -105,6 +117,7 @@ void FASTCALL Vdp1FrameBufferWriteByte(u32 addr, u8 val) {
 
 void FASTCALL Vdp1FrameBufferWriteWord(u32 addr, u16 val) {
    addr &= 0x3FFFF;
+   Vdp1SyncFrameBuffer();
    T1WriteWord(Vdp1FrameBuffer, addr, val);
 }
 
@@ -112,6 +125,7 @@ void FASTCALL Vdp1FrameBufferWriteWord(u32 addr, u16 val) {
 
 void FASTCALL Vdp1FrameBufferWriteLong(u32 addr, u32 val) {
    addr &= 0x3FFFF;
+   Vdp1SyncFrameBuffer();
    T1WriteLong(Vdp1FrameBuffer, addr, val);
 }
 
@@ -53,6 +53,8 @@ typedef struct
    void (*Vdp2DrawEnd)(void);
    void (*Vdp2DrawScreens)(void);
    void (*GetGlSize)(int *width, int *height);
+   // Optional, finishes any VDP1 drawing still in progress
+   void (*Vdp1Sync)(void);
 } VideoInterface_struct;
 
 extern VideoInterface_struct *VIDCore;
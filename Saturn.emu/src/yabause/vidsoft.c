@@ -24,6 +24,7 @@
 #include "vidshared.h"
 #include "debug.h"
 #include "vdp2.h"
+#include "threads.h"
 #include "titan/titan.h"
 
 #ifdef HAVE_LIBGL
@@ -37,6 +38,7 @@
 #include "yui.h"
 
 #include <stdlib.h>
+#include <string.h>
 #include <limits.h>
 
 #if defined(__APPLE__)
@@ -104,6 +106,7 @@ void FASTCALL VIDSoftVdp2SetPriorityRBG0(int priority);
 void VIDSoftGetGlSize(int *width, int *height);
 void VIDSoftVdp1SwapFrameBuffer(void);
 void VIDSoftVdp1EraseFrameBuffer(void);
+void VIDSoftVdp1Sync(void);
 
 VideoInterface_struct VIDSoft = {
 VIDCORE_SOFT,
@@ -133,6 +136,7 @@ VIDSoftVdp2DrawStart,
 VIDSoftVdp2DrawEnd,
 VIDSoftVdp2DrawScreens,
 VIDSoftGetGlSize,
+VIDSoftVdp1Sync,
 };
 
 pixel_t *dispbuffer=NULL;
@@ -148,7 +152,11 @@ static int vdp1clipxend;
 static int vdp1clipystart;
 static int vdp1clipyend;
 static int vdp1pixelsize;
-static int vdp1spritetype;
+// VDP1 state read by the rasteriser, either the live RAM and registers or the
+// copies owned by the VDP1 thread
+static u8 *vdp1ram;
+static Vdp1 *vdp1regs;
+static u16 vdp1spctl;
 int vdp2width;
 int vdp2height;
 static int nbg0priority=0;
@@ -163,6 +171,8 @@ static int outputheight;
 static int resxratio;
 static int resyratio;
 
+static int mosaic_table[16][1024];
+
 typedef struct { s16 x; s16 y; } vdp1vertex;
 
 typedef struct
@@ -642,9 +652,10 @@ static u8 FASTCALL GetAlpha(vdp2draw_struct * info, u32 color)
 
 //////////////////////////////////////////////////////////////////////////////
 
-static void FASTCALL Vdp2DrawScroll(vdp2draw_struct *info)
+static void FASTCALL Vdp2DrawScroll(vdp2draw_struct *info, int linestart, int lineend)
 {
    int i, j;
+   int drawwidth;
    int x, y;
    clipping_struct clip[2];
    u32 linewnd0addr, linewnd1addr;
@@ -667,24 +678,12 @@ static void FASTCALL Vdp2DrawScroll(vdp2draw_struct *info)
    ReadLineWindowData(&info->islinewindow, info->wctl, &linewnd0addr, &linewnd1addr);
    /* color calculation window: in => no color calc, out => color calc */
    ReadWindowData(Vdp2Regs->WCTLD >> 8, colorcalcwindow);
-   {
-	   static int tables_initialized = 0;
-	   static int mosaic_table[16][1024];
-	   if(!tables_initialized)
-	   {
-		   tables_initialized = 1;
-			for(i=0;i<16;i++)
-			{
-				int m = i+1;
-				for(j=0;j<1024;j++)
-					mosaic_table[i][j] = j/m*m;
-			}
-	   }
-	   mosaic_x = mosaic_table[info->mosaicxmask-1];
-	   mosaic_y = mosaic_table[info->mosaicymask-1];
-   }
+   mosaic_x = mosaic_table[info->mosaicxmask-1];
+   mosaic_y = mosaic_table[info->mosaicymask-1];
 
-   for (j = 0; j < vdp2height; j++)
+   // Per line state is advanced from the top of the screen, only lines in
+   // [linestart, lineend) are drawn
+   for (j = 0; j < lineend; j++)
    {
       int Y;
       int linescrollx = 0;
@@ -735,7 +734,8 @@ static void FASTCALL Vdp2DrawScroll(vdp2draw_struct *info)
 
       info->LoadLineParams(info, j);
 
-      for (i = 0; i < vdp2width; i++)
+      drawwidth = j < linestart ? 0 : vdp2width;
+      for (i = 0; i < drawwidth; i++)
       {
          u32 color;
          /* I'm really not sure about this... but I think the way we handle
@@ -794,9 +794,10 @@ static void FASTCALL Vdp2DrawScroll(vdp2draw_struct *info)
 
 //////////////////////////////////////////////////////////////////////////////
 
-static void FASTCALL Vdp2DrawRotationFP(vdp2draw_struct *info, vdp2rotationparameterfp_struct *parameter)
+static void FASTCALL Vdp2DrawRotationFP(vdp2draw_struct *info, vdp2rotationparameterfp_struct *parameter, int linestart, int lineend)
 {
    int i, j;
+   int drawwidth;
    int x, y;
    screeninfo_struct sinfo;
    vdp2rotationparameterfp_struct *p=&parameter[info->rotatenum];
@@ -833,12 +834,13 @@ static void FASTCALL Vdp2DrawRotationFP(vdp2draw_struct *info, vdp2rotationparam
 
          SetupScreenVars(info, &sinfo, info->PlaneAddr);
 
-         for (j = 0; j < vdp2height; j++)
+         for (j = 0; j < lineend; j++)
          {
             info->LoadLineParams(info, j);
             ReadLineWindowClip(info->islinewindow, clip, &linewnd0addr, &linewnd1addr);
 
-            for (i = 0; i < vdp2width; i++)
+            drawwidth = j < linestart ? 0 : vdp2width;
+            for (i = 0; i < drawwidth; i++)
             {
                u32 color;
 
@@ -934,7 +936,7 @@ static void FASTCALL Vdp2DrawRotationFP(vdp2draw_struct *info, vdp2rotationparam
          lineInc = Vdp2Regs->LCTA.part.U & 0x8000 ? 2 : 0;
       }
 
-      for (j = 0; j < vdp2height; j++)
+      for (j = 0; j < lineend; j++)
       {
          if (p->deltaKAx == 0)
          {
@@ -956,7 +958,8 @@ static void FASTCALL Vdp2DrawRotationFP(vdp2draw_struct *info, vdp2rotationparam
             lineColorAddr = (T1ReadWord(Vdp2Ram, lineAddr) & 0x780) | p->linescreen;
             lineColor = Vdp2ColorRamGetColor(lineColorAddr);
             lineAddr += lineInc;
-            TitanPutLineHLine(info->linescreen, j, COLSAT2YAB32(0x3F, lineColor));
+            if (j >= linestart)
+               TitanPutLineHLine(info->linescreen, j, COLSAT2YAB32(0x3F, lineColor));
          }
 
          info->LoadLineParams(info, j);
@@ -965,7 +968,8 @@ static void FASTCALL Vdp2DrawRotationFP(vdp2draw_struct *info, vdp2rotationparam
          if (userpwindow)
             ReadLineWindowClip(isrplinewindow, rpwindow, &rplinewnd0addr, &rplinewnd1addr);
 
-         for (i = 0; i < vdp2width; i++)
+         drawwidth = j < linestart ? 0 : vdp2width;
+         for (i = 0; i < drawwidth; i++)
          {
             u32 color;
 
@@ -1084,7 +1088,7 @@ static void FASTCALL Vdp2DrawRotationFP(vdp2draw_struct *info, vdp2rotationparam
       return;
    }
 
-   Vdp2DrawScroll(info);
+   Vdp2DrawScroll(info, linestart, lineend);
 }
 
 //////////////////////////////////////////////////////////////////////////////
@@ -1187,7 +1191,7 @@ static void LoadLineParamsNBG0(vdp2draw_struct * info, int line)
 
 //////////////////////////////////////////////////////////////////////////////
 
-static void Vdp2DrawNBG0(void)
+static void Vdp2DrawNBG0(int linestart, int lineend)
 {
    vdp2draw_struct info;
    vdp2rotationparameterfp_struct parameter[2];
@@ -1312,12 +1316,12 @@ static void Vdp2DrawNBG0(void)
    if (info.enable == 1)
    {
       // NBG0 draw
-      Vdp2DrawScroll(&info);
+      Vdp2DrawScroll(&info, linestart, lineend);
    }
    else
    {
       // RBG1 draw
-      Vdp2DrawRotationFP(&info, parameter);
+      Vdp2DrawRotationFP(&info, parameter, linestart, lineend);
    }
 }
 
@@ -1335,7 +1339,7 @@ static void LoadLineParamsNBG1(vdp2draw_struct * info, int line)
 
 //////////////////////////////////////////////////////////////////////////////
 
-static void Vdp2DrawNBG1(void)
+static void Vdp2DrawNBG1(int linestart, int lineend)
 {
    vdp2draw_struct info;
 
@@ -1419,7 +1423,7 @@ static void Vdp2DrawNBG1(void)
 
    info.LoadLineParams = (void (*)(void *, int)) LoadLineParamsNBG1;
 
-   Vdp2DrawScroll(&info);
+   Vdp2DrawScroll(&info, linestart, lineend);
 }
 
 //////////////////////////////////////////////////////////////////////////////
@@ -1436,7 +1440,7 @@ static void LoadLineParamsNBG2(vdp2draw_struct * info, int line)
 
 //////////////////////////////////////////////////////////////////////////////
 
-static void Vdp2DrawNBG2(void)
+static void Vdp2DrawNBG2(int linestart, int lineend)
 {
    vdp2draw_struct info;
 
@@ -1486,7 +1490,7 @@ static void Vdp2DrawNBG2(void)
 
    info.LoadLineParams = (void (*)(void *, int)) LoadLineParamsNBG2;
 
-   Vdp2DrawScroll(&info);
+   Vdp2DrawScroll(&info, linestart, lineend);
 }
 
 //////////////////////////////////////////////////////////////////////////////
@@ -1503,7 +1507,7 @@ static void LoadLineParamsNBG3(vdp2draw_struct * info, int line)
 
 //////////////////////////////////////////////////////////////////////////////
 
-static void Vdp2DrawNBG3(void)
+static void Vdp2DrawNBG3(int linestart, int lineend)
 {
    vdp2draw_struct info;
 
@@ -1555,7 +1559,7 @@ static void Vdp2DrawNBG3(void)
 
    info.LoadLineParams = (void (*)(void *, int)) LoadLineParamsNBG3;
 
-   Vdp2DrawScroll(&info);
+   Vdp2DrawScroll(&info, linestart, lineend);
 }
 
 //////////////////////////////////////////////////////////////////////////////
@@ -1572,7 +1576,7 @@ static void LoadLineParamsRBG0(vdp2draw_struct * info, int line)
 
 //////////////////////////////////////////////////////////////////////////////
 
-static void Vdp2DrawRBG0(void)
+static void Vdp2DrawRBG0(int linestart, int lineend)
 {
    vdp2draw_struct info;
    vdp2rotationparameterfp_struct parameter[2];
@@ -1676,7 +1680,7 @@ static void Vdp2DrawRBG0(void)
 
    info.LoadLineParams = (void (*)(void *, int)) LoadLineParamsRBG0;
 
-   Vdp2DrawRotationFP(&info, parameter);
+   Vdp2DrawRotationFP(&info, parameter, linestart, lineend);
 }
 
 //////////////////////////////////////////////////////////////////////////////
@@ -1692,8 +1696,273 @@ static void LoadLineParamsSprite(vdp2draw_struct * info, int line)
 
 //////////////////////////////////////////////////////////////////////////////
 
+//////////////////////////////////////////////////////////////////////////////
+// Render threads
+//
+// VDP2 screens are drawn in horizontal line bands, one per thread. Screens
+// sharing a priority blend into the same Titan buffer so they're always drawn
+// in priority order, but once the per line table reads are done each line only
+// depends on itself. Band 0 is drawn on the emulation thread.
+//
+// VDP1 command lists are recorded while the VDP1 core walks them and then
+// rasterised on their own thread from a copy of VDP1 RAM, overlapping with SH2
+// execution until the frame buffers are swapped at VBlank IN or the SH2
+// accesses the frame buffer. Lists longer than VIDSOFT_MAX_VDP1_COMMANDS are
+// drawn in batches.
+//////////////////////////////////////////////////////////////////////////////
+
+#define VIDSOFT_MAX_BANDS 4
+#define VIDSOFT_MAX_VDP1_COMMANDS 2048
+
+typedef struct
+{
+   YabSem *start;
+   YabSem *done;
+   int linestart;
+   int lineend;
+} vdp2band_struct;
+
+typedef struct
+{
+   void (*func)(void);
+   u32 addr;
+} vdp1command_struct;
+
+static int vidsoftnumbands = 1;
+static int vidsoftvdp1thread = 0;
+static int vidsoftinitialized = 0;
+
+static vdp2band_struct vdp2bands[VIDSOFT_MAX_BANDS];
+static int vdp2numbands = 1;
+static int vdp2bandquit;
+static void (*vdp2bandfunc)(int linestart, int lineend);
+
+static struct
+{
+   YabSem *start;
+   YabSem *done;
+   int started;
+   int running;
+   int recording;
+   int quit;
+   int numcommands;
+   vdp1command_struct commands[VIDSOFT_MAX_VDP1_COMMANDS];
+   Vdp1 regs;
+   u8 *ram;
+} vdp1job;
+
+static void Vdp2BandThread(void *arg)
+{
+   vdp2band_struct *band = (vdp2band_struct *)arg;
+
+   for (;;)
+   {
+      YabSemWait(band->start);
+      if (vdp2bandquit)
+         break;
+      vdp2bandfunc(band->linestart, band->lineend);
+      YabSemPost(band->done);
+   }
+}
+
+//////////////////////////////////////////////////////////////////////////////
+
+static void Vdp2RunBands(void (*func)(int linestart, int lineend))
+{
+   int i;
+   int bandheight;
+
+   if (vdp2numbands == 1)
+   {
+      func(0, vdp2height);
+      return;
+   }
+
+   bandheight = (vdp2height + vdp2numbands - 1) / vdp2numbands;
+   vdp2bandfunc = func;
+   for (i = 1; i < vdp2numbands; i++)
+   {
+      vdp2bands[i].linestart = i * bandheight;
+      vdp2bands[i].lineend = (i == vdp2numbands - 1) ? vdp2height : (i + 1) * bandheight;
+      if (vdp2bands[i].linestart > vdp2height)
+         vdp2bands[i].linestart = vdp2height;
+      if (vdp2bands[i].lineend > vdp2height)
+         vdp2bands[i].lineend = vdp2height;
+      YabSemPost(vdp2bands[i].start);
+   }
+
+   func(0, bandheight);
+
+   for (i = 1; i < vdp2numbands; i++)
+      YabSemWait(vdp2bands[i].done);
+}
+
+//////////////////////////////////////////////////////////////////////////////
+
+static void Vdp1JobThread(UNUSED void *arg)
+{
+   int i;
+
+   for (;;)
+   {
+      YabSemWait(vdp1job.start);
+      if (vdp1job.quit)
+         break;
+      for (i = 0; i < vdp1job.numcommands; i++)
+      {
+         vdp1job.regs.addr = vdp1job.commands[i].addr;
+         vdp1job.commands[i].func();
+      }
+      YabSemPost(vdp1job.done);
+   }
+}
+
+//////////////////////////////////////////////////////////////////////////////
+
+static void Vdp1WaitJob(void)
+{
+   if (!vdp1job.running)
+      return;
+   YabSemWait(vdp1job.done);
+   vdp1job.running = 0;
+}
+
+//////////////////////////////////////////////////////////////////////////////
+
+static void Vdp1StartJob(void)
+{
+   memcpy(vdp1job.ram, Vdp1Ram, 0x80000);
+   vdp1job.running = 1;
+   YabSemPost(vdp1job.start);
+}
+
+//////////////////////////////////////////////////////////////////////////////
+
+static void Vdp1RunCommand(void (*func)(void))
+{
+   if (!vdp1job.recording)
+   {
+      func();
+      return;
+   }
+
+   if (vdp1job.numcommands == VIDSOFT_MAX_VDP1_COMMANDS)
+   {
+      // List is full, draw what's been recorded so far before continuing
+      Vdp1StartJob();
+      Vdp1WaitJob();
+      vdp1job.numcommands = 0;
+   }
+   vdp1job.commands[vdp1job.numcommands].func = func;
+   vdp1job.commands[vdp1job.numcommands].addr = Vdp1Regs->addr;
+   vdp1job.numcommands++;
+}
+
+//////////////////////////////////////////////////////////////////////////////
+
+static void StopRenderThreads(void)
+{
+   int i;
+
+   Vdp1WaitJob();
+   vdp1job.recording = 0;
+   if (vdp1job.started)
+   {
+      vdp1job.quit = 1;
+      YabSemPost(vdp1job.start);
+      YabThreadWait(YAB_THREAD_VIDSOFT_VDP1);
+      vdp1job.quit = 0;
+      vdp1job.started = 0;
+   }
+   if (vdp1job.start)
+      YabThreadFreeSem(vdp1job.start);
+   if (vdp1job.done)
+      YabThreadFreeSem(vdp1job.done);
+   free(vdp1job.ram);
+   vdp1job.start = vdp1job.done = NULL;
+   vdp1job.ram = NULL;
+
+   vdp2bandquit = 1;
+   for (i = 1; i < vdp2numbands; i++)
+   {
+      YabSemPost(vdp2bands[i].start);
+      YabThreadWait(YAB_THREAD_VIDSOFT_BAND1 + i - 1);
+   }
+   vdp2bandquit = 0;
+   for (i = 1; i < VIDSOFT_MAX_BANDS; i++)
+   {
+      if (vdp2bands[i].start)
+         YabThreadFreeSem(vdp2bands[i].start);
+      if (vdp2bands[i].done)
+         YabThreadFreeSem(vdp2bands[i].done);
+      vdp2bands[i].start = vdp2bands[i].done = NULL;
+   }
+   vdp2numbands = 1;
+}
+
+//////////////////////////////////////////////////////////////////////////////
+
+static void StartRenderThreads(void)
+{
+   int i;
+
+   for (i = 1; i < vidsoftnumbands; i++)
+   {
+      if ((vdp2bands[i].start = YabThreadCreateSem(0)) == NULL ||
+         (vdp2bands[i].done = YabThreadCreateSem(0)) == NULL ||
+         YabThreadStart(YAB_THREAD_VIDSOFT_BAND1 + i - 1, Vdp2BandThread, &vdp2bands[i]) < 0)
+         break;
+      vdp2numbands = i + 1;
+   }
+
+   if (!vidsoftvdp1thread)
+      return;
+   if ((vdp1job.ram = (u8 *)malloc(0x80000)) == NULL ||
+      (vdp1job.start = YabThreadCreateSem(0)) == NULL ||
+      (vdp1job.done = YabThreadCreateSem(0)) == NULL ||
+      YabThreadStart(YAB_THREAD_VIDSOFT_VDP1, Vdp1JobThread, NULL) < 0)
+      return;
+   vdp1job.started = 1;
+}
+
+//////////////////////////////////////////////////////////////////////////////
+
+void VIDSoftSetNumLayerThreads(int num)
+{
+   if (num < 1)
+      num = 1;
+   if (num > VIDSOFT_MAX_BANDS)
+      num = VIDSOFT_MAX_BANDS;
+   if (num == vidsoftnumbands)
+      return;
+   vidsoftnumbands = num;
+   if (vidsoftinitialized)
+   {
+      StopRenderThreads();
+      StartRenderThreads();
+   }
+}
+
+//////////////////////////////////////////////////////////////////////////////
+
+void VIDSoftSetVdp1ThreadEnable(int enable)
+{
+   if (!enable == !vidsoftvdp1thread)
+      return;
+   vidsoftvdp1thread = enable;
+   if (vidsoftinitialized)
+   {
+      StopRenderThreads();
+      StartRenderThreads();
+   }
+}
+
+//////////////////////////////////////////////////////////////////////////////
+
 int VIDSoftInit(void)
 {
+   int i, j;
+
    if (TitanInit() == -1)
       return -1;
 
@@ -1713,6 +1982,16 @@ int VIDSoftInit(void)
    vdp2width = 320;
    vdp2height = 224;
 
+   for (i = 0; i < 16; i++)
+   {
+      int m = i + 1;
+      for (j = 0; j < 1024; j++)
+         mosaic_table[i][j] = j / m * m;
+   }
+
+   StartRenderThreads();
+   vidsoftinitialized = 1;
+
 #ifdef USE_OPENGL
    glClear(GL_COLOR_BUFFER_BIT);
 
@@ -1734,6 +2013,9 @@ int VIDSoftInit(void)
 
 void VIDSoftDeInit(void)
 {
+   StopRenderThreads();
+   vidsoftinitialized = 0;
+
    if (dispbuffer)
    {
       free(dispbuffer);
@@ -1782,6 +2064,11 @@ int VIDSoftIsFullscreen(void) {
 
 int VIDSoftVdp1Reset(void)
 {
+   Vdp1WaitJob();
+   vdp1job.recording = 0;
+   vdp1ram = Vdp1Ram;
+   vdp1regs = Vdp1Regs;
+
    vdp1clipxstart = 0;
    vdp1clipxend = 512;
    vdp1clipystart = 0;
@@ -1794,6 +2081,8 @@ int VIDSoftVdp1Reset(void)
 
 void VIDSoftVdp1DrawStart(void)
 {
+   Vdp1WaitJob();
+
    if (Vdp1Regs->FBCR & 8)
       vdp1interlace = 2;
    else
@@ -1829,19 +2118,49 @@ void VIDSoftVdp1DrawStart(void)
    vdp1clipystart = Vdp1Regs->userclipY1 = Vdp1Regs->systemclipY1 = 0;
    vdp1clipxend = Vdp1Regs->userclipX2 = Vdp1Regs->systemclipX2 = vdp1width;
    vdp1clipyend = Vdp1Regs->userclipY2 = Vdp1Regs->systemclipY2 = vdp1height;
+
+   // No SH2 code runs until VIDSoftVdp1DrawEnd() so the registers can be
+   // copied here and VDP1 RAM there
+   vdp1spctl = Vdp2Regs->SPCTL;
+   if (vdp1job.started)
+   {
+      vdp1job.regs = *Vdp1Regs;
+      vdp1job.numcommands = 0;
+      vdp1job.recording = 1;
+      vdp1ram = vdp1job.ram;
+      vdp1regs = &vdp1job.regs;
+   }
+   else
+   {
+      vdp1ram = Vdp1Ram;
+      vdp1regs = Vdp1Regs;
+   }
 }
 
 //////////////////////////////////////////////////////////////////////////////
 
 void VIDSoftVdp1DrawEnd(void)
 {
+   if (!vdp1job.recording)
+      return;
+   vdp1job.recording = 0;
+   if (!vdp1job.numcommands)
+      return;
+   Vdp1StartJob();
+}
+
+//////////////////////////////////////////////////////////////////////////////
+
+void VIDSoftVdp1Sync(void)
+{
+   Vdp1WaitJob();
 }
 
 //////////////////////////////////////////////////////////////////////////////
 
 static INLINE u16  Vdp1ReadPattern16( u32 base, u32 offset ) {
 
-  u16 dot = T1ReadByte(Vdp1Ram, ( base + (offset>>1)) & 0x7FFFF);
+  u16 dot = T1ReadByte(vdp1ram, ( base + (offset>>1)) & 0x7FFFF);
   if ((offset & 0x1) == 0) dot >>= 4; // Even pixel
   else dot &= 0xF; // Odd pixel
   return dot;
@@ -1849,22 +2168,40 @@ static INLINE u16  Vdp1ReadPattern16( u32 base, u32 offset ) {
 
 static INLINE u16  Vdp1ReadPattern64( u32 base, u32 offset ) {
 
-  return T1ReadByte(Vdp1Ram, ( base + offset ) & 0x7FFFF) & 0x3F;
+  return T1ReadByte(vdp1ram, ( base + offset ) & 0x7FFFF) & 0x3F;
 }
 
 static INLINE u16  Vdp1ReadPattern128( u32 base, u32 offset ) {
 
-  return T1ReadByte(Vdp1Ram, ( base + offset ) & 0x7FFFF) & 0x7F;
+  return T1ReadByte(vdp1ram, ( base + offset ) & 0x7FFFF) & 0x7F;
 }
 
 static INLINE u16  Vdp1ReadPattern256( u32 base, u32 offset ) {
 
-  return T1ReadByte(Vdp1Ram, ( base + offset ) & 0x7FFFF) & 0xFF;
+  return T1ReadByte(vdp1ram, ( base + offset ) & 0x7FFFF) & 0xFF;
 }
 
 static INLINE u16  Vdp1ReadPattern64k( u32 base, u32 offset ) {
 
-  return T1ReadWord(Vdp1Ram, ( base + 2*offset) & 0x7FFFF);
+  return T1ReadWord(vdp1ram, ( base + 2*offset) & 0x7FFFF);
+}
+
+static void Vdp1ReadCommandSoft(vdp1cmd_struct *cmd, u32 addr) {
+   cmd->CMDCTRL = T1ReadWord(vdp1ram, addr);
+   cmd->CMDLINK = T1ReadWord(vdp1ram, addr + 0x2);
+   cmd->CMDPMOD = T1ReadWord(vdp1ram, addr + 0x4);
+   cmd->CMDCOLR = T1ReadWord(vdp1ram, addr + 0x6);
+   cmd->CMDSRCA = T1ReadWord(vdp1ram, addr + 0x8);
+   cmd->CMDSIZE = T1ReadWord(vdp1ram, addr + 0xA);
+   cmd->CMDXA = T1ReadWord(vdp1ram, addr + 0xC);
+   cmd->CMDYA = T1ReadWord(vdp1ram, addr + 0xE);
+   cmd->CMDXB = T1ReadWord(vdp1ram, addr + 0x10);
+   cmd->CMDYB = T1ReadWord(vdp1ram, addr + 0x12);
+   cmd->CMDXC = T1ReadWord(vdp1ram, addr + 0x14);
+   cmd->CMDYC = T1ReadWord(vdp1ram, addr + 0x16);
+   cmd->CMDXD = T1ReadWord(vdp1ram, addr + 0x18);
+   cmd->CMDYD = T1ReadWord(vdp1ram, addr + 0x1A);
+   cmd->CMDGRDA = T1ReadWord(vdp1ram, addr + 0x1C);
 }
 
 ////////////////////////////////////////////////////////////////////////////////
@@ -1958,7 +2295,7 @@ static int getpixel(int linenumber, int currentlineindex) {
 			if(isTextured && endcodesEnabled && currentPixel == endcode)
 				return 1;
 			if (!(currentPixel == 0 && !SPD))
-				currentPixel = T1ReadWord(Vdp1Ram, (currentPixel * 2 + colorlut) & 0x7FFFF);
+				currentPixel = T1ReadWord(vdp1ram, (currentPixel * 2 + colorlut) & 0x7FFFF);
 			currentPixelIsVisible = 0xffff;
 			break;
 		case 0x2://8pp bank (64 color)
@@ -2106,7 +2443,7 @@ static void putpixel(int x, int y) {
 		if (clipped) return;
 	}
 
-	if ((cmd.CMDPMOD & (1 << 15)) && ((Vdp2Regs->SPCTL & 0x10) == 0))
+	if ((cmd.CMDPMOD & (1 << 15)) && ((vdp1spctl & 0x10) == 0))
 	{
 		if (currentPixel) {
 			*iPix |= 0x8000;
@@ -2345,14 +2682,14 @@ static void gouraudTable(void)
 {
 	int gouraudTableAddress;
 
-	Vdp1ReadCommand(&cmd, Vdp1Regs->addr);
+	Vdp1ReadCommandSoft(&cmd, vdp1regs->addr);
 
 	gouraudTableAddress = (((unsigned int)cmd.CMDGRDA) << 3);
 
-	gouraudA.value = T1ReadWord(Vdp1Ram,gouraudTableAddress);
-	gouraudB.value = T1ReadWord(Vdp1Ram,gouraudTableAddress+2);
-	gouraudC.value = T1ReadWord(Vdp1Ram,gouraudTableAddress+4);
-	gouraudD.value = T1ReadWord(Vdp1Ram,gouraudTableAddress+6);
+	gouraudA.value = T1ReadWord(vdp1ram,gouraudTableAddress);
+	gouraudB.value = T1ReadWord(vdp1ram,gouraudTableAddress+2);
+	gouraudC.value = T1ReadWord(vdp1ram,gouraudTableAddress+4);
+	gouraudD.value = T1ReadWord(vdp1ram,gouraudTableAddress+6);
 }
 
 int xleft[1000];
@@ -2391,7 +2728,7 @@ static void drawQuad(s16 tl_x, s16 tl_y, s16 bl_x, s16 bl_y, s16 tr_x, s16 tr_y,
 	//a lookup table for the gouraud colors
 	COLOR colors[4];
 
-	Vdp1ReadCommand(&cmd, Vdp1Regs->addr);
+	Vdp1ReadCommandSoft(&cmd, vdp1regs->addr);
 	characterWidth = ((cmd.CMDSIZE >> 8) & 0x3F) * 8;
 	characterHeight = cmd.CMDSIZE & 0xFF;
 
@@ -2496,15 +2833,15 @@ static void drawQuad(s16 tl_x, s16 tl_y, s16 bl_x, s16 bl_y, s16 tr_x, s16 tr_y,
 	}
 }
 
-void VIDSoftVdp1NormalSpriteDraw() {
+static void Vdp1NormalSpriteDraw(void) {
 
 	s16 topLeftx,topLefty,topRightx,topRighty,bottomRightx,bottomRighty,bottomLeftx,bottomLefty;
 	int spriteWidth;
 	int spriteHeight;
-	Vdp1ReadCommand(&cmd, Vdp1Regs->addr);
+	Vdp1ReadCommandSoft(&cmd, vdp1regs->addr);
 
-	topLeftx = cmd.CMDXA + Vdp1Regs->localX;
-	topLefty = cmd.CMDYA + Vdp1Regs->localY;
+	topLeftx = cmd.CMDXA + vdp1regs->localX;
+	topLefty = cmd.CMDYA + vdp1regs->localY;
 	spriteWidth = ((cmd.CMDSIZE >> 8) & 0x3F) * 8;
 	spriteHeight = cmd.CMDSIZE & 0xFF;
 
@@ -2518,21 +2855,21 @@ void VIDSoftVdp1NormalSpriteDraw() {
 	drawQuad(topLeftx,topLefty,bottomLeftx,bottomLefty,topRightx,topRighty,bottomRightx,bottomRighty);
 }
 
-void VIDSoftVdp1ScaledSpriteDraw(){
+static void Vdp1ScaledSpriteDraw(void) {
 
 	s32 topLeftx,topLefty,topRightx,topRighty,bottomRightx,bottomRighty,bottomLeftx,bottomLefty;
 	int x0,y0,x1,y1;
-	Vdp1ReadCommand(&cmd, Vdp1Regs->addr);
+	Vdp1ReadCommandSoft(&cmd, vdp1regs->addr);
 
-	x0 = cmd.CMDXA + Vdp1Regs->localX;
-	y0 = cmd.CMDYA + Vdp1Regs->localY;
+	x0 = cmd.CMDXA + vdp1regs->localX;
+	y0 = cmd.CMDYA + vdp1regs->localY;
 
 	switch ((cmd.CMDCTRL >> 8) & 0xF)
 	{
 	case 0x0: // Only two coordinates
 	default:
-		x1 = ((int)cmd.CMDXC) - x0 + Vdp1Regs->localX + 1;
-		y1 = ((int)cmd.CMDYC) - y0 + Vdp1Regs->localY + 1;
+		x1 = ((int)cmd.CMDXC) - x0 + vdp1regs->localX + 1;
+		y1 = ((int)cmd.CMDYC) - y0 + vdp1regs->localY + 1;
 		break;
 	case 0x5: // Upper-left
 		x1 = ((int)cmd.CMDXB) + 1;
@@ -2615,23 +2952,23 @@ void VIDSoftVdp1ScaledSpriteDraw(){
 	drawQuad(topLeftx,topLefty,bottomLeftx,bottomLefty,topRightx,topRighty,bottomRightx,bottomRighty);
 }
 
-void VIDSoftVdp1DistortedSpriteDraw() {
+static void Vdp1DistortedSpriteDraw(void) {
 
 	s32 xa,ya,xb,yb,xc,yc,xd,yd;
 
-	Vdp1ReadCommand(&cmd, Vdp1Regs->addr);
+	Vdp1ReadCommandSoft(&cmd, vdp1regs->addr);
 
-    xa = (s32)(cmd.CMDXA + Vdp1Regs->localX);
-    ya = (s32)(cmd.CMDYA + Vdp1Regs->localY);
+    xa = (s32)(cmd.CMDXA + vdp1regs->localX);
+    ya = (s32)(cmd.CMDYA + vdp1regs->localY);
 
-    xb = (s32)(cmd.CMDXB + Vdp1Regs->localX);
-    yb = (s32)(cmd.CMDYB + Vdp1Regs->localY);
+    xb = (s32)(cmd.CMDXB + vdp1regs->localX);
+    yb = (s32)(cmd.CMDYB + vdp1regs->localY);
 
-    xc = (s32)(cmd.CMDXC + Vdp1Regs->localX);
-    yc = (s32)(cmd.CMDYC + Vdp1Regs->localY);
+    xc = (s32)(cmd.CMDXC + vdp1regs->localX);
+    yc = (s32)(cmd.CMDYC + vdp1regs->localY);
 
-    xd = (s32)(cmd.CMDXD + Vdp1Regs->localX);
-    yd = (s32)(cmd.CMDYD + Vdp1Regs->localY);
+    xd = (s32)(cmd.CMDXD + vdp1regs->localX);
+    yd = (s32)(cmd.CMDYD + vdp1regs->localY);
 
 	drawQuad(xa,ya,xd,yd,xb,yb,xc,yc);
 }
@@ -2649,23 +2986,23 @@ static void gouraudLineSetup(double * redstep, double * greenstep, double * blue
 	leftColumnColor.b = table1.b;
 }
 
-void VIDSoftVdp1PolylineDraw(void)
+static void Vdp1PolylineDraw(void)
 {
 	int X[4];
 	int Y[4];
 	double redstep = 0, greenstep = 0, bluestep = 0;
 	int length;
 
-	Vdp1ReadCommand(&cmd, Vdp1Regs->addr);
+	Vdp1ReadCommandSoft(&cmd, vdp1regs->addr);
 
-	X[0] = (int)Vdp1Regs->localX + (int)((s16)T1ReadWord(Vdp1Ram, Vdp1Regs->addr + 0x0C));
-	Y[0] = (int)Vdp1Regs->localY + (int)((s16)T1ReadWord(Vdp1Ram, Vdp1Regs->addr + 0x0E));
-	X[1] = (int)Vdp1Regs->localX + (int)((s16)T1ReadWord(Vdp1Ram, Vdp1Regs->addr + 0x10));
-	Y[1] = (int)Vdp1Regs->localY + (int)((s16)T1ReadWord(Vdp1Ram, Vdp1Regs->addr + 0x12));
-	X[2] = (int)Vdp1Regs->localX + (int)((s16)T1ReadWord(Vdp1Ram, Vdp1Regs->addr + 0x14));
-	Y[2] = (int)Vdp1Regs->localY + (int)((s16)T1ReadWord(Vdp1Ram, Vdp1Regs->addr + 0x16));
-	X[3] = (int)Vdp1Regs->localX + (int)((s16)T1ReadWord(Vdp1Ram, Vdp1Regs->addr + 0x18));
-	Y[3] = (int)Vdp1Regs->localY + (int)((s16)T1ReadWord(Vdp1Ram, Vdp1Regs->addr + 0x1A));
+	X[0] = (int)vdp1regs->localX + (int)((s16)T1ReadWord(vdp1ram, vdp1regs->addr + 0x0C));
+	Y[0] = (int)vdp1regs->localY + (int)((s16)T1ReadWord(vdp1ram, vdp1regs->addr + 0x0E));
+	X[1] = (int)vdp1regs->localX + (int)((s16)T1ReadWord(vdp1ram, vdp1regs->addr + 0x10));
+	Y[1] = (int)vdp1regs->localY + (int)((s16)T1ReadWord(vdp1ram, vdp1regs->addr + 0x12));
+	X[2] = (int)vdp1regs->localX + (int)((s16)T1ReadWord(vdp1ram, vdp1regs->addr + 0x14));
+	Y[2] = (int)vdp1regs->localY + (int)((s16)T1ReadWord(vdp1ram, vdp1regs->addr + 0x16));
+	X[3] = (int)vdp1regs->localX + (int)((s16)T1ReadWord(vdp1ram, vdp1regs->addr + 0x18));
+	Y[3] = (int)vdp1regs->localY + (int)((s16)T1ReadWord(vdp1ram, vdp1regs->addr + 0x1A));
 
 	length = iterateOverLine(X[0], Y[0], X[1], Y[1], 1, NULL, NULL);
 	gouraudLineSetup(&redstep,&greenstep,&bluestep,length, gouraudA, gouraudB);
@@ -2684,18 +3021,18 @@ void VIDSoftVdp1PolylineDraw(void)
 	DrawLine(X[0], Y[0], X[3], Y[3], 0, 0,0,redstep,greenstep,bluestep);
 }
 
-void VIDSoftVdp1LineDraw(void)
+static void Vdp1LineDraw(void)
 {
 	int x1, y1, x2, y2;
 	double redstep = 0, greenstep = 0, bluestep = 0;
 	int length;
 
-	Vdp1ReadCommand(&cmd, Vdp1Regs->addr);
+	Vdp1ReadCommandSoft(&cmd, vdp1regs->addr);
 
-	x1 = (int)Vdp1Regs->localX + (int)((s16)T1ReadWord(Vdp1Ram, Vdp1Regs->addr + 0x0C));
-	y1 = (int)Vdp1Regs->localY + (int)((s16)T1ReadWord(Vdp1Ram, Vdp1Regs->addr + 0x0E));
-	x2 = (int)Vdp1Regs->localX + (int)((s16)T1ReadWord(Vdp1Ram, Vdp1Regs->addr + 0x10));
-	y2 = (int)Vdp1Regs->localY + (int)((s16)T1ReadWord(Vdp1Ram, Vdp1Regs->addr + 0x12));
+	x1 = (int)vdp1regs->localX + (int)((s16)T1ReadWord(vdp1ram, vdp1regs->addr + 0x0C));
+	y1 = (int)vdp1regs->localY + (int)((s16)T1ReadWord(vdp1ram, vdp1regs->addr + 0x0E));
+	x2 = (int)vdp1regs->localX + (int)((s16)T1ReadWord(vdp1ram, vdp1regs->addr + 0x10));
+	y2 = (int)vdp1regs->localY + (int)((s16)T1ReadWord(vdp1ram, vdp1regs->addr + 0x12));
 
 	length = iterateOverLine(x1, y1, x2, y2, 1, NULL, NULL);
 	gouraudLineSetup(&redstep,&bluestep,&greenstep,length, gouraudA, gouraudB);
@@ -2704,39 +3041,39 @@ void VIDSoftVdp1LineDraw(void)
 
 //////////////////////////////////////////////////////////////////////////////
 
-void VIDSoftVdp1UserClipping(void)
+static void Vdp1UserClipping(void)
 {
-   Vdp1Regs->userclipX1 = T1ReadWord(Vdp1Ram, Vdp1Regs->addr + 0xC);
-   Vdp1Regs->userclipY1 = T1ReadWord(Vdp1Ram, Vdp1Regs->addr + 0xE);
-   Vdp1Regs->userclipX2 = T1ReadWord(Vdp1Ram, Vdp1Regs->addr + 0x14);
-   Vdp1Regs->userclipY2 = T1ReadWord(Vdp1Ram, Vdp1Regs->addr + 0x16);
+   vdp1regs->userclipX1 = T1ReadWord(vdp1ram, vdp1regs->addr + 0xC);
+   vdp1regs->userclipY1 = T1ReadWord(vdp1ram, vdp1regs->addr + 0xE);
+   vdp1regs->userclipX2 = T1ReadWord(vdp1ram, vdp1regs->addr + 0x14);
+   vdp1regs->userclipY2 = T1ReadWord(vdp1ram, vdp1regs->addr + 0x16);
 
 #if 0
-   vdp1clipxstart = Vdp1Regs->userclipX1;
-   vdp1clipxend = Vdp1Regs->userclipX2;
-   vdp1clipystart = Vdp1Regs->userclipY1;
-   vdp1clipyend = Vdp1Regs->userclipY2;
+   vdp1clipxstart = vdp1regs->userclipX1;
+   vdp1clipxend = vdp1regs->userclipX2;
+   vdp1clipystart = vdp1regs->userclipY1;
+   vdp1clipyend = vdp1regs->userclipY2;
 
    // This needs work
-   if (vdp1clipxstart > Vdp1Regs->systemclipX1)
-      vdp1clipxstart = Vdp1Regs->userclipX1;
+   if (vdp1clipxstart > vdp1regs->systemclipX1)
+      vdp1clipxstart = vdp1regs->userclipX1;
    else
-      vdp1clipxstart = Vdp1Regs->systemclipX1;
+      vdp1clipxstart = vdp1regs->systemclipX1;
 
-   if (vdp1clipxend < Vdp1Regs->systemclipX2)
-      vdp1clipxend = Vdp1Regs->userclipX2;
+   if (vdp1clipxend < vdp1regs->systemclipX2)
+      vdp1clipxend = vdp1regs->userclipX2;
    else
-      vdp1clipxend = Vdp1Regs->systemclipX2;
+      vdp1clipxend = vdp1regs->systemclipX2;
 
-   if (vdp1clipystart > Vdp1Regs->systemclipY1)
-      vdp1clipystart = Vdp1Regs->userclipY1;
+   if (vdp1clipystart > vdp1regs->systemclipY1)
+      vdp1clipystart = vdp1regs->userclipY1;
    else
-      vdp1clipystart = Vdp1Regs->systemclipY1;
+      vdp1clipystart = vdp1regs->systemclipY1;
 
-   if (vdp1clipyend < Vdp1Regs->systemclipY2)
-      vdp1clipyend = Vdp1Regs->userclipY2;
+   if (vdp1clipyend < vdp1regs->systemclipY2)
+      vdp1clipyend = vdp1regs->userclipY2;
    else
-      vdp1clipyend = Vdp1Regs->systemclipY2;
+      vdp1clipyend = vdp1regs->systemclipY2;
 #endif
 }
 
@@ -2750,64 +3087,120 @@ static void PushUserClipping(int mode)
       return;
    }
 
-   vdp1clipxstart = Vdp1Regs->userclipX1;
-   vdp1clipxend = Vdp1Regs->userclipX2;
-   vdp1clipystart = Vdp1Regs->userclipY1;
-   vdp1clipyend = Vdp1Regs->userclipY2;
+   vdp1clipxstart = vdp1regs->userclipX1;
+   vdp1clipxend = vdp1regs->userclipX2;
+   vdp1clipystart = vdp1regs->userclipY1;
+   vdp1clipyend = vdp1regs->userclipY2;
 
    // This needs work
-   if (vdp1clipxstart > Vdp1Regs->systemclipX1)
-      vdp1clipxstart = Vdp1Regs->userclipX1;
+   if (vdp1clipxstart > vdp1regs->systemclipX1)
+      vdp1clipxstart = vdp1regs->userclipX1;
    else
-      vdp1clipxstart = Vdp1Regs->systemclipX1;
+      vdp1clipxstart = vdp1regs->systemclipX1;
 
-   if (vdp1clipxend < Vdp1Regs->systemclipX2)
-      vdp1clipxend = Vdp1Regs->userclipX2;
+   if (vdp1clipxend < vdp1regs->systemclipX2)
+      vdp1clipxend = vdp1regs->userclipX2;
    else
-      vdp1clipxend = Vdp1Regs->systemclipX2;
+      vdp1clipxend = vdp1regs->systemclipX2;
 
-   if (vdp1clipystart > Vdp1Regs->systemclipY1)
-      vdp1clipystart = Vdp1Regs->userclipY1;
+   if (vdp1clipystart > vdp1regs->systemclipY1)
+      vdp1clipystart = vdp1regs->userclipY1;
    else
-      vdp1clipystart = Vdp1Regs->systemclipY1;
+      vdp1clipystart = vdp1regs->systemclipY1;
 
-   if (vdp1clipyend < Vdp1Regs->systemclipY2)
-      vdp1clipyend = Vdp1Regs->userclipY2;
+   if (vdp1clipyend < vdp1regs->systemclipY2)
+      vdp1clipyend = vdp1regs->userclipY2;
    else
-      vdp1clipyend = Vdp1Regs->systemclipY2;
+      vdp1clipyend = vdp1regs->systemclipY2;
 }
 
 //////////////////////////////////////////////////////////////////////////////
 
 static void PopUserClipping(void)
 {
-   vdp1clipxstart = Vdp1Regs->systemclipX1;
-   vdp1clipxend = Vdp1Regs->systemclipX2;
-   vdp1clipystart = Vdp1Regs->systemclipY1;
-   vdp1clipyend = Vdp1Regs->systemclipY2;
+   vdp1clipxstart = vdp1regs->systemclipX1;
+   vdp1clipxend = vdp1regs->systemclipX2;
+   vdp1clipystart = vdp1regs->systemclipY1;
+   vdp1clipyend = vdp1regs->systemclipY2;
 }
 
 //////////////////////////////////////////////////////////////////////////////
 
-void VIDSoftVdp1SystemClipping(void)
+static void Vdp1SystemClipping(void)
 {
-   Vdp1Regs->systemclipX1 = 0;
-   Vdp1Regs->systemclipY1 = 0;
-   Vdp1Regs->systemclipX2 = T1ReadWord(Vdp1Ram, Vdp1Regs->addr + 0x14);
-   Vdp1Regs->systemclipY2 = T1ReadWord(Vdp1Ram, Vdp1Regs->addr + 0x16);
+   vdp1regs->systemclipX1 = 0;
+   vdp1regs->systemclipY1 = 0;
+   vdp1regs->systemclipX2 = T1ReadWord(vdp1ram, vdp1regs->addr + 0x14);
+   vdp1regs->systemclipY2 = T1ReadWord(vdp1ram, vdp1regs->addr + 0x16);
 
-   vdp1clipxstart = Vdp1Regs->systemclipX1;
-   vdp1clipxend = Vdp1Regs->systemclipX2;
-   vdp1clipystart = Vdp1Regs->systemclipY1;
-   vdp1clipyend = Vdp1Regs->systemclipY2;
+   vdp1clipxstart = vdp1regs->systemclipX1;
+   vdp1clipxend = vdp1regs->systemclipX2;
+   vdp1clipystart = vdp1regs->systemclipY1;
+   vdp1clipyend = vdp1regs->systemclipY2;
+}
+
+//////////////////////////////////////////////////////////////////////////////
+
+static void Vdp1LocalCoordinate(void)
+{
+   vdp1regs->localX = T1ReadWord(vdp1ram, vdp1regs->addr + 0xC);
+   vdp1regs->localY = T1ReadWord(vdp1ram, vdp1regs->addr + 0xE);
+}
+
+//////////////////////////////////////////////////////////////////////////////
+
+void VIDSoftVdp1NormalSpriteDraw(void)
+{
+   Vdp1RunCommand(Vdp1NormalSpriteDraw);
+}
+
+//////////////////////////////////////////////////////////////////////////////
+
+void VIDSoftVdp1ScaledSpriteDraw(void)
+{
+   Vdp1RunCommand(Vdp1ScaledSpriteDraw);
+}
+
+//////////////////////////////////////////////////////////////////////////////
+
+void VIDSoftVdp1DistortedSpriteDraw(void)
+{
+   Vdp1RunCommand(Vdp1DistortedSpriteDraw);
+}
+
+//////////////////////////////////////////////////////////////////////////////
+
+void VIDSoftVdp1PolylineDraw(void)
+{
+   Vdp1RunCommand(Vdp1PolylineDraw);
+}
+
+//////////////////////////////////////////////////////////////////////////////
+
+void VIDSoftVdp1LineDraw(void)
+{
+   Vdp1RunCommand(Vdp1LineDraw);
+}
+
+//////////////////////////////////////////////////////////////////////////////
+
+void VIDSoftVdp1UserClipping(void)
+{
+   Vdp1RunCommand(Vdp1UserClipping);
+}
+
+//////////////////////////////////////////////////////////////////////////////
+
+void VIDSoftVdp1SystemClipping(void)
+{
+   Vdp1RunCommand(Vdp1SystemClipping);
 }
 
 //////////////////////////////////////////////////////////////////////////////
 
 void VIDSoftVdp1LocalCoordinate(void)
 {
-   Vdp1Regs->localX = T1ReadWord(Vdp1Ram, Vdp1Regs->addr + 0xC);
-   Vdp1Regs->localY = T1ReadWord(Vdp1Ram, Vdp1Regs->addr + 0xE);
+   Vdp1RunCommand(Vdp1LocalCoordinate);
 }
 
 //////////////////////////////////////////////////////////////////////////////
@@ -2832,9 +3225,10 @@ void VIDSoftVdp2DrawStart(void)
 
 //////////////////////////////////////////////////////////////////////////////
 
-void VIDSoftVdp2DrawEnd(void)
+static void Vdp2DrawSprites(int linestart, int lineend)
 {
    int i, i2;
+   int drawwidth;
    u16 pixel;
    u8 prioritytable[8];
    u32 vdp1coloroffset;
@@ -2845,6 +3239,7 @@ void VIDSoftVdp2DrawEnd(void)
    u32 linewnd0addr, linewnd1addr;
    int wctl;
    clipping_struct colorcalcwindow[2];
+   int vdp1spritetype;
 
    // Figure out whether to draw vdp1 framebuffer or vdp2 framebuffer pixels
    // based on priority
@@ -2891,13 +3286,14 @@ void VIDSoftVdp2DrawEnd(void)
       if (Vdp1Regs->TVMR & 2)
          Vdp2ReadRotationTableFP(0, &p);
 
-      for (i2 = 0; i2 < vdp2height; i2++)
+      for (i2 = 0; i2 < lineend; i2++)
       {
          ReadLineWindowClip(islinewindow, clip, &linewnd0addr, &linewnd1addr);
 
          LoadLineParamsSprite(&info, i2);
 
-         for (i = 0; i < vdp2width; i++)
+         drawwidth = i2 < linestart ? 0 : vdp2width;
+         for (i = 0; i < drawwidth; i++)
          {
             // See if screen position is clipped, if it isn't, continue
             if (!TestBothWindow(wctl, clip, i * resxratio, i2))
@@ -3075,7 +3471,25 @@ void VIDSoftVdp2DrawEnd(void)
          }
       }
    }
-   TitanRender(dispbuffer);
+}
+
+//////////////////////////////////////////////////////////////////////////////
+
+static void Vdp2DrawEndLines(int linestart, int lineend)
+{
+   Vdp2DrawSprites(linestart, lineend);
+   TitanRenderLines(dispbuffer, linestart, lineend);
+}
+
+//////////////////////////////////////////////////////////////////////////////
+
+void VIDSoftVdp2DrawEnd(void)
+{
+#ifdef USE_OPENGL
+   int i;
+#endif
+
+   Vdp2RunBands(Vdp2DrawEndLines);
 
    VIDSoftVdp1SwapFrameBuffer();
 
@@ -3101,34 +3515,41 @@ void VIDSoftVdp2DrawEnd(void)
 
 //////////////////////////////////////////////////////////////////////////////
 
-void VIDSoftVdp2DrawScreens(void)
+static void Vdp2DrawScreenLines(int linestart, int lineend)
 {
    int i;
 
-   VIDSoftVdp2SetResolution(Vdp2Regs->TVMD);
-   VIDSoftVdp2SetPriorityNBG0(Vdp2Regs->PRINA & 0x7);
-   VIDSoftVdp2SetPriorityNBG1((Vdp2Regs->PRINA >> 8) & 0x7);
-   VIDSoftVdp2SetPriorityNBG2(Vdp2Regs->PRINB & 0x7);
-   VIDSoftVdp2SetPriorityNBG3((Vdp2Regs->PRINB >> 8) & 0x7);
-   VIDSoftVdp2SetPriorityRBG0(Vdp2Regs->PRIR & 0x7);
-
    for (i = 7; i > 0; i--)
    {   
       if (nbg3priority == i)
-         Vdp2DrawNBG3();
+         Vdp2DrawNBG3(linestart, lineend);
       if (nbg2priority == i)
-         Vdp2DrawNBG2();
+         Vdp2DrawNBG2(linestart, lineend);
       if (nbg1priority == i)
-         Vdp2DrawNBG1();
+         Vdp2DrawNBG1(linestart, lineend);
       if (nbg0priority == i)
-         Vdp2DrawNBG0();
+         Vdp2DrawNBG0(linestart, lineend);
       if (rbg0priority == i)
-         Vdp2DrawRBG0();
+         Vdp2DrawRBG0(linestart, lineend);
    }
 }
 
 //////////////////////////////////////////////////////////////////////////////
 
+void VIDSoftVdp2DrawScreens(void)
+{
+   VIDSoftVdp2SetResolution(Vdp2Regs->TVMD);
+   VIDSoftVdp2SetPriorityNBG0(Vdp2Regs->PRINA & 0x7);
+   VIDSoftVdp2SetPriorityNBG1((Vdp2Regs->PRINA >> 8) & 0x7);
+   VIDSoftVdp2SetPriorityNBG2(Vdp2Regs->PRINB & 0x7);
+   VIDSoftVdp2SetPriorityNBG3((Vdp2Regs->PRINB >> 8) & 0x7);
+   VIDSoftVdp2SetPriorityRBG0(Vdp2Regs->PRIR & 0x7);
+
+   Vdp2RunBands(Vdp2DrawScreenLines);
+}
+
+//////////////////////////////////////////////////////////////////////////////
+
 void VIDSoftVdp2DrawScreen(int screen)
 {
    VIDSoftVdp2SetResolution(Vdp2Regs->TVMD);
@@ -3140,19 +3561,19 @@ void VIDSoftVdp2DrawScreen(int screen)
    switch(screen)
    {
       case 0:
-         Vdp2DrawNBG0();
+         Vdp2DrawNBG0(0, vdp2height);
          break;
       case 1:
-         Vdp2DrawNBG1();
+         Vdp2DrawNBG1(0, vdp2height);
          break;
       case 2:
-         Vdp2DrawNBG2();
+         Vdp2DrawNBG2(0, vdp2height);
          break;
       case 3:
-         Vdp2DrawNBG3();
+         Vdp2DrawNBG3(0, vdp2height);
          break;
       case 4:
-         Vdp2DrawRBG0();
+         Vdp2DrawRBG0(0, vdp2height);
          break;
    }
 }
@@ -3270,6 +3691,8 @@ void FASTCALL VIDSoftVdp2SetPriorityRBG0(int priority)
 
 void VIDSoftVdp1SwapFrameBuffer(void)
 {
+   Vdp1WaitJob();
+
    if (((Vdp1Regs->FBCR & 2) == 0) || Vdp1External.manualchange)
    {
       u8 *temp = vdp1frontframebuffer;
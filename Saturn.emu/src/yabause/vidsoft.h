@@ -30,4 +30,9 @@ extern VideoInterface_struct VIDSoft;
 
 void VIDSoftVdp2DrawScreen(int screen);
 
+// Number of threads drawing VDP2 line bands, including the emulation thread
+void VIDSoftSetNumLayerThreads(int num);
+// Rasterise VDP1 command lists on their own thread
+void VIDSoftSetVdp1ThreadEnable(int enable);
+
 #endif
@@ -1,6 +1,7 @@
 #define LOGTAG "main"
 #include <emuframework/EmuSystemInlines.hh>
 #include <emuframework/EmuAppInlines.hh>
+#include <emuframework/zlibUtils.hh>
 #include <imagine/fs/FS.hh>
 #include <imagine/fs/ArchiveFS.hh>
 #include <imagine/util/format.hh>
@@ -34,6 +35,7 @@ bool EmuSystem::hasPALVideoSystem = true;
 bool EmuSystem::hasResetModes = true;
 bool EmuSystem::canRenderRGBA8888 = false;
 bool EmuSystem::hasRectangularPixels = true;
+bool EmuSystem::hasRunAhead = true;
 bool EmuApp::needsGlobalInstance = true;
 
 EmuSystem::NameFilterFunc EmuSystem::defaultFsFilter =
@@ -105,6 +107,7 @@ static FS::PathString sramFilename(EmuApp &app)
 	return app.contentSaveFilePath(".srm");
 }
 
+#ifdef SNES9X_VERSION_1_4
 void Snes9xSystem::saveState(IG::CStringView path)
 {
 	if(!S9xFreezeGame(path))
@@ -120,6 +123,60 @@ void Snes9xSystem::loadState(EmuApp &, IG::CStringView path)
 	else
 		return throwFileReadError();
 }
+#else
+// well above the largest freeze size, including SA-1 and Super FX RAM
+static constexpr size_t maxStateSize = 0x800000;
+
+size_t Snes9xSystem::stateSize()
+{
+	return gzipCompressBound(S9xFreezeSize());
+}
+
+void Snes9xSystem::readState(EmuApp &, std::span<const uint8_t> buff)
+{
+	int result;
+	if(hasGzipHeader(buff))
+	{
+		auto size = gzipUncompressedSize(buff, maxStateSize);
+		if(!size)
+			throw std::runtime_error("Invalid state data size");
+		auto stateBuff = std::make_unique_for_overwrite<uint8_t[]>(size);
+		if(gzipDecompress(buff, {stateBuff.get(), size}) != size)
+			throw std::runtime_error("Error uncompressing state data");
+		result = S9xUnfreezeGameMem(stateBuff.get(), size);
+	}
+	else
+	{
+		result = S9xUnfreezeGameMem(buff.data(), buff.size());
+	}
+	if(result != SUCCESS)
+		throw std::runtime_error(IG::format<std::string>("Invalid state data (error {})", result));
+	IPPU.RenderThisFrame = TRUE;
+}
+
+size_t Snes9xSystem::writeState(std::span<uint8_t> buff, SaveStateFlags flags)
+{
+	size_t size = S9xFreezeSize();
+	if(to_underlying(flags & SaveStateFlags::uncompressed))
+	{
+		if(size > buff.size())
+			throw std::runtime_error("State buffer too small");
+		S9xFreezeGameMem(buff.data(), size);
+		return size;
+	}
+	auto stateBuff = std::make_unique_for_overwrite<uint8_t[]>(size);
+	S9xFreezeGameMem(stateBuff.get(), size);
+	auto compressedSize = gzipCompress({stateBuff.get(), size}, buff);
+	if(!compressedSize)
+		throw std::runtime_error("State buffer too small");
+	return compressedSize;
+}
+
+size_t Snes9xSystem::compressState(std::span<const uint8_t> src, std::span<uint8_t> dest) const
+{
+	return gzipCompress(src, dest);
+}
+#endif
 
 void Snes9xSystem::loadBackupMemory(EmuApp &app)
 {
@@ -379,6 +379,11 @@ void removeFileHelper(const char* filename)
 	EmuEx::gAppContext().removeFileUri(filename);
 }
 
+void writeBackupMemoryHelper(const char* filename, const void *data, size_t size)
+{
+	gApp().saveBackupMemory(filename, {static_cast<const uint8_t*>(data), size});
+}
+
 gzFile gzopenHelper(const char *filename, const char *mode)
 {
 	auto openFlags = std::string_view{mode}.contains('w') ? IG::OpenFlagsMask::New : IG::OpenFlagsMask{};
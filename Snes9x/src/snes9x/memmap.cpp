@@ -1798,17 +1798,7 @@ bool8 CMemory::LoadSRTC (void)
 
 bool8 CMemory::SaveSRTC (void)
 {
-	FILE	*fp;
-
-	fp = fopen(S9xGetFilename(".rtc", SRAM_DIR).c_str(), "wb");
-	if (!fp)
-		return (FALSE);
-
-	if (fwrite(RTCData.reg, 1, 20, fp) < 20)
-	{
-		printf ("Failed to save clock data.\n");
-	}
-	fclose(fp);
+	writeBackupMemoryHelper(S9xGetFilename(".rtc", SRAM_DIR).c_str(), RTCData.reg, 20);
 
 	return (TRUE);
 }
@@ -1902,7 +1892,6 @@ bool8 CMemory::SaveSRAM (const char *filename)
 	if (Settings.SA1 && ROMType == 0x34)    // doesn't have SRAM
 		return (TRUE);
 
-	FILE	*file;
 	int		size;
 
 	if (Multi.cartType && Multi.sramSizeB)
@@ -1910,13 +1899,7 @@ bool8 CMemory::SaveSRAM (const char *filename)
 		std::string name = S9xGetFilename(Multi.fileNameB, ".srm", SRAM_DIR);
 		size = (1 << (Multi.sramSizeB + 3)) * 128;
 
-		file = fopen(name.c_str(), "wb");
-		if (file)
-		{
-			if (!fwrite((char *) Multi.sramB, size, 1, file))
-				printf ("Couldn't write to subcart SRAM file.\n");
-			fclose(file);
-		}
+		writeBackupMemoryHelper(name.c_str(), Multi.sramB, size);
     }
 
     size = SRAMSize ? (1 << (SRAMSize + 3)) * 128 : 0;
@@ -1927,18 +1910,12 @@ bool8 CMemory::SaveSRAM (const char *filename)
 
 	if (size)
 	{
-		file = fopen(filename, "wb");
-		if (file)
-		{
-			if (!fwrite((char *) SRAM, size, 1, file))
-				printf ("Couldn't write to SRAM file.\n");
-			fclose(file);
+		writeBackupMemoryHelper(filename, SRAM, size);
 
-			if (Settings.SRTC || Settings.SPC7110RTC)
-				SaveSRTC();
+		if (Settings.SRTC || Settings.SPC7110RTC)
+			SaveSRTC();
 
-			return (TRUE);
-		}
+		return (TRUE);
 	}
 
 	return (FALSE);
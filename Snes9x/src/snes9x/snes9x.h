@@ -43,6 +43,7 @@ gzFile gzopenHelper(const char *filename, const char *mode);
 
 FILE *fopenHelper(const char *filename, const char *mode);
 void removeFileHelper(const char *filename);
+void writeBackupMemoryHelper(const char *filename, const void *data, size_t size);
 
 #include "stream.h"
 
@@ -42,6 +42,7 @@ namespace EmuEx
 using namespace MDFN_IEN_WSWAN;
 
 const char *EmuSystem::creditsViewStr = CREDITS_INFO_STRING "(c) 2011-2023\nRobert Broglia\nwww.explusalpha.com\n\nPortions (c) the\nMednafen Team\nmednafen.github.io";
+bool EmuSystem::hasRunAhead = true;
 bool EmuApp::needsGlobalInstance = true;
 
 EmuSystem::NameFilterFunc EmuSystem::defaultFsFilter =
@@ -64,16 +65,23 @@ FS::FileString WsSystem::stateFilename(int slot, std::string_view name) const
 	return stateFilenameMDFN(*MDFNGameInfo, slot, name, 'a');
 }
 
-void WsSystem::saveState(IG::CStringView path)
+static constexpr size_t maxStateSize = 0x400000;
+
+size_t WsSystem::stateSize() { return stateSizeMDFN(); }
+
+void WsSystem::readState(EmuApp &, std::span<const uint8_t> buff)
+{
+	readStateMDFN(buff, maxStateSize);
+}
+
+size_t WsSystem::writeState(std::span<uint8_t> buff, SaveStateFlags flags)
 {
-	if(!MDFNI_SaveState(path, 0, 0, 0, 0))
-		throwFileWriteError();
+	return writeStateMDFN(buff, flags);
 }
 
-void WsSystem::loadState(EmuApp &, IG::CStringView path)
+size_t WsSystem::compressState(std::span<const uint8_t> src, std::span<uint8_t> dest) const
 {
-	if(!MDFNI_LoadState(path, 0))
-		throwFileReadError();
+	return gzipCompress(src, dest);
 }
 
 void WsSystem::loadBackupMemory(EmuApp &app)
@@ -81,8 +89,7 @@ void WsSystem::loadBackupMemory(EmuApp &app)
 	if(!eeprom_size && !sram_size)
 		return;
 	logMsg("loading sram/eeprom");
-	if(!saveFileIO)
-		saveFileIO = staticBackupMemoryFile(savePathMDFN(app, 0, "sav"), eeprom_size + sram_size);
+	auto saveFileIO = staticBackupMemoryFile(savePathMDFN(app, 0, "sav"), eeprom_size + sram_size);
 	if(eeprom_size)
 		saveFileIO.read(wsEEPROM, eeprom_size, 0);
 	if(sram_size)
@@ -94,10 +101,12 @@ void WsSystem::onFlushBackupMemory(EmuApp &app, BackupMemoryDirtyFlags)
 	if(!eeprom_size && !sram_size)
 		return;
 	logMsg("saving sram/eeprom");
+	auto saveData = std::make_unique_for_overwrite<uint8_t[]>(eeprom_size + sram_size);
 	if(eeprom_size)
-		saveFileIO.write(wsEEPROM, eeprom_size, 0);
+		memcpy(saveData.get(), wsEEPROM, eeprom_size);
 	if(sram_size)
-		saveFileIO.write(wsSRAM, sram_size, eeprom_size);
+		memcpy(saveData.get() + eeprom_size, wsSRAM, sram_size);
+	app.saveBackupMemory(savePathMDFN(app, 0, "sav"), {saveData.get(), eeprom_size + sram_size});
 }
 
 IG::Time WsSystem::backupMemoryLastWriteTime(const EmuApp &app) const
@@ -108,8 +117,8 @@ IG::Time WsSystem::backupMemoryLastWriteTime(const EmuApp &app) const
 void WsSystem::closeSystem()
 {
 	mdfnGameInfo.CloseGame();
+	resetStateCacheMDFN();
 	mdfnGameInfo.rotated = MDFN_ROTATE0;
-	saveFileIO = {};
 }
 
 void WsSystem::loadContent(IO &io, EmuSystemCreateParams, OnLoadProgressDelegate)
@@ -99,6 +99,8 @@ public:
 	void setClipTest(bool on);
 	void setClipRect(ClipRect b);
 	void setTexture(const Texture &t);
+	// binds to another texture unit for programs sampling more than one texture, unit 0 stays active
+	void setTexture(const Texture &t, int unit);
 	void set(TextureBinding);
 	void setTextureSampler(const TextureSampler &sampler);
 	void setViewport(Viewport v);
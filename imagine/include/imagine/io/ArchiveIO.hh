@@ -49,6 +49,9 @@ public:
 	FS::file_type type() const;
 	size_t size() const;
 	uint32_t crc32() const;
+	// true if the archive's format can compress entries together in one stream (7-Zip & RAR),
+	// where reading an entry may need decompressing the ones before it
+	bool hasSolidFormat() const;
 	ArchiveIO releaseIO();
 	void reset(ArchiveIO io);
 	bool readNextEntry();
@@ -67,6 +67,9 @@ ssize_t readFromUri(ApplicationContext, CStringView uri, std::span<unsigned char
 	IOAccessHint accessHint = IOAccessHint::All);
 std::pair<ssize_t, FS::PathString> readFromUriWithArchiveScan(ApplicationContext, CStringView uri,
 	std::span<unsigned char> dest, bool(*nameMatchFunc)(std::string_view), IOAccessHint accessHint = IOAccessHint::All);
+// Reads the IO into dest, but if dest is page aligned & the IO is a private file mapping,
+// its pages are moved in place of dest's so nothing is read up-front & only modified pages use memory
+ssize_t mapOrRead(IO &, std::span<unsigned char> dest);
 IOBuffer bufferFromPath(CStringView path, OpenFlagsMask oFlags = {}, size_t sizeLimit = defaultBufferReadSizeLimit);
 IOBuffer bufferFromUri(ApplicationContext, CStringView uri, OpenFlagsMask oFlags = {}, size_t sizeLimit = defaultBufferReadSizeLimit);
 IOBuffer rwBufferFromUri(ApplicationContext, CStringView uri, OpenFlagsMask extraOFlags, size_t size, uint8_t initValue = 0);
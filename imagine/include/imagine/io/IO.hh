@@ -66,6 +66,7 @@ public:
 	// optional API
 	bool truncate(off_t offset);
 	std::span<uint8_t> map();
+	IOBuffer releaseBuffer();
 	void sync();
 	void advise(off_t offset, size_t bytes, Advice advice);
 };
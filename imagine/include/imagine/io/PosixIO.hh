@@ -26,6 +26,7 @@ enum class IOMapFlagsMask: uint8_t
 {
 	Write = bit(0),
 	PopulatePages = bit(1),
+	Private = bit(2), // copy-on-write, writes never reach the file
 };
 
 IG_DEFINE_ENUM_BIT_FLAG_FUNCTIONS(IOMapFlagsMask);
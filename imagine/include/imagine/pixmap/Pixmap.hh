@@ -23,6 +23,8 @@
 #include <imagine/util/container/array.hh>
 #include <imagine/util/concepts.hh>
 #include <cstring>
+#include <span>
+#include <string>
 
 namespace IG
 {
@@ -39,6 +41,13 @@ uint32_t transformRGB565ToBGRX8888(uint16_t p);
 uint32_t transformRGB888ToRGBX8888(ByteArray<3> p);
 uint32_t transformRGB888ToBGRX8888(ByteArray<3> p);
 
+// Converts 8-bit palette indices to pixels, using AVX2 gathers (selected at runtime)
+// or NEON table lookups when available
+void expandPalette8(std::span<const uint8_t> src, uint16_t *dest, std::span<const uint16_t, 256> palette);
+void expandPalette8(std::span<const uint8_t> src, uint32_t *dest, std::span<const uint32_t, 256> palette);
+// returns JSON with megapixels/sec of expandPalette8() vs writeTransformed()
+std::string benchmarkPaletteExpand();
+
 template <class Func>
 concept PixmapTransformFunc =
 		requires (Func &&f, unsigned data){ f(data); } ||
@@ -307,6 +316,17 @@ public:
 		writeTransformed2<Src, Dest>(func, pixmap);
 	}
 
+	// same as writeTransformed() with a palette lookup of 8-bit pixels, but vectorized
+	void writePaletteExpanded(std::span<const uint16_t, 256> palette, auto pixmap) requires(dataIsMutable)
+	{
+		writePaletteExpanded2(palette, pixmap);
+	}
+
+	void writePaletteExpanded(std::span<const uint32_t, 256> palette, auto pixmap) requires(dataIsMutable)
+	{
+		writePaletteExpanded2(palette, pixmap);
+	}
+
 protected:
 	PixData *data_{};
 	int pitch{}; // in bytes
@@ -354,6 +374,29 @@ protected:
 		}
 	}
 
+	template <class Dest>
+	void writePaletteExpanded2(std::span<const Dest, 256> palette, auto pixmap) requires(dataIsMutable)
+	{
+		assumeExpr(pixmap.format().bytesPerPixel() == 1);
+		assumeExpr(format().bytesPerPixel() == sizeof(Dest));
+		auto srcData = (const uint8_t*)pixmap.data();
+		auto destData = (Dest*)data_;
+		if(w() == pixmap.w() && !isPadded() && !pixmap.isPadded())
+		{
+			expandPalette8({srcData, size_t(pixmap.w() * pixmap.h())}, destData, palette);
+		}
+		else
+		{
+			auto destPitchPixels = pitchPixels();
+			for(auto h : iotaCount(pixmap.h()))
+			{
+				expandPalette8({srcData, size_t(pixmap.w())}, destData, palette);
+				srcData += pixmap.pitchPixels();
+				destData += destPitchPixels;
+			}
+		}
+	}
+
 	static void invalidFormatConversion(auto dest, auto src)
 	{
 		bug_unreachable("unimplemented conversion:%s -> %s", src.format().name(), dest.format().name());
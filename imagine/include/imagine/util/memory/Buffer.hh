@@ -94,6 +94,9 @@ public:
 
 	constexpr T *data() const { return data_.get(); }
 
+	// Gives up ownership of the data without deleting it
+	constexpr T *release() { return data_.release(); }
+
 	constexpr size_t size() const
 	{
 		return data_.get_deleter().size;
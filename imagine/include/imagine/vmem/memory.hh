@@ -25,6 +25,13 @@ void freeVMem(void *vMemPtr, size_t bytes);
 size_t adjustVMemAllocSize(size_t bytes);
 void *allocMirroredBuffer(size_t bytes);
 void freeMirroredBuffer(void *vMemPtr, size_t bytes);
+// Moves the pages of the mapping at src to dest, replacing dest's existing pages,
+// both must be page aligned. Returns false if unsupported or on error, leaving src intact
+bool moveVMem(void *src, size_t bytes, void *dest);
+// Allows writes to the pages, for private file mappings only the modified pages are copied
+bool makeVMemWritable(void *vMemPtr, size_t bytes);
+// Replaces the pages with zero-filled ones, freeing their previous memory
+bool resetVMem(void *vMemPtr, size_t bytes);
 
 template<class T>
 static T *allocVMemObjects(size_t size)
@@ -387,6 +387,20 @@ void RendererCommands::setTexture(const Texture &t)
 	set(t.binding());
 }
 
+void RendererCommands::setTexture(const Texture &t, int unit)
+{
+	if(!unit)
+	{
+		setTexture(t);
+		return;
+	}
+	rTask->verifyCurrentContext();
+	auto binding = t.binding();
+	glActiveTexture(GL_TEXTURE0 + unit);
+	glBindTexture(binding.target, binding.name);
+	glActiveTexture(GL_TEXTURE0);
+}
+
 void RendererCommands::set(TextureBinding binding)
 {
 	rTask->verifyCurrentContext();
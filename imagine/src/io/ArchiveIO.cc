@@ -200,6 +200,18 @@ uint32_t ArchiveEntry::crc32() const
 	return archive_entry_crc32(ptr);
 }
 
+bool ArchiveEntry::hasSolidFormat() const
+{
+	assumeExpr(arch);
+	switch(archive_format(arch.get()) & ARCHIVE_FORMAT_BASE_MASK)
+	{
+		case ARCHIVE_FORMAT_7ZIP:
+		case ARCHIVE_FORMAT_RAR:
+			return true;
+	}
+	return false;
+}
+
 ArchiveIO ArchiveEntry::releaseIO()
 {
 	return ArchiveIO{std::move(*this)};
@@ -13,11 +13,14 @@
 	You should have received a copy of the GNU General Public License
 	along with Imagine.  If not, see <http://www.gnu.org/licenses/> */
 
+#define LOGTAG "IO"
 #include <imagine/io/IO.hh>
 #include <imagine/io/FileIO.hh>
 #include <imagine/fs/FS.hh>
 #include <imagine/util/format.hh>
 #include <imagine/util/variant.hh>
+#include <imagine/vmem/memory.hh>
+#include <imagine/vmem/pageSize.hh>
 #include <imagine/logger/logger.h>
 #include "IOUtils.hh"
 
@@ -52,6 +55,17 @@ std::span<uint8_t> IO::map()
 	}, *this);
 };
 
+IOBuffer IO::releaseBuffer()
+{
+	return visit([&](auto &io)
+	{
+		if constexpr(requires {io.releaseBuffer();})
+			return io.releaseBuffer();
+		else
+			return IOBuffer{};
+	}, *this);
+};
+
 bool IO::truncate(off_t offset)
 {
 	return visit([&](auto &io)
@@ -104,6 +118,30 @@ ssize_t readFromPath(CStringView path, std::span<unsigned char> dest, IO::Access
 	return f.read(dest).bytes;
 }
 
+ssize_t mapOrRead(IO &io, std::span<unsigned char> dest)
+{
+	auto destAddr = std::bit_cast<uintptr_t>(dest.data());
+	if(destAddr != roundDownToPageSize(destAddr) || dest.size() != roundUpToPageSize(dest.size()))
+		return io.read(dest.data(), dest.size());
+	// release any pages a previous call mapped into dest
+	resetVMem(dest.data(), dest.size());
+	if(!io.map().data() || io.size() > dest.size())
+		return io.read(dest.data(), dest.size());
+	auto buff = io.buffer(IOBufferMode::Release);
+	auto mapSize = roundUpToPageSize(buff.size());
+	if(buff.isMappedFile() && makeVMemWritable(buff.data(), mapSize) &&
+		moveVMem(buff.data(), mapSize, dest.data()))
+	{
+		logMsg("moved %zu byte file mapping to %p", buff.size(), dest.data());
+		auto size = buff.size();
+		buff.release();
+		return size;
+	}
+	// the IO's data was already released, so copy it
+	std::ranges::copy(buff.span(), dest.data());
+	return buff.size();
+}
+
 IOBuffer bufferFromPath(CStringView path, OpenFlagsMask openFlags, size_t sizeLimit)
 {
 	FileIO file{path, IOAccessHint::All, openFlags};
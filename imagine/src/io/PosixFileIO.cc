@@ -85,6 +85,8 @@ bool PosixFileIO::tryMap(IOAccessHint access, OpenFlagsMask openFlags)
 				flags |= IOMapFlagsMask::PopulatePages;
 			if(to_underlying(openFlags & OpenFlagsMask::Write))
 				flags |= IOMapFlagsMask::Write;
+			else
+				flags |= IOMapFlagsMask::Private;
 			MapIO mappedFile{io.mapRange(0, io.size(), flags)};
 			if(!mappedFile)
 				return false;
@@ -231,12 +231,12 @@ IOBuffer PosixIO::releaseBuffer()
 		flags = 0;
 	}
 	bool isWritable = (flags & O_WRONLY) || (flags & O_RDWR);
-	return mapRange(0, size(), isWritable ? IOMapFlagsMask::Write : IOMapFlagsMask{});
+	return mapRange(0, size(), isWritable ? IOMapFlagsMask::Write : IOMapFlagsMask::Private);
 }
 
 IOBuffer PosixIO::mapRange(off_t start, size_t size, IOMapFlagsMask mapFlags)
 {
-	int flags = MAP_SHARED;
+	int flags = to_underlying(mapFlags & IOMapFlagsMask::Private) ? MAP_PRIVATE : MAP_SHARED;
 	if(to_underlying(mapFlags & IOMapFlagsMask::PopulatePages))
 		flags |= MAP_POPULATE;
 	int prot = PROT_READ;
@@ -0,0 +1,216 @@
+/*  This file is part of Imagine.
+
+	Imagine is free software: you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation, either version 3 of the License, or
+	(at your option) any later version.
+
+	Imagine is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License
+	along with Imagine.  If not, see <http://www.gnu.org/licenses/> */
+
+#include <imagine/pixmap/Pixmap.hh>
+#include <imagine/util/format.hh>
+#include <chrono>
+#include <random>
+#include <vector>
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#define IG_PALETTE_EXPAND_AVX2
+#elif defined(__aarch64__)
+#include <arm_neon.h>
+#define IG_PALETTE_EXPAND_NEON
+#endif
+
+namespace IG
+{
+
+template <class Pixel>
+static void expandScalar(const uint8_t *src, Pixel *dest, size_t n, const Pixel *palette)
+{
+	for(; n >= 4; n -= 4, src += 4, dest += 4)
+	{
+		dest[0] = palette[src[0]];
+		dest[1] = palette[src[1]];
+		dest[2] = palette[src[2]];
+		dest[3] = palette[src[3]];
+	}
+	while(n--)
+	{
+		*dest++ = palette[*src++];
+	}
+}
+
+#ifdef IG_PALETTE_EXPAND_AVX2
+static bool cpuHasAVX2()
+{
+	static const bool hasAVX2 = __builtin_cpu_supports("avx2");
+	return hasAVX2;
+}
+
+[[gnu::target("avx2")]]
+static void expandAVX2(const uint8_t *src, uint32_t *dest, size_t n, const uint32_t *palette)
+{
+	for(; n >= 8; n -= 8, src += 8, dest += 8)
+	{
+		auto idx = _mm256_cvtepu8_epi32(_mm_loadl_epi64((const __m128i*)src));
+		_mm256_storeu_si256((__m256i*)dest, _mm256_i32gather_epi32((const int*)palette, idx, 4));
+	}
+	expandScalar(src, dest, n, palette);
+}
+
+// Gathers 32 bits starting at each 16-bit entry and keeps the low half. Index 255 is masked
+// out of the gather so it never reads past the palette and takes the pre-loaded entry instead.
+[[gnu::target("avx2")]]
+static __m256i gather16AVX2(const uint16_t *palette, __m256i idx, __m256i lastEntry, __m256i lastIdx)
+{
+	auto mask = _mm256_xor_si256(_mm256_cmpeq_epi32(idx, lastIdx), _mm256_set1_epi32(-1));
+	auto px = _mm256_mask_i32gather_epi32(lastEntry, (const int*)palette, idx, mask, 2);
+	return _mm256_and_si256(px, _mm256_set1_epi32(0xFFFF));
+}
+
+[[gnu::target("avx2")]]
+static void expandAVX2(const uint8_t *src, uint16_t *dest, size_t n, const uint16_t *palette)
+{
+	auto lastEntry = _mm256_set1_epi32(palette[255]);
+	auto lastIdx = _mm256_set1_epi32(255);
+	for(; n >= 16; n -= 16, src += 16, dest += 16)
+	{
+		auto idx0 = _mm256_cvtepu8_epi32(_mm_loadl_epi64((const __m128i*)src));
+		auto idx1 = _mm256_cvtepu8_epi32(_mm_loadl_epi64((const __m128i*)(src + 8)));
+		auto px0 = gather16AVX2(palette, idx0, lastEntry, lastIdx);
+		auto px1 = gather16AVX2(palette, idx1, lastEntry, lastIdx);
+		// packus interleaves 128-bit lanes, permute restores pixel order
+		auto packed = _mm256_permute4x64_epi64(_mm256_packus_epi32(px0, px1), _MM_SHUFFLE(3, 1, 2, 0));
+		_mm256_storeu_si256((__m256i*)dest, packed);
+	}
+	expandScalar(src, dest, n, palette);
+}
+#endif
+
+#ifdef IG_PALETTE_EXPAND_NEON
+// the palette is split into byte planes so each output byte is a 256-entry table lookup,
+// done as 4 chained 64-byte lookups since out of range indices return 0 (tbl) or are kept (tbx)
+static uint8x16_t lookup256(const uint8_t *plane, uint8x16_t idx)
+{
+	auto table = [](const uint8_t *p) { return uint8x16x4_t{{vld1q_u8(p), vld1q_u8(p + 16), vld1q_u8(p + 32), vld1q_u8(p + 48)}}; };
+	auto r = vqtbl4q_u8(table(plane), idx);
+	r = vqtbx4q_u8(r, table(plane + 64), vsubq_u8(idx, vdupq_n_u8(64)));
+	r = vqtbx4q_u8(r, table(plane + 128), vsubq_u8(idx, vdupq_n_u8(128)));
+	r = vqtbx4q_u8(r, table(plane + 192), vsubq_u8(idx, vdupq_n_u8(192)));
+	return r;
+}
+
+static void expandNEON(const uint8_t *src, uint32_t *dest, size_t n, const uint32_t *palette)
+{
+	alignas(16) uint8_t planes[4][256];
+	for(int i = 0; i < 256; i += 16)
+	{
+		auto p = vld4q_u8((const uint8_t*)&palette[i]);
+		vst1q_u8(&planes[0][i], p.val[0]);
+		vst1q_u8(&planes[1][i], p.val[1]);
+		vst1q_u8(&planes[2][i], p.val[2]);
+		vst1q_u8(&planes[3][i], p.val[3]);
+	}
+	for(; n >= 16; n -= 16, src += 16, dest += 16)
+	{
+		auto idx = vld1q_u8(src);
+		uint8x16x4_t px{{lookup256(planes[0], idx), lookup256(planes[1], idx),
+			lookup256(planes[2], idx), lookup256(planes[3], idx)}};
+		vst4q_u8((uint8_t*)dest, px);
+	}
+	expandScalar(src, dest, n, palette);
+}
+
+static void expandNEON(const uint8_t *src, uint16_t *dest, size_t n, const uint16_t *palette)
+{
+	alignas(16) uint8_t planes[2][256];
+	for(int i = 0; i < 256; i += 16)
+	{
+		auto p = vld2q_u8((const uint8_t*)&palette[i]);
+		vst1q_u8(&planes[0][i], p.val[0]);
+		vst1q_u8(&planes[1][i], p.val[1]);
+	}
+	for(; n >= 16; n -= 16, src += 16, dest += 16)
+	{
+		auto idx = vld1q_u8(src);
+		uint8x16x2_t px{{lookup256(planes[0], idx), lookup256(planes[1], idx)}};
+		vst2q_u8((uint8_t*)dest, px);
+	}
+	expandScalar(src, dest, n, palette);
+}
+#endif
+
+template <class Pixel>
+static void expandPalette8Impl(std::span<const uint8_t> src, Pixel *dest, std::span<const Pixel, 256> palette)
+{
+	#if defined IG_PALETTE_EXPAND_AVX2
+	if(cpuHasAVX2())
+		return expandAVX2(src.data(), dest, src.size(), palette.data());
+	#elif defined IG_PALETTE_EXPAND_NEON
+	if(src.size() >= 64) // skip the plane setup for tiny spans
+		return expandNEON(src.data(), dest, src.size(), palette.data());
+	#endif
+	expandScalar(src.data(), dest, src.size(), palette.data());
+}
+
+void expandPalette8(std::span<const uint8_t> src, uint16_t *dest, std::span<const uint16_t, 256> palette)
+{
+	expandPalette8Impl(src, dest, palette);
+}
+
+void expandPalette8(std::span<const uint8_t> src, uint32_t *dest, std::span<const uint32_t, 256> palette)
+{
+	expandPalette8Impl(src, dest, palette);
+}
+
+template <class Pixel>
+static double megapixelsPerSec(auto &&func, int pixels)
+{
+	using namespace std::chrono;
+	constexpr int minIterations = 16;
+	constexpr auto minDuration = milliseconds{250};
+	int iterations{};
+	auto start = steady_clock::now();
+	auto elapsed = steady_clock::duration{};
+	do
+	{
+		func();
+		iterations++;
+		elapsed = steady_clock::now() - start;
+	} while(iterations < minIterations || elapsed < minDuration);
+	return double(pixels) * iterations / duration_cast<duration<double>>(elapsed).count() / 1e6;
+}
+
+template <class Pixel>
+static std::string benchmarkFormat(const char *name, std::span<const uint8_t> srcData, WP size, PixelFormat fmt)
+{
+	std::array<Pixel, 256> palette;
+	for(auto i : iotaCount(256))
+		palette[i] = Pixel(i * 0x01010101u);
+	std::vector<Pixel> destData(size.x * size.y);
+	PixmapView src{{size, PIXEL_FMT_I8}, srcData.data()};
+	MutablePixmapView dest{{size, fmt}, destData.data()};
+	auto generic = megapixelsPerSec<Pixel>([&]{ dest.writeTransformed([&](uint8_t p){ return palette[p]; }, src); }, size.x * size.y);
+	auto expanded = megapixelsPerSec<Pixel>([&]{ dest.writePaletteExpanded(std::span<const Pixel, 256>{palette}, src); }, size.x * size.y);
+	return fmt::format("{{\"format\":\"{}\",\"writeTransformed_mpix_per_sec\":{:.1f},\"writePaletteExpanded_mpix_per_sec\":{:.1f},\"speedup\":{:.2f}}}",
+		name, generic, expanded, expanded / generic);
+}
+
+std::string benchmarkPaletteExpand()
+{
+	constexpr WP size{256, 240};
+	std::vector<uint8_t> srcData(size.x * size.y);
+	std::minstd_rand rng{1};
+	for(auto &p : srcData)
+		p = rng();
+	return fmt::format("{{\"width\":{},\"height\":{},\"results\":[{},{}]}}", size.x, size.y,
+		benchmarkFormat<uint16_t>("I8->RGB565", srcData, size, PIXEL_FMT_RGB565),
+		benchmarkFormat<uint32_t>("I8->RGBA8888", srcData, size, PIXEL_FMT_RGBA8888));
+}
+
+}
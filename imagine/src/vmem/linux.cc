@@ -75,6 +75,36 @@ size_t adjustVMemAllocSize(size_t size)
 	return roundUpToPageSize(size);
 }
 
+bool moveVMem(void *src, size_t size, void *dest)
+{
+	if(mremap(src, size, size, MREMAP_MAYMOVE | MREMAP_FIXED, dest) == MAP_FAILED)
+	{
+		logErr("error in mremap");
+		return false;
+	}
+	return true;
+}
+
+bool makeVMemWritable(void *vMemPtr, size_t size)
+{
+	if(mprotect(vMemPtr, size, PROT_READ | PROT_WRITE) == -1)
+	{
+		logErr("error in mprotect");
+		return false;
+	}
+	return true;
+}
+
+bool resetVMem(void *vMemPtr, size_t size)
+{
+	if(mmap(vMemPtr, size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_FIXED, -1, 0) == MAP_FAILED)
+	{
+		logErr("error in mmap");
+		return false;
+	}
+	return true;
+}
+
 void *allocMirroredBuffer(size_t size)
 {
 	// allocate enough pages for the buffer + the mirrored pages
@@ -54,6 +54,42 @@ size_t adjustVMemAllocSize(size_t size)
 	return round_page(size);
 }
 
+bool moveVMem(void *src, size_t size, void *dest)
+{
+	vm_prot_t currProtect, maxProtect;
+	vm_address_t destAddr = (vm_address_t)dest;
+	if(vm_remap(mach_task_self(), &destAddr, size, 0,
+		VM_FLAGS_FIXED | VM_FLAGS_OVERWRITE, mach_task_self(), (vm_address_t)src,
+		0, &currProtect, &maxProtect, VM_INHERIT_COPY) != KERN_SUCCESS)
+	{
+		logErr("error in vm_remap");
+		return false;
+	}
+	freeVMem(src, size);
+	return true;
+}
+
+bool makeVMemWritable(void *vMemPtr, size_t size)
+{
+	if(vm_protect(mach_task_self(), (vm_address_t)vMemPtr, size, false, VM_PROT_READ | VM_PROT_WRITE) != KERN_SUCCESS)
+	{
+		logErr("error in vm_protect");
+		return false;
+	}
+	return true;
+}
+
+bool resetVMem(void *vMemPtr, size_t size)
+{
+	vm_address_t addr = (vm_address_t)vMemPtr;
+	if(vm_allocate(mach_task_self(), &addr, size, VM_FLAGS_FIXED | VM_FLAGS_OVERWRITE) != KERN_SUCCESS)
+	{
+		logErr("error in vm_allocate");
+		return false;
+	}
+	return true;
+}
+
 void *allocMirroredBuffer(size_t size)
 {
 	// allocate enough pages for the buffer + the mirrored pages